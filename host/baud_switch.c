@@ -0,0 +1,292 @@
+/******************************************************************************
+ * File Name:   baud_switch.c
+ *
+ * Description: Moves a kit built with ENABLE_BAUD_SWITCH to a new baud rate
+ *              without a reboot. Optionally sends sync characters first so the
+ *              kit detects the current rate, then sends the switch request,
+ *              follows the kit to the new rate on its answer and verifies the
+ *              link with an echoed test pattern.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "baud_rate.h"
+#include "serial_port.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define DEFAULT_INITIAL_BAUD 115200
+#define RESPONSE_TIMEOUT_MS 1000
+#define SYNC_COUNT 8u
+#define PATTERN_SIZE 256u
+
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000u) + ((uint64_t)ts.tv_nsec / 1000u);
+}
+
+/*******************************************************************************
+ * Function Name: write_all
+ ********************************************************************************
+ * Summary:
+ * Write everything, waiting for the port to drain when its buffer is full.
+ *
+ *******************************************************************************/
+static int write_all(int fd, const uint8_t *data, size_t len)
+{
+    while (len != 0)
+    {
+        ssize_t n = write(fd, data, len);
+        if (n > 0)
+        {
+            data += n;
+            len -= (size_t)n;
+        }
+        else if ((n < 0) && (errno == EAGAIN))
+        {
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+            poll(&pfd, 1, -1);
+        }
+        else if ((n < 0) && (errno != EINTR))
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: read_byte
+ ********************************************************************************
+ * Summary:
+ * Read one byte before the deadline.
+ *
+ * Return:
+ *  int: The byte, or -1 on timeout or error
+ *
+ *******************************************************************************/
+static int read_byte(int fd, uint64_t deadline_us)
+{
+    for (;;)
+    {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        uint64_t now = now_us();
+        uint8_t c;
+
+        if (now >= deadline_us)
+        {
+            return -1;
+        }
+        if (poll(&pfd, 1, (int)((deadline_us - now + 999u) / 1000u)) <= 0)
+        {
+            continue;
+        }
+        if (read(fd, &c, 1) == 1)
+        {
+            return c;
+        }
+        if ((errno != EAGAIN) && (errno != EINTR))
+        {
+            return -1;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: wait_response
+ ********************************************************************************
+ * Summary:
+ * Wait for the answer to a switch request, skipping the echo of the request
+ * and anything else the kit sends before it.
+ *
+ * Return:
+ *  int: BAUD_RATE_ACCEPT, BAUD_RATE_REJECT, or -1 on timeout
+ *
+ *******************************************************************************/
+static int wait_response(int fd, uint32_t rate)
+{
+    uint8_t expected[BAUD_RATE_REQUEST_SIZE];
+    uint64_t deadline = now_us() + (RESPONSE_TIMEOUT_MS * 1000u);
+    uint32_t fill = 0;
+    int code = -1;
+    int c;
+
+    baud_rate_response(expected, 0, rate);
+    while ((c = read_byte(fd, deadline)) >= 0)
+    {
+        if (fill == 0)
+        {
+            fill = (c == BAUD_RATE_ESCAPE) ? 1u : 0u;
+        }
+        else if (fill == 1u)
+        {
+            code = c;
+            fill = ((c == BAUD_RATE_ACCEPT) || (c == BAUD_RATE_REJECT)) ? 2u : ((c == BAUD_RATE_ESCAPE) ? 1u : 0u);
+        }
+        else if ((uint8_t)c == expected[fill])
+        {
+            if (++fill == BAUD_RATE_REQUEST_SIZE)
+            {
+                return code;
+            }
+        }
+        else
+        {
+            fill = (c == BAUD_RATE_ESCAPE) ? 1u : 0u;
+        }
+    }
+    return -1;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-i initial_baud] [-a] port baud\n"
+            "  -i  current rate of the link (default: %d)\n"
+            "  -a  send sync characters first so the kit detects the current rate\n",
+            argv0, DEFAULT_INITIAL_BAUD);
+}
+
+int main(int argc, char *argv[])
+{
+    long initial = DEFAULT_INITIAL_BAUD;
+    bool sync = false;
+    uint8_t request[BAUD_RATE_REQUEST_SIZE];
+    uint8_t pattern[PATTERN_SIZE];
+    uint32_t matched = 0;
+    uint64_t start;
+    uint64_t switched;
+    long rate;
+    int fd;
+    int code;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:ah")) != -1)
+    {
+        switch (opt)
+        {
+            case 'i': initial = strtol(optarg, NULL, 0); break;
+            case 'a': sync = true; break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((argc - optind) != 2)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    rate = strtol(argv[optind + 1], NULL, 0);
+    if (serial_port_speed(rate) == 0)
+    {
+        fprintf(stderr, "%ld: rate not supported by termios\n", rate);
+        return EXIT_FAILURE;
+    }
+
+    fd = serial_port_open(argv[optind], O_RDWR, initial);
+    if (fd < 0)
+    {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    if (sync)
+    {
+        /* The kit adopts the rate of the sync characters and flushes what it misframed */
+        memset(pattern, BAUD_RATE_SYNC_CHAR, SYNC_COUNT);
+        write_all(fd, pattern, SYNC_COUNT);
+        tcdrain(fd);
+        usleep(50000);
+        tcflush(fd, TCIFLUSH);
+    }
+
+    start = now_us();
+    baud_rate_response(request, BAUD_RATE_REQUEST, (uint32_t)rate);
+    if (write_all(fd, request, sizeof(request)) != 0)
+    {
+        perror("write");
+        return EXIT_FAILURE;
+    }
+    code = wait_response(fd, (uint32_t)rate);
+    if (code != BAUD_RATE_ACCEPT)
+    {
+        fprintf(stderr, "%s\n", (code == BAUD_RATE_REJECT) ? "kit rejected the rate" : "no answer from the kit");
+        return EXIT_FAILURE;
+    }
+
+    /* The kit switches once its answer has left the shift register */
+    if (serial_port_set_baud(fd, rate) != 0)
+    {
+        perror("tcsetattr");
+        return EXIT_FAILURE;
+    }
+    switched = now_us();
+    usleep(2000);
+    tcflush(fd, TCIFLUSH);
+
+    for (uint32_t i = 0; i < PATTERN_SIZE; ++i)
+    {
+        pattern[i] = (uint8_t)(i ^ 0xA5u);
+    }
+    write_all(fd, pattern, sizeof(pattern));
+    while (matched < PATTERN_SIZE)
+    {
+        int c = read_byte(fd, now_us() + (RESPONSE_TIMEOUT_MS * 1000u));
+        if ((c < 0) || ((uint8_t)c != pattern[matched]))
+        {
+            break;
+        }
+        matched++;
+    }
+
+    printf("%ld -> %ld baud: switched %.1f ms after the request, echo %u of %u bytes %s\n", initial, rate,
+           (switched - start) / 1000.0, matched, PATTERN_SIZE, (matched == PATTERN_SIZE) ? "verified" : "FAILED");
+    close(fd);
+    return (matched == PATTERN_SIZE) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,244 @@
+/******************************************************************************
+ * File Name:   bench_autobaud.c
+ *
+ * Description: Checks the auto-baud detector and the switch request parser. RX
+ *              waveforms are generated at standard rates with a transmitter
+ *              clock error and capture timer quantization; the detector must
+ *              find the rate of a 0x55 sync character after random traffic,
+ *              and its false detections on traffic without sync characters are
+ *              counted.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "baud_rate.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define DEFAULT_CLOCK 36000000u     /* fCCU 144 MHz with prescaler 4 */
+#define TIMER_MASK 0xFFFFu          /* 16-bit CCU4 slice */
+#define NOISE_BYTES 100000u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    autobaud_t detector;
+    double now;                 /* Line time in timer ticks */
+    double bit;                 /* Bit time in timer ticks, including the clock error */
+    int level;                  /* Current line level */
+    uint32_t edges;
+    uint32_t detected;          /* First rate reported, 0 if none */
+    uint32_t detected_at;       /* Edge count at the first detection */
+} line_t;
+
+/*******************************************************************************
+ * Function Name: line_send
+ ********************************************************************************
+ * Summary:
+ * Drive one 8N1 character onto the simulated line, feeding the capture time
+ * of every edge to the detector. Captures are quantized to timer ticks with
+ * one tick of random jitter.
+ *
+ *******************************************************************************/
+static void line_send(line_t *line, uint8_t c, uint32_t idle_bits)
+{
+    uint32_t frame = (1u << 9) | ((uint32_t)c << 1);    /* start 0, data LSB first, stop 1 */
+
+    line->now += idle_bits * line->bit;
+    for (uint32_t i = 0; i < 10u; ++i)
+    {
+        int level = (int)((frame >> i) & 1u);
+        if (level != line->level)
+        {
+            uint32_t capture = (uint32_t)(line->now + (rand() % 2)) & TIMER_MASK;
+            uint32_t rate = autobaud_edge(&line->detector, capture);
+
+            line->level = level;
+            line->edges++;
+            if ((rate != 0) && (line->detected == 0))
+            {
+                line->detected = rate;
+                line->detected_at = line->edges;
+            }
+        }
+        line->now += line->bit;
+    }
+}
+
+/* Beyond BAUD_RATE_SNAP_PERCENT the true transmitter rate is expected */
+static bool matches(uint32_t detected, uint32_t nominal, double actual)
+{
+    return (detected == nominal) || (fabs(detected - actual) < (actual * 0.01));
+}
+
+static void line_init(line_t *line, uint32_t clock, uint32_t rate, double error)
+{
+    memset(line, 0, sizeof(*line));
+    autobaud_init(&line->detector, clock, TIMER_MASK);
+    line->bit = ((double)clock / rate) * (1.0 + error);
+    line->level = 1;
+}
+
+/*******************************************************************************
+ * Function Name: check_parser
+ ********************************************************************************
+ * Summary:
+ * Feed requests split at every position, embedded in traffic containing
+ * stray escape bytes, and check the parsed rate.
+ *
+ *******************************************************************************/
+static bool check_parser(void)
+{
+    uint8_t stream[64];
+    uint8_t request[BAUD_RATE_REQUEST_SIZE];
+    uint32_t len = 0;
+
+    stream[len++] = 'a';
+    stream[len++] = BAUD_RATE_ESCAPE;
+    stream[len++] = BAUD_RATE_ESCAPE;
+    baud_rate_response(request, BAUD_RATE_REQUEST, 3000000u);
+    request[4] = BAUD_RATE_ESCAPE;   /* escape inside the rate field must not restart the parser */
+    memcpy(&stream[len], request, sizeof(request));
+    len += sizeof(request);
+    stream[len++] = '\r';
+
+    for (uint32_t split = 0; split <= len; ++split)
+    {
+        baud_request_t req;
+        uint32_t rate;
+
+        baud_request_init(&req);
+        rate = baud_request_scan(&req, stream, split);
+        rate |= baud_request_scan(&req, &stream[split], len - split);
+        if (rate != ((3000000u & 0xFF00FFFFu) | ((uint32_t)BAUD_RATE_ESCAPE << 16)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-c clock_hz] [-e error_percent]\n"
+            "  -c  capture timer clock (default: %u)\n"
+            "  -e  transmitter clock error in percent (default: 1.5)\n",
+            argv0, DEFAULT_CLOCK);
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t rates[] =
+    {
+        9600u, 19200u, 57600u, 115200u, 230400u, 460800u, 921600u, 1000000u, 2000000u, 3000000u
+    };
+    uint32_t clock = DEFAULT_CLOCK;
+    double error = 0.015;
+    bool ok = true;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:e:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c': clock = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'e': error = strtod(optarg, NULL) / 100.0; break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    srand(1);
+    printf("capture clock %u Hz, 16-bit timer, transmitter clock error %+.1f%%\n", clock, error * 100.0);
+    for (uint32_t r = 0; r < (sizeof(rates) / sizeof(rates[0])); ++r)
+    {
+        line_t line;
+        uint32_t false_detections = 0;
+        uint32_t lowest_wrong = 0;
+        double actual;
+        bool found;
+
+        /* Traffic without sync characters: count reports of a wrong rate */
+        actual = rates[r] / (1.0 + error);
+        line_init(&line, clock, rates[r], error);
+        for (uint32_t i = 0; i < NOISE_BYTES; ++i)
+        {
+            uint8_t c = (uint8_t)rand();
+            uint32_t before = line.edges;
+
+            line.detected = 0;
+            line_send(&line, (c == BAUD_RATE_SYNC_CHAR) ? 0 : c, (uint32_t)(rand() % 3));
+            if ((line.detected != 0) && !matches(line.detected, rates[r], actual) && (line.detected_at > before))
+            {
+                false_detections++;
+                lowest_wrong = ((lowest_wrong == 0) || (line.detected < lowest_wrong)) ? line.detected : lowest_wrong;
+            }
+        }
+
+        /* Random characters from a link at the wrong rate, an idle gap, then the sync character */
+        line_init(&line, clock, rates[r], error);
+        for (uint32_t i = 0; i < 16u; ++i)
+        {
+            uint8_t c = (uint8_t)rand();
+            line_send(&line, (c == BAUD_RATE_SYNC_CHAR) ? 0 : c, 0);
+            line.detected = 0;
+        }
+        line_send(&line, BAUD_RATE_SYNC_CHAR, 20);
+
+        found = matches(line.detected, rates[r], actual);
+        printf("%8u baud: detected %8u %s, %u wrong-rate reports in %u bytes of traffic", rates[r], line.detected,
+               found ? "ok  " : "FAIL", false_detections, NOISE_BYTES);
+        if (false_detections != 0)
+        {
+            printf(" (lowest %u)", lowest_wrong);
+        }
+        printf("\n");
+        ok = ok && found;
+    }
+
+    printf("switch request parser: %s\n", check_parser() ? "ok" : "FAIL");
+    return (ok && check_parser()) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,260 @@
+/******************************************************************************
+ * File Name:   bench_budget.c
+ *
+ * Description: Host benchmark of budgeted per-tick consumption. The DMA ring
+ *              of main.c is filled at line rate while the consumer misses
+ *              ticks now and then; SysTick_Handler is replayed with a modeled
+ *              CPU cycle clock and a per-byte handler cost, draining
+ *              everything or up to a byte or cycle budget, and the worst ISR
+ *              duration, the backlog carried and the stream are checked.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "ring_buffer.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define RING_SIZE 1024u             /* RING_BUFFER_SIZE in main.c */
+#define CHUNK 16u                   /* RX_BUDGET_CHUNK in main.c */
+#define CPU_HZ 144000000u           /* XMC4700 core clock */
+#define TICKS_PER_SECOND 1000u
+#define SEGMENT_CYCLES 60u          /* Handler call overhead */
+#define TICK_CYCLES 200u            /* Handler entry, position read, statistics */
+#define DEFAULT_BAUD 921600u
+#define DEFAULT_BYTE_CYCLES 40u     /* E.g. decryption and scanner stages */
+#define DEFAULT_STALL_MS 10u        /* Ticks missed in a row ... */
+#define DEFAULT_STALL_EVERY_MS 500u /* ... this often */
+#define DEFAULT_SECONDS 30u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    const char *name;
+    uint32_t bytes;                 /* Per tick, 0 for no limit */
+    uint32_t cycles;                /* Per tick, 0 for no limit */
+} bench_setting_t;
+
+typedef struct
+{
+    uint32_t expected;              /* Stream position of the next byte */
+    uint32_t cycles;                /* Modeled CPU clock */
+    uint32_t byte_cycles;
+    bool in_order;
+} sim_consumer_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static volatile uint8_t storage[RING_SIZE];
+
+static uint8_t pattern(uint32_t position)
+{
+    return (uint8_t)(position ^ (position >> 8) ^ (position >> 16));
+}
+
+/* Stands in for uart_receive(): checks the stream and charges its cycles */
+static void sim_handler(void *context, const uint8_t *data, uint32_t len)
+{
+    sim_consumer_t *c = context;
+
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        c->in_order &= (data[i] == pattern(c->expected + i));
+    }
+    c->expected += len;
+    c->cycles += SEGMENT_CYCLES + (len * c->byte_cycles);
+}
+
+/*******************************************************************************
+ * Function Name: run
+ ********************************************************************************
+ * Summary:
+ * Replay one setting. The consumer step is the ENABLE_RX_BUDGET branch of
+ * SysTick_Handler: chunks of RX_BUDGET_CHUNK bytes until the byte budget is
+ * used up or the cycle budget is exceeded. An overflow is reported when the
+ * DMA would overwrite unread data.
+ *
+ *******************************************************************************/
+static void run(const bench_setting_t *setting, uint32_t baud, uint32_t byte_cycles, uint32_t stall_ms,
+                uint32_t stall_every_ms, uint32_t seconds)
+{
+    ring_buffer_t ring;
+    sim_consumer_t consumer = { 0, 0, byte_cycles, true };
+    uint32_t per_second = baud / 10u;
+    uint64_t written = 0;
+    uint32_t worst_cycles = 0;
+    uint32_t backlog_max = 0;
+    uint32_t overflow_ms = 0;
+
+    ring_buffer_init(&ring, storage, RING_SIZE);
+
+    for (uint32_t ms = 1; ms <= (seconds * TICKS_PER_SECOND); ++ms)
+    {
+        uint64_t target = ((uint64_t)ms * per_second) / TICKS_PER_SECOND;
+        uint32_t end;
+        uint32_t start_cycles;
+        uint32_t budget = (setting->bytes != 0) ? setting->bytes : 0xFFFFFFFFu;
+        uint32_t taken;
+
+        /* DMA: bytes of this millisecond */
+        while (written < target)
+        {
+            if (ring_buffer_pending(&ring, (uint32_t)((written + 1u) % RING_SIZE)) == 0)
+            {
+                overflow_ms = (overflow_ms == 0) ? ms : overflow_ms;
+                break;
+            }
+            storage[written % RING_SIZE] = pattern((uint32_t)written);
+            written++;
+        }
+        if (overflow_ms != 0)
+        {
+            break;
+        }
+
+        /* Higher-priority work keeps SysTick out */
+        if ((ms % stall_every_ms) < stall_ms)
+        {
+            continue;
+        }
+
+        end = (uint32_t)(written % RING_SIZE);
+        consumer.cycles = 0;
+        start_cycles = consumer.cycles;
+        consumer.cycles += TICK_CYCLES;
+        if ((setting->bytes == 0) && (setting->cycles == 0))
+        {
+            ring_buffer_consume(&ring, end, sim_handler, &consumer);
+        }
+        else
+        {
+            do
+            {
+                uint32_t chunk = (budget < CHUNK) ? budget : CHUNK;
+
+                taken = ring_buffer_consume_max(&ring, end, chunk, sim_handler, &consumer);
+                budget -= taken;
+            } while ((taken != 0) && (budget != 0) &&
+                     ((setting->cycles == 0) || ((consumer.cycles - start_cycles) < setting->cycles)));
+        }
+
+        backlog_max = (ring_buffer_pending(&ring, end) > backlog_max) ? ring_buffer_pending(&ring, end) : backlog_max;
+        worst_cycles = ((consumer.cycles - start_cycles) > worst_cycles) ? (consumer.cycles - start_cycles)
+                                                                         : worst_cycles;
+    }
+
+    printf("  %-24s worst ISR %6u cycles (%6.1f us), backlog carried up to %4u B, ", setting->name, worst_cycles,
+           (worst_cycles * 1e6) / CPU_HZ, backlog_max);
+    if (overflow_ms != 0)
+    {
+        printf("ring OVERFLOW after %u ms\n", overflow_ms);
+    }
+    else
+    {
+        printf("stream %s\n", consumer.in_order ? "verified" : "CORRUPT");
+    }
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-b baud] [-c cycles_per_byte] [-t stall_ms] [-e stall_every_ms] [-s seconds]\n"
+            "  -b  line rate (default: %u)\n"
+            "  -c  handler cost per byte in CPU cycles (default: %u)\n"
+            "  -t  ticks missed in a row (default: %u)\n"
+            "  -e  interval of the missed ticks in ms (default: %u)\n"
+            "  -s  simulated time (default: %u)\n",
+            argv0, DEFAULT_BAUD, DEFAULT_BYTE_CYCLES, DEFAULT_STALL_MS, DEFAULT_STALL_EVERY_MS, DEFAULT_SECONDS);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t baud = DEFAULT_BAUD;
+    uint32_t byte_cycles = DEFAULT_BYTE_CYCLES;
+    uint32_t stall_ms = DEFAULT_STALL_MS;
+    uint32_t stall_every_ms = DEFAULT_STALL_EVERY_MS;
+    uint32_t seconds = DEFAULT_SECONDS;
+    uint32_t per_tick;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:c:t:e:s:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'c': byte_cycles = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 't': stall_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'e': stall_every_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((baud < 9600u) || (baud > 10000000u) || (stall_every_ms == 0) || (stall_ms >= stall_every_ms) ||
+        (seconds == 0) || (seconds > 3600u))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    per_tick = (baud / 10u + TICKS_PER_SECOND - 1u) / TICKS_PER_SECOND;
+    {
+        const bench_setting_t settings[] =
+        {
+            { "drain everything:", 0u, 0u },
+            { "256 bytes per tick:", 256u, 0u },
+            { "2x line rate per tick:", 2u * per_tick, 0u },
+            { "line rate per tick:", per_tick, 0u },
+            { "25 us per tick:", 0u, CPU_HZ / 40000u },
+        };
+
+        printf("%u baud (%u B per tick), %u cycles per byte, %u ticks missed every %u ms, %u B ring\n", baud,
+               per_tick, byte_cycles, stall_ms, stall_every_ms, RING_SIZE);
+        for (uint32_t i = 0; i < (sizeof(settings) / sizeof(settings[0])); ++i)
+        {
+            run(&settings[i], baud, byte_cycles, stall_ms, stall_every_ms, seconds);
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,240 @@
+/******************************************************************************
+ * File Name:   bench_coalesce.c
+ *
+ * Description: Host benchmark of the transmit coalescer. Chatty echo traffic
+ *              of small fragments is replayed tick by tick through tx_coalesce
+ *              for several threshold and deadline settings, counting transfers
+ *              and the time bytes are held.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tx_coalesce.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define TICK_US 1000u               /* SysTick period, TICKS_PER_SECOND in main.c */
+#define BATCH_SIZE 256u             /* TX_COALESCE_SIZE in main.c */
+#define DEFAULT_RATE 3000u          /* Fragments per second */
+#define DEFAULT_MAX_FRAGMENT 8u
+#define DEFAULT_SECONDS 10u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t threshold;
+    uint32_t deadline_us;
+} bench_setting_t;
+
+typedef struct
+{
+    uint32_t *arrival;              /* Tick at which each stream byte was written */
+    uint32_t tick;                  /* Current tick */
+    uint32_t expected;              /* Stream position of the next byte */
+    uint32_t transfers;
+    uint64_t hold_us;               /* Sum over all bytes */
+    uint32_t max_hold_us;
+    bool in_order;
+} bench_sink_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static const bench_setting_t settings[] =
+{
+    { 1u, 0u },                     /* Coalescing off: every fragment is one transfer */
+    { 64u, 500u },                  /* main.c defaults, hold for one tick */
+    { 64u, 2000u },
+    { 256u, 5000u },
+    { 16u, 500u },
+};
+
+static uint8_t pattern(uint32_t position)
+{
+    return (uint8_t)(position ^ (position >> 8) ^ (position >> 16));
+}
+
+static uint32_t random_below(uint32_t *state, uint32_t limit)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state % limit;
+}
+
+/*******************************************************************************
+ * Sink standing in for uart_transmit(): one call is one transfer to set up.
+ *******************************************************************************/
+static void bench_sink(void *context, const uint8_t *data, uint32_t len)
+{
+    bench_sink_t *s = context;
+
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        uint32_t hold = (s->tick - s->arrival[s->expected + i]) * TICK_US;
+
+        if (data[i] != pattern(s->expected + i))
+        {
+            s->in_order = false;
+        }
+        s->hold_us += hold;
+        s->max_hold_us = (hold > s->max_hold_us) ? hold : s->max_hold_us;
+    }
+    s->expected += len;
+    s->transfers++;
+}
+
+/*******************************************************************************
+ * Function Name: run
+ ********************************************************************************
+ * Summary:
+ * Replay the same fragment sequence through one setting. Each tick first
+ * calls tx_coalesce_tick() and then writes the fragments that arrived in the
+ * tick, like SysTick_Handler with ENABLE_TX_COALESCING.
+ *
+ *******************************************************************************/
+static void run(const bench_setting_t *setting, uint32_t rate, uint32_t max_fragment, uint32_t seconds,
+                uint32_t *arrival)
+{
+    static uint8_t storage[BATCH_SIZE];
+    uint8_t fragment[DEFAULT_MAX_FRAGMENT * 32u];
+    tx_coalesce_t tx;
+    bench_sink_t out;
+    uint32_t seed = 0x2545F491u;
+    uint32_t written = 0;
+    uint32_t ticks = seconds * (1000000u / TICK_US);
+    uint32_t fragments = 0;
+    uint32_t deadline_ticks = (setting->deadline_us + TICK_US - 1u) / TICK_US;
+
+    /* Rounded up to whole ticks as in main.c */
+    deadline_ticks = (deadline_ticks != 0) ? deadline_ticks : 1u;
+    memset(&out, 0, sizeof(out));
+    out.arrival = arrival;
+    out.in_order = true;
+    tx_coalesce_init(&tx, storage, sizeof(storage), bench_sink, &out, setting->threshold, deadline_ticks);
+
+    for (out.tick = 0; out.tick < ticks; ++out.tick)
+    {
+        /* Fragments arriving in this tick, rate is spread over the ticks */
+        uint32_t count = (rate / (1000000u / TICK_US)) + ((random_below(&seed, 1000000u / TICK_US) <
+                                                            (rate % (1000000u / TICK_US))) ? 1u : 0u);
+
+        tx_coalesce_tick(&tx, 1u);
+        for (uint32_t f = 0; f < count; ++f)
+        {
+            uint32_t len = 1u + random_below(&seed, max_fragment);
+
+            for (uint32_t i = 0; i < len; ++i)
+            {
+                fragment[i] = pattern(written + i);
+                arrival[written + i] = out.tick;
+            }
+            tx_coalesce_write(&tx, fragment, len);
+            written += len;
+            fragments++;
+        }
+    }
+    tx_coalesce_flush(&tx);
+
+    printf("  threshold %3u, deadline %5u us (%2u ticks): %7u transfers for %7u fragments (%5.1f bytes each), "
+           "hold mean %6.1f us max %5u us, stream %s\n",
+           setting->threshold, setting->deadline_us, deadline_ticks, out.transfers, fragments,
+           (double)out.expected / (double)out.transfers, (double)out.hold_us / (double)out.expected,
+           out.max_hold_us, ((out.expected == written) && out.in_order) ? "verified" : "CORRUPT");
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-r fragments_per_s] [-m max_fragment] [-s seconds]\n"
+            "  -r  fragment rate (default: %u)\n"
+            "  -m  largest fragment in bytes, at most %u (default: %u)\n"
+            "  -s  simulated time (default: %u)\n",
+            argv0, DEFAULT_RATE, DEFAULT_MAX_FRAGMENT * 32u, DEFAULT_MAX_FRAGMENT, DEFAULT_SECONDS);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t rate = DEFAULT_RATE;
+    uint32_t max_fragment = DEFAULT_MAX_FRAGMENT;
+    uint32_t seconds = DEFAULT_SECONDS;
+    uint32_t *arrival;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:m:s:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'r': rate = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'm': max_fragment = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((rate == 0) || (max_fragment == 0) || (max_fragment > (DEFAULT_MAX_FRAGMENT * 32u)) || (seconds == 0) ||
+        (((uint64_t)rate * max_fragment * seconds) > 0x7FFFFFFFu))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Upper bound of the stream length, one entry per byte */
+    arrival = malloc(((size_t)rate + (1000000u / TICK_US)) * max_fragment * seconds * sizeof(uint32_t));
+    if (arrival == NULL)
+    {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+
+    printf("%u fragments/s of 1..%u bytes for %u s, %u us ticks, %u byte batches\n", rate, max_fragment, seconds,
+           TICK_US, BATCH_SIZE);
+    for (uint32_t i = 0; i < (sizeof(settings) / sizeof(settings[0])); ++i)
+    {
+        run(&settings[i], rate, max_fragment, seconds, arrival);
+    }
+
+    free(arrival);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,331 @@
+/******************************************************************************
+ * File Name:   bench_dfa.c
+ *
+ * Description: Benchmark of the generated line protocol scanner against a
+ *              hand-written switch parser for the same grammar. Both run over
+ *              the same stream in tick-sized segments; the token counts must
+ *              agree on well-formed input.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "line_protocol_dfa.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define STREAM_SIZE (8u * 1024u * 1024u)
+#define SEGMENT_SIZE 92u /* One tick at 921600 baud */
+#define ROUNDS 5u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+/* States of the hand-written parser */
+typedef enum
+{
+    SW_IDLE,
+    SW_O, SW_OK, SW_OK_CR,
+    SW_E, SW_ER, SW_ERR, SW_ERRO, SW_ERROR, SW_ERROR_CR,
+    SW_DOLLAR, SW_ADDRESS, SW_FIELDS, SW_CHECK1, SW_CHECK2, SW_CHECK_CR, SW_TLM_LF
+} switch_state_t;
+
+/* Telemetry sub-states, tracked next to the NMEA field state */
+typedef enum
+{
+    TLM_NONE, TLM_T, TLM_TL, TLM_TLM, TLM_NUMBER_START, TLM_NUMBER, TLM_KEY_START, TLM_KEY, TLM_VALUE_START, TLM_VALUE
+} tlm_state_t;
+
+typedef struct
+{
+    switch_state_t state;
+    tlm_state_t tlm;
+} switch_parser_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static uint8_t stream[STREAM_SIZE];
+static uint32_t dfa_counts[LINE_PROTOCOL_TOKENS + 1];
+static uint32_t switch_counts[LINE_PROTOCOL_TOKENS + 1];
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+static void count_token(void *context, uint8_t token, const uint8_t *end)
+{
+    (void)end;
+    ((uint32_t *)context)[token]++;
+}
+
+static bool is_upper(uint8_t c)
+{
+    return (c >= 'A') && (c <= 'Z');
+}
+
+static bool is_digit(uint8_t c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+static bool is_hex(uint8_t c)
+{
+    return is_digit(c) || ((c >= 'A') && (c <= 'F'));
+}
+
+/*******************************************************************************
+ * Function Name: telemetry_step
+ ********************************************************************************
+ * Summary:
+ * Advances the telemetry validation for one field byte of a '$' sentence.
+ *
+ *******************************************************************************/
+static tlm_state_t telemetry_step(tlm_state_t tlm, uint8_t c)
+{
+    switch (tlm)
+    {
+        case TLM_T: return (c == 'L') ? TLM_TL : TLM_NONE;
+        case TLM_TL: return (c == 'M') ? TLM_TLM : TLM_NONE;
+        case TLM_TLM: return (c == ',') ? TLM_NUMBER_START : TLM_NONE;
+        case TLM_NUMBER_START: return is_digit(c) ? TLM_NUMBER : TLM_NONE;
+        case TLM_NUMBER: return is_digit(c) ? TLM_NUMBER : ((c == ',') ? TLM_KEY_START : TLM_NONE);
+        case TLM_KEY_START: return ((c >= 'a') && (c <= 'z')) ? TLM_KEY : TLM_NONE;
+        case TLM_KEY: return ((c >= 'a') && (c <= 'z')) ? TLM_KEY : ((c == '=') ? TLM_VALUE_START : TLM_NONE);
+        case TLM_VALUE_START:
+        case TLM_VALUE:
+            if ((c == '-') || (c == '.') || is_digit(c) || is_upper(c))
+            {
+                return TLM_VALUE;
+            }
+            return ((tlm == TLM_VALUE) && (c == ',')) ? TLM_KEY_START : TLM_NONE;
+        default: return TLM_NONE;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: switch_scan
+ ********************************************************************************
+ * Summary:
+ * Hand-written byte-by-byte parser for line_protocol.dfa. An unexpected byte
+ * restarts the parser with that byte, as such parsers are usually written.
+ *
+ *******************************************************************************/
+static void switch_scan(switch_parser_t *p, const uint8_t *data, uint32_t len, uint32_t *counts)
+{
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        uint8_t c = data[i];
+        bool again;
+
+        do
+        {
+            switch_state_t from = p->state;
+
+            again = false;
+            p->state = SW_IDLE;
+            switch (from)
+            {
+                case SW_IDLE:
+                    if (c == 'O') { p->state = SW_O; }
+                    else if (c == 'E') { p->state = SW_E; }
+                    else if (c == '$') { p->state = SW_DOLLAR; }
+                    break;
+                case SW_O: if (c == 'K') { p->state = SW_OK; } else { again = true; } break;
+                case SW_OK: if (c == '\r') { p->state = SW_OK_CR; } else { again = true; } break;
+                case SW_OK_CR: if (c == '\n') { counts[LINE_PROTOCOL_OK]++; } else { again = true; } break;
+                case SW_E: if (c == 'R') { p->state = SW_ER; } else { again = true; } break;
+                case SW_ER: if (c == 'R') { p->state = SW_ERR; } else { again = true; } break;
+                case SW_ERR: if (c == 'O') { p->state = SW_ERRO; } else { again = true; } break;
+                case SW_ERRO: if (c == 'R') { p->state = SW_ERROR; } else { again = true; } break;
+                case SW_ERROR: if (c == '\r') { p->state = SW_ERROR_CR; } else { again = true; } break;
+                case SW_ERROR_CR: if (c == '\n') { counts[LINE_PROTOCOL_ERROR]++; } else { again = true; } break;
+                case SW_DOLLAR:
+                    if (is_upper(c))
+                    {
+                        p->state = SW_ADDRESS;
+                        p->tlm = (c == 'T') ? TLM_T : TLM_NONE;
+                    }
+                    else
+                    {
+                        again = true;
+                    }
+                    break;
+                case SW_ADDRESS:
+                    p->tlm = telemetry_step(p->tlm, c);
+                    if (is_upper(c)) { p->state = SW_ADDRESS; }
+                    else if (c == ',') { p->state = SW_FIELDS; }
+                    else { again = true; }
+                    break;
+                case SW_FIELDS:
+                    if (c == '*') { p->state = SW_CHECK1; }
+                    else if (c == '\r')
+                    {
+                        if ((p->tlm == TLM_NUMBER) || (p->tlm == TLM_VALUE)) { p->state = SW_TLM_LF; }
+                        else { again = true; }
+                    }
+                    else if (c == '\n') { again = true; }
+                    else
+                    {
+                        p->tlm = telemetry_step(p->tlm, c);
+                        p->state = SW_FIELDS;
+                    }
+                    break;
+                case SW_CHECK1: if (is_hex(c)) { p->state = SW_CHECK2; } else { again = true; } break;
+                case SW_CHECK2: if (is_hex(c)) { p->state = SW_CHECK_CR; } else { again = true; } break;
+                case SW_CHECK_CR: if (c == '\r') { p->state = SW_TLM_LF; p->tlm = TLM_NONE; } else { again = true; } break;
+                case SW_TLM_LF:
+                    if (c == '\n') { counts[(p->tlm == TLM_NONE) ? LINE_PROTOCOL_NMEA : LINE_PROTOCOL_TELEMETRY]++; }
+                    else { again = true; }
+                    break;
+            }
+        } while (again);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: make_stream
+ ********************************************************************************
+ * Summary:
+ * Fill the stream with protocol lines. With noise, lines are sometimes cut
+ * short and followed by junk, which the two parsers resynchronise on
+ * differently.
+ *
+ *******************************************************************************/
+static void make_stream(bool noise)
+{
+    uint32_t used = 0;
+    uint32_t seq = 0;
+
+    srand(1);
+    while (used < STREAM_SIZE)
+    {
+        char line[128];
+        int n;
+
+        switch (rand() % 4)
+        {
+            case 0: n = snprintf(line, sizeof(line), "OK\r\n"); break;
+            case 1: n = snprintf(line, sizeof(line), "ERROR\r\n"); break;
+            case 2:
+                n = snprintf(line, sizeof(line), "$GPGGA,%06u,4807.038,N,01131.000,E,1,08,0.9,545.4,M*%02X\r\n",
+                             seq, (unsigned)(rand() & 0xFF));
+                break;
+            default:
+                n = snprintf(line, sizeof(line), "$TLM,%u,temp=%d.%u,vbus=%u,state=RUN\r\n",
+                             seq, 20 + (rand() % 10), (unsigned)(rand() % 10), 11900u + (unsigned)(rand() % 200));
+                break;
+        }
+        if (noise && ((rand() % 8) == 0))
+        {
+            n = rand() % n;
+            n += snprintf(&line[n], sizeof(line) - (size_t)n, "#noise\n");
+        }
+        if ((used + (uint32_t)n) > STREAM_SIZE)
+        {
+            memset(&stream[used], ' ', STREAM_SIZE - used);
+            break;
+        }
+        memcpy(&stream[used], line, (size_t)n);
+        used += (uint32_t)n;
+        ++seq;
+    }
+}
+
+static void run(const char *label)
+{
+    uint64_t dfa_ns = 0;
+    uint64_t switch_ns = 0;
+
+    for (uint32_t round = 0; round < ROUNDS; ++round)
+    {
+        dfa_t dfa;
+        switch_parser_t parser = { SW_IDLE, TLM_NONE };
+        uint64_t start;
+
+        memset(dfa_counts, 0, sizeof(dfa_counts));
+        memset(switch_counts, 0, sizeof(switch_counts));
+
+        LINE_PROTOCOL_DFA_INIT(&dfa);
+        start = now_ns();
+        for (uint32_t i = 0; i < STREAM_SIZE; i += SEGMENT_SIZE)
+        {
+            uint32_t len = ((STREAM_SIZE - i) < SEGMENT_SIZE) ? (STREAM_SIZE - i) : SEGMENT_SIZE;
+            dfa_scan(&dfa, &stream[i], len, count_token, dfa_counts);
+        }
+        dfa_ns += now_ns() - start;
+
+        start = now_ns();
+        for (uint32_t i = 0; i < STREAM_SIZE; i += SEGMENT_SIZE)
+        {
+            uint32_t len = ((STREAM_SIZE - i) < SEGMENT_SIZE) ? (STREAM_SIZE - i) : SEGMENT_SIZE;
+            switch_scan(&parser, &stream[i], len, switch_counts);
+        }
+        switch_ns += now_ns() - start;
+    }
+
+    printf("%s:\n", label);
+    printf("  table:  %5.2f ns/byte, tokens OK %u ERROR %u NMEA %u TELEMETRY %u\n",
+           (double)dfa_ns / ((double)STREAM_SIZE * ROUNDS), dfa_counts[1], dfa_counts[2], dfa_counts[3], dfa_counts[4]);
+    printf("  switch: %5.2f ns/byte, tokens OK %u ERROR %u NMEA %u TELEMETRY %u\n",
+           (double)switch_ns / ((double)STREAM_SIZE * ROUNDS), switch_counts[1], switch_counts[2], switch_counts[3],
+           switch_counts[4]);
+}
+
+int main(void)
+{
+    make_stream(false);
+    run("well-formed lines");
+    if (memcmp(dfa_counts, switch_counts, sizeof(dfa_counts)) != 0)
+    {
+        fprintf(stderr, "token counts differ on well-formed input\n");
+        return EXIT_FAILURE;
+    }
+
+    make_stream(true);
+    run("lines cut short by noise");
+    printf("table: %u states, %u bytes\n", LINE_PROTOCOL_STATES, LINE_PROTOCOL_STATES * 256u);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,309 @@
+/******************************************************************************
+ * File Name:   bench_fwupdate.c
+ *
+ * Description: Simulation of the firmware update receiver at line rate. Bytes
+ *              arrive in the DMA ring at the given baud rate, the SysTick step
+ *              of main.c feeds the receiver, and the simulated flash is busy
+ *              for the page programming time. Reports the peak ring fill and
+ *              whether the ring overflowed, for a range of baud rates.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fw_update.h"
+#include "ring_buffer.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define RING_BUFFER_SIZE 1024u /* RING_BUFFER_SIZE in main.c */
+#define SLOT_SIZE (1024u * 1024u)
+#define DEFAULT_IMAGE_SIZE (256u * 1024u)
+#define DEFAULT_PROGRAM_US 5500u /* XMC4 page programming time, datasheet maximum */
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint8_t flash[SLOT_SIZE];
+    uint64_t now_us;
+    uint64_t busy_until_us;
+    uint32_t program_us;
+    uint32_t crc;
+    uint32_t erases;
+} sim_flash_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static sim_flash_t sim;
+static uint8_t image[SLOT_SIZE];
+static uint8_t stream[sizeof(fw_update_header_t) + SLOT_SIZE];
+static volatile uint8_t ring_storage[RING_BUFFER_SIZE];
+static uint32_t crc_table[256];
+
+static void crc_init_table(void)
+{
+    for (uint32_t i = 0; i < 256u; ++i)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+        {
+            c = (c & 1u) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t crc_bytes(uint32_t crc, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        crc = crc_table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+/*******************************************************************************
+ * Simulated flash and CRC backend
+ *******************************************************************************/
+static void sim_erase(void *context, uint32_t address, uint32_t length)
+{
+    sim_flash_t *f = context;
+
+    memset(&f->flash[address], 0xFF, length);
+    f->erases++;
+}
+
+static void sim_program(void *context, uint32_t address, const uint32_t *page)
+{
+    sim_flash_t *f = context;
+
+    memcpy(&f->flash[address], page, FW_UPDATE_PAGE_SIZE);
+    f->busy_until_us = f->now_us + f->program_us;
+}
+
+static bool sim_busy(void *context)
+{
+    sim_flash_t *f = context;
+
+    return f->now_us < f->busy_until_us;
+}
+
+static void sim_crc_reset(void *context)
+{
+    ((sim_flash_t *)context)->crc = 0xFFFFFFFFu;
+}
+
+static void sim_crc_update(void *context, const uint32_t *data, uint32_t words)
+{
+    sim_flash_t *f = context;
+
+    f->crc = crc_bytes(f->crc, (const uint8_t *)data, words * 4u);
+}
+
+static uint32_t sim_crc_result(void *context)
+{
+    return ((sim_flash_t *)context)->crc ^ 0xFFFFFFFFu;
+}
+
+static const fw_update_ops_t sim_ops =
+{
+    sim_erase, sim_program, sim_busy, sim_crc_reset, sim_crc_update, sim_crc_result
+};
+
+/*******************************************************************************
+ * Function Name: simulate
+ ********************************************************************************
+ * Summary:
+ * Run one transfer. Time advances in 1 ms ticks; the DMA writes the bytes of
+ * a tick before the SysTick step runs, which is the worst case for the ring.
+ *
+ * Return:
+ *  bool: true if the image was programmed and verified without a ring overflow
+ *
+ *******************************************************************************/
+static bool simulate(uint32_t baud, uint32_t image_size, uint32_t program_us)
+{
+    fw_update_t fw;
+    ring_buffer_t ring;
+    uint32_t total = sizeof(fw_update_header_t) + image_size;
+    uint32_t sent = 0;
+    uint32_t written = 0;       /* DMA position, counting all bytes */
+    uint32_t consumed = 0;
+    uint32_t peak = 0;
+    uint32_t bytes_per_tick = baud / 10u / 1000u;
+    bool ready = false;
+    bool overflow = false;
+    uint32_t ms = 0;
+
+    memset(&sim, 0, sizeof(sim));
+    sim.program_us = program_us;
+    fw_update_init(&fw, &sim_ops, &sim, 0, SLOT_SIZE);
+    ring_buffer_init(&ring, ring_storage, RING_BUFFER_SIZE);
+
+    while ((fw.state != FW_UPDATE_DONE) && (fw.state != FW_UPDATE_FAILED) && !overflow && (ms < 600000u))
+    {
+        uint32_t end;
+        const uint8_t *data;
+        uint32_t len;
+
+        /* Sender: header, then the image once READY was received */
+        uint32_t limit = ready ? total : sizeof(fw_update_header_t);
+        for (uint32_t n = 0; (n < bytes_per_tick) && (sent < limit); ++n)
+        {
+            ring_storage[written % RING_BUFFER_SIZE] = stream[sent++];
+            written++;
+        }
+        /* A start/end ring holds RING_BUFFER_SIZE - 1 bytes; a full one would read as empty */
+        if ((written - consumed) >= RING_BUFFER_SIZE)
+        {
+            overflow = true;
+            break;
+        }
+        if ((written - consumed) > peak)
+        {
+            peak = written - consumed;
+        }
+
+        /* SysTick step, same as main.c */
+        end = written % RING_BUFFER_SIZE;
+        while ((len = ring_buffer_peek(&ring, end, &data)) != 0)
+        {
+            uint32_t taken = fw_update_write(&fw, data, len);
+            ring_buffer_advance(&ring, taken);
+            consumed += taken;
+            if (taken < len)
+            {
+                break;
+            }
+        }
+        fw_update_service(&fw);
+
+        /* Main loop */
+        if (fw_update_poll(&fw))
+        {
+            ready = true;
+        }
+
+        ++ms;
+        sim.now_us += 1000u;
+    }
+
+    printf("%7u baud: ", baud);
+    if (overflow)
+    {
+        printf("ring overflow after %u ms, %u of %u pages programmed\n", ms, fw.programmed, image_size / FW_UPDATE_PAGE_SIZE);
+        return false;
+    }
+    else
+    {
+        bool same = (memcmp(sim.flash, image, image_size) == 0);
+        printf("%s in %.2f s (%.1f KB/s), peak ring fill %u of %u bytes, %u stalled ticks, image %s\n",
+               (fw.state == FW_UPDATE_DONE) ? "done" : "FAILED", ms / 1000.0,
+               (image_size / 1024.0) / (ms / 1000.0), peak, RING_BUFFER_SIZE, fw.stalls, same ? "verified" : "differs");
+        return (fw.state == FW_UPDATE_DONE) && same;
+    }
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-s image_kb] [-p program_us] [-b baud]\n"
+            "  -s  image size in KB (default: %u)\n"
+            "  -p  page programming time in us (default: %u)\n"
+            "  -b  simulate only this rate (default: 115200 to 921600)\n"
+            "exit status 1 if any rate overflows the ring or fails to verify\n",
+            argv0, DEFAULT_IMAGE_SIZE / 1024u, DEFAULT_PROGRAM_US);
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint32_t bauds[] = { 115200u, 230400u, 460800u, 921600u };
+    uint32_t image_size = DEFAULT_IMAGE_SIZE;
+    uint32_t program_us = DEFAULT_PROGRAM_US;
+    uint32_t baud = 0;
+    bool ok = true;
+    fw_update_header_t header;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:p:b:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 's': image_size = (uint32_t)strtoul(optarg, NULL, 0) * 1024u; break;
+            case 'p': program_us = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((image_size == 0) || (image_size > SLOT_SIZE) || ((baud != 0) && (baud < 10000u)))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    crc_init_table();
+    srand(1);
+    for (uint32_t i = 0; i < image_size; ++i)
+    {
+        image[i] = (uint8_t)rand();
+    }
+    header.magic = FW_UPDATE_MAGIC;
+    header.length = image_size;
+    header.crc32 = crc_bytes(0xFFFFFFFFu, image, image_size) ^ 0xFFFFFFFFu;
+    header.reserved = 0;
+    memcpy(stream, &header, sizeof(header));
+    memcpy(&stream[sizeof(header)], image, image_size);
+
+    printf("%u KB image, %u us per %u byte page: flash limit %.1f KB/s\n", image_size / 1024u, program_us,
+           FW_UPDATE_PAGE_SIZE, (FW_UPDATE_PAGE_SIZE / 1024.0) / (program_us / 1e6));
+    if (baud != 0)
+    {
+        ok = simulate(baud, image_size, program_us);
+    }
+    for (uint32_t i = 0; (baud == 0) && (i < (sizeof(bauds) / sizeof(bauds[0]))); ++i)
+    {
+        ok = simulate(bauds[i], image_size, program_us) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
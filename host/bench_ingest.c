@@ -0,0 +1,350 @@
+/******************************************************************************
+ * File Name:   bench_ingest.c
+ *
+ * Description: Benchmark of the gateway ingestion engines. A writer thread
+ *              streams a known pattern into the slave side of N ptys while the
+ *              epoll backend or the io_uring engine fills the per-port rings
+ *              from the master side; the consumer verifies every byte with the
+ *              firmware's ring_buffer_consume().
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ring_buffer.h"
+#include "serial_port.h"
+#include "serial_ring.h"
+#include "serial_uring.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Declarations for ring buffer */
+#define RING_BUFFER_SIZE 4096
+
+/* Defaults, overridable from the command line */
+#define DEFAULT_PORTS 32
+#define DEFAULT_BYTES_PER_PORT (1024 * 1024)
+#define DEFAULT_CHUNK 256
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    serial_ring_t port;
+    uint32_t index;
+    int slave_fd;
+    uint64_t verified;
+    uint64_t errors;
+    uint8_t storage[RING_BUFFER_SIZE];
+} bench_port_t;
+
+typedef struct
+{
+    bench_port_t *ports;
+    uint32_t count;
+    uint64_t bytes_per_port;
+    uint32_t chunk;
+} bench_writer_t;
+
+/*******************************************************************************
+ * Function Name: pattern
+ ********************************************************************************
+ * Summary:
+ * Expected byte at a given stream offset of a port.
+ *
+ *******************************************************************************/
+static inline uint8_t pattern(uint32_t port, uint64_t offset)
+{
+    return (uint8_t)((offset * 7u) + port);
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+static double cpu_s(void)
+{
+    struct rusage ru;
+
+    getrusage(RUSAGE_SELF, &ru);
+    return (double)ru.ru_utime.tv_sec + ((double)ru.ru_utime.tv_usec * 1e-6) +
+           (double)ru.ru_stime.tv_sec + ((double)ru.ru_stime.tv_usec * 1e-6);
+}
+
+/*******************************************************************************
+ * Function Name: writer_thread
+ ********************************************************************************
+ * Summary:
+ * Plays the role of the serial devices: writes the pattern round robin into
+ * every pty in chunks, then closes the slaves so the readers see EOF.
+ *
+ *******************************************************************************/
+static void *writer_thread(void *arg)
+{
+    bench_writer_t *w = arg;
+    uint8_t *chunk = malloc(w->chunk);
+    uint64_t offset = 0;
+
+    while (offset < w->bytes_per_port)
+    {
+        uint32_t len = (uint32_t)(((w->bytes_per_port - offset) < w->chunk) ? (w->bytes_per_port - offset) : w->chunk);
+
+        for (uint32_t p = 0; p < w->count; ++p)
+        {
+            uint32_t done = 0;
+
+            for (uint32_t i = 0; i < len; ++i)
+            {
+                chunk[i] = pattern(p, offset + i);
+            }
+            while (done < len)
+            {
+                ssize_t n = write(w->ports[p].slave_fd, &chunk[done], len - done);
+                if (n > 0)
+                {
+                    done += (uint32_t)n;
+                }
+                else if (errno != EINTR)
+                {
+                    perror("write");
+                    free(chunk);
+                    return NULL;
+                }
+            }
+        }
+        offset += len;
+    }
+
+    for (uint32_t p = 0; p < w->count; ++p)
+    {
+        close(w->ports[p].slave_fd);
+    }
+    free(chunk);
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: verify
+ ********************************************************************************
+ * Summary:
+ * Ring buffer handler of the benchmark, checks every byte against the pattern.
+ *
+ *******************************************************************************/
+static void verify(void *context, const uint8_t *data, uint32_t len)
+{
+    bench_port_t *bp = context;
+
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        if (data[i] != pattern(bp->index, bp->verified + i))
+        {
+            bp->errors++;
+        }
+    }
+    bp->verified += len;
+}
+
+/*******************************************************************************
+ * Function Name: run
+ ********************************************************************************
+ * Summary:
+ * Run one benchmark pass with the selected backend and print a result line.
+ *
+ * Parameters:
+ *  bool use_uring: io_uring engine if true, epoll backend otherwise
+ *  uint32_t count: Number of ptys
+ *  uint64_t bytes_per_port: Bytes streamed through every pty
+ *  uint32_t chunk: Size of the writes issued by the simulated devices
+ *
+ * Return:
+ *  int: 0 if every byte arrived intact, -1 otherwise
+ *
+ *******************************************************************************/
+static int run(bool use_uring, uint32_t count, uint64_t bytes_per_port, uint32_t chunk)
+{
+    bench_port_t *ports = calloc(count, sizeof(*ports));
+    serial_ring_t **list = calloc(count, sizeof(*list));
+    bench_writer_t writer = { ports, count, bytes_per_port, chunk };
+    serial_epoll_t poller;
+    serial_uring_t engine;
+    pthread_t thread;
+    uint64_t total = 0;
+    uint64_t errors = 0;
+    uint64_t syscalls;
+    uint32_t open_ports = count;
+    double t0;
+    double c0;
+    double elapsed;
+    double cpu;
+
+    if (serial_epoll_init(&poller) != 0)
+    {
+        perror("epoll_create1");
+        return -1;
+    }
+
+    for (uint32_t p = 0; p < count; ++p)
+    {
+        int fd = serial_port_open_pty(&ports[p].slave_fd);
+        if (fd < 0)
+        {
+            perror("posix_openpt");
+            return -1;
+        }
+        serial_ring_init(&ports[p].port, fd, ports[p].storage, RING_BUFFER_SIZE);
+        ports[p].index = p;
+        list[p] = &ports[p].port;
+        if (!use_uring && (serial_epoll_add(&poller, &ports[p].port) != 0))
+        {
+            perror("epoll_ctl");
+            return -1;
+        }
+    }
+
+    if (use_uring && (serial_uring_init(&engine, list, count) != 0))
+    {
+        perror("io_uring");
+        return -1;
+    }
+
+    t0 = now_s();
+    c0 = cpu_s();
+    pthread_create(&thread, NULL, writer_thread, &writer);
+
+    while (open_ports != 0)
+    {
+        int result = use_uring ? serial_uring_wait(&engine, 100) : serial_epoll_wait(&poller, list, count, 100);
+        if (result < 0)
+        {
+            perror("wait");
+            break;
+        }
+
+        open_ports = 0;
+        for (uint32_t p = 0; p < count; ++p)
+        {
+            /* Same consume step as SysTick_Handler in main.c */
+            uint32_t end = serial_ring_position(&ports[p].port);
+            ring_buffer_consume(&ports[p].port.ring, end, verify, &ports[p]);
+            open_ports += ports[p].port.eof ? 0u : 1u;
+        }
+    }
+
+    pthread_join(thread, NULL);
+    elapsed = now_s() - t0;
+    cpu = cpu_s() - c0;
+
+    for (uint32_t p = 0; p < count; ++p)
+    {
+        total += ports[p].verified;
+        errors += ports[p].errors;
+        if (ports[p].verified != bytes_per_port)
+        {
+            errors++;
+        }
+        close(ports[p].port.fd);
+    }
+
+    syscalls = use_uring ? engine.enters : poller.syscalls;
+    printf("%-8s ports=%-4u %8.1f MB/s  cpu %5.1f%%  syscalls %9llu  bytes/syscall %8.1f  errors %llu\n",
+           use_uring ? "io_uring" : "epoll", count, (double)total / elapsed / 1e6, 100.0 * cpu / elapsed,
+           (unsigned long long)syscalls, (double)total / (double)(syscalls ? syscalls : 1u),
+           (unsigned long long)errors);
+
+    if (use_uring)
+    {
+        serial_uring_close(&engine);
+    }
+    serial_epoll_close(&poller);
+    free(list);
+    free(ports);
+    return (errors == 0) ? 0 : -1;
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ * Runs the epoll backend and the io_uring engine with identical load. The CPU
+ * figure covers the whole process, including the simulated devices and the
+ * io_uring kernel workers, so compare the two lines rather than the absolute
+ * values.
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    uint32_t count = DEFAULT_PORTS;
+    uint64_t bytes_per_port = DEFAULT_BYTES_PER_PORT;
+    uint32_t chunk = DEFAULT_CHUNK;
+    int result = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:b:c:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': count = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': bytes_per_port = strtoull(optarg, NULL, 0); break;
+            case 'c': chunk = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-n ports] [-b bytes_per_port] [-c write_chunk]\n", argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if ((count == 0) || (count > SERIAL_URING_MAX_PORTS) || (chunk == 0))
+    {
+        fprintf(stderr, "ports must be 1..%d, chunk must be non-zero\n", SERIAL_URING_MAX_PORTS);
+        return EXIT_FAILURE;
+    }
+
+    result |= run(false, count, bytes_per_port, chunk);
+    result |= run(true, count, bytes_per_port, chunk);
+    return (result == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,330 @@
+/******************************************************************************
+ * File Name:   bench_loopback.c
+ *
+ * Description: Host run of the loopback self-test of main.c against the
+ *              simulated line. The PRBS pattern goes from a single-block GPDMA
+ *              transmit channel over a line with Gaussian edge jitter into the
+ *              DMA ring buffer, whose SysTick consumer has a cycle cost per
+ *              byte; the same loopback_test sweep steps the rate up and
+ *              reports each step, the maximum sustainable throughput and the
+ *              bit error rate.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "dma_producer.h"
+#include "loopback_test.h"
+#include "ring_buffer.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define RX_CHANNEL 2u               /* GPDMA_CHANNEL_2 in main.c */
+#define TX_CHANNEL 3u               /* GPDMA_CHANNEL_LOOPBACK in main.c */
+#define RING_SIZE 1024u             /* RING_BUFFER_SIZE in main.c */
+#define BLOCK_SIZE 256u             /* LOOPBACK_TEST_BLOCK in main.c */
+#define CPU_HZ 144000000u           /* XMC4700 core clock */
+#define PERIPHERAL_HZ 144000000u
+#define OVERSAMPLING 16u            /* UART_OVERSAMPLING in main.c */
+#define TICK_NS 1000000u
+#define TICK_CYCLES 200u            /* Handler entry, position read, statistics */
+#define CLOCK_HZ 1000000000u        /* Test time in ns */
+#define DEFAULT_STEP_MS 250u        /* LOOPBACK_TEST_STEP_MS in main.c */
+#define DEFAULT_BYTE_CYCLES 200u    /* PRBS check of one byte */
+#define DEFAULT_JITTER_NS 0.0
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    dma_producer_t producer;
+    uint32_t rate;
+    double char_ns;
+    double error_probability;       /* Per data bit */
+    double jitter_ns;               /* RMS edge jitter */
+    double now_ns;
+    double tx_next_ns;              /* The transmit buffer takes the next byte */
+    bool in_flight;                 /* A byte is in the shift register */
+    uint8_t shifting;
+    double arrival_ns;              /* Its stop bit is through */
+    uint64_t random;
+    uint32_t flipped;               /* Bits the line inverted */
+} sim_line_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+/* LOOPBACK_TEST_RATES in main.c */
+static const uint32_t rates[] =
+{
+    115200u, 230400u, 460800u, 921600u, 1500000u, 2000000u, 3000000u, 4500000u, 6000000u, 9000000u
+};
+
+static XMC_DMA_t dma;
+static volatile uint8_t ring_storage[RING_SIZE];
+static uint8_t block[BLOCK_SIZE];
+static loopback_step_t steps[sizeof(rates) / sizeof(rates[0])];
+static loopback_test_t test;
+
+static double random_uniform(sim_line_t *line)
+{
+    line->random ^= line->random << 13;
+    line->random ^= line->random >> 7;
+    line->random ^= line->random << 17;
+    return (double)(line->random >> 11) / 9007199254740992.0;
+}
+
+static void discard(void *context, const uint8_t *data, uint32_t len)
+{
+    (void)context;
+    (void)data;
+    (void)len;
+}
+
+/* Stands in for uart_set_baud_rate(rate, true) */
+static bool sim_set_rate(void *context, uint32_t rate)
+{
+    sim_line_t *line = context;
+    double sigma = line->jitter_ns * rate / 1e9;
+
+    if (rate > (PERIPHERAL_HZ / OVERSAMPLING))
+    {
+        return false;
+    }
+    line->rate = rate;
+    line->char_ns = (1e9 * LOOPBACK_TEST_FRAME_BITS) / rate;
+    /* A bit is sampled in its middle: wrong once an edge moves by more than half a bit */
+    line->error_probability = (sigma > 0.0) ? erfc(0.5 / (sigma * sqrt(2.0))) : 0.0;
+    ring_buffer_consume(&line->producer.ring, dma_producer_position(&line->producer), discard, NULL);
+    return true;
+}
+
+/* Stands in for loopback_transmit(): the service request of the empty transmit buffer starts the block */
+static void sim_transmit(void *context, const uint8_t *data, uint32_t len)
+{
+    sim_line_t *line = context;
+
+    XMC_DMA_CH_SetSourceAddress(&dma, TX_CHANNEL, (uint32_t)(uintptr_t)data);
+    XMC_DMA_CH_SetBlockSize(&dma, TX_CHANNEL, len);
+    XMC_DMA_CH_Enable(&dma, TX_CHANNEL);
+    line->tx_next_ns = (line->tx_next_ns > line->now_ns) ? line->tx_next_ns : line->now_ns;
+}
+
+static bool sim_busy(void *context)
+{
+    (void)context;
+    return XMC_DMA_CH_IsEnabled(&dma, TX_CHANNEL);
+}
+
+static const loopback_test_ops_t sim_ops = { sim_set_rate, sim_transmit, sim_busy };
+
+/* Stands in for uart_receive() during the sweep */
+static void sim_receive(void *context, const uint8_t *data, uint32_t len)
+{
+    sim_line_t *line = context;
+
+    loopback_test_receive(&test, data, len, (uint32_t)(uint64_t)line->now_ns);
+}
+
+/*******************************************************************************
+ * Function Name: sim_character
+ ********************************************************************************
+ * Summary:
+ * Next character slot of the transmitter: the byte in the shift register
+ * arrives with its data bits flipped at the line's error probability and is
+ * written to the ring by the receive channel, whether the consumer has made
+ * room or not; the transmit channel then moves the next byte in.
+ *
+ *******************************************************************************/
+static void sim_character(sim_line_t *line)
+{
+    uint32_t value;
+
+    if (line->in_flight)
+    {
+        for (uint32_t bit = 0; (line->error_probability > 0.0) && (bit < 8u); ++bit)
+        {
+            if (random_uniform(line) < line->error_probability)
+            {
+                line->shifting ^= (uint8_t)(1u << bit);
+                line->flipped++;
+            }
+        }
+        gpdma_model_request(&dma, RX_CHANNEL, line->shifting);
+        line->in_flight = false;
+    }
+    if (gpdma_model_fetch(&dma, TX_CHANNEL, &value))
+    {
+        line->shifting = (uint8_t)value;
+        line->in_flight = true;
+        line->arrival_ns = line->tx_next_ns + line->char_ns;
+    }
+    line->tx_next_ns += line->char_ns;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-s step_ms] [-c cycles_per_byte] [-j jitter_ns]\n"
+            "  -s  pattern length per rate (default: %u)\n"
+            "  -c  consumer cost per byte in CPU cycles, 0 for none (default: %u)\n"
+            "  -j  RMS edge jitter of the line in ns (default: %.0f)\n",
+            argv0, DEFAULT_STEP_MS, DEFAULT_BYTE_CYCLES, DEFAULT_JITTER_NS);
+}
+
+int main(int argc, char *argv[])
+{
+    static const dma_producer_source_t source =
+    {
+        0x40030000u, XMC_DMA_CH_TRANSFER_WIDTH_8, 0, XMC_DMA_CH_PRIORITY_0
+    };
+    const XMC_DMA_CH_CONFIG_t tx_config =
+    {
+        .src_transfer_width = XMC_DMA_CH_TRANSFER_WIDTH_8,
+        .dst_transfer_width = XMC_DMA_CH_TRANSFER_WIDTH_8,
+        .src_address_count_mode = XMC_DMA_CH_ADDRESS_COUNT_MODE_INCREMENT,
+        .dst_address_count_mode = XMC_DMA_CH_ADDRESS_COUNT_MODE_NO_CHANGE,
+        .transfer_flow = XMC_DMA_CH_TRANSFER_FLOW_M2P_DMA,
+        .dst_addr = 0x40030000u,
+        .block_size = 1,
+        .transfer_type = XMC_DMA_CH_TRANSFER_TYPE_SINGLE_BLOCK,
+        .priority = XMC_DMA_CH_PRIORITY_0
+    };
+    sim_line_t line = { 0 };
+    uint32_t step_ms = DEFAULT_STEP_MS;
+    uint32_t byte_cycles = DEFAULT_BYTE_CYCLES;
+    uint32_t tick_bytes;
+    double next_tick_ns = TICK_NS;
+    const loopback_step_t *best;
+    const loopback_step_t *failed;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:c:j:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 's': step_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'c': byte_cycles = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'j': line.jitter_ns = strtod(optarg, NULL); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    /* A step and its timeout must stay within the wrap of the 32-bit ns clock */
+    if ((step_ms == 0) || (step_ms > 1000u) || (line.jitter_ns < 0.0))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* The consumer gets the CPU of a whole tick at most */
+    tick_bytes = (byte_cycles != 0) ? (((CPU_HZ / 1000u) - TICK_CYCLES) / byte_cycles) : 0xFFFFFFFFu;
+    line.random = 0x9E3779B97F4A7C15u;
+
+    gpdma_model_memory(ring_storage, sizeof(ring_storage));
+    gpdma_model_memory(block, sizeof(block));
+    dma_producer_init(&line.producer, &dma, RX_CHANNEL, &source, ring_storage, RING_SIZE);
+    dma_producer_start(&line.producer);
+    XMC_DMA_CH_Init(&dma, TX_CHANNEL, &tx_config);
+
+    loopback_test_init(&test, &sim_ops, &line, rates, steps, sizeof(rates) / sizeof(rates[0]), block, BLOCK_SIZE,
+                       CLOCK_HZ, step_ms);
+    loopback_test_start(&test, 0);
+
+    /* Event loop: character slots while the transmitter has data, SysTick, and the main loop after each */
+    while (loopback_test_service(&test, (uint32_t)(uint64_t)line.now_ns))
+    {
+        bool sending = line.in_flight || XMC_DMA_CH_IsEnabled(&dma, TX_CHANNEL);
+        double slot_ns = line.in_flight ? line.arrival_ns : line.tx_next_ns;
+
+        if (sending && (slot_ns < next_tick_ns))
+        {
+            line.now_ns = slot_ns;
+            line.tx_next_ns = slot_ns;
+            sim_character(&line);
+        }
+        else
+        {
+            line.now_ns = next_tick_ns;
+            next_tick_ns += TICK_NS;
+            ring_buffer_consume_max(&line.producer.ring, dma_producer_position(&line.producer), tick_bytes,
+                                    sim_receive, &line);
+        }
+    }
+
+    printf("Loopback sweep: %u ms per rate, %u B ring, %u cycles per byte (%u B per tick), %.1f ns rms jitter\n",
+           step_ms, RING_SIZE, byte_cycles, tick_bytes, line.jitter_ns);
+    printf("  %8s %8s %8s %9s %6s %5s %8s %9s\n", "rate", "sent", "received", "bits", "errors", "slips", "B/s",
+           "BER");
+    for (uint32_t i = 0; i < (sizeof(rates) / sizeof(rates[0])); ++i)
+    {
+        const loopback_step_t *s = &steps[i];
+
+        if ((s->status == LOOPBACK_STEP_NOT_RUN) || (s->status == LOOPBACK_STEP_SKIPPED))
+        {
+            printf("  %8u %s\n", s->rate, (s->status == LOOPBACK_STEP_SKIPPED) ? "skipped" : "not run");
+            continue;
+        }
+        printf("  %8u %8u %8u %9u %6u %5u %8u %9.2e %s\n", s->rate, s->sent, s->received, s->bits, s->errors,
+               s->slips, s->throughput, (s->bits != 0) ? ((double)s->errors / s->bits) : 1.0,
+               (s->status == LOOPBACK_STEP_PASSED) ? "passed" : "FAILED");
+    }
+
+    best = loopback_test_best(&test);
+    failed = loopback_test_failed(&test);
+    if (best != NULL)
+    {
+        printf("Maximum sustainable: %u baud, %u B/s\n", best->rate, best->throughput);
+    }
+    else
+    {
+        printf("Maximum sustainable: none, the first rate failed\n");
+    }
+    if (failed != NULL)
+    {
+        printf("First failure: %u baud, %u bit errors in %u bits, %u slips, %u bytes lost\n", failed->rate,
+               failed->errors, failed->bits, failed->slips,
+               (failed->received < failed->sent) ? (failed->sent - failed->received) : 0u);
+    }
+    printf("Line flipped %u bits in total\n", line.flipped);
+    return (best != NULL) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
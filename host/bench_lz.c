@@ -0,0 +1,206 @@
+/******************************************************************************
+ * File Name:   bench_lz.c
+ *
+ * Description: Benchmark of the TX stream compressor. Feeds a telemetry log
+ *              in chunks of the size one SysTick delivers at the given baud
+ *              rate, checks the round trip and reports the compression ratio,
+ *              the resulting effective link throughput and the CPU cost.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lz_stream.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define DEFAULT_BAUD 115200u
+#define TICKS_PER_SECOND 1000u
+#define SAMPLE_SIZE (1024u * 1024u)
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static uint8_t sample[SAMPLE_SIZE];
+static uint8_t packed[SAMPLE_SIZE + (SAMPLE_SIZE / 64u)];
+static uint8_t unpacked[SAMPLE_SIZE];
+static uint32_t packed_len;
+static uint32_t unpacked_len;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+static void collect_packed(void *context, const uint8_t *data, uint32_t len)
+{
+    (void)context;
+    memcpy(&packed[packed_len], data, len);
+    packed_len += len;
+}
+
+static void collect_unpacked(void *context, const uint8_t *data, uint32_t len)
+{
+    (void)context;
+    if ((unpacked_len + len) <= sizeof(unpacked))
+    {
+        memcpy(&unpacked[unpacked_len], data, len);
+    }
+    unpacked_len += len;
+}
+
+/*******************************************************************************
+ * Function Name: make_telemetry
+ ********************************************************************************
+ * Summary:
+ * Generate a log of the kind echoed by the kit: fixed record layout with
+ * slowly changing counters and sensor values.
+ *
+ *******************************************************************************/
+static uint32_t make_telemetry(uint8_t *buffer, uint32_t size)
+{
+    uint32_t used = 0;
+    uint32_t seq = 0;
+
+    srand(1);
+    while (used < size)
+    {
+        char line[128];
+        int n = snprintf(line, sizeof(line), "$TLM,%08u,ch=%u,temp=%d.%u,vbus=%u,state=%s,err=%u\r\n",
+                         seq, seq % 4u, 24 + (rand() % 3), (unsigned)(rand() % 10), 11950u + (unsigned)(rand() % 100),
+                         ((seq / 50u) % 2u) ? "RUN" : "IDLE", (seq % 997u) == 0u);
+        uint32_t take = ((uint32_t)n < (size - used)) ? (uint32_t)n : (size - used);
+        memcpy(&buffer[used], line, take);
+        used += take;
+        ++seq;
+    }
+    return used;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-b baud] [file]\n"
+            "  -b  link baud rate, sets the bytes per tick (default: %u)\n"
+            "Compresses the given file, or a generated telemetry log.\n",
+            argv0, DEFAULT_BAUD);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t baud = DEFAULT_BAUD;
+    uint32_t len;
+    uint32_t chunk;
+    lz_stream_encoder_t encoder;
+    lz_stream_decoder_t decoder;
+    uint64_t start;
+    uint64_t compress_ns;
+    uint64_t decompress_ns;
+    double ratio;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (optind < argc)
+    {
+        FILE *file = fopen(argv[optind], "rb");
+        if (file == NULL)
+        {
+            fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+            return EXIT_FAILURE;
+        }
+        len = (uint32_t)fread(sample, 1, sizeof(sample), file);
+        fclose(file);
+    }
+    else
+    {
+        len = make_telemetry(sample, sizeof(sample));
+    }
+
+    /* 10 bits per byte on the line */
+    chunk = baud / 10u / TICKS_PER_SECOND;
+    if (chunk == 0)
+    {
+        chunk = 1;
+    }
+
+    lz_stream_encoder_init(&encoder, collect_packed, NULL);
+    start = now_ns();
+    for (uint32_t i = 0; i < len; i += chunk)
+    {
+        lz_stream_compress(&encoder, &sample[i], ((len - i) < chunk) ? (len - i) : chunk);
+    }
+    compress_ns = now_ns() - start;
+
+    lz_stream_decoder_init(&decoder, collect_unpacked, NULL);
+    start = now_ns();
+    for (uint32_t i = 0; i < packed_len; i += 7u)
+    {
+        lz_stream_decompress(&decoder, &packed[i], ((packed_len - i) < 7u) ? (packed_len - i) : 7u);
+    }
+    decompress_ns = now_ns() - start;
+
+    if ((unpacked_len != len) || (memcmp(unpacked, sample, len) != 0))
+    {
+        fprintf(stderr, "round trip mismatch\n");
+        return EXIT_FAILURE;
+    }
+
+    ratio = (double)len / (double)packed_len;
+    printf("%u bytes in %u byte ticks -> %u bytes, ratio %.2f\n", len, chunk, packed_len, ratio);
+    printf("effective throughput at %u baud: %.0f B/s instead of %u B/s\n", baud,
+           (baud / 10.0) * ratio, baud / 10u);
+    printf("host: compress %.1f ns/byte, decompress %.1f ns/byte\n",
+           (double)compress_ns / len, (double)decompress_ns / len);
+    printf("encoder state: %u bytes\n", (unsigned)sizeof(encoder));
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
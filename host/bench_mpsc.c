@@ -0,0 +1,240 @@
+/******************************************************************************
+ * File Name:   bench_mpsc.c
+ *
+ * Description: Contention benchmark of the MPSC frame queue. 1 to 32 producer
+ *              threads allocate frames from the pool and queue their handles;
+ *              one aggregator drains them in batches, checks per-producer
+ *              ordering and returns the frames to the pool.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "frame_pool.h"
+#include "mpsc_queue.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define MAX_PRODUCERS 32
+#define DEFAULT_FRAMES 2000000u
+#define QUEUE_CAPACITY 16384u
+#define POOL_FRAMES 32768u
+#define MAX_BATCH 4096u
+#define WAKE_THRESHOLD 1024u
+#define MAX_LATENCY_MS 1
+#define FRAME_LEN 64u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    _Alignas(MPSC_CACHE_LINE) pthread_t thread;
+    uint16_t channel;
+    uint64_t frames;
+    uint64_t full_retries;
+    uint64_t pool_retries;
+} producer_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static frame_pool_t pool;
+static mpsc_queue_t queue;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * Function Name: producer_main
+ ********************************************************************************
+ * Summary:
+ * Stands in for a shard: fills frames in place and hands over the handle.
+ *
+ *******************************************************************************/
+static void *producer_main(void *arg)
+{
+    producer_t *producer = arg;
+
+    for (uint64_t seq = 0; seq < producer->frames; ++seq)
+    {
+        uint32_t handle;
+        frame_t *frame;
+
+        while ((handle = frame_pool_alloc(&pool)) == FRAME_POOL_INVALID)
+        {
+            producer->pool_retries++;
+            sched_yield();
+        }
+
+        frame = frame_pool_get(&pool, handle);
+        frame->timestamp_ns = seq;
+        frame->channel = producer->channel;
+        frame->len = FRAME_LEN;
+        memset(frame->data, (int)(seq & 0xFFu), FRAME_LEN);
+
+        while (!mpsc_queue_push(&queue, handle))
+        {
+            producer->full_retries++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: run
+ ********************************************************************************
+ * Summary:
+ * Run one contention level and print a result line.
+ *
+ *******************************************************************************/
+static int run(uint32_t producers, uint64_t total)
+{
+    static producer_t threads[MAX_PRODUCERS];
+    static uint32_t handles[MAX_BATCH];
+    uint64_t expected[MAX_PRODUCERS] = { 0 };
+    uint64_t received = 0;
+    uint64_t wakeups = 0;
+    uint64_t errors = 0;
+    uint64_t full_retries = 0;
+    uint64_t pool_retries = 0;
+    uint64_t per_producer = total / producers;
+    uint64_t t0;
+    double elapsed;
+
+    if ((frame_pool_init(&pool, POOL_FRAMES) != 0) || (mpsc_queue_init(&queue, QUEUE_CAPACITY, WAKE_THRESHOLD) != 0))
+    {
+        perror("init");
+        return -1;
+    }
+
+    t0 = now_ns();
+    for (uint32_t p = 0; p < producers; ++p)
+    {
+        threads[p].channel = (uint16_t)p;
+        threads[p].frames = per_producer;
+        threads[p].full_retries = 0;
+        threads[p].pool_retries = 0;
+        pthread_create(&threads[p].thread, NULL, producer_main, &threads[p]);
+    }
+
+    while (received < (per_producer * producers))
+    {
+        uint32_t count = mpsc_queue_wait_batch(&queue, handles, MAX_BATCH, MAX_LATENCY_MS);
+        if (count == 0)
+        {
+            continue;
+        }
+        ++wakeups;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const frame_t *frame = frame_pool_get(&pool, handles[i]);
+            if ((frame->channel >= producers) || (frame->timestamp_ns != expected[frame->channel]) ||
+                (frame->data[FRAME_LEN - 1u] != (uint8_t)frame->timestamp_ns))
+            {
+                errors++;
+            }
+            else
+            {
+                expected[frame->channel]++;
+            }
+        }
+        frame_pool_free_batch(&pool, handles, count);
+        received += count;
+    }
+
+    for (uint32_t p = 0; p < producers; ++p)
+    {
+        pthread_join(threads[p].thread, NULL);
+        full_retries += threads[p].full_retries;
+        pool_retries += threads[p].pool_retries;
+    }
+    elapsed = (double)(now_ns() - t0) * 1e-9;
+
+    printf("producers=%-3u %7.2f Mframes/s  avg batch %7.1f  full retries %8llu  pool retries %8llu  errors %llu\n",
+           producers, (double)received / elapsed / 1e6, (double)received / (double)(wakeups ? wakeups : 1u),
+           (unsigned long long)full_retries, (unsigned long long)pool_retries, (unsigned long long)errors);
+
+    mpsc_queue_destroy(&queue);
+    frame_pool_destroy(&pool);
+    return (errors == 0) ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t total = DEFAULT_FRAMES;
+    uint32_t max_producers = MAX_PRODUCERS;
+    int result = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:p:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': total = strtoull(optarg, NULL, 0); break;
+            case 'p': max_producers = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-n total_frames] [-p max_producers]\n", argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if ((max_producers == 0) || (max_producers > MAX_PRODUCERS))
+    {
+        fprintf(stderr, "producers must be 1..%d\n", MAX_PRODUCERS);
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t producers = 1; producers <= max_producers; producers *= 2)
+    {
+        result |= run(producers, total);
+    }
+    return (result == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,237 @@
+/******************************************************************************
+ * File Name:   bench_resize.c
+ *
+ * Description: Exercises dma_producer_resize() on the simulated GPDMA channel.
+ *              Bytes stream into the ring at line rate while the ring is
+ *              resized at random points between four ticks of data and 4095
+ *              bytes, with and without draining first. The consumer verifies
+ *              that no byte is duplicated or reordered. The blackout of each
+ *              switchover is modeled in CPU cycles from the bytes copied, and
+ *              characters that overrun the USIC meanwhile count as lost.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dma_producer.h"
+#include "ring_buffer.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define CHANNEL 2u
+#define INITIAL_SIZE 1024u
+#define DEFAULT_BAUD 921600u
+#define DEFAULT_RESIZES 10000u
+#define CPU_HZ 144000000u           /* XMC4700 core clock */
+#define RESIZE_CYCLES 120u          /* Stop, wait, reprogram and restart the channel */
+#define COPY_CYCLES 8u              /* Per byte migrated: volatile load and store, wrap check */
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t expected;          /* Stream position of the next byte */
+    uint32_t errors;
+} check_sink_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t refused;
+    uint64_t blackout;          /* Channel disabled, in CPU cycles */
+    uint64_t max_blackout;
+    uint32_t lost;              /* Characters overrun in RBUF meanwhile */
+} resize_stats_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static XMC_DMA_t dma;
+static volatile uint8_t banks[2][DMA_PRODUCER_MAX_BLOCK_SIZE + 1u];
+
+static uint8_t pattern(uint32_t position)
+{
+    return (uint8_t)(position ^ (position >> 8) ^ (position >> 16));
+}
+
+static void check(void *context, const uint8_t *data, uint32_t len)
+{
+    check_sink_t *sink = context;
+
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        if (data[i] != pattern(sink->expected + i))
+        {
+            sink->errors++;
+        }
+    }
+    sink->expected += len;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-b baud] [-n resizes]\n"
+            "  -b  line rate (default: %u)\n"
+            "  -n  number of resizes (default: %u)\n",
+            argv0, DEFAULT_BAUD, DEFAULT_RESIZES);
+}
+
+int main(int argc, char *argv[])
+{
+    static const dma_producer_source_t source =
+    {
+        0x40030000u, XMC_DMA_CH_TRANSFER_WIDTH_8, 0, XMC_DMA_CH_PRIORITY_0
+    };
+    uint32_t baud = DEFAULT_BAUD;
+    uint32_t resizes = DEFAULT_RESIZES;
+    dma_producer_t producer;
+    check_sink_t sink = { 0, 0 };
+    resize_stats_t stats[2];
+    uint32_t written = 0;
+    uint32_t lost = 0;
+    uint32_t drain_lost;
+    uint32_t overflows = 0;
+    uint32_t bank = 0;
+    uint32_t per_tick;
+    uint32_t min_size;
+    uint32_t char_cycles;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:n:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'n': resizes = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((baud < 10000u) || (baud > 2000000u) || (resizes == 0))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* The consumer may skip one tick, so the smallest ring holds four ticks */
+    per_tick = baud / 10u / 1000u;
+    min_size = 4u * per_tick;
+    char_cycles = (uint32_t)(((uint64_t)CPU_HZ * 10u) / baud);
+    memset(stats, 0, sizeof(stats));
+    gpdma_model_memory(banks[0], sizeof(banks[0]));
+    gpdma_model_memory(banks[1], sizeof(banks[1]));
+    dma_producer_init(&producer, &dma, CHANNEL, &source, banks[0], INITIAL_SIZE);
+    dma_producer_start(&producer);
+
+    srand(1);
+    while ((stats[0].count + stats[1].count) < resizes)
+    {
+        /* Resize at a random byte of the tick, draining first on every other attempt */
+        uint32_t at = (uint32_t)rand() % per_tick;
+        bool drain = (rand() & 1) != 0;
+        bool stall = (rand() % 8) == 0;
+
+        for (uint32_t i = 0; i < per_tick; ++i)
+        {
+            if (i == at)
+            {
+                uint32_t size = min_size + ((uint32_t)rand() % (DMA_PRODUCER_MAX_BLOCK_SIZE + 1u - min_size));
+                resize_stats_t *s = &stats[drain ? 1 : 0];
+
+                if (dma_producer_resize(&producer, banks[bank ^ 1u], size, drain ? check : NULL, &sink))
+                {
+                    /* The bytes still unread right after the restart are the ones migrated */
+                    uint64_t blackout = RESIZE_CYCLES +
+                                        ((uint64_t)COPY_CYCLES *
+                                         ring_buffer_pending(&producer.ring, dma_producer_position(&producer)));
+
+                    bank ^= 1u;
+                    s->count++;
+                    s->blackout += blackout;
+                    s->max_blackout = (blackout > s->max_blackout) ? blackout : s->max_blackout;
+                    s->lost += gpdma_model_blackout(&dma, CHANNEL, blackout, char_cycles);
+                }
+                else
+                {
+                    s->refused++;
+                }
+            }
+            if ((ring_buffer_pending(&producer.ring, dma_producer_position(&producer)) + 1u) >= producer.ring.size)
+            {
+                overflows++;
+            }
+            if (!gpdma_model_request(&dma, CHANNEL, pattern(written)))
+            {
+                lost++;
+            }
+            written++;
+        }
+
+        /* SysTick step; now and then the consumer skips a tick to build a backlog */
+        if (!stall)
+        {
+            ring_buffer_consume(&producer.ring, dma_producer_position(&producer), check, &sink);
+        }
+    }
+    ring_buffer_consume(&producer.ring, dma_producer_position(&producer), check, &sink);
+
+    printf("%u baud, %u bytes per tick, one character every %u cycles at %u MHz\n", baud, per_tick, char_cycles,
+           CPU_HZ / 1000000u);
+    for (uint32_t i = 0; i < 2u; ++i)
+    {
+        double count = (stats[i].count != 0) ? stats[i].count : 1.0;
+
+        printf("%-13s %5u resizes, %4u refused, blackout avg %6.0f cycles, max %6llu cycles (%.2f characters), "
+               "%5u characters lost\n", i ? "drain first:" : "migrate all:", stats[i].count, stats[i].refused,
+               stats[i].blackout / count, (unsigned long long)stats[i].max_blackout,
+               (double)stats[i].max_blackout / char_cycles, stats[i].lost);
+    }
+    /* main.c drains first; migrating everything is shown for comparison */
+    drain_lost = stats[1].lost;
+    printf("%u bytes streamed, %u consumed, %u lost with draining, %u overflows, %u out of order: %s\n", written, sink.expected,
+           lost + drain_lost, overflows, sink.errors,
+           ((sink.expected == written) && ((lost + drain_lost) == 0) && (overflows == 0) && (sink.errors == 0))
+           ? "verified" : "FAILED");
+    return ((sink.expected == written) && ((lost + drain_lost) == 0) && (overflows == 0) && (sink.errors == 0))
+           ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,218 @@
+/******************************************************************************
+ * File Name:   bench_shaper.c
+ *
+ * Description: Host benchmark of the token-bucket transmit shaper. A UART line
+ *              is simulated in character times with bursty echo traffic; for
+ *              several rate and burst settings the achieved rate, the longest
+ *              back-to-back run and the peak 10 ms load on the line are
+ *              compared with the configured limits.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "token_bucket.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define CLOCK_HZ 1000000000u        /* Refill time in ns */
+#define WINDOW_US 10000u            /* Window of the peak load */
+#define DEFAULT_BAUD 115200u
+#define DEFAULT_BURST_BYTES 2048u   /* Echo arrives in bursts of this size */
+#define DEFAULT_BURST_MS 250u       /* ... this far apart on average */
+#define DEFAULT_SECONDS 60u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t rate_percent;          /* Of the line rate, 0 for no shaper */
+    uint32_t burst;
+} bench_setting_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static const bench_setting_t settings[] =
+{
+    { 0u, 0u },
+    { 50u, 64u },
+    { 50u, 1024u },
+    { 25u, 16u },
+    { 150u, 64u },                  /* Above the line rate: must not cost throughput */
+};
+
+static uint32_t random_below(uint32_t *state, uint32_t limit)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state % limit;
+}
+
+/*******************************************************************************
+ * Function Name: run
+ ********************************************************************************
+ * Summary:
+ * Replay the same burst sequence through one setting. In each character
+ * time the bucket is refilled and, if data is waiting and a token is there,
+ * one byte goes on the line, as uart_write() does with ENABLE_TX_SHAPER.
+ *
+ *******************************************************************************/
+static void run(const bench_setting_t *setting, uint32_t baud, uint32_t burst_bytes, uint32_t burst_ms,
+                uint32_t seconds)
+{
+    token_bucket_t tb;
+    uint32_t line_rate = baud / 10u;
+    uint32_t char_ns = CLOCK_HZ / line_rate;
+    uint32_t chars = seconds * line_rate;
+    uint32_t window = (uint32_t)(((uint64_t)WINDOW_US * line_rate) / 1000000u);
+    uint8_t *history = calloc(window, 1);
+    uint32_t seed = 0x1234567u;
+    uint32_t next_burst = 0;
+    uint64_t offered = 0;
+    uint64_t sent = 0;
+    uint32_t backlog = 0;
+    uint32_t in_window = 0;
+    uint32_t peak_window = 0;
+    uint32_t run_length = 0;
+    uint32_t longest_run = 0;
+    uint32_t rate = (uint32_t)(((uint64_t)line_rate * setting->rate_percent) / 100u);
+
+    if (history == NULL)
+    {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    token_bucket_init(&tb, rate, setting->burst, CLOCK_HZ);
+
+    for (uint32_t t = 0; t < chars; ++t)
+    {
+        bool busy = false;
+
+        if (t >= next_burst)
+        {
+            backlog += burst_bytes;
+            offered += burst_bytes;
+            next_burst = t + 1u + random_below(&seed, (uint32_t)(((uint64_t)2u * burst_ms * line_rate) / 1000u));
+        }
+
+        if (setting->rate_percent != 0)
+        {
+            token_bucket_refill(&tb, char_ns);
+        }
+        if ((backlog != 0) && ((setting->rate_percent == 0) || (token_bucket_take(&tb, 1u) == 1u)))
+        {
+            backlog--;
+            sent++;
+            busy = true;
+        }
+
+        run_length = busy ? (run_length + 1u) : 0u;
+        longest_run = (run_length > longest_run) ? run_length : longest_run;
+        in_window += (busy ? 1u : 0u) - history[t % window];
+        history[t % window] = busy ? 1u : 0u;
+        peak_window = (in_window > peak_window) ? in_window : peak_window;
+    }
+
+    if (setting->rate_percent == 0)
+    {
+        printf("  no shaper:                     sent %6llu of %6llu B/s offered, longest run %5u B, "
+               "peak %5u B per %u ms\n", (unsigned long long)(sent / seconds),
+               (unsigned long long)(offered / seconds), longest_run, peak_window, WINDOW_US / 1000u);
+    }
+    else
+    {
+        printf("  rate %6u B/s, burst %5u B: sent %6llu of %6llu B/s offered, longest run %5u B, "
+               "peak %5u B per %u ms (limit %u), achieved %u B/s\n", rate, setting->burst,
+               (unsigned long long)(sent / seconds), (unsigned long long)(offered / seconds), longest_run,
+               peak_window, WINDOW_US / 1000u,
+               (uint32_t)(((uint64_t)rate * WINDOW_US) / 1000000u) + setting->burst, token_bucket_achieved(&tb));
+    }
+    free(history);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-b baud] [-n burst_bytes] [-i burst_ms] [-s seconds]\n"
+            "  -b  line rate (default: %u)\n"
+            "  -n  size of the echo bursts (default: %u)\n"
+            "  -i  mean interval of the echo bursts in ms (default: %u)\n"
+            "  -s  simulated time (default: %u)\n",
+            argv0, DEFAULT_BAUD, DEFAULT_BURST_BYTES, DEFAULT_BURST_MS, DEFAULT_SECONDS);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t baud = DEFAULT_BAUD;
+    uint32_t burst_bytes = DEFAULT_BURST_BYTES;
+    uint32_t burst_ms = DEFAULT_BURST_MS;
+    uint32_t seconds = DEFAULT_SECONDS;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:n:i:s:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'n': burst_bytes = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'i': burst_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((baud < 9600u) || (baud > 10000000u) || (burst_bytes == 0) || (burst_ms == 0) || (seconds == 0) ||
+        (((uint64_t)seconds * baud) > 0xFFFFFFFFu))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u baud (%u B/s), bursts of %u B every %u ms on average, %u s\n", baud, baud / 10u, burst_bytes,
+           burst_ms, seconds);
+    for (uint32_t i = 0; i < (sizeof(settings) / sizeof(settings[0])); ++i)
+    {
+        run(&settings[i], baud, burst_bytes, burst_ms, seconds);
+    }
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
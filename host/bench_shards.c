@@ -0,0 +1,254 @@
+/******************************************************************************
+ * File Name:   bench_shards.c
+ *
+ * Description: Scaling benchmark of the sharded executor. Simulated UART rings
+ *              are filled at a fixed byte rate, a few hot ports at eight times
+ *              the rate of the others, and consumed with per-byte processing by
+ *              1 to N pinned shards.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shard_executor.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Declarations for ring buffer */
+#define RING_BUFFER_SIZE 4096
+
+#define DEFAULT_RINGS 64
+#define DEFAULT_HOT_RINGS 4
+#define HOT_WEIGHT 8
+#define DEFAULT_RATE_MBPS 200
+#define DEFAULT_SECONDS 2
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+/* A UART ring whose DMA progress is derived from the clock */
+typedef struct
+{
+    uint64_t rate;          /* Offered load in bytes per second */
+    uint64_t consumed;      /* Bytes seen by the handler */
+    uint64_t errors;
+    uint32_t crc;
+    uint8_t storage[RING_BUFFER_SIZE];
+} sim_ring_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static uint64_t start_ns;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint8_t pattern(uint32_t index)
+{
+    return (uint8_t)((index * 131u) >> 3);
+}
+
+/*******************************************************************************
+ * Function Name: sim_position
+ ********************************************************************************
+ * Summary:
+ * Simulated DMA position. The stream advances with the clock but, like a
+ * link with flow control, never gets more than one ring ahead of the
+ * consumer, so everything that is offered but not taken shows up as lost
+ * throughput instead of corrupted data.
+ *
+ *******************************************************************************/
+static uint32_t sim_position(void *context)
+{
+    sim_ring_t *sim = context;
+    uint64_t offered = (sim->rate * (now_ns() - start_ns)) / 1000000000u;
+    uint64_t consumed = __atomic_load_n(&sim->consumed, __ATOMIC_RELAXED);
+    uint64_t limit = consumed + RING_BUFFER_SIZE - 1u;
+
+    return (uint32_t)(((offered < limit) ? offered : limit) % RING_BUFFER_SIZE);
+}
+
+/*******************************************************************************
+ * Function Name: sim_process
+ ********************************************************************************
+ * Summary:
+ * Per-ring consume logic: verify the data and run a bitwise CRC-32 over it
+ * as a stand-in for protocol decoding.
+ *
+ *******************************************************************************/
+static void sim_process(void *context, const uint8_t *data, uint32_t len)
+{
+    sim_ring_t *sim = context;
+    uint32_t index = (uint32_t)(data - sim->storage);
+    uint32_t crc = sim->crc;
+
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        if (data[i] != pattern(index + i))
+        {
+            sim->errors++;
+        }
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    sim->crc = crc;
+    __atomic_store_n(&sim->consumed, sim->consumed + len, __ATOMIC_RELAXED);
+}
+
+/*******************************************************************************
+ * Function Name: run
+ ********************************************************************************
+ * Summary:
+ * Run the executor with a given number of shards and print one result line.
+ *
+ *******************************************************************************/
+static int run(uint32_t shards, uint32_t rings, uint32_t hot, uint64_t rate, uint32_t seconds, bool pin)
+{
+    shard_task_t *tasks = aligned_alloc(SHARD_CACHE_LINE, rings * sizeof(*tasks));
+    sim_ring_t *sims = calloc(rings, sizeof(*sims));
+    static shard_executor_t executor;
+    uint64_t weight = (uint64_t)hot * HOT_WEIGHT + (rings - hot);
+    uint64_t consumed = 0;
+    uint64_t errors = 0;
+    uint64_t steals = 0;
+    uint64_t min_bytes = UINT64_MAX;
+    uint64_t max_bytes = 0;
+    double elapsed;
+    int result;
+
+    for (uint32_t r = 0; r < rings; ++r)
+    {
+        sims[r].rate = (rate * ((r < hot) ? HOT_WEIGHT : 1u)) / weight;
+        for (uint32_t i = 0; i < RING_BUFFER_SIZE; ++i)
+        {
+            sims[r].storage[i] = pattern(i);
+        }
+        shard_task_init(&tasks[r], sims[r].storage, RING_BUFFER_SIZE, sim_position, sim_process, &sims[r]);
+    }
+
+    start_ns = now_ns();
+    result = shard_executor_start(&executor, tasks, rings, shards, pin);
+    if (result != 0)
+    {
+        fprintf(stderr, "shard_executor_start: %s\n", strerror(result));
+        return -1;
+    }
+    sleep(seconds);
+    shard_executor_stop(&executor);
+    elapsed = (double)(now_ns() - start_ns) * 1e-9;
+
+    for (uint32_t r = 0; r < rings; ++r)
+    {
+        consumed += sims[r].consumed;
+        errors += sims[r].errors;
+    }
+    for (uint32_t s = 0; s < shards; ++s)
+    {
+        steals += executor.shards[s].steals;
+        min_bytes = (executor.shards[s].bytes < min_bytes) ? executor.shards[s].bytes : min_bytes;
+        max_bytes = (executor.shards[s].bytes > max_bytes) ? executor.shards[s].bytes : max_bytes;
+    }
+
+    printf("shards=%-3u %8.1f MB/s  %5.1f%% of offered  steals %6llu  shard bytes min/max %5.2f  errors %llu\n",
+           shards, (double)consumed / elapsed / 1e6, 100.0 * (double)consumed / ((double)rate * elapsed),
+           (unsigned long long)steals, (max_bytes != 0) ? (double)min_bytes / (double)max_bytes : 0.0,
+           (unsigned long long)errors);
+
+    free(sims);
+    free(tasks);
+    return (errors == 0) ? 0 : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t max_shards = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t rings = DEFAULT_RINGS;
+    uint32_t hot = DEFAULT_HOT_RINGS;
+    uint64_t rate = (uint64_t)DEFAULT_RATE_MBPS * 1000000u;
+    uint32_t seconds = DEFAULT_SECONDS;
+    bool pin = true;
+    int result = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:n:k:r:t:uh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c': max_shards = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'n': rings = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'k': hot = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': rate = strtoull(optarg, NULL, 0) * 1000000u; break;
+            case 't': seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'u': pin = false; break;
+            default:
+                fprintf(stderr,
+                        "usage: %s [-c max_shards] [-n rings] [-k hot_rings] [-r MB/s] [-t seconds] [-u]\n"
+                        "  -u  do not pin shards to cores\n", argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if ((rings == 0) || (hot > rings) || (max_shards == 0) || (max_shards > SHARD_MAX))
+    {
+        fprintf(stderr, "invalid configuration\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%u rings (%u hot), %.0f MB/s offered\n", rings, hot, (double)rate / 1e6);
+    for (uint32_t shards = 1; shards <= max_shards; shards = (shards < max_shards && shards * 2 > max_shards) ? max_shards : shards * 2)
+    {
+        result |= run(shards, rings, hot, rate, seconds, pin);
+        if (shards == max_shards)
+        {
+            break;
+        }
+    }
+    return (result == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
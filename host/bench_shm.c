@@ -0,0 +1,299 @@
+/******************************************************************************
+ * File Name:   bench_shm.c
+ *
+ * Description: Benchmark of the shared-memory ring against a Unix domain socket.
+ *              A forked reader process receives a stream of fixed-size messages
+ *              through either transport; the tool reports the writer's cost per
+ *              message, the end-to-end cost per delivered message and, for the
+ *              lossy ring, how many messages the reader missed.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shm_ring.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define DEFAULT_MESSAGES 1000000
+#define DEFAULT_SIZE 64
+#define DEFAULT_SLOTS 65536
+
+#define TAG_DATA 0u
+#define TAG_END 1u
+
+#define MAX_MESSAGE 4096
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+/* Sent from the reader process back to the parent when it is done */
+typedef struct
+{
+    uint64_t end_ns;
+    uint64_t delivered;
+    uint64_t lost;
+} bench_report_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * Function Name: shm_reader_process
+ ********************************************************************************
+ * Summary:
+ * Child side of the ring benchmark, reads until the end marker arrives.
+ *
+ *******************************************************************************/
+static void shm_reader_process(const char *name, int report_fd, int ready_fd)
+{
+    shm_ring_t ring;
+    shm_reader_t reader;
+    bench_report_t report = { 0, 0, 0 };
+    uint8_t buffer[MAX_MESSAGE];
+    uint32_t tag = TAG_DATA;
+
+    if ((shm_ring_open(&ring, name) != 0) || (shm_reader_attach(&reader, &ring) != 0))
+    {
+        perror("shm reader");
+        _exit(EXIT_FAILURE);
+    }
+    (void)write(ready_fd, "r", 1);
+
+    while (tag != TAG_END)
+    {
+        if (shm_reader_read(&reader, &tag, buffer, sizeof(buffer), -1) >= 0)
+        {
+            report.delivered++;
+        }
+    }
+
+    report.end_ns = now_ns();
+    report.lost = reader.overruns;
+    (void)write(report_fd, &report, sizeof(report));
+    _exit(EXIT_SUCCESS);
+}
+
+/*******************************************************************************
+ * Function Name: socket_reader_process
+ ********************************************************************************
+ * Summary:
+ * Child side of the socket benchmark, each message starts with its tag.
+ *
+ *******************************************************************************/
+static void socket_reader_process(int sock, int report_fd, int ready_fd)
+{
+    bench_report_t report = { 0, 0, 0 };
+    uint8_t buffer[MAX_MESSAGE];
+    uint32_t tag = TAG_DATA;
+
+    (void)write(ready_fd, "r", 1);
+    while (tag != TAG_END)
+    {
+        ssize_t n = recv(sock, buffer, sizeof(buffer), 0);
+        if (n >= (ssize_t)sizeof(tag))
+        {
+            memcpy(&tag, buffer, sizeof(tag));
+            report.delivered++;
+        }
+        else if ((n < 0) && (errno != EINTR))
+        {
+            break;
+        }
+    }
+
+    report.end_ns = now_ns();
+    (void)write(report_fd, &report, sizeof(report));
+    _exit(EXIT_SUCCESS);
+}
+
+/*******************************************************************************
+ * Function Name: run
+ ********************************************************************************
+ * Summary:
+ * Fork the reader, stream the messages and print one result line.
+ *
+ * Parameters:
+ *  bool use_shm: Shared-memory ring if true, SOCK_SEQPACKET socket otherwise
+ *  uint64_t messages: Number of data messages to send
+ *  uint32_t size: Payload size of every message
+ *  uint32_t slots: Ring size in messages
+ *
+ * Return:
+ *  int: 0 on success, -1 on failure
+ *
+ *******************************************************************************/
+static int run(bool use_shm, uint64_t messages, uint32_t size, uint32_t slots)
+{
+    static const char NAME[] = "/bench_shm_ring";
+    uint8_t payload[MAX_MESSAGE];
+    bench_report_t report;
+    shm_ring_t ring;
+    int report_pipe[2];
+    int ready_pipe[2];
+    int socks[2] = { -1, -1 };
+    uint64_t t0;
+    uint64_t t1;
+    char ready;
+    pid_t pid;
+
+    memset(payload, 0xA5, sizeof(payload));
+    if ((pipe(report_pipe) != 0) || (pipe(ready_pipe) != 0))
+    {
+        perror("pipe");
+        return -1;
+    }
+
+    if (use_shm)
+    {
+        if (shm_ring_create(&ring, NAME, slots, size + 16u) != 0)
+        {
+            perror("shm_ring_create");
+            return -1;
+        }
+    }
+    else if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, socks) != 0)
+    {
+        perror("socketpair");
+        return -1;
+    }
+
+    pid = fork();
+    if (pid == 0)
+    {
+        if (use_shm)
+        {
+            shm_reader_process(NAME, report_pipe[1], ready_pipe[1]);
+        }
+        socket_reader_process(socks[1], report_pipe[1], ready_pipe[1]);
+    }
+    (void)read(ready_pipe[0], &ready, 1);
+
+    t0 = now_ns();
+    for (uint64_t i = 0; i <= messages; ++i)
+    {
+        uint32_t tag = (i == messages) ? TAG_END : TAG_DATA;
+
+        if (use_shm)
+        {
+            shm_ring_publish(&ring, tag, payload, size);
+        }
+        else
+        {
+            memcpy(payload, &tag, sizeof(tag));
+            while ((send(socks[0], payload, (size < sizeof(tag)) ? sizeof(tag) : size, 0) < 0) && (errno == EINTR))
+            {
+            }
+        }
+    }
+    t1 = now_ns();
+
+    if (read(report_pipe[0], &report, sizeof(report)) != (ssize_t)sizeof(report))
+    {
+        report.end_ns = t1;
+        report.delivered = 0;
+        report.lost = 0;
+    }
+    waitpid(pid, NULL, 0);
+
+    printf("%-12s size=%-5u writer %7.1f ns/msg  end-to-end %7.1f ns/msg  delivered %llu  lost %llu\n",
+           use_shm ? "shm ring" : "unix socket", size, (double)(t1 - t0) / (double)(messages + 1u),
+           (double)(report.end_ns - t0) / (double)(report.delivered ? report.delivered : 1u),
+           (unsigned long long)report.delivered, (unsigned long long)report.lost);
+
+    if (use_shm)
+    {
+        shm_ring_close(&ring);
+        shm_ring_unlink(NAME);
+    }
+    else
+    {
+        close(socks[0]);
+        close(socks[1]);
+    }
+    close(report_pipe[0]);
+    close(report_pipe[1]);
+    close(ready_pipe[0]);
+    close(ready_pipe[1]);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t messages = DEFAULT_MESSAGES;
+    uint32_t size = DEFAULT_SIZE;
+    uint32_t slots = DEFAULT_SLOTS;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:r:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': messages = strtoull(optarg, NULL, 0); break;
+            case 's': size = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': slots = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-n messages] [-s size] [-r ring_slots]\n", argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if ((size == 0) || (size > MAX_MESSAGE - 16u))
+    {
+        fprintf(stderr, "size must be 1..%d\n", MAX_MESSAGE - 16);
+        return EXIT_FAILURE;
+    }
+
+    if ((run(true, messages, size, slots) != 0) || (run(false, messages, size, slots) != 0))
+    {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
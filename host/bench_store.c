@@ -0,0 +1,202 @@
+/******************************************************************************
+ * File Name:   bench_store.c
+ *
+ * Description: Benchmark of the time-series store. Appends frames as they
+ *              arrive from many UART ports at full baud rate and reports the
+ *              ingest rate in ports, followed by the latency of time window
+ *              queries against the filled store.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ts_store.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define DEFAULT_PORTS 64u
+#define DEFAULT_BAUD 921600u
+#define DEFAULT_MEGABYTES 512u
+#define DEFAULT_FRAME_LEN 64u
+#define QUERY_COUNT 1000u
+#define QUERY_WINDOW_NS 1000000u /* One SysTick period */
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static uint64_t visited;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+static int count_record(void *context, const ts_record_t *record, const uint8_t *data)
+{
+    (void)context;
+    (void)data;
+    visited += record->len;
+    return 0;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-n ports] [-b baud] [-m megabytes] [-l frame_len] dir\n"
+            "  -n  simulated ports (default: %u)\n"
+            "  -b  baud rate of every port (default: %u)\n"
+            "  -m  amount of frame data to append (default: %u)\n"
+            "  -l  frame length in bytes (default: %u)\n"
+            "The directory must not contain a store yet.\n",
+            argv0, DEFAULT_PORTS, DEFAULT_BAUD, DEFAULT_MEGABYTES, DEFAULT_FRAME_LEN);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ * Frame timestamps follow simulated time: with n ports at the given baud rate
+ * (10 bits per byte) a frame arrives every frame_len * 10 / baud / n seconds.
+ * The append loop runs as fast as it can, so the ratio of simulated to
+ * elapsed time is the number of such port sets the store keeps up with.
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    uint32_t ports = DEFAULT_PORTS;
+    uint32_t baud = DEFAULT_BAUD;
+    uint32_t megabytes = DEFAULT_MEGABYTES;
+    uint32_t frame_len = DEFAULT_FRAME_LEN;
+    uint8_t frame[4096];
+    ts_store_t store;
+    uint64_t frames;
+    uint64_t interval_ns;
+    uint64_t start;
+    uint64_t elapsed;
+    uint64_t simulated;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:b:m:l:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': ports = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'm': megabytes = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'l': frame_len = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (((argc - optind) != 1) || (ports == 0) || (baud == 0) || (frame_len == 0) ||
+        (frame_len > sizeof(frame)))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (ts_store_open(&store, argv[optind], 0, TS_STORE_WRITE) != 0)
+    {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if ((store.segment_count != 1) || (store.segments[0].records != 0))
+    {
+        fprintf(stderr, "%s: store is not empty\n", argv[optind]);
+        ts_store_close(&store);
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t i = 0; i < frame_len; ++i)
+    {
+        frame[i] = (uint8_t)i;
+    }
+
+    frames = ((uint64_t)megabytes * 1024u * 1024u) / frame_len;
+    interval_ns = ((uint64_t)frame_len * 10u * 1000000000u) / baud / ports;
+    if (interval_ns == 0)
+    {
+        interval_ns = 1;
+    }
+
+    start = now_ns();
+    for (uint64_t i = 0; i < frames; ++i)
+    {
+        if (ts_store_append(&store, i * interval_ns, (uint16_t)(i % ports), 0, frame, frame_len) != 0)
+        {
+            perror("append");
+            ts_store_close(&store);
+            return EXIT_FAILURE;
+        }
+    }
+    if (ts_store_sync(&store, 1) != 0)
+    {
+        perror("msync");
+    }
+    elapsed = now_ns() - start;
+    simulated = frames * interval_ns;
+
+    printf("ingest: %llu frames of %u bytes in %.3f s, %.1f MB/s, %llu segments, %llu msync calls\n",
+           (unsigned long long)frames, frame_len, (double)elapsed / 1e9,
+           ((double)store.bytes / (1024.0 * 1024.0)) / ((double)elapsed / 1e9),
+           (unsigned long long)store.segment_count, (unsigned long long)store.syncs);
+    printf("        %.1f s of traffic from %u ports at %u baud, keeps up with %.0f such ports\n",
+           (double)simulated / 1e9, ports, baud, ((double)simulated / (double)elapsed) * ports);
+
+    srand(1);
+    visited = 0;
+    start = now_ns();
+    for (uint32_t q = 0; q < QUERY_COUNT; ++q)
+    {
+        uint64_t from = (((uint64_t)rand() << 31) | (uint64_t)rand()) % simulated;
+        ts_store_query(&store, from, from + QUERY_WINDOW_NS - 1u, count_record, NULL);
+    }
+    elapsed = now_ns() - start;
+    printf("query:  %u random 1 ms windows, %.1f us per query, %.1f KB per window\n",
+           QUERY_COUNT, ((double)elapsed / 1e3) / QUERY_COUNT, ((double)visited / 1024.0) / QUERY_COUNT);
+
+    ts_store_close(&store);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,320 @@
+/******************************************************************************
+ * File Name:   bench_tiered.c
+ *
+ * Description: Simulation and benchmark of the two-tier receive ring. An
+ *              uplink stall of several seconds is replayed against the 1 KB
+ *              DMA ring alone and with a cold tier behind it, then the host
+ *              CPU throughput of consuming from each tier is measured.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ring_buffer.h"
+#include "tiered_ring.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define HOT_SIZE 1024u              /* RING_BUFFER_SIZE in main.c */
+#define MAX_COPY 4095u              /* GPDMA block limit with 8-bit transfers */
+#define DEFAULT_BAUD 921600u
+#define DEFAULT_STALL_MS 5000u
+#define DEFAULT_COLD_MB 16u
+#define THROUGHPUT_BYTES (256u * 1024u * 1024u)
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t copies;
+    uint64_t bytes;
+} sim_engine_t;
+
+typedef struct
+{
+    uint32_t expected;          /* Stream position of the next byte */
+    bool in_order;
+} sim_sink_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static volatile uint8_t hot_storage[HOT_SIZE];
+static uint8_t *cold_storage;
+
+static uint8_t pattern(uint32_t position)
+{
+    return (uint8_t)(position ^ (position >> 8) ^ (position >> 16));
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * Simulated copy engine: the copy lands at once, the tiered ring retires it
+ * on the next service call like a DMA that finished within the tick.
+ *******************************************************************************/
+static void sim_copy(void *context, volatile uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+    sim_engine_t *engine = context;
+
+    memcpy((uint8_t *)dst, src, len);
+    engine->copies++;
+    engine->bytes += len;
+}
+
+static bool sim_busy(void *context)
+{
+    (void)context;
+    return false;
+}
+
+static const tiered_ring_ops_t sim_ops = { sim_copy, sim_busy };
+
+static void sink(sim_sink_t *s, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        if (data[i] != pattern(s->expected + i))
+        {
+            s->in_order = false;
+        }
+    }
+    s->expected += len;
+}
+
+/*******************************************************************************
+ * Function Name: produce
+ ********************************************************************************
+ * Summary:
+ * DMA step of one tick. Returns false if the ring would overflow, i.e. the
+ * DMA would overwrite unread data.
+ *
+ *******************************************************************************/
+static bool produce(const ring_buffer_t *ring, uint32_t *written, uint32_t count)
+{
+    uint32_t end = *written % HOT_SIZE;
+
+    if ((ring_buffer_pending(ring, end) + count) >= HOT_SIZE)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        hot_storage[(*written + i) % HOT_SIZE] = pattern(*written + i);
+    }
+    *written += count;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: simulate_stall
+ ********************************************************************************
+ * Summary:
+ * Data arrives at line rate while the uplink is stalled for stall_ms, then
+ * the uplink drains at twice the line rate. With cold_size 0 only the hot
+ * ring is used, as in main.c without ENABLE_EBU_BUFFER.
+ *
+ *******************************************************************************/
+static void simulate_stall(uint32_t baud, uint32_t stall_ms, uint32_t cold_size)
+{
+    ring_buffer_t hot;
+    tiered_ring_t tier;
+    sim_engine_t engine = { 0, 0 };
+    sim_sink_t out = { 0, true };
+    uint32_t per_tick = baud / 10u / 1000u;
+    uint32_t written = 0;
+    uint32_t ms = 0;
+
+    ring_buffer_init(&hot, hot_storage, HOT_SIZE);
+    tiered_ring_init(&tier, &hot, &sim_ops, &engine, cold_storage, cold_size, HOT_SIZE / 2u, MAX_COPY);
+
+    /* Run until the backlog is gone, at most twice the stall */
+    for (ms = 0; ms < (stall_ms * 3u); ++ms)
+    {
+        uint32_t end;
+        uint32_t budget = (ms < stall_ms) ? 0 : (2u * per_tick);
+        const uint8_t *data;
+        uint32_t len;
+
+        if (!produce(&hot, &written, per_tick))
+        {
+            printf("  %-9s overflow after %u ms of stall, %u bytes buffered\n",
+                   (cold_size != 0) ? "tiered:" : "hot only:", ms, written - out.expected);
+            return;
+        }
+
+        /* SysTick step with ENABLE_EBU_BUFFER */
+        end = written % HOT_SIZE;
+        if (cold_size != 0)
+        {
+            tiered_ring_service(&tier, end);
+        }
+        while ((budget != 0) && ((len = tiered_ring_peek(&tier, end, &data)) != 0))
+        {
+            len = (len < budget) ? len : budget;
+            sink(&out, data, len);
+            tiered_ring_advance(&tier, len);
+            budget -= len;
+        }
+        if ((ms > stall_ms) && (tiered_ring_pending(&tier, end) < per_tick))
+        {
+            break;
+        }
+    }
+
+    printf("  %-9s no loss, peak backlog %u KB in the cold tier, %u copies, backlog drained %u ms after the stall, "
+           "stream %s\n", (cold_size != 0) ? "tiered:" : "hot only:", tier.peak_cold / 1024u, engine.copies,
+           ms - stall_ms, out.in_order ? "verified" : "CORRUPT");
+}
+
+/*******************************************************************************
+ * Function Name: measure_tier
+ ********************************************************************************
+ * Summary:
+ * Host CPU throughput of moving THROUGHPUT_BYTES through one tier: a spill
+ * threshold of 0 sends every byte through the cold tier, a threshold above
+ * the ring size keeps every byte in the hot tier.
+ *
+ *******************************************************************************/
+static double measure_tier(uint32_t spill_threshold, uint32_t cold_size, tiered_ring_t *tier)
+{
+    ring_buffer_t hot;
+    sim_engine_t engine = { 0, 0 };
+    sim_sink_t out = { 0, true };
+    uint32_t written = 0;
+    uint64_t start;
+    uint64_t elapsed;
+
+    ring_buffer_init(&hot, hot_storage, HOT_SIZE);
+    tiered_ring_init(tier, &hot, &sim_ops, &engine, cold_storage, cold_size, spill_threshold, MAX_COPY);
+
+    start = now_ns();
+    while (written < THROUGHPUT_BYTES)
+    {
+        const uint8_t *data;
+        uint32_t len;
+        uint32_t end;
+
+        produce(&hot, &written, HOT_SIZE / 2u);
+        end = written % HOT_SIZE;
+        tiered_ring_service(tier, end);
+        while ((len = tiered_ring_peek(tier, end, &data)) != 0)
+        {
+            out.expected += len;
+            tiered_ring_advance(tier, len);
+        }
+        /* Retire the last spill so the next tick finds the hot ring released */
+        tiered_ring_service(tier, end);
+        while ((len = tiered_ring_peek(tier, end, &data)) != 0)
+        {
+            out.expected += len;
+            tiered_ring_advance(tier, len);
+        }
+    }
+    elapsed = now_ns() - start;
+    return (out.expected / (1024.0 * 1024.0)) / (elapsed / 1e9);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-b baud] [-s stall_ms] [-c cold_mb]\n"
+            "  -b  line rate (default: %u)\n"
+            "  -s  uplink stall in ms (default: %u)\n"
+            "  -c  cold tier size in MB (default: %u)\n",
+            argv0, DEFAULT_BAUD, DEFAULT_STALL_MS, DEFAULT_COLD_MB);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t baud = DEFAULT_BAUD;
+    uint32_t stall_ms = DEFAULT_STALL_MS;
+    uint32_t cold_size = DEFAULT_COLD_MB * 1024u * 1024u;
+    tiered_ring_t tier;
+    double hot_rate;
+    double cold_rate;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:s:c:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': stall_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'c': cold_size = (uint32_t)strtoul(optarg, NULL, 0) * 1024u * 1024u; break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((baud < 10000u) || (stall_ms == 0) || (cold_size == 0))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    cold_storage = malloc(cold_size);
+    if (cold_storage == NULL)
+    {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+
+    printf("%u baud, %u ms uplink stall, %u byte hot ring, %u MB cold tier\n", baud, stall_ms, HOT_SIZE,
+           cold_size / (1024u * 1024u));
+    simulate_stall(baud, stall_ms, 0);
+    simulate_stall(baud, stall_ms, cold_size);
+
+    hot_rate = measure_tier(HOT_SIZE + 1u, cold_size, &tier);
+    printf("hot tier:  %8.1f MB/s (%u bytes read in place)\n", hot_rate, tier.hot_bytes);
+    cold_rate = measure_tier(0, cold_size, &tier);
+    printf("cold tier: %8.1f MB/s (%u bytes spilled and read back)\n", cold_rate, tier.cold_bytes);
+
+    free(cold_storage);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,268 @@
+/******************************************************************************
+ * File Name:   bench_txsched.c
+ *
+ * Description: Host benchmark of the priority-classed transmit queue. A UART
+ *              line is simulated in character times: SysTick queues echo data
+ *              as bulk frames at a configurable share of the line rate while
+ *              the main loop queues short control replies, once through the
+ *              scheduler and once through a single FIFO class, and the latency
+ *              of both classes is compared.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tx_sched.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define TICK_US 1000u               /* SysTick period, TICKS_PER_SECOND in main.c */
+#define URGENT_SIZE 128u            /* TX_SCHED_URGENT_SIZE in main.c */
+#define URGENT_FRAMES 8u
+#define BULK_SIZE 2048u             /* TX_SCHED_BULK_SIZE in main.c */
+#define BULK_FRAMES 64u
+#define BULK_FRAME 32u              /* TX_SCHED_BULK_FRAME in main.c */
+#define REPLY_SIZE 6u               /* A baud rate switch response */
+#define LINE_SLOTS 2u               /* USIC transmit buffer and shift register */
+#define DEFAULT_BAUD 115200u
+#define DEFAULT_LOAD 90u
+#define DEFAULT_REPLY_MS 7u
+#define DEFAULT_SECONDS 20u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t slots;                 /* Bytes in the transmitter */
+    uint32_t bulk_expected;         /* Stream position of the next echo byte */
+    uint32_t reply_left;            /* Bytes of the reply currently on the line */
+    bool in_order;                  /* Echo stream intact and replies not interleaved */
+} sim_line_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static uint8_t urgent_data[URGENT_SIZE];
+static tx_sched_frame_t urgent_frames[URGENT_FRAMES];
+static uint8_t bulk_data[BULK_SIZE];
+static tx_sched_frame_t bulk_frames[BULK_FRAMES];
+
+/* Echo bytes never have the top bit set, reply bytes always */
+static uint8_t pattern(uint32_t position)
+{
+    return (uint8_t)((position ^ (position >> 7)) & 0x7Fu);
+}
+
+static uint32_t random_below(uint32_t *state, uint32_t limit)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state % limit;
+}
+
+/*******************************************************************************
+ * Writer standing in for uart_write(): takes bytes while the transmitter has
+ * a free slot and checks the order of what goes on the line.
+ *******************************************************************************/
+static uint32_t sim_write(void *context, const uint8_t *data, uint32_t len)
+{
+    sim_line_t *line = context;
+    uint32_t count = 0;
+
+    while ((count < len) && (line->slots < LINE_SLOTS))
+    {
+        uint8_t byte = data[count++];
+
+        line->slots++;
+        if ((byte & 0x80u) != 0)
+        {
+            line->reply_left = (line->reply_left == 0) ? (REPLY_SIZE - 1u) : (line->reply_left - 1u);
+        }
+        else
+        {
+            line->in_order &= (line->reply_left == 0) && (byte == pattern(line->bulk_expected));
+            line->bulk_expected++;
+        }
+    }
+    return count;
+}
+
+/* One character time: the line sends a byte, the main loop pumps */
+static void step(tx_sched_t *sched, sim_line_t *line, uint32_t *now)
+{
+    line->slots -= (line->slots != 0) ? 1u : 0u;
+    ++*now;
+    tx_sched_pump(sched, *now);
+}
+
+/*******************************************************************************
+ * Function Name: run
+ ********************************************************************************
+ * Summary:
+ * Simulate the line for the given time. With prioritize false the replies
+ * are queued in the bulk class, which models the single blocking transmit
+ * path without the scheduler. Queueing into a full class pumps until there
+ * is room, as uart_queue() does.
+ *
+ *******************************************************************************/
+static void run(bool prioritize, uint32_t baud, uint32_t load, uint32_t reply_ms, uint32_t seconds)
+{
+    tx_sched_t sched;
+    sim_line_t line = { 0, 0, 0, true };
+    double char_us = 10.0 * 1e6 / baud;
+    uint32_t per_tick = (uint32_t)((TICK_US / char_us) * load / 100u);
+    uint32_t chars = (uint32_t)((seconds * 1e6) / char_us);
+    uint32_t tick_chars = (uint32_t)(TICK_US / char_us);
+    uint32_t seed = 0x9E3779B9u;
+    uint32_t next_reply = random_below(&seed, 2u * reply_ms * tick_chars) + 1u;
+    uint32_t written = 0;
+    uint32_t now = 0;
+    uint32_t next_tick = tick_chars;
+    uint8_t chunk[BULK_FRAME];
+    const tx_sched_stats_t *urgent;
+    const tx_sched_stats_t *bulk;
+
+    tx_sched_init(&sched, sim_write, &line);
+    tx_sched_class_init(&sched, TX_SCHED_URGENT, urgent_data, sizeof(urgent_data), urgent_frames, URGENT_FRAMES);
+    tx_sched_class_init(&sched, TX_SCHED_BULK, bulk_data, sizeof(bulk_data), bulk_frames, BULK_FRAMES);
+
+    while (now < chars)
+    {
+        step(&sched, &line, &now);
+
+        if (now >= next_tick)
+        {
+            /* SysTick: echo of one tick */
+            for (uint32_t done = 0; done < per_tick; done += BULK_FRAME)
+            {
+                uint32_t len = ((per_tick - done) < BULK_FRAME) ? (per_tick - done) : BULK_FRAME;
+
+                for (uint32_t i = 0; i < len; ++i)
+                {
+                    chunk[i] = pattern(written + i);
+                }
+                while (!tx_sched_enqueue(&sched, TX_SCHED_BULK, chunk, len, now))
+                {
+                    step(&sched, &line, &now);
+                }
+                written += len;
+            }
+            next_tick += tick_chars;
+        }
+
+        if (now >= next_reply)
+        {
+            /* Main loop: control reply */
+            static const uint8_t reply[REPLY_SIZE] = { 0x9B, 0xE2, 0x80, 0x80, 0x80, 0x80 };
+            tx_sched_class_t cls = prioritize ? TX_SCHED_URGENT : TX_SCHED_BULK;
+
+            while (!tx_sched_enqueue(&sched, cls, reply, sizeof(reply), now))
+            {
+                step(&sched, &line, &now);
+            }
+            next_reply = now + random_below(&seed, 2u * reply_ms * tick_chars) + 1u;
+        }
+    }
+
+    urgent = &sched.queue[prioritize ? TX_SCHED_URGENT : TX_SCHED_BULK].stats;
+    bulk = &sched.queue[TX_SCHED_BULK].stats;
+    if (prioritize)
+    {
+        printf("  scheduler:   replies mean %8.1f us max %8.1f us over %u, "
+               "echo mean %8.1f us max %8.1f us, peak %u bulk frames, stream %s\n",
+               char_us * (double)urgent->total_latency / urgent->frames, char_us * urgent->max_latency,
+               urgent->frames, char_us * (double)bulk->total_latency / bulk->frames, char_us * bulk->max_latency,
+               bulk->peak_frames, line.in_order ? "verified" : "CORRUPT");
+    }
+    else
+    {
+        printf("  single FIFO: all frames mean %8.1f us max %8.1f us over %u, peak %u frames, stream %s\n",
+               char_us * (double)bulk->total_latency / bulk->frames, char_us * bulk->max_latency, bulk->frames,
+               bulk->peak_frames, line.in_order ? "verified" : "CORRUPT");
+    }
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-b baud] [-l load_percent] [-r reply_ms] [-s seconds]\n"
+            "  -b  line rate (default: %u)\n"
+            "  -l  echo data as share of the line rate (default: %u)\n"
+            "  -r  mean interval of control replies in ms (default: %u)\n"
+            "  -s  simulated time (default: %u)\n",
+            argv0, DEFAULT_BAUD, DEFAULT_LOAD, DEFAULT_REPLY_MS, DEFAULT_SECONDS);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t baud = DEFAULT_BAUD;
+    uint32_t load = DEFAULT_LOAD;
+    uint32_t reply_ms = DEFAULT_REPLY_MS;
+    uint32_t seconds = DEFAULT_SECONDS;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:l:r:s:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baud = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'l': load = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': reply_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((baud < 20000u) || (baud > 10000000u) || (load == 0) || (load > 100u) || (reply_ms == 0) ||
+        (seconds == 0) || (seconds > 300u))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u baud, echo at %u%% of the line rate in %u byte frames, a %u byte reply every %u ms on average\n",
+           baud, load, BULK_FRAME, REPLY_SIZE, reply_ms);
+    run(false, baud, load, reply_ms, seconds);
+    run(true, baud, load, reply_ms, seconds);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
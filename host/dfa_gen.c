@@ -0,0 +1,835 @@
+/******************************************************************************
+ * File Name:   dfa_gen.c
+ *
+ * Description: Generates the dense transition table of a line protocol scanner
+ *              from a grammar of regular expressions (one token per line). The
+ *              output is a C header for source/dfa.c; the firmware only carries
+ *              the table, the construction runs on the host at build time.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define MAX_TOKENS 64
+#define MAX_NFA_STATES 4096
+#define MAX_DFA_STATES 1024
+#define SET_WORDS (MAX_NFA_STATES / 64)
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint64_t bits[4];
+} byte_set_t;
+
+/* NFA state: up to two epsilon edges, one byte set edge and an accept mark */
+typedef struct
+{
+    int eps[2];
+    int next;
+    byte_set_t on;
+    int token;
+} nfa_state_t;
+
+typedef struct
+{
+    int start;
+    int end;
+} fragment_t;
+
+typedef struct
+{
+    uint64_t set[SET_WORDS];
+    int token;
+    int next[256];
+} dfa_state_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static nfa_state_t nfa[MAX_NFA_STATES];
+static int nfa_count;
+static dfa_state_t dfa[MAX_DFA_STATES];
+static int dfa_count;
+static char token_names[MAX_TOKENS][64];
+static char token_patterns[MAX_TOKENS][256];
+static int token_count;
+
+/* Copyright block of the generated header */
+static const char *const license_lines[] =
+{
+    " * Copyright (c) 2024, Infineon Technologies AG",
+    " * All rights reserved.",
+    " *",
+    " * Boost Software License - Version 1.0 - August 17th, 2003",
+    " *",
+    " * Permission is hereby granted, free of charge, to any person or organization",
+    " * obtaining a copy of the software and accompanying documentation covered by",
+    " * this license (the \"Software\") to use, reproduce, display, distribute,",
+    " * execute, and transmit the Software, and to prepare derivative works of the",
+    " * Software, and to permit third-parties to whom the Software is furnished to",
+    " * do so, all subject to the following:",
+    " *",
+    " * The copyright notices in the Software and this entire statement, including",
+    " * the above license grant, this restriction and the following disclaimer,",
+    " * must be included in all copies of the Software, in whole or in part, and",
+    " * all derivative works of the Software, unless such copies or derivative",
+    " * works are solely in the form of machine-executable object code generated by",
+    " * a source language processor.",
+    " *",
+    " * THE SOFTWARE IS PROVIDED \"AS IS\", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR",
+    " * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,",
+    " * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT",
+    " * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE",
+    " * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,",
+    " * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER",
+    " * DEALINGS IN THE SOFTWARE.",
+    " *",
+    " *****************************************************************************/",
+};
+
+static const char *pattern;
+static const char *cursor;
+static int line_number;
+
+static void fail(const char *message)
+{
+    fprintf(stderr, "line %d: %s at offset %d of \"%s\"\n", line_number, message, (int)(cursor - pattern), pattern);
+    exit(EXIT_FAILURE);
+}
+
+/*******************************************************************************
+ * Regular expression parser, builds a Thompson NFA
+ *******************************************************************************/
+static void set_add(byte_set_t *set, unsigned value)
+{
+    set->bits[value / 64u] |= (uint64_t)1 << (value % 64u);
+}
+
+static bool set_has(const byte_set_t *set, unsigned value)
+{
+    return (set->bits[value / 64u] >> (value % 64u)) & 1u;
+}
+
+static int new_state(void)
+{
+    if (nfa_count == MAX_NFA_STATES)
+    {
+        fail("grammar too large");
+    }
+    memset(&nfa[nfa_count], 0, sizeof(nfa_state_t));
+    nfa[nfa_count].eps[0] = -1;
+    nfa[nfa_count].eps[1] = -1;
+    nfa[nfa_count].next = -1;
+    nfa[nfa_count].token = -1;
+    return nfa_count++;
+}
+
+static void add_eps(int from, int to)
+{
+    if (nfa[from].eps[0] < 0)
+    {
+        nfa[from].eps[0] = to;
+    }
+    else if (nfa[from].eps[1] < 0)
+    {
+        nfa[from].eps[1] = to;
+    }
+    else
+    {
+        int hop = new_state();
+        nfa[hop].eps[0] = nfa[from].eps[1];
+        nfa[hop].eps[1] = to;
+        nfa[from].eps[1] = hop;
+    }
+}
+
+static fragment_t set_fragment(const byte_set_t *set)
+{
+    fragment_t f = { new_state(), new_state() };
+
+    nfa[f.start].on = *set;
+    nfa[f.start].next = f.end;
+    return f;
+}
+
+static int hex_digit(char c)
+{
+    if (isdigit((unsigned char)c))
+    {
+        return c - '0';
+    }
+    c = (char)tolower((unsigned char)c);
+    if ((c >= 'a') && (c <= 'f'))
+    {
+        return c - 'a' + 10;
+    }
+    fail("bad hex digit");
+    return 0;
+}
+
+/* Parses one escape after the backslash, adds it to set */
+static void parse_escape(byte_set_t *set)
+{
+    char c = *cursor++;
+
+    switch (c)
+    {
+        case 'r': set_add(set, '\r'); break;
+        case 'n': set_add(set, '\n'); break;
+        case 't': set_add(set, '\t'); break;
+        case '0': set_add(set, 0); break;
+        case 'd':
+            for (unsigned v = '0'; v <= '9'; ++v)
+            {
+                set_add(set, v);
+            }
+            break;
+        case 'x':
+        {
+            int hi = hex_digit(*cursor++);
+            int lo = hex_digit(*cursor++);
+            set_add(set, (unsigned)((hi << 4) | lo));
+            break;
+        }
+        case '\0': fail("trailing backslash"); break;
+        default: set_add(set, (unsigned char)c); break;
+    }
+}
+
+static unsigned class_char(byte_set_t *single)
+{
+    if (*cursor == '\\')
+    {
+        byte_set_t tmp = { { 0 } };
+        ++cursor;
+        parse_escape(&tmp);
+        for (unsigned v = 0; v < 256u; ++v)
+        {
+            if (set_has(&tmp, v))
+            {
+                *single = tmp;
+                return v;
+            }
+        }
+    }
+    memset(single, 0, sizeof(*single));
+    set_add(single, (unsigned char)*cursor);
+    return (unsigned char)*cursor++;
+}
+
+static void parse_class(byte_set_t *set)
+{
+    bool negate = false;
+
+    if (*cursor == '^')
+    {
+        negate = true;
+        ++cursor;
+    }
+    while (*cursor != ']')
+    {
+        byte_set_t single;
+        unsigned lo;
+
+        if (*cursor == '\0')
+        {
+            fail("unterminated class");
+        }
+        lo = class_char(&single);
+        if ((cursor[0] == '-') && (cursor[1] != ']') && (cursor[1] != '\0'))
+        {
+            unsigned hi;
+            ++cursor;
+            hi = class_char(&single);
+            for (unsigned v = lo; v <= hi; ++v)
+            {
+                set_add(set, v);
+            }
+        }
+        else
+        {
+            for (unsigned w = 0; w < 4u; ++w)
+            {
+                set->bits[w] |= single.bits[w];
+            }
+        }
+    }
+    ++cursor;
+    if (negate)
+    {
+        for (unsigned w = 0; w < 4u; ++w)
+        {
+            set->bits[w] = ~set->bits[w];
+        }
+    }
+}
+
+static fragment_t parse_alternation(void);
+
+static fragment_t parse_atom(void)
+{
+    byte_set_t set = { { 0 } };
+    char c = *cursor++;
+
+    switch (c)
+    {
+        case '(':
+        {
+            fragment_t f = parse_alternation();
+            if (*cursor++ != ')')
+            {
+                fail("missing )");
+            }
+            return f;
+        }
+        case '[': parse_class(&set); break;
+        case '.':
+            for (unsigned w = 0; w < 4u; ++w)
+            {
+                set.bits[w] = ~(uint64_t)0;
+            }
+            break;
+        case '\\': parse_escape(&set); break;
+        case '*':
+        case '+':
+        case '?':
+        case ')':
+        case '|': --cursor; fail("unexpected operator"); break;
+        default: set_add(&set, (unsigned char)c); break;
+    }
+    return set_fragment(&set);
+}
+
+static fragment_t parse_repeat(void)
+{
+    fragment_t f = parse_atom();
+
+    while ((*cursor == '*') || (*cursor == '+') || (*cursor == '?'))
+    {
+        fragment_t r = { new_state(), new_state() };
+        char op = *cursor++;
+
+        add_eps(r.start, f.start);
+        add_eps(f.end, r.end);
+        if (op != '+')
+        {
+            add_eps(r.start, r.end);
+        }
+        if (op != '?')
+        {
+            add_eps(f.end, f.start);
+        }
+        f = r;
+    }
+    return f;
+}
+
+static fragment_t parse_concatenation(void)
+{
+    fragment_t f = { new_state(), -1 };
+
+    f.end = f.start;
+    while ((*cursor != '\0') && (*cursor != '|') && (*cursor != ')'))
+    {
+        fragment_t next = parse_repeat();
+        add_eps(f.end, next.start);
+        f.end = next.end;
+    }
+    return f;
+}
+
+static fragment_t parse_alternation(void)
+{
+    fragment_t f = parse_concatenation();
+
+    while (*cursor == '|')
+    {
+        fragment_t alt = { new_state(), new_state() };
+        fragment_t other;
+
+        ++cursor;
+        other = parse_concatenation();
+        add_eps(alt.start, f.start);
+        add_eps(alt.start, other.start);
+        add_eps(f.end, alt.end);
+        add_eps(other.end, alt.end);
+        f = alt;
+    }
+    return f;
+}
+
+/*******************************************************************************
+ * Subset construction and minimization
+ *******************************************************************************/
+static void closure(uint64_t *set)
+{
+    int stack[MAX_NFA_STATES];
+    int top = 0;
+
+    for (int s = 0; s < nfa_count; ++s)
+    {
+        if ((set[s / 64] >> (s % 64)) & 1u)
+        {
+            stack[top++] = s;
+        }
+    }
+    while (top != 0)
+    {
+        int s = stack[--top];
+        for (int k = 0; k < 2; ++k)
+        {
+            int t = nfa[s].eps[k];
+            if ((t >= 0) && !((set[t / 64] >> (t % 64)) & 1u))
+            {
+                set[t / 64] |= (uint64_t)1 << (t % 64);
+                stack[top++] = t;
+            }
+        }
+    }
+}
+
+/* Lowest token id accepted in the set, so earlier grammar lines win */
+static int set_token(const uint64_t *set)
+{
+    int token = -1;
+
+    for (int s = 0; s < nfa_count; ++s)
+    {
+        if (((set[s / 64] >> (s % 64)) & 1u) && (nfa[s].token >= 0) && ((token < 0) || (nfa[s].token < token)))
+        {
+            token = nfa[s].token;
+        }
+    }
+    return token;
+}
+
+static int find_or_add(const uint64_t *set)
+{
+    for (int d = 0; d < dfa_count; ++d)
+    {
+        if (memcmp(dfa[d].set, set, sizeof(dfa[d].set)) == 0)
+        {
+            return d;
+        }
+    }
+    if (dfa_count == MAX_DFA_STATES)
+    {
+        fprintf(stderr, "more than %d states before minimization\n", MAX_DFA_STATES);
+        exit(EXIT_FAILURE);
+    }
+    memcpy(dfa[dfa_count].set, set, sizeof(dfa[dfa_count].set));
+    dfa[dfa_count].token = set_token(set);
+    return dfa_count++;
+}
+
+/*******************************************************************************
+ * Function Name: build_dfa
+ ********************************************************************************
+ * Summary:
+ * Subset construction for an unanchored search: the NFA start state is added
+ * to every subset, so the scanner finds tokens anywhere in the stream.
+ * Accepting states get the transitions of the start state, which restarts
+ * the search after every token.
+ *
+ *******************************************************************************/
+static void build_dfa(int nfa_start)
+{
+    uint64_t start[SET_WORDS] = { 0 };
+
+    start[nfa_start / 64] |= (uint64_t)1 << (nfa_start % 64);
+    closure(start);
+    find_or_add(start);
+    if (dfa[0].token >= 0)
+    {
+        fprintf(stderr, "token %s matches the empty string\n", token_names[dfa[0].token]);
+        exit(EXIT_FAILURE);
+    }
+
+    for (int d = 0; d < dfa_count; ++d)
+    {
+        for (unsigned c = 0; c < 256u; ++c)
+        {
+            uint64_t next[SET_WORDS];
+
+            if (dfa[d].token >= 0)
+            {
+                continue;
+            }
+            memcpy(next, start, sizeof(next));
+            for (int s = 0; s < nfa_count; ++s)
+            {
+                if (((dfa[d].set[s / 64] >> (s % 64)) & 1u) && (nfa[s].next >= 0) && set_has(&nfa[s].on, c))
+                {
+                    next[nfa[s].next / 64] |= (uint64_t)1 << (nfa[s].next % 64);
+                }
+            }
+            closure(next);
+            dfa[d].next[c] = find_or_add(next);
+        }
+    }
+    for (int d = 0; d < dfa_count; ++d)
+    {
+        if (dfa[d].token >= 0)
+        {
+            memcpy(dfa[d].next, dfa[0].next, sizeof(dfa[d].next));
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: minimize
+ ********************************************************************************
+ * Summary:
+ * Moore partition refinement. Returns the class of every state; classes are
+ * numbered so that the start state is 0 and accepting classes come last.
+ *
+ *******************************************************************************/
+static int minimize(int *class_of, int *class_count, int *accept_base, int *class_token)
+{
+    int next_class[MAX_DFA_STATES];
+    int count;
+    bool changed = true;
+
+    /* Initial partition: one class per token, one for non-accepting states */
+    for (int d = 0; d < dfa_count; ++d)
+    {
+        class_of[d] = dfa[d].token + 1;
+    }
+
+    while (changed)
+    {
+        changed = false;
+        count = 0;
+        for (int d = 0; d < dfa_count; ++d)
+        {
+            next_class[d] = -1;
+        }
+        for (int d = 0; d < dfa_count; ++d)
+        {
+            if (next_class[d] >= 0)
+            {
+                continue;
+            }
+            next_class[d] = count;
+            for (int e = d + 1; e < dfa_count; ++e)
+            {
+                bool same = (next_class[e] < 0) && (class_of[e] == class_of[d]);
+                for (unsigned c = 0; same && (c < 256u); ++c)
+                {
+                    same = (class_of[dfa[e].next[c]] == class_of[dfa[d].next[c]]);
+                }
+                if (same)
+                {
+                    next_class[e] = count;
+                }
+            }
+            ++count;
+        }
+        for (int d = 0; d < dfa_count; ++d)
+        {
+            changed |= (next_class[d] != class_of[d]);
+        }
+        memcpy(class_of, next_class, sizeof(int) * (size_t)dfa_count);
+    }
+
+    /* Renumber: non-accepting classes first in order of appearance, then accepting */
+    {
+        int order[MAX_DFA_STATES];
+        int next_id = 0;
+
+        for (int k = 0; k < count; ++k)
+        {
+            order[k] = -1;
+        }
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            if (pass == 1)
+            {
+                *accept_base = next_id;
+            }
+            for (int d = 0; d < dfa_count; ++d)
+            {
+                if (((dfa[d].token >= 0) == (pass == 1)) && (order[class_of[d]] < 0))
+                {
+                    order[class_of[d]] = next_id;
+                    class_token[next_id] = dfa[d].token;
+                    ++next_id;
+                }
+            }
+        }
+        for (int d = 0; d < dfa_count; ++d)
+        {
+            class_of[d] = order[class_of[d]];
+        }
+    }
+    *class_count = count;
+    return 0;
+}
+
+/*******************************************************************************
+ * Output
+ *******************************************************************************/
+static void upper_case(char *out, const char *in, size_t size)
+{
+    size_t i = 0;
+
+    for (; (in[i] != '\0') && (i < (size - 1u)); ++i)
+    {
+        out[i] = isalnum((unsigned char)in[i]) ? (char)toupper((unsigned char)in[i]) : '_';
+    }
+    out[i] = '\0';
+}
+
+static void write_header(FILE *out, const char *name, const char *grammar_path, int class_count, int accept_base,
+                         const int *class_of, const int *class_token)
+{
+    const char *grammar_name = strrchr(grammar_path, '/');
+    char upper[64];
+    int representative[MAX_DFA_STATES];
+
+    grammar_name = (grammar_name == NULL) ? grammar_path : (grammar_name + 1);
+    upper_case(upper, name, sizeof(upper));
+    for (int d = dfa_count; d-- > 0;)
+    {
+        representative[class_of[d]] = d;
+    }
+
+    fprintf(out,
+            "/******************************************************************************\n"
+            " * File Name:   %s_dfa.h\n"
+            " *\n"
+            " * Description: Scanner tables for the %s grammar. Generated by\n"
+            " *              host/dfa_gen from %s, do not edit.\n"
+            " *\n"
+            " * Related Document: See README.md\n"
+            " *\n"
+            " *******************************************************************************\n"
+            " *\n",
+            name, name, grammar_name);
+    for (size_t i = 0; i < (sizeof(license_lines) / sizeof(license_lines[0])); ++i)
+    {
+        fprintf(out, "%s\n", license_lines[i]);
+    }
+    fprintf(out, "\n");
+    fprintf(out, "#ifndef %s_DFA_H\n#define %s_DFA_H\n\n#include \"dfa.h\"\n\n", upper, upper);
+
+    fprintf(out, "/* Token ids */\n");
+    for (int t = 0; t < token_count; ++t)
+    {
+        char token_upper[64];
+        upper_case(token_upper, token_names[t], sizeof(token_upper));
+        fprintf(out, "#define %s_%s %d /* %s */\n", upper, token_upper, t + 1, token_patterns[t]);
+    }
+    fprintf(out, "#define %s_TOKENS %d\n\n", upper, token_count);
+    fprintf(out, "#define %s_STATES %d\n#define %s_ACCEPT_BASE %d\n\n", upper, class_count, upper, accept_base);
+
+    fprintf(out, "static const uint8_t %s_transitions[%s_STATES][256] =\n{\n", name, upper);
+    for (int k = 0; k < class_count; ++k)
+    {
+        const dfa_state_t *d = &dfa[representative[k]];
+        fprintf(out, "    {");
+        for (unsigned c = 0; c < 256u; ++c)
+        {
+            fprintf(out, "%s%s%d", (c == 0) ? "" : ",", ((c % 32u) == 0u) ? "\n        " : " ", class_of[d->next[c]]);
+        }
+        fprintf(out, "\n    }%s\n", (k == (class_count - 1)) ? "" : ",");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const uint8_t %s_tokens[%s_STATES - %s_ACCEPT_BASE] =\n{\n    ", name, upper, upper);
+    for (int k = accept_base; k < class_count; ++k)
+    {
+        fprintf(out, "%s%d", (k == accept_base) ? "" : ", ", class_token[k] + 1);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "#define %s_DFA_INIT(dfa) dfa_init((dfa), %s_transitions, %s_tokens, %s_ACCEPT_BASE)\n\n",
+            upper, name, name, upper);
+    fprintf(out, "#endif /* %s_DFA_H */\n\n/* [] END OF FILE */\n", upper);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-n name] [-o out.h] grammar\n"
+            "  -n  prefix of the generated identifiers (default: protocol)\n"
+            "  -o  output header (default: stdout)\n"
+            "Grammar: one token per line, \"NAME regex\"; '#' starts a comment.\n"
+            "Regex: literals, \\r \\n \\t \\xHH \\d, [classes], ., ( ), |, *, +, ?\n",
+            argv0);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *name = "protocol";
+    const char *output = NULL;
+    int class_of[MAX_DFA_STATES];
+    int class_token[MAX_DFA_STATES];
+    int class_count;
+    int accept_base;
+    char line[512];
+    FILE *in;
+    FILE *out = stdout;
+    int start;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:o:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': name = optarg; break;
+            case 'o': output = optarg; break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((argc - optind) != 1)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    in = fopen(argv[optind], "r");
+    if (in == NULL)
+    {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    start = new_state();
+    while (fgets(line, sizeof(line), in) != NULL)
+    {
+        char *p = line;
+        char *regex;
+        fragment_t f;
+        size_t len;
+
+        ++line_number;
+        line[strcspn(line, "\r\n")] = '\0';
+        while (isspace((unsigned char)*p))
+        {
+            ++p;
+        }
+        if ((*p == '\0') || (*p == '#'))
+        {
+            continue;
+        }
+        regex = p + strcspn(p, " \t");
+        if (*regex == '\0')
+        {
+            fprintf(stderr, "line %d: missing expression\n", line_number);
+            return EXIT_FAILURE;
+        }
+        *regex++ = '\0';
+        while (isspace((unsigned char)*regex))
+        {
+            ++regex;
+        }
+        len = strlen(regex);
+        while ((len != 0) && isspace((unsigned char)regex[len - 1u]))
+        {
+            regex[--len] = '\0';
+        }
+        if (token_count == MAX_TOKENS)
+        {
+            fprintf(stderr, "line %d: more than %d tokens\n", line_number, MAX_TOKENS);
+            return EXIT_FAILURE;
+        }
+
+        snprintf(token_names[token_count], sizeof(token_names[0]), "%.63s", p);
+        snprintf(token_patterns[token_count], sizeof(token_patterns[0]), "%.255s", regex);
+        /* Keep the pattern from closing the comment it is printed in */
+        for (char *q = token_patterns[token_count]; (q = strstr(q, "*/")) != NULL;)
+        {
+            q[1] = '_';
+        }
+
+        pattern = regex;
+        cursor = regex;
+        f = parse_alternation();
+        if (*cursor != '\0')
+        {
+            fail("unbalanced )");
+        }
+        nfa[f.end].token = token_count++;
+        add_eps(start, f.start);
+    }
+    fclose(in);
+
+    if (token_count == 0)
+    {
+        fprintf(stderr, "%s: no tokens\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    build_dfa(start);
+    minimize(class_of, &class_count, &accept_base, class_token);
+    if (class_count > 255)
+    {
+        fprintf(stderr, "%d states, the table format allows 255\n", class_count);
+        return EXIT_FAILURE;
+    }
+
+    if (output != NULL)
+    {
+        out = fopen(output, "w");
+        if (out == NULL)
+        {
+            fprintf(stderr, "%s: %s\n", output, strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+    write_header(out, name, argv[optind], class_count, accept_base, class_of, class_token);
+    if ((out != stdout) && (fclose(out) != 0))
+    {
+        perror(output);
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "%d tokens, %d NFA states, %d DFA states, %d after minimization (%d bytes of table)\n",
+            token_count, nfa_count, dfa_count, class_count, class_count * 256);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
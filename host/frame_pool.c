@@ -0,0 +1,174 @@
+/******************************************************************************
+ * File Name:   frame_pool.c
+ *
+ * Description: Fixed pool of frame buffers addressed by 32-bit handles. The free
+ *              list is a Treiber stack whose head carries an ABA counter.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "frame_pool.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define HEAD(tag, index) (((uint64_t)(tag) << 32) | (uint64_t)(index))
+#define HEAD_INDEX(head) ((uint32_t)(head))
+#define HEAD_TAG(head) ((uint32_t)((head) >> 32))
+
+/*******************************************************************************
+ * Function Name: frame_pool_init
+ ********************************************************************************
+ * Summary:
+ * Allocate count frames and put all of them on the free list.
+ *
+ * Parameters:
+ *  frame_pool_t *pool: Pool instance
+ *  uint32_t count: Number of frames, below FRAME_POOL_INVALID
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int frame_pool_init(frame_pool_t *pool, uint32_t count)
+{
+    if ((count == 0) || (count >= FRAME_POOL_INVALID))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pool->frames = calloc(count, sizeof(frame_t));
+    if (pool->frames == NULL)
+    {
+        return -1;
+    }
+    pool->count = count;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        pool->frames[i].next = ((i + 1u) < count) ? (i + 1u) : FRAME_POOL_INVALID;
+    }
+    pool->free_head = HEAD(0, 0);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: frame_pool_alloc
+ ********************************************************************************
+ * Summary:
+ * Take a frame from the free list.
+ *
+ * Return:
+ *  uint32_t: Frame handle or FRAME_POOL_INVALID if the pool is exhausted
+ *
+ *******************************************************************************/
+uint32_t frame_pool_alloc(frame_pool_t *pool)
+{
+    uint64_t head = __atomic_load_n(&pool->free_head, __ATOMIC_ACQUIRE);
+
+    for (;;)
+    {
+        uint32_t index = HEAD_INDEX(head);
+        uint64_t next;
+
+        if (index == FRAME_POOL_INVALID)
+        {
+            return FRAME_POOL_INVALID;
+        }
+        /* May read a stale link; the tag makes the CAS fail in that case */
+        next = HEAD(HEAD_TAG(head) + 1u, __atomic_load_n(&pool->frames[index].next, __ATOMIC_RELAXED));
+        if (__atomic_compare_exchange_n(&pool->free_head, &head, next, true, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+        {
+            return index;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: frame_pool_free_batch
+ ********************************************************************************
+ * Summary:
+ * Return a batch of frames with a single CAS on the free list, the way the
+ * aggregator releases everything it drained in one wakeup.
+ *
+ * Parameters:
+ *  frame_pool_t *pool: Pool instance
+ *  const uint32_t *handles: Frames to release
+ *  uint32_t count: Number of handles
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void frame_pool_free_batch(frame_pool_t *pool, const uint32_t *handles, uint32_t count)
+{
+    uint64_t head;
+    uint32_t last;
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    /* Chain the batch privately, then splice it in front of the list */
+    for (uint32_t i = 0; (i + 1u) < count; ++i)
+    {
+        __atomic_store_n(&pool->frames[handles[i]].next, handles[i + 1u], __ATOMIC_RELAXED);
+    }
+    last = handles[count - 1u];
+
+    head = __atomic_load_n(&pool->free_head, __ATOMIC_RELAXED);
+    do
+    {
+        __atomic_store_n(&pool->frames[last].next, HEAD_INDEX(head), __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&pool->free_head, &head, HEAD(HEAD_TAG(head) + 1u, handles[0]), true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+void frame_pool_free(frame_pool_t *pool, uint32_t handle)
+{
+    frame_pool_free_batch(pool, &handle, 1u);
+}
+
+void frame_pool_destroy(frame_pool_t *pool)
+{
+    free(pool->frames);
+    pool->frames = NULL;
+    pool->count = 0;
+}
+
+/* [] END OF FILE */
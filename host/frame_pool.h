@@ -0,0 +1,90 @@
+/******************************************************************************
+ * File Name:   frame_pool.h
+ *
+ * Description: Fixed pool of frame buffers addressed by 32-bit handles. Frames
+ *              are handed between threads by handle, so queues never copy frame
+ *              data. Allocation and release are lock-free.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Largest payload carried by one frame */
+#define FRAME_POOL_PAYLOAD 256
+
+/* Returned by frame_pool_alloc() when the pool is exhausted */
+#define FRAME_POOL_INVALID UINT32_MAX
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint64_t timestamp_ns;
+    uint16_t channel;
+    uint16_t len;
+    uint32_t next;          /* Free list link, owned by the pool */
+    uint8_t data[FRAME_POOL_PAYLOAD];
+} frame_t;
+
+typedef struct
+{
+    frame_t *frames;
+    uint32_t count;
+    uint64_t free_head;     /* ABA tag in the upper, frame index in the lower half */
+} frame_pool_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+int frame_pool_init(frame_pool_t *pool, uint32_t count);
+uint32_t frame_pool_alloc(frame_pool_t *pool);
+void frame_pool_free(frame_pool_t *pool, uint32_t handle);
+void frame_pool_free_batch(frame_pool_t *pool, const uint32_t *handles, uint32_t count);
+void frame_pool_destroy(frame_pool_t *pool);
+
+static inline frame_t *frame_pool_get(const frame_pool_t *pool, uint32_t handle)
+{
+    return &pool->frames[handle];
+}
+
+#endif /* FRAME_POOL_H */
+
+/* [] END OF FILE */
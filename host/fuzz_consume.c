@@ -0,0 +1,541 @@
+/******************************************************************************
+ * File Name:   fuzz_consume.c
+ *
+ * Description: Differential fuzz harness of the SysTick consume paths. Random
+ *              DMA progress, including runs that stop exactly at or across the
+ *              wrap, is written into one ring buffer, and each consume path
+ *              reads it with its own random tick timing: a verbatim copy of
+ *              the start/end block of the original SysTick_Handler() as the
+ *              oracle, and the ring_buffer_consume(), budgeted, peek/advance
+ *              and tiered paths of main.c as candidates. Every segment handed
+ *              to a handler is checked against the stream and against the
+ *              storage bounds, and after a final drain every path must have
+ *              delivered the same stream as the oracle. New consume paths are
+ *              added to the path table.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ring_buffer.h"
+#include "tiered_ring.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define RING_MAX 1024u              /* RING_BUFFER_SIZE in main.c */
+#define COLD_MAX 4096u
+#define DEFAULT_RUNS 20000u
+#define DEFAULT_TICKS 500u
+#define DRAIN_TICKS 100000u         /* A path that has not drained by then is stuck */
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct fuzz_consumer fuzz_consumer_t;
+
+typedef struct
+{
+    const char *name;
+    /* Random parameters of one run */
+    void (*setup)(fuzz_consumer_t *c);
+    /* One SysTick_Handler() run with the given DMA position */
+    void (*tick)(fuzz_consumer_t *c, uint32_t end);
+    bool empty_segments;            /* Hands out zero-length segments */
+} fuzz_path_t;
+
+struct fuzz_consumer
+{
+    const fuzz_path_t *path;
+    ring_buffer_t ring;
+    uint32_t random;
+    uint32_t skip_percent;          /* Ticks this consumer misses */
+    uint32_t budget;                /* Bytes per tick */
+    uint32_t chunk;
+    tiered_ring_t tier;
+    volatile uint8_t cold[COLD_MAX];
+    uint32_t copy_wait;             /* Service calls until the copy in flight completes */
+    uint64_t delivered;             /* Stream position of the next byte handed out */
+    const char *error;
+    uint64_t error_at;
+};
+
+typedef struct
+{
+    uint64_t runs;
+    uint64_t bytes;
+    uint64_t segments;
+    uint64_t failures;
+} fuzz_stats_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static volatile uint8_t storage[RING_MAX];
+static uint64_t stream_key;
+
+static uint32_t random_below(uint32_t *state, uint32_t limit)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state % limit;
+}
+
+/* Byte of the stream at position, not periodic in any ring size */
+static uint8_t stream_byte(uint64_t position)
+{
+    uint64_t x = position + stream_key;
+
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9u;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBu;
+    return (uint8_t)(x ^ (x >> 31));
+}
+
+/*******************************************************************************
+ * Function Name: fuzz_sink
+ ********************************************************************************
+ * Summary:
+ * Handler of every path. A segment must be non-empty unless the path is
+ * known to emit empty ones, lie within the ring storage or the cold tier,
+ * and continue the stream where the previous one ended.
+ *
+ *******************************************************************************/
+static void fuzz_sink(void *context, const uint8_t *data, uint32_t len)
+{
+    fuzz_consumer_t *c = context;
+    const uint8_t *ring = (const uint8_t *)c->ring.buffer;
+    const uint8_t *cold = (const uint8_t *)c->cold;
+    bool in_ring = (data >= ring) && ((data + len) <= (ring + c->ring.size));
+    bool in_cold = (c->tier.cold != NULL) && (data >= cold) && ((data + len) <= (cold + c->tier.cold_size));
+
+    if (c->error != NULL)
+    {
+        return;
+    }
+    if ((len == 0) && !c->path->empty_segments)
+    {
+        c->error = "empty segment";
+    }
+    else if (!in_ring && !in_cold)
+    {
+        c->error = "segment outside the storage";
+    }
+    for (uint32_t i = 0; (c->error == NULL) && (i < len); ++i)
+    {
+        if (data[i] != stream_byte(c->delivered + i))
+        {
+            c->error = "stream differs";
+            c->error_at = c->delivered + i;
+        }
+    }
+    if (c->error != NULL)
+    {
+        c->error_at = (c->error_at != 0) ? c->error_at : c->delivered;
+        return;
+    }
+    c->delivered += len;
+}
+
+/* The oracle: the start/end block of the original SysTick_Handler(), transcribed verbatim.
+ * ring.start stands in for its static start, so the backlog of this path is known */
+static void baseline_tick(fuzz_consumer_t *c, uint32_t end)
+{
+    volatile uint8_t *ring_buffer = c->ring.buffer;
+    uint32_t start = c->ring.start;
+
+    /* Did the pointer proceed in the meanwhile? */
+    if (start != end)
+    {
+        /* Has the ring buffer overflowed ? */
+        if (start < end)
+        {
+            /* Process input data in linear buffer phase */
+            fuzz_sink(c, (const uint8_t *)& ring_buffer[start], end - start);
+        }
+        else
+        {
+            /* Process data until end of buffer, then until current position on top of buffer;
+             * the second segment is empty when end is 0 */
+            fuzz_sink(c, (const uint8_t *)&ring_buffer[start], c->ring.size - start);
+            fuzz_sink(c, (const uint8_t *)&ring_buffer[0], end);
+        }
+
+        /* Set start pointer to the last read data */
+        start = end;
+    }
+    c->ring.start = start;
+}
+
+/* The #else branch of SysTick_Handler(): everything written since the last tick */
+static void plain_setup(fuzz_consumer_t *c)
+{
+    (void)c;
+}
+
+static void reference_tick(fuzz_consumer_t *c, uint32_t end)
+{
+    ring_buffer_consume(&c->ring, end, fuzz_sink, c);
+}
+
+/* ENABLE_RX_BUDGET: chunks of at most chunk bytes up to the byte budget of the tick */
+static void budget_setup(fuzz_consumer_t *c)
+{
+    c->budget = 1u + random_below(&c->random, c->ring.size);
+    c->chunk = 1u + random_below(&c->random, 64u);
+}
+
+static void budget_tick(fuzz_consumer_t *c, uint32_t end)
+{
+    uint32_t budget = c->budget;
+    uint32_t taken;
+
+    do
+    {
+        uint32_t chunk = (budget < c->chunk) ? budget : c->chunk;
+
+        taken = ring_buffer_consume_max(&c->ring, end, chunk, fuzz_sink, c);
+        budget -= taken;
+    } while ((taken != 0) && (budget != 0));
+}
+
+/* ENABLE_FW_UPDATE: peek, take what the page buffers accept, stop at the first partial take */
+static void peek_setup(fuzz_consumer_t *c)
+{
+    (void)c;
+}
+
+static void peek_tick(fuzz_consumer_t *c, uint32_t end)
+{
+    const uint8_t *data;
+    uint32_t len;
+
+    while ((len = ring_buffer_peek(&c->ring, end, &data)) != 0)
+    {
+        uint32_t taken = (random_below(&c->random, 2u) == 0) ? len : random_below(&c->random, len + 1u);
+
+        if (taken != 0)
+        {
+            fuzz_sink(c, data, taken);
+        }
+        ring_buffer_advance(&c->ring, taken);
+        if (taken < len)
+        {
+            break;
+        }
+    }
+}
+
+/* ENABLE_EBU_BUFFER: spill to a cold tier whose copies complete after a random delay, uplink budget per tick */
+static void spill_copy(void *context, volatile uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+    fuzz_consumer_t *c = context;
+
+    memcpy((uint8_t *)dst, src, len);
+    c->copy_wait = random_below(&c->random, 4u);
+}
+
+static bool spill_busy(void *context)
+{
+    fuzz_consumer_t *c = context;
+
+    if (c->copy_wait != 0)
+    {
+        c->copy_wait--;
+        return true;
+    }
+    return false;
+}
+
+static const tiered_ring_ops_t spill_ops = { spill_copy, spill_busy };
+
+static void tiered_setup(fuzz_consumer_t *c)
+{
+    uint32_t cold_size = 1u + random_below(&c->random, COLD_MAX);
+    uint32_t threshold = 1u + random_below(&c->random, c->ring.size);
+    uint32_t max_copy = 1u + random_below(&c->random, 4095u);
+
+    c->budget = 1u + random_below(&c->random, c->ring.size);
+    c->copy_wait = 0;
+    tiered_ring_init(&c->tier, &c->ring, &spill_ops, c, c->cold, cold_size, threshold, max_copy);
+}
+
+static void tiered_tick(fuzz_consumer_t *c, uint32_t end)
+{
+    uint32_t budget = c->budget;
+    const uint8_t *data;
+    uint32_t len;
+
+    tiered_ring_service(&c->tier, end);
+    while ((budget != 0) && ((len = tiered_ring_peek(&c->tier, end, &data)) != 0))
+    {
+        len = (len < budget) ? len : budget;
+        fuzz_sink(c, data, len);
+        tiered_ring_advance(&c->tier, len);
+        budget -= len;
+    }
+}
+
+/* Deliberately broken path for -x: forgets the segment after the wrap */
+static void broken_tick(fuzz_consumer_t *c, uint32_t end)
+{
+    uint32_t start = c->ring.start;
+
+    if (start < end)
+    {
+        fuzz_sink(c, (const uint8_t *)&c->ring.buffer[start], end - start);
+    }
+    else if (start > end)
+    {
+        fuzz_sink(c, (const uint8_t *)&c->ring.buffer[start], c->ring.size - start);
+    }
+    c->ring.start = end;
+}
+
+static const fuzz_path_t paths[] =
+{
+    { "baseline (original)", plain_setup, baseline_tick, true },
+    { "consume all", plain_setup, reference_tick, false },
+    { "rx budget (consume_max)", budget_setup, budget_tick, false },
+    { "fw update (peek/advance)", peek_setup, peek_tick, false },
+    { "ebu tier (spill + uplink)", tiered_setup, tiered_tick, false },
+    { "broken wrap (-x)", plain_setup, broken_tick, false },
+};
+
+#define PATH_COUNT (sizeof(paths) / sizeof(paths[0]))
+
+/* Bytes the DMA must not overwrite yet: unread by the slowest path, including a spill in flight */
+static uint32_t fuzz_backlog(const fuzz_consumer_t *consumers, uint32_t count, uint32_t end)
+{
+    uint32_t backlog = 0;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t pending = ring_buffer_pending(&consumers[i].ring, end);
+        backlog = (pending > backlog) ? pending : backlog;
+    }
+    return backlog;
+}
+
+/*******************************************************************************
+ * Function Name: fuzz_progress
+ ********************************************************************************
+ * Summary:
+ * Bytes the DMA writes before the next tick: nothing, a trickle, line rate,
+ * as much as fits, or exactly up to the wrap or to one byte short of it.
+ *
+ *******************************************************************************/
+static uint32_t fuzz_progress(uint32_t *state, uint32_t size, uint32_t end, uint32_t free)
+{
+    uint32_t n;
+
+    switch (random_below(state, 6u))
+    {
+        case 0: n = 0; break;
+        case 1: n = 1u + random_below(state, 3u); break;
+        case 2: n = 1u + random_below(state, 1u + (size / 8u)); break;
+        case 3: n = free; break;
+        case 4: n = size - end; break;
+        default: n = (size - end > 1u) ? (size - end - 1u) : (size - end + 1u); break;
+    }
+    return (n < free) ? n : free;
+}
+
+/*******************************************************************************
+ * Function Name: fuzz_run
+ ********************************************************************************
+ * Summary:
+ * One run with the given seed: a random ring size, biased to tiny rings
+ * where every tick crosses the wrap, random parameters per path, then
+ * ticks of random DMA progress and a drain.
+ *
+ * Return:
+ *  bool: true if every path delivered the identical stream
+ *
+ *******************************************************************************/
+static bool fuzz_run(uint32_t seed, uint32_t ticks, uint32_t count, fuzz_stats_t *stats, bool verbose)
+{
+    static fuzz_consumer_t consumers[PATH_COUNT];
+    uint32_t state = seed | 1u;
+    uint32_t size;
+    uint32_t end = 0;
+    uint64_t produced = 0;
+    bool ok = true;
+
+    switch (random_below(&state, 3u))
+    {
+        case 0: size = 2u + random_below(&state, 15u); break;
+        case 1: size = (1u << (1u + random_below(&state, 10u))) + random_below(&state, 3u) - 1u; break;
+        default: size = 2u + random_below(&state, RING_MAX - 1u); break;
+    }
+    size = (size > RING_MAX) ? RING_MAX : size;
+    stream_key = ((uint64_t)seed << 32) | random_below(&state, 0xFFFFFFFFu);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        fuzz_consumer_t *c = &consumers[i];
+
+        c->path = &paths[i];
+        c->random = (seed * (i + 1u)) | 1u;
+        c->skip_percent = random_below(&state, 60u);
+        c->delivered = 0;
+        c->error = NULL;
+        c->error_at = 0;
+        ring_buffer_init(&c->ring, storage, size);
+        c->path->setup(c);
+    }
+
+    for (uint32_t t = 0; t < (ticks + DRAIN_TICKS); ++t)
+    {
+        bool draining = (t >= ticks);
+        bool drained = true;
+
+        if (!draining)
+        {
+            uint32_t free = size - 1u - fuzz_backlog(consumers, count, end);
+            uint32_t n = fuzz_progress(&state, size, end, free);
+
+            for (uint32_t i = 0; i < n; ++i)
+            {
+                storage[end] = stream_byte(produced++);
+                end = (end + 1u == size) ? 0u : (end + 1u);
+            }
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            fuzz_consumer_t *c = &consumers[i];
+
+            if (draining || (random_below(&state, 100u) >= c->skip_percent))
+            {
+                c->path->tick(c, end);
+            }
+            drained &= (c->error != NULL) || (c->delivered == produced);
+        }
+        if (draining && drained)
+        {
+            break;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        fuzz_consumer_t *c = &consumers[i];
+        const char *error = c->error;
+
+        if ((error == NULL) && (c->delivered != consumers[0].delivered))
+        {
+            error = "stream length differs from the baseline";
+            c->error_at = c->delivered;
+        }
+        if (error != NULL)
+        {
+            stats[i].failures++;
+            if (verbose || (stats[i].failures == 1u))
+            {
+                printf("  %s: %s at byte %llu, ring of %u bytes; reproduce with -s %u -n 1\n", c->path->name, error,
+                       (unsigned long long)c->error_at, size, seed);
+            }
+            ok = false;
+        }
+        stats[i].runs++;
+        stats[i].bytes += c->delivered;
+    }
+    return ok;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-n runs] [-t ticks] [-s seed] [-x] [-v]\n"
+            "  -n  number of runs (default: %u)\n"
+            "  -t  ticks with DMA progress per run, followed by a drain (default: %u)\n"
+            "  -s  seed of the first run, run i uses seed + i (default: 1)\n"
+            "  -x  add a path with a wrap bug, to see the harness catch it\n"
+            "  -v  report every failing run, not only the first per path\n",
+            argv0, DEFAULT_RUNS, DEFAULT_TICKS);
+}
+
+int main(int argc, char *argv[])
+{
+    fuzz_stats_t stats[PATH_COUNT];
+    uint32_t runs = DEFAULT_RUNS;
+    uint32_t ticks = DEFAULT_TICKS;
+    uint32_t seed = 1;
+    uint32_t count = PATH_COUNT - 1u;
+    uint32_t failed = 0;
+    bool verbose = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:t:s:xvh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': runs = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 't': ticks = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'x': count = PATH_COUNT; break;
+            case 'v': verbose = true; break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((runs == 0) || (ticks == 0))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    memset(stats, 0, sizeof(stats));
+    printf("%u runs of %u ticks, seeds %u to %u\n", runs, ticks, seed, seed + runs - 1u);
+    for (uint32_t r = 0; r < runs; ++r)
+    {
+        failed += fuzz_run(seed + r, ticks, count, stats, verbose) ? 0u : 1u;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        printf("  %-26s %10llu bytes, %u of %u runs identical to the baseline%s\n", paths[i].name,
+               (unsigned long long)stats[i].bytes, (uint32_t)(stats[i].runs - stats[i].failures), runs,
+               (stats[i].failures == 0) ? "" : ", FAILED");
+    }
+    printf("%s\n", (failed == 0) ? "all paths identical" : "MISMATCH");
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,236 @@
+/******************************************************************************
+ * File Name:   fw_send.c
+ *
+ * Description: Host tool that sends a firmware image to a kit built with
+ *              ENABLE_FW_UPDATE. The image is padded to whole flash pages and
+ *              sent after an update header; the tool waits for the kit to
+ *              erase the slot, streams the image at line rate and reports the
+ *              result of the CRC check on the kit.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fw_update.h"
+#include "serial_port.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Erasing a 1 MB slot takes several seconds */
+#define ERASE_TIMEOUT_MS 30000
+#define DONE_TIMEOUT_MS 10000
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000u) + ((uint64_t)ts.tv_nsec / 1000000u);
+}
+
+static uint32_t crc32_ieee(const uint8_t *data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        crc ^= data[i];
+        for (int k = 0; k < 8; ++k)
+        {
+            crc = (crc & 1u) ? (0xEDB88320u ^ (crc >> 1)) : (crc >> 1);
+        }
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+/*******************************************************************************
+ * Function Name: write_all
+ ********************************************************************************
+ * Summary:
+ * Write everything, waiting for the port to drain when its buffer is full.
+ *
+ *******************************************************************************/
+static int write_all(int fd, const uint8_t *data, size_t len)
+{
+    while (len != 0)
+    {
+        ssize_t n = write(fd, data, len);
+        if (n > 0)
+        {
+            data += n;
+            len -= (size_t)n;
+        }
+        else if ((n < 0) && (errno == EAGAIN))
+        {
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+            poll(&pfd, 1, -1);
+        }
+        else if ((n < 0) && (errno != EINTR))
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: wait_response
+ ********************************************************************************
+ * Summary:
+ * Wait for one of the single byte responses, skipping anything else (for
+ * example the welcome message of the kit).
+ *
+ *******************************************************************************/
+static int wait_response(int fd, int timeout_ms)
+{
+    uint64_t deadline = now_ms() + (uint64_t)timeout_ms;
+
+    for (;;)
+    {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        uint64_t now = now_ms();
+        uint8_t c;
+
+        if (now >= deadline)
+        {
+            return -1;
+        }
+        if ((poll(&pfd, 1, (int)(deadline - now)) > 0) && (read(fd, &c, 1) == 1) &&
+            ((c == FW_UPDATE_RESPONSE_READY) || (c == FW_UPDATE_RESPONSE_OK) || (c == FW_UPDATE_RESPONSE_ERROR)))
+        {
+            return c;
+        }
+    }
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [-b baud] port image.bin\n  -b  reconfigure the port to this baud rate\n", argv0);
+}
+
+int main(int argc, char *argv[])
+{
+    long baud = 0;
+    fw_update_header_t header;
+    uint8_t *image;
+    uint32_t len;
+    uint32_t padded;
+    uint64_t start;
+    FILE *file;
+    int fd;
+    int response;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baud = strtol(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((argc - optind) != 2)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    file = fopen(argv[optind + 1], "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "%s: %s\n", argv[optind + 1], strerror(errno));
+        return EXIT_FAILURE;
+    }
+    fseek(file, 0, SEEK_END);
+    len = (uint32_t)ftell(file);
+    rewind(file);
+    padded = (len + FW_UPDATE_PAGE_SIZE - 1u) & ~(FW_UPDATE_PAGE_SIZE - 1u);
+    image = malloc(padded);
+    if ((image == NULL) || (fread(image, 1, len, file) != len))
+    {
+        fprintf(stderr, "%s: read failed\n", argv[optind + 1]);
+        return EXIT_FAILURE;
+    }
+    fclose(file);
+    /* Pad with the erased flash value */
+    memset(&image[len], 0xFF, padded - len);
+
+    fd = serial_port_open(argv[optind], O_RDWR, baud);
+    if (fd < 0)
+    {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    header.magic = FW_UPDATE_MAGIC;
+    header.length = padded;
+    header.crc32 = crc32_ieee(image, padded);
+    header.reserved = 0;
+
+    if (write_all(fd, (const uint8_t *)&header, sizeof(header)) != 0)
+    {
+        perror("write");
+        return EXIT_FAILURE;
+    }
+    response = wait_response(fd, ERASE_TIMEOUT_MS);
+    if (response != FW_UPDATE_RESPONSE_READY)
+    {
+        fprintf(stderr, "kit %s the header\n", (response < 0) ? "did not answer" : "rejected");
+        return EXIT_FAILURE;
+    }
+
+    start = now_ms();
+    if (write_all(fd, image, padded) != 0)
+    {
+        perror("write");
+        return EXIT_FAILURE;
+    }
+    tcdrain(fd);
+    response = wait_response(fd, DONE_TIMEOUT_MS);
+    fprintf(stderr, "%u bytes (%u padded) in %.2f s, CRC %08x: %s\n", len, padded, (now_ms() - start) / 1000.0,
+            header.crc32, (response == FW_UPDATE_RESPONSE_OK) ? "OK" : ((response < 0) ? "no answer" : "CRC error"));
+    free(image);
+    close(fd);
+    return (response == FW_UPDATE_RESPONSE_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,261 @@
+/******************************************************************************
+ * File Name:   gpdma_model.c
+ *
+ * Description: Simulated GPDMA channels for the host tools. A channel in
+ *              multi-block mode with destination reload writes one transfer
+ *              per service request and returns to the start of its block, like
+ *              GPDMA0 of the XMC4; a single-block memory-to-peripheral
+ *              channel reads one transfer per request and disables itself at
+ *              the end of the block. Disabling a channel takes effect at once,
+ *              and a request that arrives while it is disabled is lost.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <stddef.h>
+#include <string.h>
+
+#include "xmc_dma.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define GPDMA_MODEL_REGIONS 8u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    volatile uint8_t *base;
+    uint32_t size;
+} gpdma_model_region_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static gpdma_model_region_t regions[GPDMA_MODEL_REGIONS];
+static uint32_t region_count = 0;
+
+void gpdma_model_memory(volatile void *base, uint32_t size)
+{
+    if (region_count < GPDMA_MODEL_REGIONS)
+    {
+        regions[region_count].base = base;
+        regions[region_count].size = size;
+        region_count++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: gpdma_model_address
+ ********************************************************************************
+ * Summary:
+ * Map a 32-bit bus address back to the registered host memory it was taken
+ * from.
+ *
+ *******************************************************************************/
+static volatile uint8_t *gpdma_model_address(uint32_t address)
+{
+    for (uint32_t i = 0; i < region_count; ++i)
+    {
+        uint32_t offset = address - (uint32_t)(uintptr_t)regions[i].base;
+        if (offset < regions[i].size)
+        {
+            return &regions[i].base[offset];
+        }
+    }
+    return NULL;
+}
+
+void XMC_DMA_Init(XMC_DMA_t *dma)
+{
+    memset(dma, 0, sizeof(*dma));
+    dma->enabled = true;
+}
+
+bool XMC_DMA_IsEnabled(XMC_DMA_t *dma)
+{
+    return dma->enabled;
+}
+
+void XMC_DMA_CH_Init(XMC_DMA_t *dma, uint8_t channel, const XMC_DMA_CH_CONFIG_t *config)
+{
+    gpdma_model_channel_t *ch = &dma->ch[channel];
+
+    ch->source = config->src_addr;
+    ch->destination = config->dst_addr;
+    ch->block_size = config->block_size;
+    ch->width = 1u << config->dst_transfer_width;
+    ch->single_block = (config->transfer_type == XMC_DMA_CH_TRANSFER_TYPE_SINGLE_BLOCK);
+    ch->transferred = 0;
+    ch->enabled = false;
+}
+
+void XMC_DMA_CH_Enable(XMC_DMA_t *dma, uint8_t channel)
+{
+    gpdma_model_channel_t *ch = &dma->ch[channel];
+
+    ch->transferred = 0;
+    ch->enabled = true;
+}
+
+void XMC_DMA_CH_Disable(XMC_DMA_t *dma, uint8_t channel)
+{
+    dma->ch[channel].enabled = false;
+}
+
+bool XMC_DMA_CH_IsEnabled(XMC_DMA_t *dma, uint8_t channel)
+{
+    return dma->ch[channel].enabled;
+}
+
+void XMC_DMA_CH_SetSourceAddress(XMC_DMA_t *dma, uint8_t channel, uint32_t address)
+{
+    dma->ch[channel].source = address;
+}
+
+void XMC_DMA_CH_SetDestinationAddress(XMC_DMA_t *dma, uint8_t channel, uint32_t address)
+{
+    dma->ch[channel].destination = address;
+}
+
+void XMC_DMA_CH_SetBlockSize(XMC_DMA_t *dma, uint8_t channel, uint32_t block_size)
+{
+    dma->ch[channel].block_size = block_size;
+}
+
+uint32_t XMC_DMA_CH_GetTransferredData(XMC_DMA_t *dma, uint8_t channel)
+{
+    return dma->ch[channel].transferred;
+}
+
+/* End of one transfer: a single block disables the channel, a multi-block
+ * transfer reloads the addresses */
+static void gpdma_model_advance(gpdma_model_channel_t *ch)
+{
+    if (++ch->transferred == ch->block_size)
+    {
+        if (ch->single_block)
+        {
+            ch->enabled = false;
+        }
+        else
+        {
+            ch->transferred = 0;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: gpdma_model_request
+ ********************************************************************************
+ * Summary:
+ * One hardware request: write value with the channel width at the current
+ * position, then reload the destination at the end of the block.
+ *
+ * Return:
+ *  bool: false if the channel was disabled and the value was lost
+ *
+ *******************************************************************************/
+bool gpdma_model_request(XMC_DMA_t *dma, uint8_t channel, uint32_t value)
+{
+    gpdma_model_channel_t *ch = &dma->ch[channel];
+    volatile uint8_t *dst;
+
+    if (!ch->enabled || (ch->block_size == 0))
+    {
+        return false;
+    }
+
+    dst = gpdma_model_address(ch->destination + (ch->transferred * ch->width));
+    for (uint32_t i = 0; (dst != NULL) && (i < ch->width); ++i)
+    {
+        dst[i] = (uint8_t)(value >> (8u * i));
+    }
+    gpdma_model_advance(ch);
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: gpdma_model_fetch
+ ********************************************************************************
+ * Summary:
+ * One hardware request of a transmitter: read the next value with the
+ * channel width from the incrementing source.
+ *
+ * Return:
+ *  bool: false if the channel was disabled and nothing was transferred
+ *
+ *******************************************************************************/
+bool gpdma_model_fetch(XMC_DMA_t *dma, uint8_t channel, uint32_t *value)
+{
+    gpdma_model_channel_t *ch = &dma->ch[channel];
+    volatile uint8_t *src;
+
+    if (!ch->enabled || (ch->block_size == 0))
+    {
+        return false;
+    }
+
+    *value = 0;
+    src = gpdma_model_address(ch->source + (ch->transferred * ch->width));
+    for (uint32_t i = 0; (src != NULL) && (i < ch->width); ++i)
+    {
+        *value |= (uint32_t)src[i] << (8u * i);
+    }
+    gpdma_model_advance(ch);
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: gpdma_model_blackout
+ ********************************************************************************
+ * Summary:
+ * Account for a restart of a peripheral-to-memory channel. Without a FIFO
+ * the peripheral holds one character in its result register, so every
+ * further character that completes while the channel is stopped overruns
+ * it. The phase is taken as the worst case: a character completes right
+ * after the stop.
+ *
+ *******************************************************************************/
+uint32_t gpdma_model_blackout(XMC_DMA_t *dma, uint8_t channel, uint64_t blackout, uint64_t char_cycles)
+{
+    uint32_t lost = (blackout > char_cycles) ? (uint32_t)(((blackout + char_cycles - 1u) / char_cycles) - 1u) : 0u;
+
+    dma->ch[channel].lost += lost;
+    return lost;
+}
+
+/* [] END OF FILE */
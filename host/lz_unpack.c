@@ -0,0 +1,131 @@
+/******************************************************************************
+ * File Name:   lz_unpack.c
+ *
+ * Description: Host tool that decompresses the TX stream of a kit built with
+ *              ENABLE_TX_COMPRESSION. Reads a serial port (or stdin) and writes
+ *              the original data to stdout.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lz_stream.h"
+#include "serial_port.h"
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static lz_stream_decoder_t decoder;
+static uint64_t bytes_in;
+static uint64_t bytes_out;
+
+static void write_stdout(void *context, const uint8_t *data, uint32_t len)
+{
+    (void)context;
+    bytes_out += len;
+    fwrite(data, 1, len, stdout);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-b baud] [port]\n"
+            "  -b  reconfigure the port to this baud rate\n"
+            "Reads stdin when no port is given. Start the tool before resetting\n"
+            "the kit; the decoder must see the stream from its first byte.\n",
+            argv0);
+}
+
+int main(int argc, char *argv[])
+{
+    long baud = 0;
+    int fd = STDIN_FILENO;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baud = strtol(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if ((argc - optind) > 1)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (optind < argc)
+    {
+        fd = serial_port_open(argv[optind], O_RDONLY, baud);
+        if (fd < 0)
+        {
+            fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+
+    lz_stream_decoder_init(&decoder, write_stdout, NULL);
+    for (;;)
+    {
+        uint8_t chunk[4096];
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        ssize_t n;
+
+        poll(&pfd, 1, -1);
+        n = read(fd, chunk, sizeof(chunk));
+        if (n > 0)
+        {
+            bytes_in += (uint64_t)n;
+            lz_stream_decompress(&decoder, chunk, (uint32_t)n);
+            fflush(stdout);
+        }
+        else if ((n == 0) || ((errno != EAGAIN) && (errno != EINTR)))
+        {
+            break;
+        }
+    }
+
+    fprintf(stderr, "%llu bytes in, %llu bytes out\n", (unsigned long long)bytes_in, (unsigned long long)bytes_out);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
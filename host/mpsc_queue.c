@@ -0,0 +1,263 @@
+/******************************************************************************
+ * File Name:   mpsc_queue.c
+ *
+ * Description: Bounded lock-free multi-producer, single-consumer queue of frame
+ *              handles. Every cell carries a sequence number, so producers claim
+ *              cells with one CAS on the tail and the consumer needs no atomic
+ *              read-modify-write at all.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <linux/futex.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mpsc_queue.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static long futex(uint32_t *addr, int op, uint32_t value, const struct timespec *timeout)
+{
+    return syscall(SYS_futex, addr, op, value, timeout, NULL, 0);
+}
+
+/*******************************************************************************
+ * Function Name: mpsc_queue_init
+ ********************************************************************************
+ * Summary:
+ * Allocate the cell array. Cell i starts with sequence i, which marks it as
+ * free for the producer that claims position i.
+ *
+ * A sleeping consumer is only woken once wake_threshold handles are queued;
+ * below that, the timeout of mpsc_queue_wait_batch() bounds the latency. A
+ * threshold of 1 wakes the consumer on every push.
+ *
+ * Parameters:
+ *  mpsc_queue_t *queue: Queue instance
+ *  uint32_t capacity: Number of cells, must be a power of two
+ *  uint32_t wake_threshold: Queue depth that wakes a sleeping consumer
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int mpsc_queue_init(mpsc_queue_t *queue, uint32_t capacity, uint32_t wake_threshold)
+{
+    if ((capacity < 2u) || ((capacity & (capacity - 1u)) != 0) || (wake_threshold == 0) ||
+        (wake_threshold > capacity))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    queue->cells = aligned_alloc(MPSC_CACHE_LINE, ((capacity * sizeof(mpsc_cell_t)) + MPSC_CACHE_LINE - 1u) &
+                                                  ~(size_t)(MPSC_CACHE_LINE - 1u));
+    if (queue->cells == NULL)
+    {
+        return -1;
+    }
+    for (uint32_t i = 0; i < capacity; ++i)
+    {
+        queue->cells[i].seq = i;
+    }
+    queue->mask = capacity - 1u;
+    queue->tail = 0;
+    queue->head = 0;
+    queue->wake = 0;
+    queue->sleeping = 0;
+    queue->wake_threshold = wake_threshold;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: mpsc_queue_push
+ ********************************************************************************
+ * Summary:
+ * Enqueue a frame handle. Never blocks; the caller decides what to do with a
+ * full queue. The consumer is only woken if it announced that it sleeps and
+ * the queue reached the wake threshold.
+ *
+ * Parameters:
+ *  mpsc_queue_t *queue: Queue instance
+ *  uint32_t handle: Frame handle
+ *
+ * Return:
+ *  bool: false if the queue is full
+ *
+ *******************************************************************************/
+bool mpsc_queue_push(mpsc_queue_t *queue, uint32_t handle)
+{
+    uint32_t pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    mpsc_cell_t *cell;
+
+    for (;;)
+    {
+        int32_t diff;
+
+        cell = &queue->cells[pos & queue->mask];
+        diff = (int32_t)(LOAD_ACQUIRE(&cell->seq) - pos);
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&queue->tail, &pos, pos + 1u, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+        else
+        {
+            pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->handle = handle;
+    STORE_RELEASE(&cell->seq, pos + 1u);
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if ((__atomic_load_n(&queue->sleeping, __ATOMIC_RELAXED) != 0) &&
+        ((pos + 1u - __atomic_load_n(&queue->head, __ATOMIC_RELAXED)) >= queue->wake_threshold))
+    {
+        mpsc_queue_wake(queue);
+    }
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: mpsc_queue_pop_batch
+ ********************************************************************************
+ * Summary:
+ * Drain up to max handles in queue order. Must only be called by the single
+ * consumer thread.
+ *
+ * Parameters:
+ *  mpsc_queue_t *queue: Queue instance
+ *  uint32_t *handles: Receives the handles
+ *  uint32_t max: Capacity of handles
+ *
+ * Return:
+ *  uint32_t: Number of handles drained
+ *
+ *******************************************************************************/
+uint32_t mpsc_queue_pop_batch(mpsc_queue_t *queue, uint32_t *handles, uint32_t max)
+{
+    uint32_t head = queue->head;
+    uint32_t count = 0;
+
+    while (count < max)
+    {
+        mpsc_cell_t *cell = &queue->cells[head & queue->mask];
+        if (LOAD_ACQUIRE(&cell->seq) != (head + 1u))
+        {
+            break;
+        }
+        handles[count++] = cell->handle;
+        /* Hand the cell back for the producer one lap ahead */
+        STORE_RELEASE(&cell->seq, head + queue->mask + 1u);
+        ++head;
+    }
+    __atomic_store_n(&queue->head, head, __ATOMIC_RELAXED);
+    return count;
+}
+
+/*******************************************************************************
+ * Function Name: mpsc_queue_wait_batch
+ ********************************************************************************
+ * Summary:
+ * Like mpsc_queue_pop_batch(), but sleeps on the futex while the queue is
+ * empty. Setting the sleeping flag before re-checking the queue pairs with
+ * the fence in mpsc_queue_push(), so a push can not be missed.
+ *
+ * Parameters:
+ *  mpsc_queue_t *queue: Queue instance
+ *  uint32_t *handles: Receives the handles
+ *  uint32_t max: Capacity of handles
+ *  int timeout_ms: Maximum time to sleep, -1 to sleep until woken
+ *
+ * Return:
+ *  uint32_t: Number of handles drained, 0 on timeout or explicit wakeup
+ *
+ *******************************************************************************/
+uint32_t mpsc_queue_wait_batch(mpsc_queue_t *queue, uint32_t *handles, uint32_t max, int timeout_ms)
+{
+    struct timespec ts = { timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000L };
+    uint32_t count = mpsc_queue_pop_batch(queue, handles, max);
+    uint32_t wake;
+
+    if ((count != 0) || (timeout_ms == 0))
+    {
+        return count;
+    }
+
+    __atomic_store_n(&queue->sleeping, 1u, __ATOMIC_SEQ_CST);
+    wake = __atomic_load_n(&queue->wake, __ATOMIC_SEQ_CST);
+    count = mpsc_queue_pop_batch(queue, handles, max);
+    if (count == 0)
+    {
+        futex(&queue->wake, FUTEX_WAIT_PRIVATE, wake, (timeout_ms < 0) ? NULL : &ts);
+        count = mpsc_queue_pop_batch(queue, handles, max);
+    }
+    __atomic_store_n(&queue->sleeping, 0u, __ATOMIC_RELAXED);
+    return count;
+}
+
+/*******************************************************************************
+ * Function Name: mpsc_queue_wake
+ ********************************************************************************
+ * Summary:
+ * Wake the consumer, e.g. to make it notice a shutdown request.
+ *
+ *******************************************************************************/
+void mpsc_queue_wake(mpsc_queue_t *queue)
+{
+    __atomic_fetch_add(&queue->wake, 1u, __ATOMIC_SEQ_CST);
+    futex(&queue->wake, FUTEX_WAKE_PRIVATE, 1, NULL);
+}
+
+void mpsc_queue_destroy(mpsc_queue_t *queue)
+{
+    free(queue->cells);
+    queue->cells = NULL;
+}
+
+/* [] END OF FILE */
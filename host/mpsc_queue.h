@@ -0,0 +1,85 @@
+/******************************************************************************
+ * File Name:   mpsc_queue.h
+ *
+ * Description: Bounded lock-free multi-producer, single-consumer queue of frame
+ *              handles. Producers are the shards, the consumer is the single
+ *              sink writer, which drains the queue in large batches and sleeps
+ *              on a futex while it is empty.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define MPSC_CACHE_LINE 64
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t seq;
+    uint32_t handle;
+} mpsc_cell_t;
+
+typedef struct
+{
+    mpsc_cell_t *cells;
+    uint32_t mask;
+    _Alignas(MPSC_CACHE_LINE) uint32_t tail;    /* Next cell to claim, shared by producers */
+    _Alignas(MPSC_CACHE_LINE) uint32_t head;    /* Next cell to drain, consumer only */
+    _Alignas(MPSC_CACHE_LINE) uint32_t wake;    /* Futex word */
+    uint32_t sleeping;
+    uint32_t wake_threshold;                    /* Queue depth that wakes the consumer */
+} mpsc_queue_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+int mpsc_queue_init(mpsc_queue_t *queue, uint32_t capacity, uint32_t wake_threshold);
+bool mpsc_queue_push(mpsc_queue_t *queue, uint32_t handle);
+uint32_t mpsc_queue_pop_batch(mpsc_queue_t *queue, uint32_t *handles, uint32_t max);
+uint32_t mpsc_queue_wait_batch(mpsc_queue_t *queue, uint32_t *handles, uint32_t max, int timeout_ms);
+void mpsc_queue_wake(mpsc_queue_t *queue);
+void mpsc_queue_destroy(mpsc_queue_t *queue);
+
+#endif /* MPSC_QUEUE_H */
+
+/* [] END OF FILE */
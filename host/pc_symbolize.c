@@ -0,0 +1,425 @@
+/******************************************************************************
+ * File Name:   pc_symbolize.c
+ *
+ * Description: Host tool that turns the reports of a kit built with
+ *              ENABLE_PC_PROFILE into a flat profile. Reads a serial port (or
+ *              stdin), picks the checksummed profile records out of the other
+ *              traffic and attributes the sampled address ranges to the
+ *              functions in the symbol table of the firmware ELF file.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pc_profile.h"
+#include "serial_port.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define DEFAULT_TOP 25u
+#define MAX_ENTRIES 65536u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t address;
+    uint32_t size;
+    const char *name;
+} symbol_t;
+
+typedef struct
+{
+    uint32_t base;
+    uint32_t shift;
+    uint32_t samples;
+    uint32_t outside;
+    uint32_t entries;                   /* Announced by the header */
+    uint32_t received;
+    uint32_t index[MAX_ENTRIES];
+    uint32_t count[MAX_ENTRIES];
+    bool open;                          /* Header seen, entries outstanding */
+} report_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static symbol_t *symbols;
+static uint32_t symbol_count;
+static uint64_t *function_samples;      /* Per symbol, the last one is unknown code */
+static uint64_t total_samples;
+static uint64_t total_outside;
+static uint32_t reports;
+static uint32_t dropped;
+static uint32_t bucket_size;
+static report_t report;
+
+static uint32_t get16(const uint8_t *p)
+{
+    return p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return get16(p) | (get16(p + 2) << 16);
+}
+
+static int compare_symbols(const void *a, const void *b)
+{
+    const symbol_t *sa = a;
+    const symbol_t *sb = b;
+
+    return (sa->address > sb->address) - (sa->address < sb->address);
+}
+
+/*******************************************************************************
+ * Function Name: load_symbols
+ ********************************************************************************
+ * Summary:
+ * Read the sized function symbols of a 32 bit little-endian ELF file and
+ * sort them by address. Thumb symbols of ARM files have the lowest address
+ * bit cleared.
+ *
+ *******************************************************************************/
+static bool load_symbols(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    const Elf32_Ehdr *eh;
+    const Elf32_Shdr *sh;
+    uint8_t *image;
+    uint32_t thumb;
+    long size;
+
+    if (file == NULL)
+    {
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    rewind(file);
+    image = malloc((size_t)size);   /* Kept, the symbol names point into it */
+    if ((size < (long)sizeof(Elf32_Ehdr)) || (image == NULL) || (fread(image, 1, (size_t)size, file) != (size_t)size))
+    {
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    eh = (const Elf32_Ehdr *)image;
+    sh = (const Elf32_Shdr *)(image + eh->e_shoff);
+    thumb = (eh->e_machine == EM_ARM) ? 1u : 0u;
+    if ((memcmp(image, ELFMAG, SELFMAG) != 0) || (image[EI_CLASS] != ELFCLASS32) || (image[EI_DATA] != ELFDATA2LSB) ||
+        ((eh->e_shoff + ((uint64_t)eh->e_shnum * sizeof(Elf32_Shdr))) > (uint64_t)size))
+    {
+        return false;
+    }
+
+    for (uint32_t s = 0; s < eh->e_shnum; ++s)
+    {
+        const Elf32_Shdr *strtab = &sh[sh[s].sh_link];
+        const Elf32_Sym *sym = (const Elf32_Sym *)(image + sh[s].sh_offset);
+
+        if ((sh[s].sh_type != SHT_SYMTAB) || (sh[s].sh_link >= eh->e_shnum) ||
+            (((uint64_t)sh[s].sh_offset + sh[s].sh_size) > (uint64_t)size) ||
+            (((uint64_t)strtab->sh_offset + strtab->sh_size) > (uint64_t)size))
+        {
+            continue;
+        }
+        for (uint32_t i = 0; i < (sh[s].sh_size / sizeof(Elf32_Sym)); ++i)
+        {
+            if ((ELF32_ST_TYPE(sym[i].st_info) != STT_FUNC) || (sym[i].st_size == 0) ||
+                (sym[i].st_shndx == SHN_UNDEF) || (sym[i].st_name >= strtab->sh_size))
+            {
+                continue;
+            }
+            symbols = realloc(symbols, (symbol_count + 1u) * sizeof(symbol_t));
+            symbols[symbol_count].address = sym[i].st_value & ~thumb;
+            symbols[symbol_count].size = sym[i].st_size;
+            symbols[symbol_count].name = (const char *)(image + strtab->sh_offset + sym[i].st_name);
+            symbol_count++;
+        }
+    }
+
+    qsort(symbols, symbol_count, sizeof(symbol_t), compare_symbols);
+    function_samples = calloc(symbol_count + 1u, sizeof(uint64_t));
+    return (symbol_count != 0) && (function_samples != NULL);
+}
+
+/* Symbol containing the start of [address, address + size), else the first one starting
+ * inside it; symbol_count if none */
+static uint32_t lookup(uint64_t address, uint64_t size)
+{
+    uint32_t low = 0;
+    uint32_t high = symbol_count;
+
+    /* First symbol starting after address */
+    while (low < high)
+    {
+        uint32_t mid = (low + high) / 2u;
+
+        if (symbols[mid].address <= address)
+        {
+            low = mid + 1u;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    if ((low != 0) && (((uint64_t)symbols[low - 1u].address + symbols[low - 1u].size) > address))
+    {
+        return low - 1u;
+    }
+    if ((low < symbol_count) && (symbols[low].address < (address + size)))
+    {
+        return low;
+    }
+    return symbol_count;
+}
+
+static int compare_samples(const void *a, const void *b)
+{
+    uint64_t sa = function_samples[*(const uint32_t *)a];
+    uint64_t sb = function_samples[*(const uint32_t *)b];
+
+    return (sa < sb) - (sa > sb);
+}
+
+static void print_profile(uint32_t top)
+{
+    uint32_t *order = malloc((symbol_count + 1u) * sizeof(uint32_t));
+
+    for (uint32_t i = 0; i <= symbol_count; ++i)
+    {
+        order[i] = i;
+    }
+    qsort(order, symbol_count + 1u, sizeof(uint32_t), compare_samples);
+
+    printf("%u reports (%u dropped), %llu samples, %.1f%% outside the profiled range, %u byte buckets\n", reports,
+           dropped, (unsigned long long)total_samples, (100.0 * total_outside) / total_samples, bucket_size);
+    printf("       %%    samples  function\n");
+    for (uint32_t i = 0; (i < top) && (i <= symbol_count) && (function_samples[order[i]] != 0); ++i)
+    {
+        printf("  %6.2f%% %10llu  %s\n", (100.0 * function_samples[order[i]]) / total_samples,
+               (unsigned long long)function_samples[order[i]],
+               (order[i] == symbol_count) ? "[unknown]" : symbols[order[i]].name);
+    }
+    fflush(stdout);
+    free(order);
+}
+
+/*******************************************************************************
+ * Function Name: add_record
+ ********************************************************************************
+ * Summary:
+ * Collect the records of one report. A report is added to the profile once
+ * all announced entries are in and their counts add up to the samples; a
+ * report with a lost record is dropped.
+ *
+ *******************************************************************************/
+static bool add_record(const uint8_t *record)
+{
+    const uint8_t *payload = &record[4];
+    uint32_t len = record[3];
+    uint64_t sum = 0;
+
+    if (record[2] == PC_PROFILE_HEADER)
+    {
+        dropped += report.open ? 1u : 0u;
+        report.base = get32(&payload[0]);
+        report.shift = get32(&payload[4]);
+        report.samples = get32(&payload[8]);
+        report.outside = get32(&payload[12]);
+        report.entries = get32(&payload[16]);
+        report.received = 0;
+        report.open = (report.entries <= MAX_ENTRIES) && (report.shift < 32u) && (report.outside <= report.samples);
+        dropped += report.open ? 0u : 1u;
+    }
+    else if (report.open)
+    {
+        for (uint32_t i = 0; (i < len) && (report.received < report.entries); i += 4u)
+        {
+            report.index[report.received] = get16(&payload[i]);
+            report.count[report.received] = get16(&payload[i + 2u]);
+            report.received++;
+        }
+    }
+    if (!report.open || (report.received < report.entries))
+    {
+        return false;
+    }
+
+    report.open = false;
+    for (uint32_t i = 0; i < report.entries; ++i)
+    {
+        sum += report.count[i];
+    }
+    if (sum != (report.samples - report.outside))
+    {
+        dropped++;
+        return false;
+    }
+    for (uint32_t i = 0; i < report.entries; ++i)
+    {
+        uint64_t address = report.base + ((uint64_t)report.index[i] << report.shift);
+
+        function_samples[lookup(address, 1ull << report.shift)] += report.count[i];
+    }
+    total_samples += report.samples;
+    total_outside += report.outside;
+    bucket_size = 1u << report.shift;
+    reports++;
+    return true;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-b baud] [-n top] firmware.elf [port]\n"
+            "  -b  reconfigure the port to this baud rate\n"
+            "  -n  functions listed (default: %u)\n"
+            "Reads stdin when no port is given. The profile over all reports so far\n"
+            "is printed after each report from a port, and at the end of the input.\n",
+            argv0, DEFAULT_TOP);
+}
+
+int main(int argc, char *argv[])
+{
+    long baud = 0;
+    uint32_t top = DEFAULT_TOP;
+    int fd = STDIN_FILENO;
+    bool live = false;
+    bool printed = true;
+    static uint8_t buffer[65536];
+    uint32_t fill = 0;
+    bool eof = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:n:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baud = strtol(optarg, NULL, 0); break;
+            case 'n': top = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (((argc - optind) < 1) || ((argc - optind) > 2))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!load_symbols(argv[optind]))
+    {
+        fprintf(stderr, "%s: no function symbols in a 32 bit little-endian ELF file\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+    if ((optind + 1) < argc)
+    {
+        fd = serial_port_open(argv[optind + 1], O_RDONLY, baud);
+        if (fd < 0)
+        {
+            fprintf(stderr, "%s: %s\n", argv[optind + 1], strerror(errno));
+            return EXIT_FAILURE;
+        }
+        live = true;
+    }
+
+    while (!eof)
+    {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        uint32_t pos = 0;
+        ssize_t n;
+
+        poll(&pfd, 1, -1);
+        n = read(fd, &buffer[fill], sizeof(buffer) - fill);
+        if (n > 0)
+        {
+            fill += (uint32_t)n;
+        }
+        else if ((n == 0) || ((errno != EAGAIN) && (errno != EINTR)))
+        {
+            eof = true;
+        }
+
+        /* A record may start anywhere; wait for more data while one could still be incomplete */
+        while ((pos < fill) && (eof || ((fill - pos) >= PC_PROFILE_RECORD_MAX) || (buffer[pos] != PC_PROFILE_ESCAPE)))
+        {
+            uint32_t len = pc_profile_check(&buffer[pos], fill - pos);
+
+            if (len == 0)
+            {
+                pos++;
+                continue;
+            }
+            if (add_record(&buffer[pos]))
+            {
+                printed = false;
+                if (live)
+                {
+                    print_profile(top);
+                    printed = true;
+                }
+            }
+            pos += len;
+        }
+        memmove(buffer, &buffer[pos], fill - pos);
+        fill -= pos;
+    }
+
+    if (reports == 0)
+    {
+        fprintf(stderr, "no complete report (%u dropped)\n", dropped);
+        return EXIT_FAILURE;
+    }
+    if (!printed)
+    {
+        print_profile(top);
+    }
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
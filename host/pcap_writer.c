@@ -0,0 +1,372 @@
+/******************************************************************************
+ * File Name:   pcap_writer.c
+ *
+ * Description: Streaming pcapng writer for UART frames captured from the DMA
+ *              ring buffer. Blocks are staged in a fixed buffer inside the
+ *              writer and flushed with write(2), so memory use does not grow
+ *              with the length of the capture.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pcap_writer.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* pcapng block types */
+#define PCAPNG_BLOCK_SHB 0x0A0D0D0Au
+#define PCAPNG_BLOCK_IDB 0x00000001u
+#define PCAPNG_BLOCK_EPB 0x00000006u
+
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4Du
+
+/* pcapng option codes */
+#define PCAPNG_OPT_ENDOFOPT 0
+#define PCAPNG_OPT_SHB_USERAPPL 4
+#define PCAPNG_OPT_IF_NAME 2
+#define PCAPNG_OPT_IF_TSRESOL 9
+#define PCAPNG_OPT_EPB_FLAGS 2
+
+/* Timestamps are written with nanosecond resolution (10^-9) */
+#define PCAPNG_TSRESOL_NS 9
+
+/* Worst case block overhead around the frame payload of an EPB */
+#define PCAPNG_EPB_OVERHEAD 48
+
+#define PAD4(x) (((x) + 3u) & ~3u)
+
+static const char USER_APPLICATION[] = "mtb-example-xmc-dma-ring-buffer";
+
+/*******************************************************************************
+ * Function Name: put_u16 / put_u32 / put_bytes
+ ********************************************************************************
+ * Summary:
+ * Append host-endian fields to the staging buffer. pcapng readers detect the
+ * byte order from the section header, so no swapping is required.
+ *
+ *******************************************************************************/
+static void put_u16(pcap_writer_t *writer, uint16_t value)
+{
+    memcpy(&writer->buffer[writer->used], &value, sizeof(value));
+    writer->used += sizeof(value);
+}
+
+static void put_u32(pcap_writer_t *writer, uint32_t value)
+{
+    memcpy(&writer->buffer[writer->used], &value, sizeof(value));
+    writer->used += sizeof(value);
+}
+
+static void put_bytes(pcap_writer_t *writer, const void *data, uint32_t len)
+{
+    memcpy(&writer->buffer[writer->used], data, len);
+    memset(&writer->buffer[writer->used + len], 0, PAD4(len) - len);
+    writer->used += PAD4(len);
+}
+
+static void put_option(pcap_writer_t *writer, uint16_t code, const void *data, uint16_t len)
+{
+    put_u16(writer, code);
+    put_u16(writer, len);
+    put_bytes(writer, data, len);
+}
+
+/*******************************************************************************
+ * Function Name: reserve
+ ********************************************************************************
+ * Summary:
+ * Make sure at least len bytes are free in the staging buffer, flushing the
+ * buffered blocks to the file if necessary.
+ *
+ * Parameters:
+ *  pcap_writer_t *writer: Writer instance
+ *  size_t len: Number of bytes about to be appended
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+static int reserve(pcap_writer_t *writer, size_t len)
+{
+    if (writer->used + len > sizeof(writer->buffer))
+    {
+        return pcap_writer_flush(writer);
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: write_interface
+ ********************************************************************************
+ * Summary:
+ * Emit an Interface Description Block for a channel the first time a frame is
+ * seen on it. The interface is named "uart<channel>".
+ *
+ * Parameters:
+ *  pcap_writer_t *writer: Writer instance
+ *  uint16_t channel: Channel id
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+static int write_interface(pcap_writer_t *writer, uint16_t channel)
+{
+    char name[16];
+    uint8_t tsresol = PCAPNG_TSRESOL_NS;
+    uint16_t name_len = (uint16_t)snprintf(name, sizeof(name), "uart%u", channel);
+    uint32_t block_len = 20u + 4u + PAD4(name_len) + 4u + 4u + 4u;
+
+    if (reserve(writer, block_len) != 0)
+    {
+        return -1;
+    }
+
+    put_u32(writer, PCAPNG_BLOCK_IDB);
+    put_u32(writer, block_len);
+    put_u16(writer, writer->linktype);
+    put_u16(writer, 0);
+    put_u32(writer, writer->snaplen);
+    put_option(writer, PCAPNG_OPT_IF_NAME, name, name_len);
+    put_option(writer, PCAPNG_OPT_IF_TSRESOL, &tsresol, sizeof(tsresol));
+    put_u32(writer, PCAPNG_OPT_ENDOFOPT);
+    put_u32(writer, block_len);
+
+    writer->interface_id[channel] = (int32_t)writer->interface_count++;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: pcap_writer_open
+ ********************************************************************************
+ * Summary:
+ * Create a pcapng capture file and write its Section Header Block.
+ *
+ * Parameters:
+ *  pcap_writer_t *writer: Writer instance to initialize
+ *  const char *path: Output file, "-" writes to stdout
+ *  uint16_t linktype: Link type stored for every channel, usually
+ *                     PCAP_WRITER_LINKTYPE_USER0
+ *  uint32_t snaplen: Maximum number of bytes stored per frame
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int pcap_writer_open(pcap_writer_t *writer, const char *path, uint16_t linktype, uint32_t snaplen)
+{
+    uint32_t block_len = 28u + 4u + PAD4(sizeof(USER_APPLICATION) - 1u) + 4u;
+    uint64_t section_len = UINT64_MAX;
+
+    if ((snaplen == 0) || (snaplen > (sizeof(writer->buffer) - PCAPNG_EPB_OVERHEAD)))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (strcmp(path, "-") == 0)
+    {
+        writer->fd = STDOUT_FILENO;
+    }
+    else
+    {
+        writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (writer->fd < 0)
+        {
+            return -1;
+        }
+    }
+
+    writer->linktype = linktype;
+    writer->snaplen = snaplen;
+    writer->interface_count = 0;
+    writer->frames = 0;
+    writer->bytes = 0;
+    writer->used = 0;
+    for (uint32_t i = 0; i < PCAP_WRITER_MAX_CHANNELS; ++i)
+    {
+        writer->interface_id[i] = -1;
+    }
+
+    put_u32(writer, PCAPNG_BLOCK_SHB);
+    put_u32(writer, block_len);
+    put_u32(writer, PCAPNG_BYTE_ORDER_MAGIC);
+    put_u16(writer, 1);
+    put_u16(writer, 0);
+    memcpy(&writer->buffer[writer->used], &section_len, sizeof(section_len));
+    writer->used += sizeof(section_len);
+    put_option(writer, PCAPNG_OPT_SHB_USERAPPL, USER_APPLICATION, sizeof(USER_APPLICATION) - 1u);
+    put_u32(writer, PCAPNG_OPT_ENDOFOPT);
+    put_u32(writer, block_len);
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: pcap_writer_write_frame
+ ********************************************************************************
+ * Summary:
+ * Append one decoded UART frame as an Enhanced Packet Block. Frames longer than
+ * the snaplen are truncated, the original length is preserved in the block.
+ *
+ * Parameters:
+ *  pcap_writer_t *writer: Writer instance
+ *  uint16_t channel: Channel id, below PCAP_WRITER_MAX_CHANNELS
+ *  pcap_direction_t direction: Whether the frame was received or sent
+ *  uint64_t timestamp_ns: Capture time in nanoseconds since the epoch
+ *  const uint8_t *data: Frame payload
+ *  uint32_t len: Length of the frame payload
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int pcap_writer_write_frame(pcap_writer_t *writer, uint16_t channel, pcap_direction_t direction,
+                            uint64_t timestamp_ns, const uint8_t *data, uint32_t len)
+{
+    uint32_t captured = (len < writer->snaplen) ? len : writer->snaplen;
+    uint32_t flags = (uint32_t)direction;
+    uint32_t block_len = 32u + PAD4(captured);
+
+    if (channel >= PCAP_WRITER_MAX_CHANNELS)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if ((writer->interface_id[channel] < 0) && (write_interface(writer, channel) != 0))
+    {
+        return -1;
+    }
+
+    if (direction != PCAP_DIRECTION_UNKNOWN)
+    {
+        block_len += 4u + sizeof(flags) + 4u;
+    }
+
+    if (reserve(writer, block_len) != 0)
+    {
+        return -1;
+    }
+
+    put_u32(writer, PCAPNG_BLOCK_EPB);
+    put_u32(writer, block_len);
+    put_u32(writer, (uint32_t)writer->interface_id[channel]);
+    put_u32(writer, (uint32_t)(timestamp_ns >> 32));
+    put_u32(writer, (uint32_t)timestamp_ns);
+    put_u32(writer, captured);
+    put_u32(writer, len);
+    put_bytes(writer, data, captured);
+    if (direction != PCAP_DIRECTION_UNKNOWN)
+    {
+        put_option(writer, PCAPNG_OPT_EPB_FLAGS, &flags, sizeof(flags));
+        put_u32(writer, PCAPNG_OPT_ENDOFOPT);
+    }
+    put_u32(writer, block_len);
+
+    writer->frames++;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: pcap_writer_flush
+ ********************************************************************************
+ * Summary:
+ * Write all staged blocks to the output file. Only complete blocks are ever
+ * staged, so the file is readable after every flush.
+ *
+ * Parameters:
+ *  pcap_writer_t *writer: Writer instance
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int pcap_writer_flush(pcap_writer_t *writer)
+{
+    size_t done = 0;
+
+    while (done < writer->used)
+    {
+        ssize_t n = write(writer->fd, &writer->buffer[done], writer->used - done);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            memmove(writer->buffer, &writer->buffer[done], writer->used - done);
+            writer->used -= done;
+            return -1;
+        }
+        done += (size_t)n;
+    }
+
+    writer->bytes += done;
+    writer->used = 0;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: pcap_writer_close
+ ********************************************************************************
+ * Summary:
+ * Flush outstanding blocks and close the output file.
+ *
+ * Parameters:
+ *  pcap_writer_t *writer: Writer instance
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int pcap_writer_close(pcap_writer_t *writer)
+{
+    int result = pcap_writer_flush(writer);
+
+    if ((writer->fd != STDOUT_FILENO) && (close(writer->fd) != 0))
+    {
+        result = -1;
+    }
+    writer->fd = -1;
+    return result;
+}
+
+/* [] END OF FILE */
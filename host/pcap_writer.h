@@ -0,0 +1,97 @@
+/******************************************************************************
+ * File Name:   pcap_writer.h
+ *
+ * Description: Streaming pcapng writer for UART frames captured from the DMA
+ *              ring buffer. Every channel id is exposed as its own pcapng
+ *              interface so standard tools can filter per serial port.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef PCAP_WRITER_H
+#define PCAP_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* First of the link types reserved by tcpdump.org for private use (DLT_USER0) */
+#define PCAP_WRITER_LINKTYPE_USER0 147
+
+/* Number of distinct channel ids a single capture can carry */
+#define PCAP_WRITER_MAX_CHANNELS 256
+
+/* Size of the staging buffer; this is the only memory the writer holds */
+#define PCAP_WRITER_BUFFER_SIZE (64 * 1024)
+
+/* Default maximum number of bytes stored per frame */
+#define PCAP_WRITER_DEFAULT_SNAPLEN 4096
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+/* Frame direction as seen from the XMC, recorded in the epb_flags option */
+typedef enum
+{
+    PCAP_DIRECTION_UNKNOWN = 0,
+    PCAP_DIRECTION_RX = 1,
+    PCAP_DIRECTION_TX = 2
+} pcap_direction_t;
+
+typedef struct
+{
+    int fd;
+    uint16_t linktype;
+    uint32_t snaplen;
+    uint32_t interface_count;
+    int32_t interface_id[PCAP_WRITER_MAX_CHANNELS];
+    uint64_t frames;
+    uint64_t bytes;
+    size_t used;
+    uint8_t buffer[PCAP_WRITER_BUFFER_SIZE];
+} pcap_writer_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+int pcap_writer_open(pcap_writer_t *writer, const char *path, uint16_t linktype, uint32_t snaplen);
+int pcap_writer_write_frame(pcap_writer_t *writer, uint16_t channel, pcap_direction_t direction,
+                            uint64_t timestamp_ns, const uint8_t *data, uint32_t len);
+int pcap_writer_flush(pcap_writer_t *writer);
+int pcap_writer_close(pcap_writer_t *writer);
+
+#endif /* PCAP_WRITER_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,613 @@
+/******************************************************************************
+ * File Name:   ring_interleave.c
+ *
+ * Description: Exhaustive interleaving explorer for the ring buffer state
+ *              shared by the DMA, SysTick_Handler() and the main loop. Each
+ *              context is modeled as a program of single shared accesses (data
+ *              bytes, the DMA position, the read position): the DMA runs
+ *              between any two accesses of anyone, SysTick preempts the main
+ *              loop unless interrupts are disabled, and the main loop never
+ *              preempts SysTick. Every reachable interleaving is visited
+ *              within small bounds, and the ring invariants are checked: each
+ *              byte is delivered once and in order, no segment reaches past
+ *              written data, and a backlog computed outside SysTick was true
+ *              at some point while it was read. A violation is printed with
+ *              the interleaving that leads to it.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define RING_MAX 8u
+#define DEFAULT_RING 4u
+#define DEFAULT_TRANSFERS 7u        /* Wraps the default ring almost twice */
+#define DEFAULT_TICKS 3u
+#define DEFAULT_MAIN_RUNS 2u
+#define MAX_DEPTH 256u
+#define DESC_SIZE 72u
+#define VISITED_BITS 24u
+#define UNWRITTEN 0xFFu
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef enum
+{
+    PROG_NONE,
+    PROG_CONSUME,                   /* ring_buffer_consume() after one read of the DMA position */
+    PROG_CONSUME_RELOAD,            /* Same, with the position read again at each use */
+    PROG_CONSUME_CRITICAL,          /* Same, with interrupts disabled, as the flush of uart_set_baud_rate() */
+    PROG_PENDING_END_START,         /* ring_buffer_pending(ring, dma_producer_position()) */
+    PROG_PENDING_START_END,         /* The same with the read position loaded first */
+    PROG_PENDING_RETRY,             /* Read position, DMA position, read position again until unchanged */
+    PROG_PENDING_CRITICAL           /* Both loaded with interrupts disabled */
+} program_t;
+
+typedef struct
+{
+    const char *name;
+    program_t tick;                 /* SysTick_Handler() */
+    program_t main;                 /* Main loop */
+    bool position_first;            /* The DMA publishes its position before the data write lands */
+    bool expect_safe;               /* False for the known hazards */
+} scenario_t;
+
+typedef struct
+{
+    uint8_t pc;                     /* 0: idle */
+    uint8_t e;                      /* DMA position as loaded */
+    uint8_t s;                      /* Read position as loaded */
+    uint8_t s2;
+    uint8_t at;                     /* Next slot to read */
+    uint8_t left;                   /* Bytes left in the segments */
+    uint8_t low;                    /* True backlog range while reading */
+    uint8_t high;
+} thread_t;
+
+typedef struct
+{
+    uint8_t data[RING_MAX];         /* Stream position of the byte in each slot */
+    uint8_t position;               /* DMA write position */
+    uint8_t start;                  /* Read position */
+    uint8_t delivered;              /* Output stream position, shared by all consumers */
+    uint8_t written;                /* Bytes the DMA has written */
+    uint8_t dma_pc;                 /* Half of a transfer done */
+    uint8_t ticks;
+    uint8_t main_runs;
+    uint8_t irq_disabled;
+    uint8_t tick_active;
+    thread_t tick;
+    thread_t main;
+} state_t;
+
+typedef struct
+{
+    uint64_t states;
+    uint64_t revisits;
+    const char *violation;
+    uint32_t depth;
+} explore_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static const scenario_t scenarios[] =
+{
+    { "SysTick consume", PROG_CONSUME, PROG_NONE, false, true },
+    { "SysTick consume, DMA position reloaded at each use", PROG_CONSUME_RELOAD, PROG_NONE, false, false },
+    { "SysTick consume, DMA position published before the data", PROG_CONSUME, PROG_NONE, true, false },
+    { "SysTick consume + main flush with interrupts disabled", PROG_CONSUME, PROG_CONSUME_CRITICAL, false, true },
+    { "SysTick consume + main flush without critical section", PROG_CONSUME, PROG_CONSUME, false, false },
+    { "SysTick consume + main pending, interrupts disabled", PROG_CONSUME, PROG_PENDING_CRITICAL, false, true },
+    { "SysTick consume + main pending, DMA then read position", PROG_CONSUME, PROG_PENDING_END_START, false, false },
+    { "SysTick consume + main pending, read then DMA position", PROG_CONSUME, PROG_PENDING_START_END, false, false },
+    { "SysTick consume + main pending, retry on read position change", PROG_CONSUME, PROG_PENDING_RETRY, false,
+      false },
+    { "main consume + SysTick pending", PROG_PENDING_END_START, PROG_CONSUME, false, true },
+};
+
+static uint32_t ring_size = DEFAULT_RING;
+static uint32_t transfers = DEFAULT_TRANSFERS;
+static uint32_t tick_runs = DEFAULT_TICKS;
+static uint32_t main_runs = DEFAULT_MAIN_RUNS;
+static uint64_t *visited;
+static char trace[MAX_DEPTH][DESC_SIZE];
+
+static uint32_t backlog(const state_t *st)
+{
+    return (st->position + ring_size - st->start) % ring_size;
+}
+
+static uint64_t state_hash(const state_t *st)
+{
+    const uint8_t *p = (const uint8_t *)st;
+    uint64_t h = 0xCBF29CE484222325u;
+
+    for (uint32_t i = 0; i < sizeof(*st); ++i)
+    {
+        h = (h ^ p[i]) * 0x100000001B3u;
+    }
+    return h | 1u;
+}
+
+/* Open addressing on the hash alone; a collision could only hide states, never invent a violation */
+static bool state_seen(const state_t *st)
+{
+    uint64_t h = state_hash(st);
+    uint64_t mask = (1u << VISITED_BITS) - 1u;
+
+    for (uint64_t i = h & mask;; i = (i + 1u) & mask)
+    {
+        if (visited[i] == h)
+        {
+            return true;
+        }
+        if (visited[i] == 0)
+        {
+            visited[i] = h;
+            return false;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dma_step
+ ********************************************************************************
+ * Summary:
+ * Half of one DMA transfer: the data write or the position update, in the
+ * scenario's order. A transfer only starts while the ring has room, the
+ * line rate contract the consumer is dimensioned for.
+ *
+ *******************************************************************************/
+static void dma_step(state_t *st, const scenario_t *sc, char *desc)
+{
+    bool data_now = (st->dma_pc == 0) != sc->position_first;
+    uint32_t slot = st->position;
+
+    if (sc->position_first && (st->dma_pc == 1))
+    {
+        slot = (st->position + ring_size - 1u) % ring_size;
+    }
+    if (data_now)
+    {
+        st->data[slot] = st->written;
+        snprintf(desc, DESC_SIZE, "DMA      data[%u] = byte %u", slot, st->written);
+    }
+    else
+    {
+        st->position = (uint8_t)((st->position + 1u) % ring_size);
+        snprintf(desc, DESC_SIZE, "DMA      position = %u", st->position);
+    }
+    if (st->dma_pc == 1)
+    {
+        st->written++;
+    }
+    st->dma_pc ^= 1u;
+}
+
+static bool dma_enabled(const state_t *st)
+{
+    return (st->dma_pc == 1) || ((st->written < transfers) && (((st->position + 1u) % ring_size) != st->start));
+}
+
+/* Read one byte of a segment: it must be the next byte of the stream */
+static void consume_byte(state_t *st, thread_t *t, const char *who, char *desc, const char **violation)
+{
+    uint8_t byte = st->data[t->at];
+
+    snprintf(desc, DESC_SIZE, "%s read data[%u] -> byte %u", who, t->at, byte);
+    if (byte != st->delivered)
+    {
+        *violation = (byte == UNWRITTEN) ? "read a slot the DMA has not written" :
+                     (byte < st->delivered) ? "read a stale or already delivered byte" : "skipped bytes of the stream";
+        return;
+    }
+    st->delivered++;
+    t->at = (uint8_t)((t->at + 1u) % ring_size);
+    t->left--;
+}
+
+static void pending_check(const thread_t *t, uint32_t e, uint32_t s, const char **violation)
+{
+    uint32_t pending = (e + ring_size - s) % ring_size;
+
+    if ((pending < t->low) || (pending > t->high))
+    {
+        *violation = "computed backlog was never true while it was read";
+    }
+}
+
+/*******************************************************************************
+ * Function Name: thread_step
+ ********************************************************************************
+ * Summary:
+ * One shared access of a program. pc 1 is the entry; the thread is idle
+ * again (pc 0) once the program has finished.
+ *
+ *******************************************************************************/
+static void thread_step(state_t *st, thread_t *t, program_t prog, const char *who, char *desc,
+                        const char **violation)
+{
+    switch (prog)
+    {
+        case PROG_CONSUME:
+        case PROG_CONSUME_CRITICAL:
+            switch (t->pc)
+            {
+                case 1:
+                    if (prog == PROG_CONSUME_CRITICAL)
+                    {
+                        st->irq_disabled = 1;
+                    }
+                    t->e = st->position;
+                    snprintf(desc, DESC_SIZE, "%s load position -> %u", who, t->e);
+                    t->pc = 2;
+                    break;
+                case 2:
+                    t->s = st->start;
+                    t->at = t->s;
+                    t->left = (uint8_t)((t->e + ring_size - t->s) % ring_size);
+                    snprintf(desc, DESC_SIZE, "%s load start -> %u", who, t->s);
+                    t->pc = (t->left != 0) ? 3 : 4;
+                    break;
+                case 3:
+                    consume_byte(st, t, who, desc, violation);
+                    t->pc = (t->left != 0) ? 3 : 4;
+                    break;
+                default:
+                    st->start = t->e;
+                    snprintf(desc, DESC_SIZE, "%s store start = %u", who, t->e);
+                    st->irq_disabled = 0;
+                    t->pc = 0;
+                    break;
+            }
+            break;
+
+        case PROG_CONSUME_RELOAD:
+            switch (t->pc)
+            {
+                case 1:
+                    t->e = st->position;
+                    snprintf(desc, DESC_SIZE, "%s load position -> %u (start != end)", who, t->e);
+                    t->pc = 2;
+                    break;
+                case 2:
+                    t->s = st->start;
+                    t->at = t->s;
+                    snprintf(desc, DESC_SIZE, "%s load start -> %u", who, t->s);
+                    t->pc = (t->s != t->e) ? 3 : 0;
+                    break;
+                case 3:
+                {
+                    /* The linear/wrap decision was taken with the first load, the length uses a new one */
+                    uint32_t e2 = st->position;
+                    uint32_t len = (t->s < t->e) ? (uint32_t)(e2 - t->s) : (ring_size - t->s + e2);
+
+                    snprintf(desc, DESC_SIZE, "%s load position -> %u (segment length)", who, e2);
+                    if (len >= ring_size)
+                    {
+                        *violation = "segment longer than the ring";
+                        break;
+                    }
+                    t->left = (uint8_t)len;
+                    t->pc = (t->left != 0) ? 4 : 5;
+                    break;
+                }
+                case 4:
+                    consume_byte(st, t, who, desc, violation);
+                    t->pc = (t->left != 0) ? 4 : 5;
+                    break;
+                default:
+                    st->start = st->position;
+                    snprintf(desc, DESC_SIZE, "%s load position, store start = %u", who, st->start);
+                    t->pc = 0;
+                    break;
+            }
+            break;
+
+        case PROG_PENDING_END_START:
+        case PROG_PENDING_START_END:
+        case PROG_PENDING_CRITICAL:
+            switch (t->pc)
+            {
+                case 1:
+                    if (prog == PROG_PENDING_CRITICAL)
+                    {
+                        st->irq_disabled = 1;
+                    }
+                    if (prog == PROG_PENDING_START_END)
+                    {
+                        t->s = st->start;
+                        snprintf(desc, DESC_SIZE, "%s load start -> %u", who, t->s);
+                    }
+                    else
+                    {
+                        t->e = st->position;
+                        snprintf(desc, DESC_SIZE, "%s load position -> %u", who, t->e);
+                    }
+                    t->pc = 2;
+                    break;
+                default:
+                    if (prog == PROG_PENDING_START_END)
+                    {
+                        t->e = st->position;
+                        snprintf(desc, DESC_SIZE, "%s load position -> %u, backlog %u", who, t->e,
+                                 (t->e + ring_size - t->s) % ring_size);
+                    }
+                    else
+                    {
+                        t->s = st->start;
+                        snprintf(desc, DESC_SIZE, "%s load start -> %u, backlog %u", who, t->s,
+                                 (t->e + ring_size - t->s) % ring_size);
+                    }
+                    st->irq_disabled = 0;
+                    pending_check(t, t->e, t->s, violation);
+                    t->pc = 0;
+                    break;
+            }
+            break;
+
+        case PROG_PENDING_RETRY:
+            switch (t->pc)
+            {
+                case 1:
+                    t->s = st->start;
+                    snprintf(desc, DESC_SIZE, "%s load start -> %u", who, t->s);
+                    t->pc = 2;
+                    break;
+                case 2:
+                    t->e = st->position;
+                    snprintf(desc, DESC_SIZE, "%s load position -> %u", who, t->e);
+                    t->pc = 3;
+                    break;
+                default:
+                    t->s2 = st->start;
+                    if (t->s2 != t->s)
+                    {
+                        snprintf(desc, DESC_SIZE, "%s load start -> %u, changed: retry", who, t->s2);
+                        t->pc = 1;
+                    }
+                    else
+                    {
+                        snprintf(desc, DESC_SIZE, "%s load start -> %u, backlog %u", who, t->s2,
+                                 (t->e + ring_size - t->s) % ring_size);
+                        pending_check(t, t->e, t->s, violation);
+                        t->pc = 0;
+                    }
+                    break;
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/* Widen the true backlog range of a reader in progress */
+static void track_backlog(const state_t *st, thread_t *t)
+{
+    uint8_t now = (uint8_t)backlog(st);
+
+    t->low = (now < t->low) ? now : t->low;
+    t->high = (now > t->high) ? now : t->high;
+}
+
+/*******************************************************************************
+ * Function Name: explore
+ ********************************************************************************
+ * Summary:
+ * Depth-first search over every enabled move: a DMA half transfer, a
+ * SysTick step (entry only while interrupts are enabled, and SysTick runs
+ * to its end before the main loop continues) or a main loop step. States
+ * reached before are not expanded again.
+ *
+ * Return:
+ *  bool: true once a violation is found, with the trace filled in
+ *
+ *******************************************************************************/
+static bool explore(const state_t *st, const scenario_t *sc, uint32_t depth, explore_t *ex)
+{
+    if (state_seen(st))
+    {
+        ex->revisits++;
+        return false;
+    }
+    ex->states++;
+    if (depth >= MAX_DEPTH)
+    {
+        ex->violation = "trace longer than MAX_DEPTH";
+        ex->depth = depth;
+        return true;
+    }
+
+    for (uint32_t move = 0; move < 3u; ++move)
+    {
+        state_t next = *st;
+        const char *violation = NULL;
+        char *desc = trace[depth];
+
+        if (move == 0)
+        {
+            if (!dma_enabled(st))
+            {
+                continue;
+            }
+            dma_step(&next, sc, desc);
+        }
+        else if (move == 1)
+        {
+            if (sc->tick == PROG_NONE)
+            {
+                continue;
+            }
+            if (!st->tick_active)
+            {
+                if ((st->ticks >= tick_runs) || st->irq_disabled)
+                {
+                    continue;
+                }
+                next.tick_active = 1;
+                next.ticks++;
+                next.tick.pc = 1;
+                next.tick.low = next.tick.high = (uint8_t)backlog(st);
+            }
+            thread_step(&next, &next.tick, sc->tick, "SysTick ", desc, &violation);
+            next.tick_active = (next.tick.pc != 0);
+        }
+        else
+        {
+            if ((sc->main == PROG_NONE) || st->tick_active)
+            {
+                continue;
+            }
+            if (st->main.pc == 0)
+            {
+                if (st->main_runs >= main_runs)
+                {
+                    continue;
+                }
+                next.main_runs++;
+                next.main.pc = 1;
+                next.main.low = next.main.high = (uint8_t)backlog(st);
+            }
+            thread_step(&next, &next.main, sc->main, "main     ", desc, &violation);
+        }
+
+        if (next.tick.pc != 0)
+        {
+            track_backlog(&next, &next.tick);
+        }
+        if (next.main.pc != 0)
+        {
+            track_backlog(&next, &next.main);
+        }
+        if (violation != NULL)
+        {
+            ex->violation = violation;
+            ex->depth = depth + 1u;
+            return true;
+        }
+        if (explore(&next, sc, depth + 1u, ex))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-r ring_size] [-d transfers] [-t ticks] [-m main_runs] [-q]\n"
+            "  -r  ring size in bytes, 2 to %u (default: %u)\n"
+            "  -d  DMA transfers (default: %u)\n"
+            "  -t  SysTick_Handler() runs (default: %u)\n"
+            "  -m  main loop runs (default: %u)\n"
+            "  -q  do not print the interleaving of a violation\n",
+            argv0, RING_MAX, DEFAULT_RING, DEFAULT_TRANSFERS, DEFAULT_TICKS, DEFAULT_MAIN_RUNS);
+}
+
+int main(int argc, char *argv[])
+{
+    bool quiet = false;
+    uint32_t unexpected = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:d:t:m:qh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'r': ring_size = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'd': transfers = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 't': tick_runs = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'm': main_runs = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'q': quiet = true; break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if ((ring_size < 2u) || (ring_size > RING_MAX) || (transfers == 0) || (transfers >= UNWRITTEN) ||
+        (tick_runs > 8u) || (main_runs > 8u))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    visited = calloc((size_t)1u << VISITED_BITS, sizeof(*visited));
+    if (visited == NULL)
+    {
+        perror("calloc");
+        return EXIT_FAILURE;
+    }
+
+    printf("%u byte ring, %u DMA transfers, %u SysTick runs, %u main loop runs\n", ring_size, transfers, tick_runs,
+           main_runs);
+    for (uint32_t i = 0; i < (sizeof(scenarios) / sizeof(scenarios[0])); ++i)
+    {
+        const scenario_t *sc = &scenarios[i];
+        explore_t ex = { 0, 0, NULL, 0 };
+        state_t initial;
+
+        memset(&initial, 0, sizeof(initial));
+        memset(initial.data, UNWRITTEN, sizeof(initial.data));
+        memset(visited, 0, ((size_t)1u << VISITED_BITS) * sizeof(*visited));
+
+        explore(&initial, sc, 0, &ex);
+        /* A known hazard can need larger bounds to show up; only a violation where none is expected fails */
+        printf("  %-64s %9llu states: %s%s\n", sc->name, (unsigned long long)ex.states,
+               (ex.violation == NULL) ? "safe" : ex.violation,
+               (ex.violation == NULL) ? (sc->expect_safe ? "" : " within these bounds") :
+               (sc->expect_safe ? "  (UNEXPECTED)" : ""));
+        if ((ex.violation != NULL) && !quiet)
+        {
+            for (uint32_t d = 0; d < ex.depth; ++d)
+            {
+                printf("      %s\n", trace[d]);
+            }
+        }
+        unexpected += ((ex.violation != NULL) && sc->expect_safe) ? 1u : 0u;
+    }
+    free(visited);
+    return (unexpected == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* [] END OF FILE */
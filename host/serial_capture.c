@@ -0,0 +1,301 @@
+/******************************************************************************
+ * File Name:   serial_capture.c
+ *
+ * Description: Host tool that records UART traffic from one or more serial
+ *              ports (or ptys, or files) into a pcapng capture. Each input
+ *              gets its own channel id; the byte stream is split into frames
+ *              at a delimiter byte or after an idle gap on the line.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pcap_writer.h"
+#include "serial_port.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Maximum number of serial inputs recorded in one capture */
+#define MAX_INPUTS 32
+
+/* Default idle time in milliseconds that terminates a frame */
+#define DEFAULT_GAP_MS 5
+
+/* Staged blocks are written out at least this often, in milliseconds */
+#define FLUSH_INTERVAL_MS 1000
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    int fd;
+    uint64_t first_ns;
+    uint64_t last_ns;
+    uint32_t len;
+    uint8_t frame[PCAP_WRITER_DEFAULT_SNAPLEN];
+} capture_input_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static volatile sig_atomic_t stop_requested = 0;
+static pcap_writer_t writer;
+static capture_input_t inputs[MAX_INPUTS];
+
+/*******************************************************************************
+ * Function Name: now_ns
+ ********************************************************************************
+ * Summary:
+ * Wall clock time in nanoseconds, used as the pcapng frame timestamp.
+ *
+ *******************************************************************************/
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+static void on_signal(int signo)
+{
+    (void)signo;
+    stop_requested = 1;
+}
+
+/*******************************************************************************
+ * Function Name: emit_frame
+ ********************************************************************************
+ * Summary:
+ * Write the pending frame of an input to the capture and reset it. The frame
+ * is stamped with the arrival time of its first byte.
+ *
+ *******************************************************************************/
+static int emit_frame(uint16_t channel)
+{
+    capture_input_t *in = &inputs[channel];
+    int result = 0;
+
+    if (in->len != 0)
+    {
+        result = pcap_writer_write_frame(&writer, channel, PCAP_DIRECTION_RX, in->first_ns, in->frame, in->len);
+        in->len = 0;
+    }
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: append_bytes
+ ********************************************************************************
+ * Summary:
+ * Add freshly read bytes to the pending frame of an input, cutting frames at
+ * the delimiter byte and at the frame buffer size.
+ *
+ *******************************************************************************/
+static int append_bytes(uint16_t channel, const uint8_t *data, size_t len, int delimiter, uint64_t ts)
+{
+    capture_input_t *in = &inputs[channel];
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        if (in->len == 0)
+        {
+            in->first_ns = ts;
+        }
+        in->frame[in->len++] = data[i];
+
+        if (((delimiter >= 0) && (data[i] == (uint8_t)delimiter)) || (in->len == sizeof(in->frame)))
+        {
+            if (emit_frame(channel) != 0)
+            {
+                return -1;
+            }
+        }
+    }
+    in->last_ns = ts;
+    return 0;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-o out.pcapng] [-b baud] [-d delimiter] [-g gap_ms] [-l linktype] input...\n"
+            "  -o  output file, '-' for stdout (default: capture.pcapng)\n"
+            "  -b  reconfigure terminal inputs to this baud rate\n"
+            "  -d  frame delimiter byte, e.g. 0x0a (default: none)\n"
+            "  -g  idle time that ends a frame in ms (default: %d)\n"
+            "  -l  pcapng link type (default: %d, DLT_USER0)\n"
+            "Input n is recorded as channel n, interface \"uart<n>\".\n",
+            argv0, DEFAULT_GAP_MS, PCAP_WRITER_LINKTYPE_USER0);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ ********************************************************************************
+ * Summary:
+ * Parses the command line, then polls all inputs until every input reached
+ * end of file or SIGINT/SIGTERM is received. Staged blocks are flushed once
+ * per FLUSH_INTERVAL_MS so a capture that is killed loses at most that much.
+ *
+ *******************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *output = "capture.pcapng";
+    long baud = 0;
+    int delimiter = -1;
+    long gap_ms = DEFAULT_GAP_MS;
+    long linktype = PCAP_WRITER_LINKTYPE_USER0;
+    struct pollfd fds[MAX_INPUTS];
+    uint32_t count;
+    uint32_t open_count;
+    uint64_t last_flush;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:b:d:g:l:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'o': output = optarg; break;
+            case 'b': baud = strtol(optarg, NULL, 0); break;
+            case 'd': delimiter = (int)(strtol(optarg, NULL, 0) & 0xFF); break;
+            case 'g': gap_ms = strtol(optarg, NULL, 0); break;
+            case 'l': linktype = strtol(optarg, NULL, 0); break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    count = (uint32_t)(argc - optind);
+    if ((count == 0) || (count > MAX_INPUTS))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        inputs[i].fd = serial_port_open(argv[optind + (int)i], O_RDONLY, baud);
+        if (inputs[i].fd < 0)
+        {
+            fprintf(stderr, "%s: %s\n", argv[optind + (int)i], strerror(errno));
+            return EXIT_FAILURE;
+        }
+        fds[i].fd = inputs[i].fd;
+        fds[i].events = POLLIN;
+    }
+
+    if (pcap_writer_open(&writer, output, (uint16_t)linktype, PCAP_WRITER_DEFAULT_SNAPLEN) != 0)
+    {
+        fprintf(stderr, "%s: %s\n", output, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    open_count = count;
+    last_flush = now_ns();
+    while (!stop_requested && (open_count != 0))
+    {
+        uint8_t chunk[4096];
+        uint64_t ts;
+        int ready = poll(fds, count, (int)gap_ms);
+
+        if ((ready < 0) && (errno != EINTR))
+        {
+            perror("poll");
+            break;
+        }
+
+        ts = now_ns();
+        for (uint16_t ch = 0; ch < count; ++ch)
+        {
+            if ((ready > 0) && (fds[ch].revents & (POLLIN | POLLHUP)))
+            {
+                ssize_t n = read(fds[ch].fd, chunk, sizeof(chunk));
+                if (n > 0)
+                {
+                    append_bytes(ch, chunk, (size_t)n, delimiter, ts);
+                }
+                else if ((n == 0) || ((errno != EAGAIN) && (errno != EINTR)))
+                {
+                    emit_frame(ch);
+                    fds[ch].fd = -1;
+                    --open_count;
+                }
+            }
+            /* Idle gap on the line terminates the pending frame */
+            if ((inputs[ch].len != 0) && ((ts - inputs[ch].last_ns) >= ((uint64_t)gap_ms * 1000000u)))
+            {
+                emit_frame(ch);
+            }
+        }
+
+        if ((ts - last_flush) >= ((uint64_t)FLUSH_INTERVAL_MS * 1000000u))
+        {
+            if (pcap_writer_flush(&writer) != 0)
+            {
+                perror("write");
+                break;
+            }
+            last_flush = ts;
+        }
+    }
+
+    for (uint16_t ch = 0; ch < count; ++ch)
+    {
+        emit_frame(ch);
+        close(inputs[ch].fd);
+    }
+
+    if (pcap_writer_close(&writer) != 0)
+    {
+        perror("close");
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "%llu frames, %llu bytes written to %s\n",
+            (unsigned long long)writer.frames, (unsigned long long)writer.bytes, output);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,382 @@
+/******************************************************************************
+ * File Name:   serial_gateway.c
+ *
+ * Description: Linux gateway counterpart of main.c. Serial ports are read into
+ *              the same ring buffers the XMC fills by DMA, and a periodic tick
+ *              runs the unchanged ring_buffer_consume() logic of the firmware's
+ *              SysTick_Handler on every port.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pcap_writer.h"
+#include "ring_buffer.h"
+#include "serial_port.h"
+#include "shm_ring.h"
+#include "ts_store.h"
+#include "serial_ring.h"
+#include "serial_uring.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Consumer period, same as the firmware's system timer */
+#define TICKS_PER_SECOND 1000
+
+/* Declarations for ring buffer */
+#define RING_BUFFER_SIZE 4096
+
+/* Maximum number of serial ports serviced by the gateway */
+#define MAX_PORTS 64
+
+/* Geometry of the shared-memory ring published with -m */
+#define SHM_SLOTS 4096
+#define SHM_SLOT_SIZE 256
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    serial_ring_t port;
+    uint16_t channel;
+    int out_fd;
+    bool closed;                    /* Hung up and drained, no longer serviced */
+    uint8_t storage[RING_BUFFER_SIZE];
+} gateway_port_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static volatile sig_atomic_t stop_requested = 0;
+static gateway_port_t ports[MAX_PORTS];
+static serial_ring_t *port_list[MAX_PORTS];
+static pcap_writer_t capture;
+static bool capture_enabled = false;
+static shm_ring_t shared;
+static bool shared_enabled = false;
+static ts_store_t archive;
+static bool archive_enabled = false;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t wall_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+static void on_signal(int signo)
+{
+    (void)signo;
+    stop_requested = 1;
+}
+
+/*******************************************************************************
+ * Function Name: write_all
+ ********************************************************************************
+ * Summary:
+ * Blocking write on a non-blocking fd, the host equivalent of uart_transmit().
+ *
+ *******************************************************************************/
+static void write_all(int fd, const uint8_t *data, uint32_t len)
+{
+    while (len != 0)
+    {
+        ssize_t n = write(fd, data, len);
+        if (n > 0)
+        {
+            data += n;
+            len -= (uint32_t)n;
+        }
+        else if ((n < 0) && (errno != EAGAIN) && (errno != EINTR))
+        {
+            break;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: uart_echo
+ ********************************************************************************
+ * Summary:
+ * Ring buffer handler, echoes each segment like the firmware and optionally
+ * records it in the pcapng capture, the shared-memory ring and the archive.
+ *
+ *******************************************************************************/
+static void uart_echo(void *context, const uint8_t *data, uint32_t len)
+{
+    gateway_port_t *gw = context;
+
+    write_all(gw->out_fd, data, len);
+    if (capture_enabled)
+    {
+        pcap_writer_write_frame(&capture, gw->channel, PCAP_DIRECTION_RX, wall_ns(), data, len);
+    }
+    if (shared_enabled)
+    {
+        uint32_t max = SHM_SLOT_SIZE - 16u;
+        for (uint32_t done = 0; done < len; done += max)
+        {
+            shm_ring_publish(&shared, gw->channel, &data[done], ((len - done) < max) ? (len - done) : max);
+        }
+    }
+    if (archive_enabled)
+    {
+        ts_store_append(&archive, wall_ns(), gw->channel, PCAP_DIRECTION_RX, data, len);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: systick
+ ********************************************************************************
+ * Summary:
+ * Consumer tick, identical in structure to SysTick_Handler in main.c.
+ *
+ *******************************************************************************/
+static void systick(gateway_port_t *gw)
+{
+    /* Get pointer to last byte written by the backend to the ring buffer */
+    uint32_t end = serial_ring_position(&gw->port);
+
+    /* Send received data to the output */
+    ring_buffer_consume(&gw->port.ring, end, uart_echo, gw);
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-b baud] [-u] [-s] [-w out.pcapng] [-m /name] [-a dir] port...\n"
+            "  -b  reconfigure the ports to this baud rate\n"
+            "  -u  ingest with io_uring instead of epoll\n"
+            "  -s  write received data to stdout instead of echoing it\n"
+            "  -w  additionally record received data as pcapng\n"
+            "  -m  additionally publish received data to a shared-memory ring\n"
+            "  -a  additionally archive received data in a time-series store\n",
+            argv0);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pcap_path = NULL;
+    const char *shm_name = NULL;
+    const char *archive_path = NULL;
+    long baud = 0;
+    bool to_stdout = false;
+    bool use_uring = false;
+    serial_epoll_t poller;
+    serial_uring_t engine;
+    uint32_t count;
+    uint64_t next_tick;
+    uint64_t period = 1000000000u / TICKS_PER_SECOND;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "b:usw:m:a:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b': baud = strtol(optarg, NULL, 0); break;
+            case 'u': use_uring = true; break;
+            case 's': to_stdout = true; break;
+            case 'w': pcap_path = optarg; break;
+            case 'm': shm_name = optarg; break;
+            case 'a': archive_path = optarg; break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    count = (uint32_t)(argc - optind);
+    if ((count == 0) || (count > MAX_PORTS))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (serial_epoll_init(&poller) != 0)
+    {
+        perror("epoll_create1");
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const char *path = argv[optind + (int)i];
+        int fd = serial_port_open(path, to_stdout ? O_RDONLY : O_RDWR, baud);
+
+        if (fd < 0)
+        {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        serial_ring_init(&ports[i].port, fd, ports[i].storage, RING_BUFFER_SIZE);
+        ports[i].channel = (uint16_t)i;
+        ports[i].out_fd = to_stdout ? STDOUT_FILENO : fd;
+        port_list[i] = &ports[i].port;
+        if (!use_uring && (serial_epoll_add(&poller, &ports[i].port) != 0))
+        {
+            fprintf(stderr, "%s: %s\n", path, strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (use_uring && (serial_uring_init(&engine, port_list, count) != 0))
+    {
+        perror("io_uring");
+        return EXIT_FAILURE;
+    }
+
+    if (pcap_path != NULL)
+    {
+        if (pcap_writer_open(&capture, pcap_path, PCAP_WRITER_LINKTYPE_USER0, RING_BUFFER_SIZE) != 0)
+        {
+            fprintf(stderr, "%s: %s\n", pcap_path, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        capture_enabled = true;
+    }
+
+    if (shm_name != NULL)
+    {
+        if (shm_ring_create(&shared, shm_name, SHM_SLOTS, SHM_SLOT_SIZE) != 0)
+        {
+            fprintf(stderr, "%s: %s\n", shm_name, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        shared_enabled = true;
+    }
+
+    if (archive_path != NULL)
+    {
+        if (ts_store_open(&archive, archive_path, 0, TS_STORE_WRITE) != 0)
+        {
+            fprintf(stderr, "%s: %s\n", archive_path, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        archive_enabled = true;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    next_tick = now_ns() + period;
+    while (!stop_requested)
+    {
+        uint64_t now = now_ns();
+        uint32_t open_ports = 0;
+
+        if (now < next_tick)
+        {
+            int timeout_ms = (int)((next_tick - now + 999999u) / 1000000u);
+            int result = use_uring ? serial_uring_wait(&engine, timeout_ms)
+                                   : serial_epoll_wait(&poller, port_list, count, timeout_ms);
+            if (result < 0)
+            {
+                perror("wait");
+                break;
+            }
+            continue;
+        }
+
+        next_tick += period;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (ports[i].closed)
+            {
+                continue;
+            }
+            systick(&ports[i]);
+
+            /* A port that hung up is closed once its last bytes are echoed */
+            if (ports[i].port.eof && (ports[i].port.ring.start == serial_ring_position(&ports[i].port)))
+            {
+                fprintf(stderr, "port %u: hung up\n", i);
+                close(ports[i].port.fd);
+                ports[i].closed = true;
+                continue;
+            }
+            open_ports++;
+        }
+        if (open_ports == 0)
+        {
+            break;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        fprintf(stderr, "port %u: %llu bytes in %llu reads\n", i,
+                (unsigned long long)ports[i].port.bytes, (unsigned long long)ports[i].port.reads);
+        if (!ports[i].closed)
+        {
+            close(ports[i].port.fd);
+        }
+    }
+    if (capture_enabled)
+    {
+        pcap_writer_close(&capture);
+    }
+    if (shared_enabled)
+    {
+        shm_ring_close(&shared);
+        shm_ring_unlink(shm_name);
+    }
+    if (archive_enabled)
+    {
+        ts_store_close(&archive);
+    }
+    if (use_uring)
+    {
+        serial_uring_close(&engine);
+    }
+    serial_epoll_close(&poller);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,195 @@
+/******************************************************************************
+ * File Name:   serial_port.c
+ *
+ * Description: Helpers to open serial devices and ptys on the Linux host in
+ *              raw mode, shared by the host tools.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "serial_port.h"
+
+/*******************************************************************************
+ * Function Name: serial_port_speed
+ ********************************************************************************
+ * Summary:
+ * Translate a numeric baud rate into the termios speed constant.
+ *
+ * Parameters:
+ *  long baud: Baud rate in bit/s
+ *
+ * Return:
+ *  speed_t: termios speed or 0 if the rate is not supported
+ *
+ *******************************************************************************/
+speed_t serial_port_speed(long baud)
+{
+    switch (baud)
+    {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        case 3000000: return B3000000;
+        case 4000000: return B4000000;
+        default: return 0;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: serial_port_open
+ ********************************************************************************
+ * Summary:
+ * Open a serial input in non-blocking mode. Terminals are switched to raw
+ * mode and, if a baud rate is given, reconfigured to that rate. Other files
+ * are opened as they are so recordings can be replayed.
+ *
+ * Parameters:
+ *  const char *path: Device, pty or file to open
+ *  int flags: O_RDONLY or O_RDWR
+ *  long baud: Baud rate in bit/s or 0 to keep the current setting
+ *
+ * Return:
+ *  int: File descriptor or -1 with errno set on failure
+ *
+ *******************************************************************************/
+int serial_port_open(const char *path, int flags, long baud)
+{
+    struct termios tio;
+    speed_t speed = serial_port_speed(baud);
+    int fd;
+
+    if ((baud != 0) && (speed == 0))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    fd = open(path, flags | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if ((fd >= 0) && isatty(fd) && (tcgetattr(fd, &tio) == 0))
+    {
+        cfmakeraw(&tio);
+        if (speed != 0)
+        {
+            cfsetspeed(&tio, speed);
+        }
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+/*******************************************************************************
+ * Function Name: serial_port_set_baud
+ ********************************************************************************
+ * Summary:
+ * Change the baud rate of an open terminal after the pending output has been
+ * sent, for a live switch negotiated with the kit.
+ *
+ * Parameters:
+ *  int fd: Terminal file descriptor
+ *  long baud: New baud rate in bit/s
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int serial_port_set_baud(int fd, long baud)
+{
+    struct termios tio;
+    speed_t speed = serial_port_speed(baud);
+
+    if (speed == 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+    if (tcgetattr(fd, &tio) != 0)
+    {
+        return -1;
+    }
+    cfsetspeed(&tio, speed);
+    return tcsetattr(fd, TCSADRAIN, &tio);
+}
+
+/*******************************************************************************
+ * Function Name: serial_port_open_pty
+ ********************************************************************************
+ * Summary:
+ * Create a raw pty pair, used as a local stand-in for a USB-serial adapter.
+ * The master side is returned non-blocking; the slave side is what a device
+ * would write into.
+ *
+ * Parameters:
+ *  int *peer_fd: Receives the slave side of the pair
+ *
+ * Return:
+ *  int: Master file descriptor or -1 with errno set on failure
+ *
+ *******************************************************************************/
+int serial_port_open_pty(int *peer_fd)
+{
+    struct termios tio;
+    int fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if ((grantpt(fd) != 0) || (unlockpt(fd) != 0) ||
+        ((*peer_fd = open(ptsname(fd), O_RDWR | O_NOCTTY | O_CLOEXEC)) < 0))
+    {
+        close(fd);
+        return -1;
+    }
+
+    if (tcgetattr(*peer_fd, &tio) == 0)
+    {
+        cfmakeraw(&tio);
+        tcsetattr(*peer_fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+/* [] END OF FILE */
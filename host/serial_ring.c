@@ -0,0 +1,315 @@
+/******************************************************************************
+ * File Name:   serial_ring.c
+ *
+ * Description: Host backend that fills the ring buffer from a serial fd, and an
+ *              epoll driver that services many such rings from one thread.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "serial_ring.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Number of epoll events fetched per epoll_wait() call */
+#define SERIAL_EPOLL_EVENTS 64
+
+/*******************************************************************************
+ * Function Name: serial_ring_init
+ ********************************************************************************
+ * Summary:
+ * Attach a serial fd to ring storage. The fd must be non-blocking.
+ *
+ * Parameters:
+ *  serial_ring_t *port: Port instance
+ *  int fd: Serial device, pty or file
+ *  volatile uint8_t *storage: Ring storage
+ *  uint32_t size: Size of the ring storage
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void serial_ring_init(serial_ring_t *port, int fd, volatile uint8_t *storage, uint32_t size)
+{
+    ring_buffer_init(&port->ring, storage, size);
+    port->fd = fd;
+    port->position = 0;
+    port->paused = false;
+    port->eof = false;
+    port->bytes = 0;
+    port->reads = 0;
+}
+
+/*******************************************************************************
+ * Function Name: serial_ring_position
+ ********************************************************************************
+ * Summary:
+ * Current write position, the host equivalent of
+ * XMC_DMA_CH_GetTransferredData() in the firmware.
+ *
+ *******************************************************************************/
+uint32_t serial_ring_position(const serial_ring_t *port)
+{
+    return port->position;
+}
+
+/*******************************************************************************
+ * Function Name: serial_ring_space
+ ********************************************************************************
+ * Summary:
+ * Number of bytes that can be written without overtaking the consumer. One
+ * byte is kept free because start == end means empty, as with the DMA.
+ *
+ *******************************************************************************/
+uint32_t serial_ring_space(const serial_ring_t *port)
+{
+    return port->ring.size - 1u - ring_buffer_pending(&port->ring, port->position);
+}
+
+/*******************************************************************************
+ * Function Name: serial_ring_fill
+ ********************************************************************************
+ * Summary:
+ * Read everything the fd has available, up to the free space of the ring, in
+ * a single readv() that covers both sides of the wrap. Unlike the DMA, the
+ * host producer never overwrites unread data; excess bytes stay queued in the
+ * kernel until the consumer catches up.
+ *
+ * Parameters:
+ *  serial_ring_t *port: Port instance
+ *
+ * Return:
+ *  ssize_t: Bytes added to the ring, 0 if the ring is full or nothing was
+ *           available, -1 with errno set on error. port->eof is set when the
+ *           peer has closed.
+ *
+ *******************************************************************************/
+ssize_t serial_ring_fill(serial_ring_t *port)
+{
+    struct iovec iov[2];
+    uint32_t space = serial_ring_space(port);
+    uint32_t tail = port->ring.size - port->position;
+    int iovcnt = 1;
+    ssize_t n;
+
+    if (space == 0)
+    {
+        return 0;
+    }
+
+    iov[0].iov_base = (uint8_t *)&port->ring.buffer[port->position];
+    iov[0].iov_len = (space < tail) ? space : tail;
+    if (space > tail)
+    {
+        iov[1].iov_base = (uint8_t *)&port->ring.buffer[0];
+        iov[1].iov_len = space - tail;
+        iovcnt = 2;
+    }
+
+    do
+    {
+        n = readv(port->fd, iov, iovcnt);
+    } while ((n < 0) && (errno == EINTR));
+
+    if (n < 0)
+    {
+        /* A pty master reports EIO once the last slave fd is closed */
+        if (errno == EIO)
+        {
+            port->eof = true;
+            return 0;
+        }
+        return ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? 0 : -1;
+    }
+
+    if (n == 0)
+    {
+        port->eof = true;
+    }
+
+    port->reads++;
+    port->bytes += (uint64_t)n;
+    port->position = (port->position + (uint32_t)n) % port->ring.size;
+    return n;
+}
+
+/*******************************************************************************
+ * Function Name: serial_epoll_init
+ ********************************************************************************
+ * Summary:
+ * Create the epoll instance that drives a set of serial rings.
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int serial_epoll_init(serial_epoll_t *poller)
+{
+    poller->count = 0;
+    poller->syscalls = 0;
+    poller->epfd = epoll_create1(EPOLL_CLOEXEC);
+    return (poller->epfd < 0) ? -1 : 0;
+}
+
+/*******************************************************************************
+ * Function Name: serial_epoll_add
+ ********************************************************************************
+ * Summary:
+ * Register a serial ring. Level triggering is used so a port whose ring was
+ * full is reported again as soon as it is re-armed.
+ *
+ *******************************************************************************/
+int serial_epoll_add(serial_epoll_t *poller, serial_ring_t *port)
+{
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = port };
+
+    if (epoll_ctl(poller->epfd, EPOLL_CTL_ADD, port->fd, &ev) != 0)
+    {
+        return -1;
+    }
+    poller->count++;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: serial_epoll_remove
+ ********************************************************************************
+ * Summary:
+ * Take a port out of the epoll set. A port cannot stay registered with an
+ * empty event mask: epoll reports EPOLLHUP and EPOLLERR regardless of the
+ * mask, so a hung-up port would wake every epoll_wait() at once.
+ *
+ *******************************************************************************/
+static void serial_epoll_remove(serial_epoll_t *poller, serial_ring_t *port)
+{
+    poller->syscalls++;
+    epoll_ctl(poller->epfd, EPOLL_CTL_DEL, port->fd, NULL);
+    poller->count--;
+}
+
+/*******************************************************************************
+ * Function Name: serial_epoll_wait
+ ********************************************************************************
+ * Summary:
+ * Wait for input on any registered port and move it into the rings. Ports
+ * that were paused on a full ring are re-armed first if the consumer made
+ * room; ports whose ring fills up are paused so a stalled consumer does not
+ * turn the loop into a busy wait. Ports that reach EOF, or hang up with
+ * nothing left to read, are removed for good.
+ *
+ * Parameters:
+ *  serial_epoll_t *poller: epoll instance
+ *  serial_ring_t *const *ports: All registered ports, used for re-arming
+ *  uint32_t count: Number of entries in ports
+ *  int timeout_ms: Maximum time to wait, -1 to wait forever
+ *
+ * Return:
+ *  int: Number of ports that received data, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int serial_epoll_wait(serial_epoll_t *poller, serial_ring_t *const *ports, uint32_t count, int timeout_ms)
+{
+    struct epoll_event events[SERIAL_EPOLL_EVENTS];
+    int filled = 0;
+    int ready;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (ports[i]->paused && !ports[i]->eof && (serial_ring_space(ports[i]) != 0))
+        {
+            poller->syscalls++;
+            if (serial_epoll_add(poller, ports[i]) != 0)
+            {
+                return -1;
+            }
+            ports[i]->paused = false;
+        }
+    }
+
+    ready = epoll_wait(poller->epfd, events, SERIAL_EPOLL_EVENTS, timeout_ms);
+    poller->syscalls++;
+    if (ready < 0)
+    {
+        return (errno == EINTR) ? 0 : -1;
+    }
+
+    for (int i = 0; i < ready; ++i)
+    {
+        serial_ring_t *port = events[i].data.ptr;
+        bool hangup = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+        ssize_t n = serial_ring_fill(port);
+
+        poller->syscalls++;
+        if ((n < 0) && !hangup)
+        {
+            return -1;
+        }
+        if (n > 0)
+        {
+            ++filled;
+        }
+
+        /* Hung up and drained: the fd will never become readable again */
+        if (hangup && (n <= 0) && (serial_ring_space(port) != 0))
+        {
+            port->eof = true;
+        }
+
+        if (port->eof)
+        {
+            serial_epoll_remove(poller, port);
+        }
+        else if (serial_ring_space(port) == 0)
+        {
+            serial_epoll_remove(poller, port);
+            port->paused = true;
+        }
+    }
+    return filled;
+}
+
+void serial_epoll_close(serial_epoll_t *poller)
+{
+    close(poller->epfd);
+    poller->epfd = -1;
+    poller->count = 0;
+}
+
+/* [] END OF FILE */
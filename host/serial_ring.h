@@ -0,0 +1,87 @@
+/******************************************************************************
+ * File Name:   serial_ring.h
+ *
+ * Description: Host backend that fills the ring buffer from a serial fd the way
+ *              GPDMA fills it from USIC RBUF on the XMC. The consumer keeps
+ *              using ring_buffer_consume() with serial_ring_position() in place
+ *              of XMC_DMA_CH_GetTransferredData().
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef SERIAL_RING_H
+#define SERIAL_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "ring_buffer.h"
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    int fd;
+    ring_buffer_t ring;     /* Consumer state, identical to the firmware */
+    uint32_t position;      /* Producer write position */
+    bool paused;            /* Removed from the epoll set while the ring is full */
+    bool eof;
+    uint64_t bytes;
+    uint64_t reads;
+} serial_ring_t;
+
+typedef struct
+{
+    int epfd;
+    uint32_t count;
+    uint64_t syscalls;      /* epoll_wait, epoll_ctl and readv calls issued */
+} serial_epoll_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void serial_ring_init(serial_ring_t *port, int fd, volatile uint8_t *storage, uint32_t size);
+uint32_t serial_ring_position(const serial_ring_t *port);
+uint32_t serial_ring_space(const serial_ring_t *port);
+ssize_t serial_ring_fill(serial_ring_t *port);
+
+int serial_epoll_init(serial_epoll_t *poller);
+int serial_epoll_add(serial_epoll_t *poller, serial_ring_t *port);
+int serial_epoll_wait(serial_epoll_t *poller, serial_ring_t *const *ports, uint32_t count, int timeout_ms);
+void serial_epoll_close(serial_epoll_t *poller);
+
+#endif /* SERIAL_RING_H */
+
+/* [] END OF FILE */
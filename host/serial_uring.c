@@ -0,0 +1,327 @@
+/******************************************************************************
+ * File Name:   serial_uring.c
+ *
+ * Description: io_uring ingestion engine for the Linux gateway. Uses the raw
+ *              system call interface so the host tools do not need liburing.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "serial_uring.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/*******************************************************************************
+ * Function Name: uring_enter
+ ********************************************************************************
+ * Summary:
+ * Submit queued reads and optionally wait for at least one completion, with
+ * a timeout passed through IORING_ENTER_EXT_ARG.
+ *
+ *******************************************************************************/
+static int uring_enter(serial_uring_t *engine, uint32_t min_complete, int timeout_ms)
+{
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    uint32_t flags = 0;
+    void *argp = NULL;
+    size_t argsz = 0;
+    int result;
+
+    if (min_complete != 0)
+    {
+        flags |= IORING_ENTER_GETEVENTS;
+        if (timeout_ms >= 0)
+        {
+            ts.tv_sec = timeout_ms / 1000;
+            ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+            memset(&arg, 0, sizeof(arg));
+            arg.ts = (uint64_t)(uintptr_t)&ts;
+            flags |= IORING_ENTER_EXT_ARG;
+            argp = &arg;
+            argsz = sizeof(arg);
+        }
+    }
+
+    result = (int)syscall(__NR_io_uring_enter, engine->fd, engine->queued, min_complete, flags, argp, argsz);
+    engine->enters++;
+    if (result >= 0)
+    {
+        engine->queued -= (uint32_t)result;
+        return 0;
+    }
+    /* ETIME only reports that the wait timed out */
+    return ((errno == ETIME) || (errno == EINTR)) ? 0 : -1;
+}
+
+/*******************************************************************************
+ * Function Name: queue_read
+ ********************************************************************************
+ * Summary:
+ * Queue a fixed-buffer read into the contiguous free part of a port's ring,
+ * starting at its write position and ending at the wrap point or one byte
+ * before the consumer, whichever comes first.
+ *
+ *******************************************************************************/
+static void queue_read(serial_uring_t *engine, uint32_t index)
+{
+    serial_ring_t *port = engine->ports[index];
+    uint32_t space = serial_ring_space(port);
+    uint32_t tail = port->ring.size - port->position;
+    uint32_t sq_tail = *engine->sq_tail;
+    uint32_t slot = sq_tail & *engine->sq_mask;
+    struct io_uring_sqe *sqe = &engine->sqes[slot];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->fd = port->fd;
+    sqe->off = (uint64_t)-1;
+    sqe->addr = (uint64_t)(uintptr_t)&port->ring.buffer[port->position];
+    sqe->len = (space < tail) ? space : tail;
+    sqe->buf_index = (uint16_t)index;
+    sqe->user_data = index;
+
+    engine->sq_array[slot] = slot;
+    STORE_RELEASE(engine->sq_tail, sq_tail + 1u);
+    engine->queued++;
+    engine->inflight[index] = true;
+}
+
+/*******************************************************************************
+ * Function Name: serial_uring_init
+ ********************************************************************************
+ * Summary:
+ * Create the io_uring instance and register the storage of every ring as a
+ * fixed buffer. The port fds are switched to blocking mode, io_uring then
+ * waits for tty input through its internal poll instead of returning EAGAIN.
+ *
+ * Parameters:
+ *  serial_uring_t *engine: Engine instance
+ *  serial_ring_t *const *ports: Ports to service, initialized with
+ *                               serial_ring_init()
+ *  uint32_t count: Number of ports, up to SERIAL_URING_MAX_PORTS
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int serial_uring_init(serial_uring_t *engine, serial_ring_t *const *ports, uint32_t count)
+{
+    struct io_uring_params params;
+    struct iovec iov[SERIAL_URING_MAX_PORTS];
+    uint8_t *sq;
+    uint8_t *cq;
+
+    if ((count == 0) || (count > SERIAL_URING_MAX_PORTS))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(engine, 0, sizeof(*engine));
+    memset(&params, 0, sizeof(params));
+    engine->fd = (int)syscall(__NR_io_uring_setup, count, &params);
+    if (engine->fd < 0)
+    {
+        return -1;
+    }
+
+    engine->sq_map_len = params.sq_off.array + (params.sq_entries * sizeof(uint32_t));
+    engine->cq_map_len = params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+    engine->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    engine->sq_map = mmap(NULL, engine->sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          engine->fd, IORING_OFF_SQ_RING);
+    engine->cq_map = mmap(NULL, engine->cq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          engine->fd, IORING_OFF_CQ_RING);
+    engine->sqes = mmap(NULL, engine->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        engine->fd, IORING_OFF_SQES);
+    if ((engine->sq_map == MAP_FAILED) || (engine->cq_map == MAP_FAILED) || (engine->sqes == MAP_FAILED))
+    {
+        serial_uring_close(engine);
+        return -1;
+    }
+
+    sq = engine->sq_map;
+    cq = engine->cq_map;
+    engine->sq_head = (uint32_t *)(sq + params.sq_off.head);
+    engine->sq_tail = (uint32_t *)(sq + params.sq_off.tail);
+    engine->sq_mask = (uint32_t *)(sq + params.sq_off.ring_mask);
+    engine->sq_array = (uint32_t *)(sq + params.sq_off.array);
+    engine->cq_head = (uint32_t *)(cq + params.cq_off.head);
+    engine->cq_tail = (uint32_t *)(cq + params.cq_off.tail);
+    engine->cq_mask = (uint32_t *)(cq + params.cq_off.ring_mask);
+    engine->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        int flags = fcntl(ports[i]->fd, F_GETFL);
+        if ((flags < 0) || (fcntl(ports[i]->fd, F_SETFL, flags & ~O_NONBLOCK) != 0))
+        {
+            serial_uring_close(engine);
+            return -1;
+        }
+        iov[i].iov_base = (void *)ports[i]->ring.buffer;
+        iov[i].iov_len = ports[i]->ring.size;
+    }
+
+    if (syscall(__NR_io_uring_register, engine->fd, IORING_REGISTER_BUFFERS, iov, count) != 0)
+    {
+        serial_uring_close(engine);
+        return -1;
+    }
+
+    engine->ports = ports;
+    engine->count = count;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: serial_uring_wait
+ ********************************************************************************
+ * Summary:
+ * Keep a read in flight for every port that has room in its ring, wait for
+ * completions and advance the write positions. Submission and waiting share
+ * a single io_uring_enter() call, independent of the number of ports.
+ *
+ * Parameters:
+ *  serial_uring_t *engine: Engine instance
+ *  int timeout_ms: Maximum time to wait, -1 to wait forever, 0 to only reap
+ *
+ * Return:
+ *  int: Number of completions that added data, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int serial_uring_wait(serial_uring_t *engine, int timeout_ms)
+{
+    uint32_t head;
+    uint32_t tail;
+    int filled = 0;
+
+    for (uint32_t i = 0; i < engine->count; ++i)
+    {
+        serial_ring_t *port = engine->ports[i];
+        if (!engine->inflight[i] && !port->eof && (serial_ring_space(port) != 0))
+        {
+            queue_read(engine, i);
+        }
+    }
+
+    head = *engine->cq_head;
+    if ((head == LOAD_ACQUIRE(engine->cq_tail)) || (engine->queued != 0))
+    {
+        if (uring_enter(engine, (timeout_ms == 0) ? 0u : 1u, timeout_ms) != 0)
+        {
+            return -1;
+        }
+    }
+
+    tail = LOAD_ACQUIRE(engine->cq_tail);
+    for (; head != tail; ++head)
+    {
+        struct io_uring_cqe *cqe = &engine->cqes[head & *engine->cq_mask];
+        uint32_t index = (uint32_t)cqe->user_data;
+        serial_ring_t *port = engine->ports[index];
+
+        engine->inflight[index] = false;
+        engine->completions++;
+        if (cqe->res > 0)
+        {
+            port->reads++;
+            port->bytes += (uint64_t)cqe->res;
+            port->position = (port->position + (uint32_t)cqe->res) % port->ring.size;
+            ++filled;
+        }
+        else if ((cqe->res == 0) || (cqe->res == -EIO))
+        {
+            /* End of file, or a pty whose slave side was closed */
+            port->eof = true;
+        }
+        else if ((cqe->res != -EAGAIN) && (cqe->res != -EINTR) && (cqe->res != -ECANCELED))
+        {
+            STORE_RELEASE(engine->cq_head, head + 1u);
+            errno = -cqe->res;
+            return -1;
+        }
+    }
+    STORE_RELEASE(engine->cq_head, head);
+
+    return filled;
+}
+
+/*******************************************************************************
+ * Function Name: serial_uring_close
+ ********************************************************************************
+ * Summary:
+ * Tear down the io_uring instance. Closing the ring cancels reads that are
+ * still in flight.
+ *
+ *******************************************************************************/
+void serial_uring_close(serial_uring_t *engine)
+{
+    if ((engine->sqes != NULL) && (engine->sqes != MAP_FAILED))
+    {
+        munmap(engine->sqes, engine->sqes_len);
+    }
+    if ((engine->cq_map != NULL) && (engine->cq_map != MAP_FAILED))
+    {
+        munmap(engine->cq_map, engine->cq_map_len);
+    }
+    if ((engine->sq_map != NULL) && (engine->sq_map != MAP_FAILED))
+    {
+        munmap(engine->sq_map, engine->sq_map_len);
+    }
+    if (engine->fd >= 0)
+    {
+        close(engine->fd);
+    }
+    engine->fd = -1;
+    engine->sqes = NULL;
+    engine->cq_map = NULL;
+    engine->sq_map = NULL;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,99 @@
+/******************************************************************************
+ * File Name:   serial_uring.h
+ *
+ * Description: io_uring ingestion engine for the Linux gateway. Every port keeps
+ *              one fixed-buffer read in flight that targets the free part of its
+ *              ring directly, so received bytes land where the consumer reads
+ *              them, just like GPDMA writes straight into the firmware's ring.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef SERIAL_URING_H
+#define SERIAL_URING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "serial_ring.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Maximum number of ports serviced by one engine */
+#define SERIAL_URING_MAX_PORTS 256
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    int fd;
+    /* Submission queue */
+    uint32_t *sq_head;
+    uint32_t *sq_tail;
+    uint32_t *sq_mask;
+    uint32_t *sq_array;
+    struct io_uring_sqe *sqes;
+    /* Completion queue */
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    uint32_t *cq_mask;
+    struct io_uring_cqe *cqes;
+    /* Mappings */
+    void *sq_map;
+    size_t sq_map_len;
+    void *cq_map;
+    size_t cq_map_len;
+    size_t sqes_len;
+    /* Ports */
+    serial_ring_t *const *ports;
+    uint32_t count;
+    uint32_t queued;
+    bool inflight[SERIAL_URING_MAX_PORTS];
+    /* Statistics */
+    uint64_t enters;
+    uint64_t completions;
+} serial_uring_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+int serial_uring_init(serial_uring_t *engine, serial_ring_t *const *ports, uint32_t count);
+int serial_uring_wait(serial_uring_t *engine, int timeout_ms);
+void serial_uring_close(serial_uring_t *engine);
+
+#endif /* SERIAL_URING_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,325 @@
+/******************************************************************************
+ * File Name:   shard_executor.c
+ *
+ * Description: Thread-per-core executor for the gateway. A ring is only ever
+ *              consumed by one thread at a time: its busy flag is taken for every
+ *              consume pass and for every migration between shards.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "shard_executor.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Consecutive idle passes before a shard yields its core */
+#define SHARD_IDLE_SPINS 64
+
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static inline bool try_lock(shard_task_t *task)
+{
+    uint32_t expected = 0;
+    return __atomic_compare_exchange_n(&task->busy, &expected, 1u, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static inline void unlock(shard_task_t *task)
+{
+    STORE_RELEASE(&task->busy, 0u);
+}
+
+/*******************************************************************************
+ * Function Name: shard_task_init
+ ********************************************************************************
+ * Summary:
+ * Describe one ring: its storage, how to read the producer position and what
+ * to do with the received bytes.
+ *
+ * Parameters:
+ *  shard_task_t *task: Task instance
+ *  volatile uint8_t *storage: Ring storage written by the producer
+ *  uint32_t size: Size of the ring storage
+ *  shard_position_t position: Returns the producer write position
+ *  ring_buffer_handler_t handler: Consumer, called per linear segment
+ *  void *context: Passed to position and handler
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void shard_task_init(shard_task_t *task, volatile uint8_t *storage, uint32_t size,
+                     shard_position_t position, ring_buffer_handler_t handler, void *context)
+{
+    memset(task, 0, sizeof(*task));
+    ring_buffer_init(&task->ring, storage, size);
+    task->position = position;
+    task->handler = handler;
+    task->context = context;
+}
+
+/*******************************************************************************
+ * Function Name: consume
+ ********************************************************************************
+ * Summary:
+ * Run the consume step of SysTick_Handler on one ring if this shard still
+ * owns it and nobody is migrating it right now.
+ *
+ *******************************************************************************/
+static uint32_t consume(shard_t *shard, shard_task_t *task)
+{
+    uint32_t count = 0;
+
+    if (try_lock(task))
+    {
+        if (__atomic_load_n(&task->owner, __ATOMIC_RELAXED) == shard->index)
+        {
+            uint32_t end = task->position(task->context);
+            count = ring_buffer_consume(&task->ring, end, task->handler, task->context);
+            task->consumed += count;
+        }
+        unlock(task);
+    }
+    return count;
+}
+
+/*******************************************************************************
+ * Function Name: steal
+ ********************************************************************************
+ * Summary:
+ * Take over the ring with the largest backlog that is owned by a shard with
+ * more than one ring. Shards that own a single ring are never robbed; moving
+ * their only ring would just move the bottleneck.
+ *
+ *******************************************************************************/
+static bool steal(shard_t *shard)
+{
+    shard_executor_t *executor = shard->executor;
+    uint32_t owned[SHARD_MAX] = { 0 };
+    shard_task_t *best = NULL;
+    uint32_t best_backlog = executor->steal_threshold;
+
+    for (uint32_t i = 0; i < executor->task_count; ++i)
+    {
+        owned[__atomic_load_n(&executor->tasks[i].owner, __ATOMIC_RELAXED)]++;
+    }
+
+    for (uint32_t i = 0; i < executor->task_count; ++i)
+    {
+        shard_task_t *task = &executor->tasks[i];
+        uint32_t owner = __atomic_load_n(&task->owner, __ATOMIC_RELAXED);
+
+        /* consume() advances the read position under the task lock, so it is read under the lock
+         * too; a ring whose lock is taken is being serviced right now and is skipped */
+        if ((owner != shard->index) && (owned[owner] > 1u) && try_lock(task))
+        {
+            uint32_t backlog = ring_buffer_pending(&task->ring, task->position(task->context));
+
+            unlock(task);
+            if (backlog > best_backlog)
+            {
+                best = task;
+                best_backlog = backlog;
+            }
+        }
+    }
+
+    if ((best != NULL) && try_lock(best))
+    {
+        __atomic_store_n(&best->owner, shard->index, __ATOMIC_RELAXED);
+        best->migrations++;
+        unlock(best);
+        shard->steals++;
+        return true;
+    }
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: shard_main
+ ********************************************************************************
+ * Summary:
+ * Worker loop: one pass over the owned rings corresponds to one SysTick of
+ * the firmware. A pass that found no data tries to steal; repeated idle
+ * passes yield the core.
+ *
+ *******************************************************************************/
+static void *shard_main(void *arg)
+{
+    shard_t *shard = arg;
+    shard_executor_t *executor = shard->executor;
+    uint32_t idle = 0;
+
+    while (!LOAD_ACQUIRE(&executor->stop))
+    {
+        uint64_t bytes = 0;
+
+        for (uint32_t i = 0; i < executor->task_count; ++i)
+        {
+            if (__atomic_load_n(&executor->tasks[i].owner, __ATOMIC_RELAXED) == shard->index)
+            {
+                bytes += consume(shard, &executor->tasks[i]);
+            }
+        }
+
+        shard->passes++;
+        shard->bytes += bytes;
+        if (bytes == 0)
+        {
+            shard->idle_passes++;
+            if (!steal(shard) && (++idle >= SHARD_IDLE_SPINS))
+            {
+                sched_yield();
+                idle = 0;
+            }
+        }
+        else
+        {
+            idle = 0;
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: shard_executor_start
+ ********************************************************************************
+ * Summary:
+ * Assign the rings round robin to the shards and start one worker per shard.
+ * With pinning enabled, shard n runs on the n-th CPU of the process's
+ * affinity mask.
+ *
+ * Parameters:
+ *  shard_executor_t *executor: Executor instance
+ *  shard_task_t *tasks: Rings, initialized with shard_task_init()
+ *  uint32_t task_count: Number of rings
+ *  uint32_t shard_count: Number of worker threads, up to SHARD_MAX
+ *  bool pin: Pin every worker to its own core
+ *
+ * Return:
+ *  int: 0 on success, error number on failure
+ *
+ *******************************************************************************/
+int shard_executor_start(shard_executor_t *executor, shard_task_t *tasks, uint32_t task_count,
+                         uint32_t shard_count, bool pin)
+{
+    cpu_set_t allowed;
+    int cpu = -1;
+
+    if ((shard_count == 0) || (shard_count > SHARD_MAX) || (task_count == 0))
+    {
+        return EINVAL;
+    }
+
+    executor->tasks = tasks;
+    executor->task_count = task_count;
+    executor->shard_count = shard_count;
+    executor->steal_threshold = SHARD_STEAL_THRESHOLD;
+    executor->stop = 0;
+
+    for (uint32_t i = 0; i < task_count; ++i)
+    {
+        tasks[i].owner = i % shard_count;
+    }
+
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+
+    for (uint32_t s = 0; s < shard_count; ++s)
+    {
+        shard_t *shard = &executor->shards[s];
+        pthread_attr_t attr;
+        int result;
+
+        memset(shard, 0, sizeof(*shard));
+        shard->executor = executor;
+        shard->index = s;
+        shard->cpu = -1;
+
+        pthread_attr_init(&attr);
+        if (pin)
+        {
+            /* Next CPU in the affinity mask, wrapping if there are fewer cores than shards */
+            for (int n = 0; n < CPU_SETSIZE; ++n)
+            {
+                cpu = (cpu + 1) % CPU_SETSIZE;
+                if (CPU_ISSET(cpu, &allowed))
+                {
+                    break;
+                }
+            }
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpu, &set);
+                pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+                shard->cpu = cpu;
+            }
+        }
+
+        result = pthread_create(&shard->thread, &attr, shard_main, shard);
+        pthread_attr_destroy(&attr);
+        if (result != 0)
+        {
+            executor->shard_count = s;
+            shard_executor_stop(executor);
+            return result;
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: shard_executor_stop
+ ********************************************************************************
+ * Summary:
+ * Ask all workers to finish their current pass and wait for them.
+ *
+ *******************************************************************************/
+void shard_executor_stop(shard_executor_t *executor)
+{
+    STORE_RELEASE(&executor->stop, 1u);
+    for (uint32_t s = 0; s < executor->shard_count; ++s)
+    {
+        pthread_join(executor->shards[s].thread, NULL);
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,115 @@
+/******************************************************************************
+ * File Name:   shard_executor.h
+ *
+ * Description: Thread-per-core executor for the gateway. Rings are distributed
+ *              over shards, each shard is a worker thread pinned to one core that
+ *              runs the firmware's consume step on the rings it owns. Idle shards
+ *              steal the ring with the largest backlog from a busier shard.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef SHARD_EXECUTOR_H
+#define SHARD_EXECUTOR_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ring_buffer.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define SHARD_CACHE_LINE 64
+
+/* Maximum number of worker threads */
+#define SHARD_MAX 64
+
+/* Default backlog in bytes a ring must have before it is worth stealing */
+#define SHARD_STEAL_THRESHOLD 512
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+/* Producer write position, XMC_DMA_CH_GetTransferredData() on the target */
+typedef uint32_t (*shard_position_t)(void *context);
+
+typedef struct
+{
+    _Alignas(SHARD_CACHE_LINE) ring_buffer_t ring;
+    shard_position_t position;
+    ring_buffer_handler_t handler;
+    void *context;
+    uint32_t owner;         /* Shard that consumes this ring */
+    uint32_t busy;          /* Held while consuming or migrating */
+    uint64_t consumed;
+    uint32_t migrations;
+} shard_task_t;
+
+struct shard_executor;
+
+typedef struct
+{
+    _Alignas(SHARD_CACHE_LINE) pthread_t thread;
+    struct shard_executor *executor;
+    uint32_t index;
+    int cpu;
+    uint64_t passes;
+    uint64_t idle_passes;
+    uint64_t bytes;
+    uint64_t steals;
+} shard_t;
+
+typedef struct shard_executor
+{
+    shard_task_t *tasks;
+    uint32_t task_count;
+    uint32_t shard_count;
+    uint32_t steal_threshold;
+    uint32_t stop;
+    shard_t shards[SHARD_MAX];
+} shard_executor_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void shard_task_init(shard_task_t *task, volatile uint8_t *storage, uint32_t size,
+                     shard_position_t position, ring_buffer_handler_t handler, void *context);
+int shard_executor_start(shard_executor_t *executor, shard_task_t *tasks, uint32_t task_count,
+                         uint32_t shard_count, bool pin);
+void shard_executor_stop(shard_executor_t *executor);
+
+#endif /* SHARD_EXECUTOR_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,414 @@
+/******************************************************************************
+ * File Name:   shm_ring.c
+ *
+ * Description: Lossy single-producer, multi-consumer message ring in POSIX shared
+ *              memory. Every slot carries a sequence number that works as a
+ *              seqlock, so readers detect a slot overwritten under them without
+ *              the writer ever looking at the readers.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <linux/futex.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "shm_ring.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define SHM_RING_MAGIC 0x52494E47u /* "RING" */
+
+/* Spins before a reader waits for a slot the writer is filling right now */
+#define SHM_RING_SPIN_LIMIT 1000
+
+#define LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint64_t seq;           /* 2n+1 while message n is written, 2n+2 once complete */
+    uint32_t tag;
+    uint32_t len;
+    uint8_t data[];
+} shm_slot_t;
+
+static inline shm_slot_t *slot_at(const shm_ring_t *ring, uint64_t n)
+{
+    return (shm_slot_t *)&ring->slots[(n % ring->header->slot_count) * ring->header->slot_size];
+}
+
+static long futex(uint32_t *addr, int op, uint32_t value, const struct timespec *timeout)
+{
+    return syscall(SYS_futex, addr, op, value, timeout, NULL, 0);
+}
+
+/*******************************************************************************
+ * Function Name: map_ring
+ ********************************************************************************
+ * Summary:
+ * Map an opened shared memory object and set up the slot pointer.
+ *
+ *******************************************************************************/
+static int map_ring(shm_ring_t *ring, int fd, size_t len)
+{
+    void *map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return -1;
+    }
+    ring->header = map;
+    ring->slots = (uint8_t *)map + sizeof(shm_ring_header_t);
+    ring->map_len = len;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: shm_ring_create
+ ********************************************************************************
+ * Summary:
+ * Create (or replace) the shared memory object and initialize it for the
+ * writer. The slot size includes a 16 byte slot header and is rounded up to
+ * whole cache lines.
+ *
+ * Parameters:
+ *  shm_ring_t *ring: Ring instance
+ *  const char *name: POSIX shared memory name, e.g. "/uart0"
+ *  uint32_t slot_count: Number of messages kept in the ring
+ *  uint32_t slot_size: Bytes per slot, the largest message is 16 bytes less
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int shm_ring_create(shm_ring_t *ring, const char *name, uint32_t slot_count, uint32_t slot_size)
+{
+    size_t len;
+    int fd;
+
+    slot_size = (slot_size + SHM_RING_CACHE_LINE - 1u) & ~(uint32_t)(SHM_RING_CACHE_LINE - 1u);
+    if ((slot_count == 0) || (slot_size <= sizeof(shm_slot_t)))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    len = sizeof(shm_ring_header_t) + ((size_t)slot_count * slot_size);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if ((ftruncate(fd, (off_t)len) != 0) || (map_ring(ring, fd, len) != 0))
+    {
+        close(fd);
+        return -1;
+    }
+
+    ring->header->slot_count = slot_count;
+    ring->header->slot_size = slot_size;
+    ring->head = 0;
+    STORE_RELEASE(&ring->header->magic, SHM_RING_MAGIC);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: shm_ring_open
+ ********************************************************************************
+ * Summary:
+ * Map an existing ring for reading.
+ *
+ * Parameters:
+ *  shm_ring_t *ring: Ring instance
+ *  const char *name: POSIX shared memory name used by the writer
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int shm_ring_open(shm_ring_t *ring, const char *name)
+{
+    struct stat st;
+    int fd = shm_open(name, O_RDWR | O_CLOEXEC, 0);
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(shm_ring_header_t)))
+    {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    if (map_ring(ring, fd, (size_t)st.st_size) != 0)
+    {
+        return -1;
+    }
+    if (LOAD_ACQUIRE(&ring->header->magic) != SHM_RING_MAGIC)
+    {
+        shm_ring_close(ring);
+        errno = EINVAL;
+        return -1;
+    }
+    ring->head = LOAD_ACQUIRE(&ring->header->head);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: shm_ring_publish
+ ********************************************************************************
+ * Summary:
+ * Append one message. Never blocks: the oldest slot is overwritten no matter
+ * where the readers are. The futex is only woken when a reader is sleeping,
+ * so the uncontended cost is a copy and a few stores.
+ *
+ * Parameters:
+ *  shm_ring_t *ring: Ring instance opened with shm_ring_create()
+ *  uint32_t tag: Caller defined value, e.g. the channel id
+ *  const void *data: Message payload
+ *  uint32_t len: Payload length, at most slot_size - 16
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set to EMSGSIZE if the message is too big
+ *
+ *******************************************************************************/
+int shm_ring_publish(shm_ring_t *ring, uint32_t tag, const void *data, uint32_t len)
+{
+    uint64_t n = ring->head;
+    shm_slot_t *slot = slot_at(ring, n);
+
+    if (len > (ring->header->slot_size - sizeof(shm_slot_t)))
+    {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    __atomic_store_n(&slot->seq, (2u * n) + 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->tag = tag;
+    slot->len = len;
+    memcpy(slot->data, data, len);
+    STORE_RELEASE(&slot->seq, (2u * n) + 2u);
+
+    ring->head = n + 1u;
+    STORE_RELEASE(&ring->header->head, ring->head);
+
+    __atomic_fetch_add(&ring->header->wake, 1u, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->header->waiters, __ATOMIC_SEQ_CST) != 0)
+    {
+        futex(&ring->header->wake, FUTEX_WAKE, INT_MAX, NULL);
+    }
+    return 0;
+}
+
+void shm_ring_close(shm_ring_t *ring)
+{
+    munmap(ring->header, ring->map_len);
+    ring->header = NULL;
+    ring->slots = NULL;
+}
+
+int shm_ring_unlink(const char *name)
+{
+    return shm_unlink(name);
+}
+
+/*******************************************************************************
+ * Function Name: shm_reader_attach
+ ********************************************************************************
+ * Summary:
+ * Claim a reader slot in the shared header. The reader starts at the current
+ * head, so it sees messages published from now on.
+ *
+ * Parameters:
+ *  shm_reader_t *reader: Reader instance
+ *  shm_ring_t *ring: Ring opened with shm_ring_open() or shm_ring_create()
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set to EBUSY if all slots are taken
+ *
+ *******************************************************************************/
+int shm_reader_attach(shm_reader_t *reader, shm_ring_t *ring)
+{
+    for (uint32_t i = 0; i < SHM_RING_MAX_READERS; ++i)
+    {
+        uint32_t expected = 0;
+        if (__atomic_compare_exchange_n(&ring->header->readers[i].active, &expected, 1u, false,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            reader->ring = ring;
+            reader->index = i;
+            reader->tail = LOAD_ACQUIRE(&ring->header->head);
+            reader->overruns = 0;
+            ring->header->readers[i].pid = (int32_t)getpid();
+            __atomic_store_n(&ring->header->readers[i].overruns, 0u, __ATOMIC_RELAXED);
+            __atomic_store_n(&ring->header->readers[i].tail, reader->tail, __ATOMIC_RELAXED);
+            return 0;
+        }
+    }
+    errno = EBUSY;
+    return -1;
+}
+
+/*******************************************************************************
+ * Function Name: wait_for_data
+ ********************************************************************************
+ * Summary:
+ * Sleep until the writer publishes past tail. The waiter count is raised
+ * before the head is checked and the writer bumps the futex word before it
+ * reads the count, so a publish can not slip in between unnoticed.
+ *
+ *******************************************************************************/
+static int wait_for_data(shm_reader_t *reader, int timeout_ms)
+{
+    shm_ring_header_t *header = reader->ring->header;
+    struct timespec ts = { timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000L };
+    uint32_t wake;
+    int result = 0;
+
+    __atomic_fetch_add(&header->waiters, 1u, __ATOMIC_SEQ_CST);
+    wake = __atomic_load_n(&header->wake, __ATOMIC_SEQ_CST);
+    if (LOAD_ACQUIRE(&header->head) == reader->tail)
+    {
+        if ((futex(&header->wake, FUTEX_WAIT, wake, (timeout_ms < 0) ? NULL : &ts) != 0) &&
+            (errno == ETIMEDOUT))
+        {
+            result = -1;
+        }
+    }
+    __atomic_fetch_sub(&header->waiters, 1u, __ATOMIC_SEQ_CST);
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: shm_reader_read
+ ********************************************************************************
+ * Summary:
+ * Copy the next message out of the ring. The slot sequence is checked before
+ * and after the copy; if the writer lapped the reader the copy is discarded
+ * and the reader resumes at the oldest message that is still intact.
+ *
+ * Parameters:
+ *  shm_reader_t *reader: Reader instance
+ *  uint32_t *tag: Receives the tag of the message, may be NULL
+ *  void *buffer: Destination for the payload
+ *  uint32_t capacity: Size of buffer, longer messages are truncated
+ *  int timeout_ms: Maximum time to wait, -1 to wait forever, 0 to poll
+ *
+ * Return:
+ *  ssize_t: Message length, or -1 with errno set to EAGAIN on timeout
+ *
+ *******************************************************************************/
+ssize_t shm_reader_read(shm_reader_t *reader, uint32_t *tag, void *buffer, uint32_t capacity, int timeout_ms)
+{
+    shm_ring_t *ring = reader->ring;
+    uint32_t spins = 0;
+
+    for (;;)
+    {
+        shm_slot_t *slot = slot_at(ring, reader->tail);
+        uint64_t expected = (2u * reader->tail) + 2u;
+        uint64_t seq = LOAD_ACQUIRE(&slot->seq);
+
+        if (seq == expected)
+        {
+            uint32_t len = slot->len;
+            uint32_t msg_tag = slot->tag;
+            uint32_t copy = (len < capacity) ? len : capacity;
+
+            memcpy(buffer, slot->data, copy);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq)
+            {
+                if (tag != NULL)
+                {
+                    *tag = msg_tag;
+                }
+                reader->tail++;
+                __atomic_store_n(&ring->header->readers[reader->index].tail, reader->tail, __ATOMIC_RELAXED);
+                return (ssize_t)len;
+            }
+        }
+        else if (seq < expected)
+        {
+            /* Either nothing new, or the writer is filling this very slot */
+            if ((seq == (expected - 1u)) && (++spins < SHM_RING_SPIN_LIMIT))
+            {
+                continue;
+            }
+            spins = 0;
+            if ((timeout_ms == 0) || (wait_for_data(reader, timeout_ms) != 0))
+            {
+                errno = EAGAIN;
+                return -1;
+            }
+            continue;
+        }
+
+        /* Lapped by the writer: skip to the oldest slot that is still intact */
+        {
+            uint64_t head = LOAD_ACQUIRE(&ring->header->head);
+            uint64_t oldest = (head > ring->header->slot_count) ? (head - ring->header->slot_count + 1u) : 0u;
+            if (oldest > reader->tail)
+            {
+                reader->overruns += oldest - reader->tail;
+                reader->tail = oldest;
+                __atomic_store_n(&ring->header->readers[reader->index].overruns, reader->overruns,
+                                 __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+void shm_reader_detach(shm_reader_t *reader)
+{
+    STORE_RELEASE(&reader->ring->header->readers[reader->index].active, 0u);
+    reader->ring = NULL;
+}
+
+/* [] END OF FILE */
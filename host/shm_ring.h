@@ -0,0 +1,111 @@
+/******************************************************************************
+ * File Name:   shm_ring.h
+ *
+ * Description: Lossy single-producer, multi-consumer message ring in POSIX shared
+ *              memory. Like the DMA filling the firmware's ring, the writer never
+ *              waits for readers; a reader that falls behind by more than the
+ *              ring size skips ahead and counts the overrun. Idle readers sleep
+ *              on a futex that the writer only touches while someone waits.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define SHM_RING_CACHE_LINE 64
+
+/* Maximum number of concurrently attached readers */
+#define SHM_RING_MAX_READERS 16
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+/* Shared layout; every field written by a different party has its own line */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t slot_count;
+    uint32_t slot_size;
+    uint32_t reserved;
+    _Alignas(SHM_RING_CACHE_LINE) uint64_t head;    /* Messages published, writer only */
+    _Alignas(SHM_RING_CACHE_LINE) uint32_t wake;    /* Futex word, bumped per publish */
+    uint32_t waiters;                               /* Readers sleeping on wake */
+    struct
+    {
+        _Alignas(SHM_RING_CACHE_LINE) uint64_t tail; /* Next message to read */
+        uint64_t overruns;                          /* Messages lost by lagging */
+        uint32_t active;
+        int32_t pid;
+    } readers[SHM_RING_MAX_READERS];
+} shm_ring_header_t;
+
+typedef struct
+{
+    shm_ring_header_t *header;
+    uint8_t *slots;
+    size_t map_len;
+    uint64_t head;          /* Writer's private copy of header->head */
+} shm_ring_t;
+
+typedef struct
+{
+    shm_ring_t *ring;
+    uint32_t index;
+    uint64_t tail;
+    uint64_t overruns;
+} shm_reader_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+int shm_ring_create(shm_ring_t *ring, const char *name, uint32_t slot_count, uint32_t slot_size);
+int shm_ring_open(shm_ring_t *ring, const char *name);
+int shm_ring_publish(shm_ring_t *ring, uint32_t tag, const void *data, uint32_t len);
+void shm_ring_close(shm_ring_t *ring);
+int shm_ring_unlink(const char *name);
+
+int shm_reader_attach(shm_reader_t *reader, shm_ring_t *ring);
+ssize_t shm_reader_read(shm_reader_t *reader, uint32_t *tag, void *buffer, uint32_t capacity, int timeout_ms);
+void shm_reader_detach(shm_reader_t *reader);
+
+#endif /* SHM_RING_H */
+
+/* [] END OF FILE */
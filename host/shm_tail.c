@@ -0,0 +1,116 @@
+/******************************************************************************
+ * File Name:   shm_tail.c
+ *
+ * Description: Reader for the shared-memory ring published by serial_gateway.
+ *              Writes the payload of every message to stdout, optionally only
+ *              for one channel, and reports lost messages on exit.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "shm_ring.h"
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_signal(int signo)
+{
+    (void)signo;
+    stop_requested = 1;
+}
+
+int main(int argc, char *argv[])
+{
+    shm_ring_t ring;
+    shm_reader_t reader;
+    uint8_t buffer[64 * 1024];
+    long channel = -1;
+    uint64_t messages = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'c': channel = strtol(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: %s [-c channel] /name\n", argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        fprintf(stderr, "usage: %s [-c channel] /name\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if ((shm_ring_open(&ring, argv[optind]) != 0) || (shm_reader_attach(&reader, &ring) != 0))
+    {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    while (!stop_requested)
+    {
+        uint32_t tag;
+        ssize_t len = shm_reader_read(&reader, &tag, buffer, sizeof(buffer), 100);
+
+        if ((len > 0) && ((channel < 0) || (tag == (uint32_t)channel)))
+        {
+            fwrite(buffer, 1, (size_t)len, stdout);
+            fflush(stdout);
+            ++messages;
+        }
+    }
+
+    fprintf(stderr, "%llu messages, %llu lost\n", (unsigned long long)messages,
+            (unsigned long long)reader.overruns);
+    shm_reader_detach(&reader);
+    shm_ring_close(&ring);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,178 @@
+/******************************************************************************
+ * File Name:   ts_query.c
+ *
+ * Description: Host tool that reads a time window from a time-series store
+ *              written by serial_gateway -a. The matching frames are written to
+ *              stdout as raw data or converted into a pcapng capture.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "pcap_writer.h"
+#include "ts_store.h"
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    int channel;
+    bool pcap;
+    pcap_writer_t writer;
+    uint64_t frames;
+    uint64_t bytes;
+} query_output_t;
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static query_output_t output = { .channel = -1 };
+
+/*******************************************************************************
+ * Function Name: parse_time
+ ********************************************************************************
+ * Summary:
+ * Convert a time in seconds since the epoch, with an optional fraction, to
+ * nanoseconds.
+ *
+ *******************************************************************************/
+static uint64_t parse_time(const char *text)
+{
+    double seconds = strtod(text, NULL);
+
+    return (seconds <= 0.0) ? 0u : (uint64_t)(seconds * 1e9);
+}
+
+/*******************************************************************************
+ * Function Name: visit
+ ********************************************************************************
+ * Summary:
+ * Store query callback, writes one matching record to the output.
+ *
+ *******************************************************************************/
+static int visit(void *context, const ts_record_t *record, const uint8_t *data)
+{
+    query_output_t *out = context;
+
+    if ((out->channel >= 0) && (record->channel != (uint16_t)out->channel))
+    {
+        return 0;
+    }
+
+    out->frames++;
+    out->bytes += record->len;
+    if (out->pcap)
+    {
+        return pcap_writer_write_frame(&out->writer, record->channel, (pcap_direction_t)record->flags,
+                                       record->timestamp_ns, data, record->len);
+    }
+    return (fwrite(data, 1, record->len, stdout) == record->len) ? 0 : -1;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [-f from] [-t to] [-c channel] [-w out.pcapng] dir\n"
+            "  -f  start of the window, seconds since the epoch (default: oldest)\n"
+            "  -t  end of the window, seconds since the epoch (default: newest)\n"
+            "  -c  only output frames of this channel\n"
+            "  -w  write a pcapng capture instead of raw data to stdout\n",
+            argv0);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *pcap_path = NULL;
+    uint64_t from_ns = 0;
+    uint64_t to_ns = UINT64_MAX;
+    ts_store_t store;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:t:c:w:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'f': from_ns = parse_time(optarg); break;
+            case 't': to_ns = parse_time(optarg); break;
+            case 'c': output.channel = (int)strtol(optarg, NULL, 0); break;
+            case 'w': pcap_path = optarg; break;
+            default: usage(argv[0]); return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if ((argc - optind) != 1)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (ts_store_open(&store, argv[optind], 0, TS_STORE_READ) != 0)
+    {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    if (pcap_path != NULL)
+    {
+        if (pcap_writer_open(&output.writer, pcap_path, PCAP_WRITER_LINKTYPE_USER0, PCAP_WRITER_DEFAULT_SNAPLEN) != 0)
+        {
+            fprintf(stderr, "%s: %s\n", pcap_path, strerror(errno));
+            return EXIT_FAILURE;
+        }
+        output.pcap = true;
+    }
+
+    if (ts_store_query(&store, from_ns, to_ns, visit, &output) != 0)
+    {
+        perror("query");
+    }
+    ts_store_close(&store);
+
+    if (output.pcap && (pcap_writer_close(&output.writer) != 0))
+    {
+        perror("close");
+        return EXIT_FAILURE;
+    }
+    fflush(stdout);
+    fprintf(stderr, "%llu frames, %llu bytes\n", (unsigned long long)output.frames, (unsigned long long)output.bytes);
+    return EXIT_SUCCESS;
+}
+
+/* [] END OF FILE */
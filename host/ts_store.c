@@ -0,0 +1,676 @@
+/******************************************************************************
+ * File Name:   ts_store.c
+ *
+ * Description: Append-only time-series store for captured serial data. A record
+ *              becomes visible to readers when the committed offset in the
+ *              segment header moves past it, so a query running in another
+ *              process never sees a partially written frame.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ts_store.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define TS_STORE_MAGIC 0x54535347u /* "TSSG" */
+#define TS_STORE_VERSION 1u
+
+#define TS_STORE_PAGE 4096u
+#define ALIGN8(x) (((x) + 7u) & ~(uint64_t)7u)
+#define PAGE_DOWN(x) ((x) & ~(uint64_t)(TS_STORE_PAGE - 1u))
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint64_t timestamp_ns;
+    uint64_t offset;
+} ts_index_entry_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t segment_size;
+    uint64_t sequence;
+    uint64_t first_ts;
+    uint64_t last_ts;
+    uint64_t records;
+    uint64_t committed;     /* End of the last complete record */
+    uint32_t index_count;
+    uint32_t index_stride;
+    ts_index_entry_t index[TS_STORE_INDEX_MAX];
+} ts_segment_header_t;
+
+/* Records start on the first page after the header */
+#define TS_STORE_DATA_OFFSET ((sizeof(ts_segment_header_t) + TS_STORE_PAGE - 1u) & ~(size_t)(TS_STORE_PAGE - 1u))
+
+static inline ts_segment_header_t *header_of(uint8_t *map)
+{
+    return (ts_segment_header_t *)map;
+}
+
+static void segment_name(char *name, size_t len, uint64_t sequence)
+{
+    snprintf(name, len, "seg-%016" PRIx64 ".ts", sequence);
+}
+
+/*******************************************************************************
+ * Function Name: add_segment_info
+ ********************************************************************************
+ * Summary:
+ * Append an entry to the in-memory segment list, growing it as needed.
+ *
+ *******************************************************************************/
+static ts_segment_info_t *add_segment_info(ts_store_t *store, uint64_t sequence)
+{
+    if (store->segment_count == store->segment_capacity)
+    {
+        uint32_t capacity = (store->segment_capacity == 0) ? 16u : (store->segment_capacity * 2u);
+        ts_segment_info_t *segments = realloc(store->segments, capacity * sizeof(*segments));
+        if (segments == NULL)
+        {
+            return NULL;
+        }
+        store->segments = segments;
+        store->segment_capacity = capacity;
+    }
+    memset(&store->segments[store->segment_count], 0, sizeof(ts_segment_info_t));
+    store->segments[store->segment_count].sequence = sequence;
+    return &store->segments[store->segment_count++];
+}
+
+static int compare_info(const void *a, const void *b)
+{
+    uint64_t sa = ((const ts_segment_info_t *)a)->sequence;
+    uint64_t sb = ((const ts_segment_info_t *)b)->sequence;
+    return (sa > sb) - (sa < sb);
+}
+
+/*******************************************************************************
+ * Function Name: scan_segments
+ ********************************************************************************
+ * Summary:
+ * Rebuild the segment list from the directory, reading only the fixed part
+ * of every segment header.
+ *
+ *******************************************************************************/
+static int scan_segments(ts_store_t *store)
+{
+    int fd = dup(store->dir_fd);
+    DIR *dir = (fd < 0) ? NULL : fdopendir(fd);
+    struct dirent *entry;
+
+    if (dir == NULL)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+
+    rewinddir(dir);
+    store->segment_count = 0;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        ts_segment_header_t header;
+        ts_segment_info_t *info;
+        uint64_t sequence;
+        int seg_fd;
+        ssize_t n;
+
+        if (sscanf(entry->d_name, "seg-%16" SCNx64 ".ts", &sequence) != 1)
+        {
+            continue;
+        }
+        seg_fd = openat(store->dir_fd, entry->d_name, O_RDONLY | O_CLOEXEC);
+        if (seg_fd < 0)
+        {
+            continue;
+        }
+        n = pread(seg_fd, &header, offsetof(ts_segment_header_t, index), 0);
+        close(seg_fd);
+        if ((n != (ssize_t)offsetof(ts_segment_header_t, index)) || (header.magic != TS_STORE_MAGIC))
+        {
+            continue;
+        }
+
+        info = add_segment_info(store, sequence);
+        if (info == NULL)
+        {
+            closedir(dir);
+            return -1;
+        }
+        info->first_ts = header.first_ts;
+        info->last_ts = header.last_ts;
+        info->records = header.records;
+    }
+    closedir(dir);
+
+    qsort(store->segments, store->segment_count, sizeof(ts_segment_info_t), compare_info);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: map_segment
+ ********************************************************************************
+ * Summary:
+ * Map an existing segment file, read-only or for appending.
+ *
+ *******************************************************************************/
+static uint8_t *map_segment(ts_store_t *store, uint64_t sequence, int writable, uint64_t *size)
+{
+    char name[32];
+    struct stat st;
+    void *map;
+    int fd;
+
+    segment_name(name, sizeof(name), sequence);
+    fd = openat(store->dir_fd, name, (writable ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    if ((fstat(fd, &st) != 0) || ((uint64_t)st.st_size < TS_STORE_DATA_OFFSET))
+    {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+    map = mmap(NULL, (size_t)st.st_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return NULL;
+    }
+    *size = (uint64_t)st.st_size;
+    return map;
+}
+
+/*******************************************************************************
+ * Function Name: activate_segment
+ ********************************************************************************
+ * Summary:
+ * Make a mapped segment the target of ts_store_append() and restore the
+ * append state from its header.
+ *
+ *******************************************************************************/
+static void activate_segment(ts_store_t *store, uint8_t *map)
+{
+    ts_segment_header_t *header = header_of(map);
+
+    store->map = map;
+    store->offset = header->committed;
+    store->synced = header->committed;
+    store->next_index_offset = TS_STORE_DATA_OFFSET + ((uint64_t)header->index_count * header->index_stride);
+    if (store->next_index_offset < store->offset)
+    {
+        store->next_index_offset = store->offset;
+    }
+    store->last_ts = header->last_ts;
+}
+
+/*******************************************************************************
+ * Function Name: create_segment
+ ********************************************************************************
+ * Summary:
+ * Create, size and map the next segment file. The index stride is chosen so
+ * that TS_STORE_INDEX_MAX entries cover the whole segment.
+ *
+ *******************************************************************************/
+static int create_segment(ts_store_t *store, uint64_t sequence)
+{
+    ts_segment_header_t *header;
+    char name[32];
+    void *map;
+    int fd;
+
+    if (add_segment_info(store, sequence) == NULL)
+    {
+        return -1;
+    }
+
+    segment_name(name, sizeof(name), sequence);
+    fd = openat(store->dir_fd, name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        store->segment_count--;
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)store->segment_size) != 0)
+    {
+        close(fd);
+        store->segment_count--;
+        return -1;
+    }
+    map = mmap(NULL, store->segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        store->segment_count--;
+        return -1;
+    }
+
+    header = header_of(map);
+    header->version = TS_STORE_VERSION;
+    header->segment_size = store->segment_size;
+    header->sequence = sequence;
+    header->committed = TS_STORE_DATA_OFFSET;
+    header->index_stride = (uint32_t)(((store->segment_size - TS_STORE_DATA_OFFSET) + TS_STORE_INDEX_MAX - 1u) /
+                                      TS_STORE_INDEX_MAX);
+    __atomic_store_n(&header->magic, TS_STORE_MAGIC, __ATOMIC_RELEASE);
+
+    activate_segment(store, map);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: ts_store_open
+ ********************************************************************************
+ * Summary:
+ * Open a store directory. With TS_STORE_WRITE the directory is created if
+ * needed and appending resumes in the newest segment. A store opened with
+ * TS_STORE_READ can query while another process appends.
+ *
+ * Parameters:
+ *  ts_store_t *store: Store instance
+ *  const char *path: Store directory
+ *  uint64_t segment_size: Size of new segment files, 0 for the default
+ *  int flags: TS_STORE_READ or TS_STORE_WRITE
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int ts_store_open(ts_store_t *store, const char *path, uint64_t segment_size, int flags)
+{
+    memset(store, 0, sizeof(*store));
+    store->flags = flags;
+    store->segment_size = (segment_size == 0) ? TS_STORE_SEGMENT_SIZE : PAGE_DOWN(segment_size);
+    if (store->segment_size <= (TS_STORE_DATA_OFFSET + TS_STORE_PAGE))
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if ((flags & TS_STORE_WRITE) && (mkdir(path, 0755) != 0) && (errno != EEXIST))
+    {
+        return -1;
+    }
+    store->dir_fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (store->dir_fd < 0)
+    {
+        return -1;
+    }
+    if (scan_segments(store) != 0)
+    {
+        ts_store_close(store);
+        return -1;
+    }
+
+    if (flags & TS_STORE_WRITE)
+    {
+        if (store->segment_count != 0)
+        {
+            ts_segment_info_t *last = &store->segments[store->segment_count - 1u];
+            uint64_t size;
+            uint8_t *map = map_segment(store, last->sequence, 1, &size);
+
+            if ((map != NULL) && (size == store->segment_size))
+            {
+                activate_segment(store, map);
+                return 0;
+            }
+            if (map != NULL)
+            {
+                munmap(map, size);
+            }
+        }
+        if (create_segment(store, (store->segment_count == 0) ? 0u :
+                                  (store->segments[store->segment_count - 1u].sequence + 1u)) != 0)
+        {
+            ts_store_close(store);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: finish_segment
+ ********************************************************************************
+ * Summary:
+ * Write back and unmap the active segment.
+ *
+ *******************************************************************************/
+static int finish_segment(ts_store_t *store)
+{
+    int result = 0;
+
+    if (store->map != NULL)
+    {
+        result = ts_store_sync(store, 1);
+        munmap(store->map, store->segment_size);
+        store->map = NULL;
+    }
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: ts_store_append
+ ********************************************************************************
+ * Summary:
+ * Append one frame. Timestamps are expected to be non-decreasing; an older
+ * timestamp is raised to the newest one so the index stays sorted. Dirty
+ * data is handed to msync(MS_ASYNC) every TS_STORE_SYNC_BYTES rather than
+ * per record.
+ *
+ * Parameters:
+ *  ts_store_t *store: Store opened with TS_STORE_WRITE
+ *  uint64_t timestamp_ns: Capture time of the frame
+ *  uint16_t channel: Channel id
+ *  uint16_t flags: Caller defined, e.g. the direction of the frame
+ *  const void *data: Frame payload
+ *  uint32_t len: Length of the frame payload
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int ts_store_append(ts_store_t *store, uint64_t timestamp_ns, uint16_t channel, uint16_t flags,
+                    const void *data, uint32_t len)
+{
+    uint64_t size = sizeof(ts_record_t) + ALIGN8((uint64_t)len);
+    ts_segment_header_t *header;
+    ts_segment_info_t *info;
+    ts_record_t *record;
+
+    if (store->map == NULL)
+    {
+        errno = EBADF;
+        return -1;
+    }
+    if (size > (store->segment_size - TS_STORE_DATA_OFFSET))
+    {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    if ((store->offset + size) > store->segment_size)
+    {
+        uint64_t sequence = header_of(store->map)->sequence + 1u;
+        if ((finish_segment(store) != 0) || (create_segment(store, sequence) != 0))
+        {
+            return -1;
+        }
+    }
+
+    if (timestamp_ns < store->last_ts)
+    {
+        timestamp_ns = store->last_ts;
+    }
+
+    header = header_of(store->map);
+    record = (ts_record_t *)&store->map[store->offset];
+    record->timestamp_ns = timestamp_ns;
+    record->channel = channel;
+    record->flags = flags;
+    record->len = len;
+    memcpy(record + 1, data, len);
+
+    if ((store->offset >= store->next_index_offset) && (header->index_count < TS_STORE_INDEX_MAX))
+    {
+        header->index[header->index_count].timestamp_ns = timestamp_ns;
+        header->index[header->index_count].offset = store->offset;
+        __atomic_store_n(&header->index_count, header->index_count + 1u, __ATOMIC_RELEASE);
+        while (store->next_index_offset <= store->offset)
+        {
+            store->next_index_offset += header->index_stride;
+        }
+    }
+
+    if (header->records == 0)
+    {
+        header->first_ts = timestamp_ns;
+    }
+    header->last_ts = timestamp_ns;
+    header->records++;
+    store->offset += size;
+    __atomic_store_n(&header->committed, store->offset, __ATOMIC_RELEASE);
+
+    info = &store->segments[store->segment_count - 1u];
+    info->first_ts = header->first_ts;
+    info->last_ts = timestamp_ns;
+    info->records = header->records;
+
+    store->last_ts = timestamp_ns;
+    store->records++;
+    store->bytes += size;
+
+    if ((store->offset - store->synced) >= TS_STORE_SYNC_BYTES)
+    {
+        return ts_store_sync(store, 0);
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: ts_store_sync
+ ********************************************************************************
+ * Summary:
+ * Hand the data written since the last sync, and the header page, to the
+ * kernel for write-back.
+ *
+ * Parameters:
+ *  ts_store_t *store: Store instance
+ *  int wait: Non-zero waits for the write-back (MS_SYNC), zero only starts
+ *            it (MS_ASYNC)
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int ts_store_sync(ts_store_t *store, int wait)
+{
+    int mode = wait ? MS_SYNC : MS_ASYNC;
+    uint64_t start = PAGE_DOWN(store->synced);
+
+    if ((store->map == NULL) || (store->offset == store->synced))
+    {
+        return 0;
+    }
+
+    store->syncs++;
+    if ((msync(&store->map[start], store->offset - start, mode) != 0) ||
+        (msync(store->map, TS_STORE_DATA_OFFSET, mode) != 0))
+    {
+        return -1;
+    }
+    store->synced = store->offset;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: query_segment
+ ********************************************************************************
+ * Summary:
+ * Binary search the sparse index for the last entry at or before from_ns,
+ * then scan the committed records from there until the window ends.
+ *
+ *******************************************************************************/
+static int query_segment(const uint8_t *map, uint64_t from_ns, uint64_t to_ns, ts_store_visit_t visit, void *context)
+{
+    const ts_segment_header_t *header = (const ts_segment_header_t *)map;
+    uint64_t committed = __atomic_load_n(&header->committed, __ATOMIC_ACQUIRE);
+    uint32_t count = __atomic_load_n(&header->index_count, __ATOMIC_ACQUIRE);
+    uint64_t offset = TS_STORE_DATA_OFFSET;
+    uint32_t lo = 0;
+    uint32_t hi = count;
+
+    while (lo < hi)
+    {
+        uint32_t mid = lo + ((hi - lo) / 2u);
+        if (header->index[mid].timestamp_ns < from_ns)
+        {
+            lo = mid + 1u;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    /* Entry lo is the first at or after from_ns; records equal to from_ns may precede it */
+    if (lo != 0)
+    {
+        offset = header->index[lo - 1u].offset;
+    }
+
+    while (offset < committed)
+    {
+        const ts_record_t *record = (const ts_record_t *)&map[offset];
+
+        if (record->timestamp_ns > to_ns)
+        {
+            break;
+        }
+        if ((record->timestamp_ns >= from_ns) && (visit(context, record, (const uint8_t *)(record + 1)) != 0))
+        {
+            return 1;
+        }
+        offset += sizeof(ts_record_t) + ALIGN8((uint64_t)record->len);
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: ts_store_query
+ ********************************************************************************
+ * Summary:
+ * Visit every record with from_ns <= timestamp <= to_ns in time order.
+ * Segments outside the window are skipped using their header, without
+ * mapping them.
+ *
+ * Parameters:
+ *  ts_store_t *store: Store instance
+ *  uint64_t from_ns: Start of the window, inclusive
+ *  uint64_t to_ns: End of the window, inclusive
+ *  ts_store_visit_t visit: Called per record, non-zero return stops the query
+ *  void *context: Passed through to visit
+ *
+ * Return:
+ *  int: 0 on success, -1 with errno set on failure
+ *
+ *******************************************************************************/
+int ts_store_query(ts_store_t *store, uint64_t from_ns, uint64_t to_ns, ts_store_visit_t visit, void *context)
+{
+    if (!(store->flags & TS_STORE_WRITE) && (scan_segments(store) != 0))
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < store->segment_count; ++i)
+    {
+        const ts_segment_info_t *info = &store->segments[i];
+        bool active = (store->map != NULL) && (i == (store->segment_count - 1u));
+        uint64_t size = store->segment_size;
+        const uint8_t *map;
+        int stop;
+
+        if ((info->records == 0) || (info->last_ts < from_ns) || (info->first_ts > to_ns))
+        {
+            continue;
+        }
+
+        map = active ? store->map : map_segment(store, info->sequence, 0, &size);
+        if (map == NULL)
+        {
+            return -1;
+        }
+        stop = query_segment(map, from_ns, to_ns, visit, context);
+        if (!active)
+        {
+            munmap((void *)map, size);
+        }
+        if (stop)
+        {
+            break;
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: ts_store_close
+ ********************************************************************************
+ * Summary:
+ * Write back the active segment and release all resources.
+ *
+ *******************************************************************************/
+int ts_store_close(ts_store_t *store)
+{
+    int result = finish_segment(store);
+
+    if (store->dir_fd >= 0)
+    {
+        if ((store->flags & TS_STORE_WRITE) && (fsync(store->dir_fd) != 0))
+        {
+            result = -1;
+        }
+        close(store->dir_fd);
+    }
+    free(store->segments);
+    store->segments = NULL;
+    store->segment_count = 0;
+    store->segment_capacity = 0;
+    store->dir_fd = -1;
+    return result;
+}
+
+/* [] END OF FILE */
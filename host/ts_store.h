@@ -0,0 +1,119 @@
+/******************************************************************************
+ * File Name:   ts_store.h
+ *
+ * Description: Append-only time-series store for captured serial data. Frames
+ *              are appended to fixed-size, memory-mapped segment files. Every
+ *              segment keeps a sparse time index in its header, so a query for a
+ *              time window only scans the few records around the window start.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef TS_STORE_H
+#define TS_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Default size of a segment file */
+#define TS_STORE_SEGMENT_SIZE (64u * 1024u * 1024u)
+
+/* Entries of the sparse index kept in every segment header */
+#define TS_STORE_INDEX_MAX 1024u
+
+/* Dirty bytes after which written data is handed to msync(MS_ASYNC) */
+#define TS_STORE_SYNC_BYTES (4u * 1024u * 1024u)
+
+/* Flags for ts_store_open() */
+#define TS_STORE_READ 0
+#define TS_STORE_WRITE 1
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint64_t timestamp_ns;
+    uint16_t channel;
+    uint16_t flags;
+    uint32_t len;
+} ts_record_t;
+
+typedef struct
+{
+    uint64_t sequence;
+    uint64_t first_ts;
+    uint64_t last_ts;
+    uint64_t records;
+} ts_segment_info_t;
+
+typedef struct
+{
+    int dir_fd;
+    int flags;
+    uint64_t segment_size;
+    /* Active segment */
+    uint8_t *map;
+    uint64_t offset;
+    uint64_t synced;
+    uint64_t next_index_offset;
+    uint64_t last_ts;
+    /* All segments, oldest first */
+    ts_segment_info_t *segments;
+    uint32_t segment_count;
+    uint32_t segment_capacity;
+    /* Statistics */
+    uint64_t records;
+    uint64_t bytes;
+    uint64_t syncs;
+} ts_store_t;
+
+/* Called for every record in a queried window, return non-zero to stop */
+typedef int (*ts_store_visit_t)(void *context, const ts_record_t *record, const uint8_t *data);
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+int ts_store_open(ts_store_t *store, const char *path, uint64_t segment_size, int flags);
+int ts_store_append(ts_store_t *store, uint64_t timestamp_ns, uint16_t channel, uint16_t flags,
+                    const void *data, uint32_t len);
+int ts_store_sync(ts_store_t *store, int wait);
+int ts_store_query(ts_store_t *store, uint64_t from_ns, uint64_t to_ns, ts_store_visit_t visit, void *context);
+int ts_store_close(ts_store_t *store);
+
+#endif /* TS_STORE_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,165 @@
+/******************************************************************************
+ * File Name:   xmc_dma.h
+ *
+ * Description: Host model of the XMCLib GPDMA interface used by
+ *              source/dma_producer.c and the loopback transmitter of main.c.
+ *              Only the types and functions they call are provided;
+ *              gpdma_model.c implements them on a simulated channel so the
+ *              producer runs unchanged in the host benchmarks.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#ifndef XMC_DMA_H
+#define XMC_DMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define GPDMA_MODEL_CHANNELS 8u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef enum
+{
+    XMC_DMA_CH_TRANSFER_WIDTH_8 = 0,
+    XMC_DMA_CH_TRANSFER_WIDTH_16 = 1,
+    XMC_DMA_CH_TRANSFER_WIDTH_32 = 2
+} XMC_DMA_CH_TRANSFER_WIDTH_t;
+
+typedef enum
+{
+    XMC_DMA_CH_PRIORITY_0 = 0
+} XMC_DMA_CH_PRIORITY_t;
+
+typedef enum
+{
+    XMC_DMA_CH_ADDRESS_COUNT_MODE_INCREMENT = 0,
+    XMC_DMA_CH_ADDRESS_COUNT_MODE_DECREMENT = 1,
+    XMC_DMA_CH_ADDRESS_COUNT_MODE_NO_CHANGE = 2
+} XMC_DMA_CH_ADDRESS_COUNT_MODE_t;
+
+typedef enum
+{
+    XMC_DMA_CH_BURST_LENGTH_1 = 0
+} XMC_DMA_CH_BURST_LENGTH_t;
+
+typedef enum
+{
+    XMC_DMA_CH_TRANSFER_FLOW_M2M_DMA = 0,
+    XMC_DMA_CH_TRANSFER_FLOW_M2P_DMA = 1,
+    XMC_DMA_CH_TRANSFER_FLOW_P2M_DMA = 2
+} XMC_DMA_CH_TRANSFER_FLOW_t;
+
+typedef enum
+{
+    XMC_DMA_CH_TRANSFER_TYPE_SINGLE_BLOCK = 0,
+    XMC_DMA_CH_TRANSFER_TYPE_MULTI_BLOCK_SRCADR_RELOAD_DSTADR_RELOAD = 1
+} XMC_DMA_CH_TRANSFER_TYPE_t;
+
+typedef enum
+{
+    XMC_DMA_CH_SRC_HANDSHAKING_HARDWARE = 0,
+    XMC_DMA_CH_SRC_HANDSHAKING_SOFTWARE = 1
+} XMC_DMA_CH_SRC_HANDSHAKING_t;
+
+typedef struct
+{
+    uint32_t src_transfer_width;
+    uint32_t dst_transfer_width;
+    uint32_t src_address_count_mode;
+    uint32_t dst_address_count_mode;
+    uint32_t src_burst_length;
+    uint32_t dst_burst_length;
+    uint32_t transfer_flow;
+    uint32_t src_addr;
+    uint32_t dst_addr;
+    uint16_t block_size;
+    XMC_DMA_CH_TRANSFER_TYPE_t transfer_type;
+    XMC_DMA_CH_PRIORITY_t priority;
+    XMC_DMA_CH_SRC_HANDSHAKING_t src_handshaking;
+    uint8_t src_peripheral_request;
+} XMC_DMA_CH_CONFIG_t;
+
+/* Simulated channel: addresses and block size as programmed, the
+ * transfer count within the current block and the characters lost while
+ * the channel was stopped */
+typedef struct
+{
+    uint32_t source;
+    uint32_t destination;
+    uint32_t block_size;
+    uint32_t transferred;
+    uint32_t width;
+    bool single_block;          /* Disables itself at the end of the block */
+    bool enabled;
+    uint32_t lost;              /* Overruns of a peripheral without FIFO during blackouts */
+} gpdma_model_channel_t;
+
+typedef struct
+{
+    bool enabled;
+    gpdma_model_channel_t ch[GPDMA_MODEL_CHANNELS];
+} XMC_DMA_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void XMC_DMA_Init(XMC_DMA_t *dma);
+bool XMC_DMA_IsEnabled(XMC_DMA_t *dma);
+void XMC_DMA_CH_Init(XMC_DMA_t *dma, uint8_t channel, const XMC_DMA_CH_CONFIG_t *config);
+void XMC_DMA_CH_Enable(XMC_DMA_t *dma, uint8_t channel);
+void XMC_DMA_CH_Disable(XMC_DMA_t *dma, uint8_t channel);
+bool XMC_DMA_CH_IsEnabled(XMC_DMA_t *dma, uint8_t channel);
+void XMC_DMA_CH_SetSourceAddress(XMC_DMA_t *dma, uint8_t channel, uint32_t address);
+void XMC_DMA_CH_SetDestinationAddress(XMC_DMA_t *dma, uint8_t channel, uint32_t address);
+void XMC_DMA_CH_SetBlockSize(XMC_DMA_t *dma, uint8_t channel, uint32_t block_size);
+uint32_t XMC_DMA_CH_GetTransferredData(XMC_DMA_t *dma, uint8_t channel);
+
+/* Register host memory the channels may write; XMCLib addresses are 32 bit */
+void gpdma_model_memory(volatile void *base, uint32_t size);
+/* Service request of the peripheral: one transfer of the given value */
+bool gpdma_model_request(XMC_DMA_t *dma, uint8_t channel, uint32_t value);
+/* Service request of a memory-to-peripheral channel: one transfer from the source */
+bool gpdma_model_fetch(XMC_DMA_t *dma, uint8_t channel, uint32_t *value);
+/* Channel stopped for blackout cycles while characters arrive every char_cycles; returns the characters lost */
+uint32_t gpdma_model_blackout(XMC_DMA_t *dma, uint8_t channel, uint64_t blackout, uint64_t char_cycles);
+
+#endif /* XMC_DMA_H */
+
+/* [] END OF FILE */
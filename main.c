@@ -43,70 +43,1446 @@
 
 #include "cybsp.h"
 #include "cy_retarget_io.h"
+#include "ring_buffer.h"
+#include "dma_producer.h"
+#include "tiered_ring.h"
+#include "tx_coalesce.h"
+#include "tx_sched.h"
+#include "token_bucket.h"
+#include "pc_profile.h"
+#include "histogram.h"
+#include "loopback_test.h"
+#include "baud_rate.h"
+#include "lz_stream.h"
+#include "aes_ctr.h"
+#include "line_protocol_dfa.h"
+#include "fw_update.h"
+#include "xmc_flash.h"
+#include "xmc_fce.h"
+#include "xmc_ccu4.h"
 
 /*******************************************************************************
  * Defines
  *******************************************************************************/
 /* Declarations for system timer emulating an OS task */
 #define TICKS_PER_SECOND 1000
+/* Longest time in microseconds a TX fragment is held with ENABLE_TX_COALESCING. The deadline
+ * is checked once per tick and rounded up to whole ticks, so 500 holds for one tick */
 #define TICKS_WAIT 500
 
+/* Interrupt priority plan of the data path. Grouping 4 leaves 3 bits of preemption priority and
+ * 3 bits of subpriority on the 6 implemented bits; lower numbers preempt higher ones. A capture
+ * edge is lost after one bit time, a DMA or USIC event before the next block or character, the
+ * consumer has a whole tick. The profiler samples above the consumer so it sees it too. Levels 3
+ * to 7 are left for the application */
+#define NVIC_PRIORITY_GROUPING 4u
+#define PRIORITY_AUTOBAUD 0u
+#define PRIORITY_DMA 1u
+#define PRIORITY_USIC 1u
+#define PRIORITY_PC_PROFILE 1u
+#define PRIORITY_SYSTICK 2u
+#define PRIORITY_LATENCY_LOAD 3u
+
+/* Interrupt lines of the data path. CYBSP_DEBUG_UART is on USIC1 on the XMC43/XMC44 kits, as
+ * src_ptr below; GPDMA0 serves the ring on every device */
+#if ( ( UC_SERIES == XMC43 ) || ( UC_SERIES == XMC44 ) )
+#define UART_IRQn USIC1_0_IRQn
+#else
+#define UART_IRQn USIC0_0_IRQn
+#endif
+#define DMA_IRQn GPDMA0_0_IRQn
+
 /* DMA Channel 2 */
 #define GPDMA_CHANNEL_2 2
 
-/* Declarations for ring buffer */
-#define RING_BUFFER_SIZE 4096
+/* Declarations for ring buffer, one DMA block (block_size in design.modus) */
+#define RING_BUFFER_SIZE 1024
+
+/* Define macro to enable/disable printing of debug messages */
+#define ENABLE_XMC_DEBUG_PRINT (0)
+
+/* Define macro to enable/disable compression of the echoed data, decode with host/lz_unpack */
+#define ENABLE_TX_COMPRESSION (0)
+
+/* Define macro to enable/disable AES-128-CTR decryption of the received data */
+#define ENABLE_RX_DECRYPTION (0)
+
+/* Define macro to enable/disable counting the tokens of source/line_protocol.dfa in the received data */
+#define ENABLE_PROTOCOL_SCANNER (0)
+
+/* Define macro to enable/disable the firmware update receiver, send images with host/fw_send */
+#define ENABLE_FW_UPDATE (0)
+
+/* Flash slot receiving update images: the second MB of an XMC4700/XMC4800 with 256 KB sectors */
+#define FW_UPDATE_SLOT_ADDRESS 0x0C100000u
+#define FW_UPDATE_SLOT_SIZE 0x00100000u
+#define FW_UPDATE_SECTOR_SIZE 0x00040000u
+
+/* Define macro to enable/disable spilling the ring buffer into external memory on the EBU */
+#define ENABLE_EBU_BUFFER (0)
+
+/* Cold tier in EBU region 0; the EBU must be set up for the fitted SDRAM/SRAM, e.g. in the Device Configurator */
+#define EBU_RING_ADDRESS 0x60000000u
+#define EBU_RING_SIZE 0x00800000u
+
+/* Memory-to-memory channel copying from the ring buffer to the cold tier (channels 0 and 1 have the larger FIFO) */
+#define GPDMA_CHANNEL_SPILL 0
+
+/* Bytes the uplink takes per tick with ENABLE_EBU_BUFFER, 0 stalls it; 92 is one tick at 921600 baud */
+#define RX_UPLINK_BYTES_PER_TICK 92u
+
+/* Define macro to enable/disable resizing the ring buffer at runtime through rx_ring_size_request */
+#define ENABLE_RING_RESIZE (0)
+
+#if ENABLE_RING_RESIZE && ENABLE_EBU_BUFFER
+#error "ENABLE_RING_RESIZE cannot move a ring buffer with a spill to the cold tier in flight"
+#endif
+
+#if ENABLE_RING_RESIZE && ENABLE_FW_UPDATE
+#error "ENABLE_RING_RESIZE drains the backlog through uart_receive(), which would echo update data"
+#endif
+
+/* Define macro to enable/disable auto-baud detection and baud rate switch requests, negotiate with host/baud_switch */
+#define ENABLE_BAUD_SWITCH (0)
+
+/* Rate and oversampling of CYBSP_DEBUG_UART in design.modus */
+#define UART_BAUD_RATE 115200u
+#define UART_OVERSAMPLING 16u
+
+/* CCU4 slice capturing the RX pin (P1.4) for auto-baud; route the pin to AUTOBAUD_INPUT of the slice */
+#define AUTOBAUD_CCU4 CCU40
+#define AUTOBAUD_SLICE CCU40_CC40
+#define AUTOBAUD_SLICE_NUMBER 0u
+#define AUTOBAUD_INPUT XMC_CCU4_SLICE_INPUT_A
+#define AUTOBAUD_PRESCALER XMC_CCU4_SLICE_PRESCALER_4
+#define AUTOBAUD_IRQn CCU40_0_IRQn
+#define AUTOBAUD_IRQHandler CCU40_0_IRQHandler
+
+/* Send echo data in batches instead of one transfer per received segment */
+#define ENABLE_TX_COALESCING (0)
+
+/* Largest batch, and the held bytes that send a batch before TICKS_WAIT */
+#define TX_COALESCE_SIZE 256u
+#define TX_COALESCE_THRESHOLD 64u
+
+/* Queue output in an urgent and a bulk class, urgent replies overtake echo data */
+#define ENABLE_TX_SCHEDULER (0)
+
+/* Bounded queues: bytes and frames per class. Echo data is cut into bulk
+ * frames of TX_SCHED_BULK_FRAME bytes, the longest an urgent frame waits */
+#define TX_SCHED_URGENT_SIZE 128u
+#define TX_SCHED_URGENT_FRAMES 8u
+#define TX_SCHED_BULK_SIZE 2048u
+#define TX_SCHED_BULK_FRAMES 64u
+#define TX_SCHED_BULK_FRAME 32u
+
+/* Limit the rate and burst the peer receives, needs ENABLE_TX_SCHEDULER */
+#define ENABLE_TX_SHAPER (0)
+
+/* Average rate in bytes per second and longest back-to-back burst in bytes */
+#define TX_SHAPER_RATE 5760u
+#define TX_SHAPER_BURST 64u
+
+/* Bound the data taken from the ring per tick, the rest waits for the next tick */
+#define ENABLE_RX_BUDGET (0)
+
+/* Bytes per tick, at least the line rate per tick (12 at 115200 baud, 300 at
+ * 3 Mbaud); cycles per tick, checked every RX_BUDGET_CHUNK bytes, 0 for no limit */
+#define RX_BUDGET_BYTES 256u
+#define RX_BUDGET_CYCLES 0u
+#define RX_BUDGET_CHUNK 16u
+
+#if ENABLE_RX_BUDGET && (ENABLE_FW_UPDATE || ENABLE_EBU_BUFFER)
+#error "ENABLE_RX_BUDGET bounds the echo path, ENABLE_FW_UPDATE and ENABLE_EBU_BUFFER consume the ring their own way"
+#endif
+
+/* Record the worst entry latency of each data path interrupt under a synthetic load */
+#define ENABLE_IRQ_LATENCY (0)
+
+/* Synthetic load: a CCU4 slice interrupt at PRIORITY_LATENCY_LOAD that keeps the CPU busy, with a
+ * period that is no divisor of the tick so it meets SysTick at every phase, and a critical section
+ * in every main loop pass as long as the longest one of the TX path */
+#define LATENCY_LOAD_CCU4 CCU40
+#define LATENCY_LOAD_SLICE CCU40_CC41
+#define LATENCY_LOAD_SLICE_NUMBER 1u
+#define LATENCY_LOAD_IRQn CCU40_1_IRQn
+#define LATENCY_LOAD_IRQHandler CCU40_1_IRQHandler
+#define LATENCY_LOAD_PERIOD 13001u          /* CCU4 clocks, 90 us at 144 MHz */
+#define LATENCY_LOAD_CYCLES 3000u           /* CPU cycles busy per period */
+#define LATENCY_CRITICAL_CYCLES 720u        /* CPU cycles with interrupts disabled per main loop pass */
+
+/* Sample the interrupted program counter into a histogram, symbolize the reports with host/pc_symbolize;
+ * needs ENABLE_TX_SCHEDULER */
+#define ENABLE_PC_PROFILE (0)
+
+/* Code range of the histogram, as linked (16 byte buckets for 128 KB), and samples per report */
+#define PC_PROFILE_BASE 0x08000000u
+#define PC_PROFILE_SIZE 0x00020000u
+#define PC_PROFILE_BUCKETS 8192u
+#define PC_PROFILE_SAMPLES 50000u
+
+/* CCU4 slice sampling at PRIORITY_PC_PROFILE, with a period that is no divisor of the tick so the
+ * samples do not lock to the consumer */
+#define PC_PROFILE_CCU4 CCU40
+#define PC_PROFILE_SLICE CCU40_CC42
+#define PC_PROFILE_SLICE_NUMBER 2u
+#define PC_PROFILE_IRQn CCU40_2_IRQn
+#define PC_PROFILE_IRQHandler CCU40_2_IRQHandler
+#define PC_PROFILE_PERIOD 14401u            /* CCU4 clocks, 10 kHz at 144 MHz */
+
+/* Record the interval between consumer runs and the bytes each run finds in the ring */
+#define ENABLE_TICK_HISTOGRAM (0)
+
+/* Bins of both histograms; intervals from 0 to 3.2 ms, bytes from 0 to the ring size, the last
+ * bin takes everything beyond */
+#define TICK_HISTOGRAM_BINS 64u
+#define TICK_INTERVAL_BIN_US 50u
+#define TICK_BYTES_BIN (RING_BUFFER_SIZE / TICK_HISTOGRAM_BINS)
+
+/* Sweep the baud rate at startup with a PRBS pattern looped back from TX to RX, report the fastest error-free rate */
+#define ENABLE_LOOPBACK_TEST (0)
+
+/* 1: internal loopback, the RX input of the USIC is switched to its own output; 0: TX pin wired to
+ * RX pin on the board. The pattern appears on the TX pin either way */
+#define LOOPBACK_TEST_INTERNAL 1
+#define LOOPBACK_INPUT 6u                   /* DX0G, the channel's own data output */
+#define UART_RX_INPUT 1u                    /* DX0B, P1.4 as routed in design.modus */
+
+/* Rates in bit/s, ascending, rates the USIC cannot generate are skipped; pattern per rate in
+ * milliseconds of line time, handed to the DMA in blocks */
+#define LOOPBACK_TEST_RATES 115200u, 230400u, 460800u, 921600u, 1500000u, 2000000u, 3000000u, 4500000u, \
+                            6000000u, 9000000u
+#define LOOPBACK_TEST_STEP_MS 250u
+#define LOOPBACK_TEST_BLOCK 256u
+
+/* Memory-to-peripheral channel feeding the transmit buffer. The transmit buffer event of the USIC
+ * goes to service request LOOPBACK_TX_SR, whose interrupt stays disabled, and through the DLR to
+ * the channel; USIC0 as on the XMC4700, the XMC43/XMC44 debug UART needs the USIC1 line */
+#define GPDMA_CHANNEL_LOOPBACK 3
+#define LOOPBACK_TX_SR 1u
+#define LOOPBACK_TX_REQUEST DMA0_PERIPHERAL_REQUEST_USIC0_SR1_2
+
+#if ENABLE_PC_PROFILE && ENABLE_TX_COMPRESSION
+#error "ENABLE_PC_PROFILE records would corrupt the compressed stream of ENABLE_TX_COMPRESSION"
+#endif
+
+#if ENABLE_PC_PROFILE && !ENABLE_TX_SCHEDULER
+#error "ENABLE_PC_PROFILE sends its records as urgent frames of ENABLE_TX_SCHEDULER"
+#endif
+
+#if ENABLE_LOOPBACK_TEST && (ENABLE_FW_UPDATE || ENABLE_TX_COMPRESSION)
+#error "ENABLE_LOOPBACK_TEST checks the data in uart_receive() and needs a plain TX stream"
+#endif
+
+#if ENABLE_TX_SHAPER && !ENABLE_TX_SCHEDULER
+#error "ENABLE_TX_SHAPER needs the non-blocking output of ENABLE_TX_SCHEDULER"
+#endif
+
+#if ENABLE_TX_SCHEDULER && ((TX_SCHED_BULK_FRAME > TX_SCHED_BULK_SIZE) || \
+    (ENABLE_PC_PROFILE && (PC_PROFILE_RECORD_MAX > TX_SCHED_URGENT_SIZE)))
+#error "A frame must fit in the queue of its class, or uart_queue() refuses it"
+#endif
+
+/* Ring buffer storage; with ENABLE_RING_RESIZE two banks that hold the largest ring */
+#if ENABLE_RING_RESIZE
+#define RING_BUFFER_STORAGE_SIZE (DMA_PRODUCER_MAX_BLOCK_SIZE + 1u)
+#else
+#define RING_BUFFER_STORAGE_SIZE RING_BUFFER_SIZE
+#endif
+
+/* Define macro to set the loop count before printing debug messages */
+#if ENABLE_XMC_DEBUG_PRINT
+static bool TRIGGERED = false;
+static bool LOOP_ENTER = false;
+#endif
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+/* Declaration of ring buffer */
+static volatile uint8_t ring_buffer[RING_BUFFER_STORAGE_SIZE];
+uint32_t *dst_ptr = (uint32_t *)&ring_buffer[0];
+
+#if ENABLE_RING_RESIZE
+/* Bank the ring buffer moves to on the next resize */
+static volatile uint8_t ring_buffer_spare[RING_BUFFER_STORAGE_SIZE];
+static volatile uint8_t *ring_buffer_next = ring_buffer_spare;
+
+/* New ring size in bytes, set with the debugger; cleared once the ring has moved */
+volatile uint32_t rx_ring_size_request = 0;
+
+/* CPU cycles of the last resize, all of it with the DMA stopped, read with the debugger */
+volatile uint32_t rx_resize_cycles = 0;
+#endif
+
+/* UART producer of the ring buffer, also holds the consumer state */
+static dma_producer_t rx_producer;
+
+#if ENABLE_TX_COMPRESSION
+/* Compressor state in front of the TX path */
+static lz_stream_encoder_t tx_lz;
+
+/* CPU cycles spent compressing and transmitting, read with the debugger */
+volatile uint32_t tx_lz_cycles = 0;
+volatile uint32_t tx_uart_cycles = 0;
+#endif
+
+#if ENABLE_RX_DECRYPTION
+/* Link key and initial counter block, replace with the values provisioned for the link */
+static const uint8_t RX_AES_KEY[16] =
+{
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const uint8_t RX_AES_IV[16] =
+{
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+
+/* Decryption state, keystream is refilled from the main loop */
+static aes_ctr_t rx_aes;
+
+/* CPU cycles spent decrypting in SysTick and refilling in the main loop, read with the debugger */
+volatile uint32_t rx_aes_cycles = 0;
+volatile uint32_t rx_aes_refill_cycles = 0;
+#endif
+
+#if ENABLE_FW_UPDATE
+/* Update receiver; the FCE kernel computes CRC-32 (IEEE 802.3) of the image */
+static fw_update_t fw_receiver;
+static const XMC_FCE_t fce_crc32 =
+{
+    .kernel_ptr = XMC_FCE_CRC32_0,
+    .fce_cfg_update.config_refin = XMC_FCE_REFIN_SET,
+    .fce_cfg_update.config_refout = XMC_FCE_REFOUT_SET,
+    .fce_cfg_update.config_xsel = XMC_FCE_INVSEL_SET,
+    .seedvalue = 0xFFFFFFFFu
+};
+#endif
+
+#if ENABLE_PROTOCOL_SCANNER
+/* Scanner over the received stream and tokens found per token id, read with the debugger */
+static dfa_t rx_scanner;
+volatile uint32_t rx_tokens[LINE_PROTOCOL_TOKENS + 1];
+#endif
+
+#if ENABLE_EBU_BUFFER
+/* Ring buffer backed by the cold tier, counters read with the debugger */
+static tiered_ring_t rx_tier;
+#endif
+
+#if ENABLE_BAUD_SWITCH
+/* Auto-baud detector fed by the capture interrupt, switch request parser fed by the RX path */
+static autobaud_t rx_autobaud;
+static baud_request_t rx_baud_request;
+
+/* Rates handed from the interrupts to the main loop */
+static volatile uint32_t rx_baud_detected = 0;
+static volatile uint32_t rx_baud_requested = 0;
+#endif
+
+#if ENABLE_BAUD_SWITCH || ENABLE_LOOPBACK_TEST
+/* Current rate of the UART, read with the debugger */
+volatile uint32_t uart_baud_rate = UART_BAUD_RATE;
+#endif
+
+#if ENABLE_TX_COALESCING
+static uint8_t tx_coalesce_buffer[TX_COALESCE_SIZE];
+static tx_coalesce_t tx_batch;
+
+/* Limits taken over at the next tick, may be changed at runtime; the deadline is used in whole ticks */
+volatile uint32_t tx_coalesce_threshold = TX_COALESCE_THRESHOLD;
+volatile uint32_t tx_coalesce_deadline_us = TICKS_WAIT;
+
+/* Set while the main loop sends bytes taken out of the coalescer, SysTick leaves the echo data in the ring */
+static volatile bool tx_coalesce_sending = false;
+#endif
+
+#if ENABLE_TX_SCHEDULER
+static uint8_t tx_urgent_data[TX_SCHED_URGENT_SIZE];
+static tx_sched_frame_t tx_urgent_frames[TX_SCHED_URGENT_FRAMES];
+static uint8_t tx_bulk_data[TX_SCHED_BULK_SIZE];
+static tx_sched_frame_t tx_bulk_frames[TX_SCHED_BULK_FRAMES];
+
+/* Output queues, per-class latency statistics in CPU cycles in tx_queue.queue[].stats */
+tx_sched_t tx_queue;
+#endif
+
+#if ENABLE_RX_BUDGET
+/* Limits per tick, may be changed at runtime */
+volatile uint32_t rx_budget_bytes = RX_BUDGET_BYTES;
+volatile uint32_t rx_budget_cycles = RX_BUDGET_CYCLES;
+
+/* Worst SysTick_Handler duration in CPU cycles, and the largest backlog left for the next tick */
+volatile uint32_t rx_tick_cycles_max = 0;
+volatile uint32_t rx_backlog_max = 0;
+#endif
+
+#if ENABLE_TX_SHAPER
+/* Bucket refilled from CPU cycles, the clock SysTick divides into ticks */
+static token_bucket_t tx_shaper;
+static uint32_t tx_shaper_cycles;
+
+/* Limits taken over at the next tick, may be changed at runtime */
+volatile uint32_t tx_shaper_rate = TX_SHAPER_RATE;
+volatile uint32_t tx_shaper_burst = TX_SHAPER_BURST;
+
+/* Bytes per second let through over the last full second, and since start */
+volatile uint32_t tx_shaper_achieved = 0;
+volatile uint32_t tx_shaper_average = 0;
+#endif
+
+#if ENABLE_IRQ_LATENCY
+/* CPU cycles per CCU4 clock */
+static uint32_t latency_ccu_cycles;
+
+/* Worst time from the event to the first instruction of each handler in CPU cycles, read with the debugger */
+volatile uint32_t irq_latency_systick_max = 0;
+volatile uint32_t irq_latency_autobaud_max = 0;
+volatile uint32_t irq_latency_load_max = 0;
+#endif
+
+#if ENABLE_TICK_HISTOGRAM
+static uint32_t rx_tick_interval_counts[TICK_HISTOGRAM_BINS];
+static uint32_t rx_tick_bytes_counts[TICK_HISTOGRAM_BINS];
+static uint32_t rx_tick_cycles;
+
+/* Interval between SysTick_Handler runs in microseconds and bytes pending at each run, read with
+ * the debugger; set rx_tick_histogram_reset to start over */
+histogram_t rx_tick_interval;
+histogram_t rx_tick_bytes;
+volatile bool rx_tick_histogram_reset = false;
+
+/* Updated every second: the interval 99.9 % of the runs stay within, and the bytes left free in
+ * the ring at the fullest run so far */
+volatile uint32_t rx_tick_interval_p999_us = 0;
+volatile uint32_t rx_ring_headroom = 0;
+#endif
+
+#if ENABLE_PC_PROFILE
+/* Samples per code bucket, sent and cleared by the main loop once PC_PROFILE_SAMPLES are taken */
+static uint16_t pc_profile_counts[PC_PROFILE_BUCKETS];
+static pc_profile_t pc_profiler;
+#endif
+
+#if ENABLE_LOOPBACK_TEST
+static const uint32_t loopback_rates[] = { LOOPBACK_TEST_RATES };
+static uint8_t loopback_block[LOOPBACK_TEST_BLOCK];
+
+/* Received data goes to the sweep instead of the echo path while set */
+static volatile bool loopback_running = false;
+
+/* Sweep and one result per rate, read with the debugger */
+loopback_test_t loopback;
+loopback_step_t loopback_steps[sizeof(loopback_rates) / sizeof(loopback_rates[0])];
+#endif
+
+#if ( ( UC_SERIES == XMC43 ) || ( UC_SERIES == XMC44 ) )
+uint32_t *src_ptr = (uint32_t *)&(XMC_UART1_CH0->RBUF);
+#else
+uint32_t *src_ptr = (uint32_t *)&(XMC_UART0_CH0->RBUF);
+#endif
+
+/* Strings for welcome message */
+const char DELIMITER_STR[] = "************************************************\r\n";
+const char APP_NAME[] = " DMA Ring buffer example\r\n";
+const char APP_HELP1[] = "This example receives data from UART-RX.\r\nData is routed through a DMA ring buffer read by CPU.\r\nFinally the data is sent as echo to UART-TX.\r\n";
+const char APP_HELP2[] = "Just start typing. What you type will be echoed below:\r\n";
+
+#if !ENABLE_TX_SCHEDULER
+/*******************************************************************************
+ * Function Name: uart_transmit
+ ********************************************************************************
+ * Summary:
+ * Helper function to transmit data on the UART.
+ *
+ * Parameters:
+ *  XMC_USIC_CH_t *const channel: Pointer to USIC instance
+ *  const uint8_t *data: Pointer to data for transmission
+ *  uint32_t len: length of data for transmission
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void uart_transmit(XMC_USIC_CH_t *const channel, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i, ++data)
+    {
+        XMC_UART_CH_Transmit(channel, *data);
+    }
+}
+#endif
+
+#if ENABLE_TX_SCHEDULER
+/*******************************************************************************
+ * Function Name: uart_write
+ ********************************************************************************
+ * Summary:
+ * Scheduler writer: fill the transmit buffer as long as it is free, without
+ * waiting for the line. With ENABLE_TX_SHAPER each byte also needs a token.
+ *
+ * Parameters:
+ *  void *context: USIC channel used for transmission
+ *  const uint8_t *data: Pointer to data for transmission
+ *  uint32_t len: length of data for transmission
+ *
+ * Return:
+ *  uint32_t: Number of bytes taken by the USIC
+ *
+ *******************************************************************************/
+static uint32_t uart_write(void *context, const uint8_t *data, uint32_t len)
+{
+    XMC_USIC_CH_t *const channel = (XMC_USIC_CH_t *)context;
+    uint32_t count = 0;
+
+    #if ENABLE_TX_SHAPER
+    uint32_t cycles = DWT->CYCCNT;
+
+    token_bucket_refill(&tx_shaper, cycles - tx_shaper_cycles);
+    tx_shaper_cycles = cycles;
+    #endif
+
+    while ((count < len) && (XMC_USIC_CH_GetTransmitBufferStatus(channel) != XMC_USIC_CH_TBUF_STATUS_BUSY))
+    {
+        #if ENABLE_TX_SHAPER
+        if (token_bucket_take(&tx_shaper, 1u) == 0)
+        {
+            break;
+        }
+        #endif
+        XMC_UART_CH_Transmit(channel, data[count]);
+        ++count;
+    }
+    return count;
+}
+
+/* Move queued output to the USIC; called from the main loop and from SysTick, so
+ * the scheduler is only touched with interrupts disabled. The caller's PRIMASK is
+ * restored rather than interrupts enabled, so a caller's critical section stays closed */
+static void uart_pump(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    tx_sched_pump(&tx_queue, DWT->CYCCNT);
+    __set_PRIMASK(primask);
+}
+
+/*******************************************************************************
+ * Function Name: uart_queue
+ ********************************************************************************
+ * Summary:
+ * Queue data in one class. Bulk data is cut into frames of TX_SCHED_BULK_FRAME
+ * bytes; an urgent frame is queued as a whole. While the class is full the
+ * queue is pumped, which blocks like uart_transmit() until there is room.
+ * An urgent frame larger than TX_SCHED_URGENT_SIZE would never fit; it is
+ * refused and counted as dropped, since splitting it would let echo data in.
+ * Safe to call with interrupts disabled, PRIMASK is saved and restored.
+ *
+ * Parameters:
+ *  tx_sched_class_t cls: TX_SCHED_URGENT or TX_SCHED_BULK
+ *  const uint8_t *data: Pointer to data for transmission
+ *  uint32_t len: length of data for transmission
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void uart_queue(tx_sched_class_t cls, const uint8_t *data, uint32_t len)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    if ((cls == TX_SCHED_URGENT) && (len > TX_SCHED_URGENT_SIZE))
+    {
+        __disable_irq();
+        tx_queue.queue[cls].stats.dropped++;
+        __set_PRIMASK(primask);
+        return;
+    }
+
+    while (len != 0)
+    {
+        uint32_t frame = ((cls == TX_SCHED_BULK) && (len > TX_SCHED_BULK_FRAME)) ? TX_SCHED_BULK_FRAME : len;
+        bool queued;
+
+        __disable_irq();
+        queued = tx_sched_enqueue(&tx_queue, cls, data, frame, DWT->CYCCNT);
+        __set_PRIMASK(primask);
+
+        if (queued)
+        {
+            data += frame;
+            len -= frame;
+        }
+        else
+        {
+            uart_pump();
+        }
+    }
+}
+#endif
+
+/* Bottom of the echo path, queued as bulk data with ENABLE_TX_SCHEDULER */
+static void uart_output(XMC_USIC_CH_t *const channel, const uint8_t *data, uint32_t len)
+{
+#if ENABLE_TX_SCHEDULER
+    (void)channel;
+    uart_queue(TX_SCHED_BULK, data, len);
+#else
+    uart_transmit(channel, data, len);
+#endif
+}
+
+#if ENABLE_FW_UPDATE || ENABLE_BAUD_SWITCH
+/* Control replies, queued ahead of echo data with ENABLE_TX_SCHEDULER */
+static void uart_respond(XMC_USIC_CH_t *const channel, const uint8_t *data, uint32_t len)
+{
+#if ENABLE_TX_SCHEDULER
+    (void)channel;
+    uart_queue(TX_SCHED_URGENT, data, len);
+#else
+    uart_transmit(channel, data, len);
+#endif
+}
+#endif
+
+#if ENABLE_PC_PROFILE
+/* Profile records, each queued as one urgent frame so it goes out whole between echo data,
+ * without blocking SysTick or disabling interrupts for the transmission */
+static void uart_report(XMC_USIC_CH_t *const channel, const uint8_t *data, uint32_t len)
+{
+    (void)channel;
+    uart_queue(TX_SCHED_URGENT, data, len);
+}
+#endif
+
+#if ENABLE_TX_COALESCING
+/* Coalescer output, one call per batch */
+static void uart_batch_sink(void *context, const uint8_t *data, uint32_t len)
+{
+    uart_output((XMC_USIC_CH_t *)context, data, len);
+}
+
+/* Hold limit in ticks, the granularity of tx_coalesce_tick(): rounded up, at least one tick */
+static uint32_t tx_coalesce_deadline_ticks(void)
+{
+    uint32_t tick_us = 1000000u / TICKS_PER_SECOND;
+    uint32_t ticks = (tx_coalesce_deadline_us + tick_us - 1u) / tick_us;
+
+    return (ticks != 0) ? ticks : 1u;
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: uart_send
+ ********************************************************************************
+ * Summary:
+ * Output of the echo path. With ENABLE_TX_COALESCING the data is held and
+ * sent in batches, otherwise it is transmitted at once.
+ *
+ * Parameters:
+ *  XMC_USIC_CH_t *const channel: Pointer to USIC instance
+ *  const uint8_t *data: Pointer to data for transmission
+ *  uint32_t len: length of data for transmission
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void uart_send(XMC_USIC_CH_t *const channel, const uint8_t *data, uint32_t len)
+{
+#if ENABLE_TX_COALESCING
+    (void)channel;
+    tx_coalesce_write(&tx_batch, data, len);
+#else
+    uart_output(channel, data, len);
+#endif
+}
+
+#if ENABLE_TX_COMPRESSION
+/*******************************************************************************
+ * Function Name: uart_lz_sink
+ ********************************************************************************
+ * Summary:
+ * Compressor output handler, transmits the tokens on the UART. The cycles
+ * spent here are counted separately so tx_lz_cycles holds only the
+ * compression cost.
+ *
+ * Parameters:
+ *  void *context: USIC channel used for transmission
+ *  const uint8_t *data: Pointer to compressed data
+ *  uint32_t len: length of compressed data
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void uart_lz_sink(void *context, const uint8_t *data, uint32_t len)
+{
+    uint32_t cycles = DWT->CYCCNT;
+
+    uart_send((XMC_USIC_CH_t *)context, data, len);
+    tx_uart_cycles += DWT->CYCCNT - cycles;
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: uart_echo
+ ********************************************************************************
+ * Summary:
+ * Ring buffer handler that sends each received segment back to the UART.
+ * With ENABLE_TX_COMPRESSION the segment is compressed on the way.
+ *
+ * Parameters:
+ *  void *context: USIC channel used for transmission
+ *  const uint8_t *data: Pointer to received data
+ *  uint32_t len: length of received data
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void uart_echo(void *context, const uint8_t *data, uint32_t len)
+{
+#if ENABLE_TX_COMPRESSION
+    uint32_t cycles = DWT->CYCCNT;
+    uint32_t transmit = tx_uart_cycles;
+
+    (void)context;
+    lz_stream_compress(&tx_lz, data, len);
+    tx_lz_cycles += (DWT->CYCCNT - cycles) - (tx_uart_cycles - transmit);
+#else
+    uart_send((XMC_USIC_CH_t *)context, data, len);
+#endif
+}
+
+#if !ENABLE_FW_UPDATE
+#if ENABLE_PROTOCOL_SCANNER
+/*******************************************************************************
+ * Function Name: count_token
+ ********************************************************************************
+ * Summary:
+ * Scanner handler, counts the tokens found in the received stream.
+ *
+ * Parameters:
+ *  void *context: Unused
+ *  uint8_t token: Token id from line_protocol_dfa.h
+ *  const uint8_t *end: Last byte of the token
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void count_token(void *context, uint8_t token, const uint8_t *end)
+{
+    (void)context;
+    (void)end;
+    rx_tokens[token]++;
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: uart_receive
+ ********************************************************************************
+ * Summary:
+ * Ring buffer handler for received segments. Runs the optional RX stages
+ * (decryption, protocol scanner) and echoes the result. The DMA does not
+ * write to the unread part of the ring, so a stage may modify the segment
+ * in place until the consumer moves on.
+ *
+ * Parameters:
+ *  void *context: USIC channel used for transmission
+ *  const uint8_t *data: Pointer to received data inside the ring buffer
+ *  uint32_t len: length of received data
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+static void uart_receive(void *context, const uint8_t *data, uint32_t len)
+{
+#if ENABLE_BAUD_SWITCH
+    uint32_t rate;
+#endif
+#if ENABLE_LOOPBACK_TEST
+    if (loopback_running)
+    {
+        loopback_test_receive(&loopback, data, len, DWT->CYCCNT);
+        return;
+    }
+#endif
+#if ENABLE_RX_DECRYPTION
+    uint32_t cycles = DWT->CYCCNT;
+
+    aes_ctr_xor(&rx_aes, (uint8_t *)data, len);
+    rx_aes_cycles += DWT->CYCCNT - cycles;
+#endif
+
+#if ENABLE_PROTOCOL_SCANNER
+    dfa_scan(&rx_scanner, data, len, count_token, NULL);
+#endif
+
+#if ENABLE_BAUD_SWITCH
+    /* The switch itself waits for the UART, so it runs in the main loop */
+    rate = baud_request_scan(&rx_baud_request, data, len);
+    if (rate != 0)
+    {
+        rx_baud_requested = rate;
+    }
+#endif
+
+    uart_echo(context, data, len);
+}
+#endif
+
+#if ENABLE_FW_UPDATE
+/*******************************************************************************
+ * Function Name: flash_erase
+ ********************************************************************************
+ * Summary:
+ * Update backend: erase the sectors covering the image. Blocks for the erase
+ * time, so it is only called from the main loop.
+ *
+ *******************************************************************************/
+static void flash_erase(void *context, uint32_t address, uint32_t length)
+{
+    (void)context;
+    for (uint32_t offset = 0; offset < length; offset += FW_UPDATE_SECTOR_SIZE)
+    {
+        XMC_FLASH_EraseSector((uint32_t *)(uintptr_t)(address + offset));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: flash_program
+ ********************************************************************************
+ * Summary:
+ * Update backend: load one page into the assembly buffer and start the write
+ * command. Unlike XMC_FLASH_ProgramPage() it returns without waiting for the
+ * flash, and the DMA keeps filling the ring in the meantime.
+ *
+ *******************************************************************************/
+static void flash_program(void *context, uint32_t address, const uint32_t *page)
+{
+    (void)context;
+    XMC_FLASH_ClearStatus();
+    XMC_FLASH_EnterPageModeCommand();
+    for (uint32_t i = 0; i < (FW_UPDATE_PAGE_SIZE / 4u); i += 2u)
+    {
+        XMC_FLASH_LoadPageCommand(page[i], page[i + 1u]);
+    }
+    XMC_FLASH_WritePageCommand((uint32_t *)(uintptr_t)address);
+}
+
+static bool flash_busy(void *context)
+{
+    (void)context;
+    return XMC_FLASH_IsBusy();
+}
+
+static void fce_reset(void *context)
+{
+    (void)context;
+    XMC_FCE_InitializeSeedValue(&fce_crc32, fce_crc32.seedvalue);
+}
+
+/*******************************************************************************
+ * Function Name: fce_update
+ ********************************************************************************
+ * Summary:
+ * Update backend: feed words to the FCE. The kernel takes the most significant
+ * byte of IR first, so each word is byte swapped to process the image in
+ * memory order, which gives the standard CRC-32 computed by host/fw_send.
+ *
+ *******************************************************************************/
+static void fce_update(void *context, const uint32_t *data, uint32_t words)
+{
+    (void)context;
+    for (uint32_t i = 0; i < words; ++i)
+    {
+        fce_crc32.kernel_ptr->IR = __REV(data[i]);
+    }
+}
+
+static uint32_t fce_result(void *context)
+{
+    uint32_t result;
+
+    (void)context;
+    XMC_FCE_GetCRCResult(&fce_crc32, &result);
+    return result;
+}
+
+static const fw_update_ops_t fw_update_ops =
+{
+    flash_erase, flash_program, flash_busy, fce_reset, fce_update, fce_result
+};
+#endif
+
+#if ENABLE_EBU_BUFFER
+/*******************************************************************************
+ * Function Name: spill_copy
+ ********************************************************************************
+ * Summary:
+ * Tiered ring backend: start a memory-to-memory block on the spill channel.
+ * The channel is configured once in main(); only addresses and length
+ * change per copy, and it disables itself when the block is done.
+ *
+ *******************************************************************************/
+static void spill_copy(void *context, volatile uint8_t *dst, const uint8_t *src, uint32_t len)
+{
+    (void)context;
+    XMC_DMA_CH_SetSourceAddress(XMC_DMA0, GPDMA_CHANNEL_SPILL, (uint32_t)(uintptr_t)src);
+    XMC_DMA_CH_SetDestinationAddress(XMC_DMA0, GPDMA_CHANNEL_SPILL, (uint32_t)(uintptr_t)dst);
+    XMC_DMA_CH_SetBlockSize(XMC_DMA0, GPDMA_CHANNEL_SPILL, len);
+    XMC_DMA_CH_Enable(XMC_DMA0, GPDMA_CHANNEL_SPILL);
+}
+
+static bool spill_busy(void *context)
+{
+    (void)context;
+    return XMC_DMA_CH_IsEnabled(XMC_DMA0, GPDMA_CHANNEL_SPILL);
+}
+
+static const tiered_ring_ops_t spill_ops = { spill_copy, spill_busy };
+
+static const XMC_DMA_CH_CONFIG_t spill_config =
+{
+    .src_transfer_width = (uint32_t)XMC_DMA_CH_TRANSFER_WIDTH_8,
+    .dst_transfer_width = (uint32_t)XMC_DMA_CH_TRANSFER_WIDTH_8,
+    .src_address_count_mode = (uint32_t)XMC_DMA_CH_ADDRESS_COUNT_MODE_INCREMENT,
+    .dst_address_count_mode = (uint32_t)XMC_DMA_CH_ADDRESS_COUNT_MODE_INCREMENT,
+    .src_burst_length = (uint32_t)XMC_DMA_CH_BURST_LENGTH_8,
+    .dst_burst_length = (uint32_t)XMC_DMA_CH_BURST_LENGTH_8,
+    .transfer_flow = (uint32_t)XMC_DMA_CH_TRANSFER_FLOW_M2M_DMA,
+    .block_size = 1,
+    .transfer_type = XMC_DMA_CH_TRANSFER_TYPE_SINGLE_BLOCK,
+    .priority = XMC_DMA_CH_PRIORITY_0,
+    .src_handshaking = XMC_DMA_CH_SRC_HANDSHAKING_SOFTWARE,
+    .dst_handshaking = XMC_DMA_CH_DST_HANDSHAKING_SOFTWARE
+};
+#endif
+
+/*******************************************************************************
+ * Function Name: nvic_priority_init
+ ********************************************************************************
+ * Summary:
+ * Apply the priority plan of the data path. Sources that are not enabled get
+ * their priority too, so enabling them later keeps the plan. Must run after
+ * SysTick_Config(), which sets SysTick to the lowest priority.
+ *
+ *******************************************************************************/
+static void nvic_priority_init(void)
+{
+    NVIC_SetPriorityGrouping(NVIC_PRIORITY_GROUPING);
+    NVIC_SetPriority(AUTOBAUD_IRQn, NVIC_EncodePriority(NVIC_PRIORITY_GROUPING, PRIORITY_AUTOBAUD, 0));
+    NVIC_SetPriority(DMA_IRQn, NVIC_EncodePriority(NVIC_PRIORITY_GROUPING, PRIORITY_DMA, 0));
+    NVIC_SetPriority(UART_IRQn, NVIC_EncodePriority(NVIC_PRIORITY_GROUPING, PRIORITY_USIC, 1));
+    NVIC_SetPriority(SysTick_IRQn, NVIC_EncodePriority(NVIC_PRIORITY_GROUPING, PRIORITY_SYSTICK, 0));
+    #if ENABLE_IRQ_LATENCY
+    NVIC_SetPriority(LATENCY_LOAD_IRQn, NVIC_EncodePriority(NVIC_PRIORITY_GROUPING, PRIORITY_LATENCY_LOAD, 0));
+    #endif
+    #if ENABLE_PC_PROFILE
+    NVIC_SetPriority(PC_PROFILE_IRQn, NVIC_EncodePriority(NVIC_PRIORITY_GROUPING, PRIORITY_PC_PROFILE, 2));
+    #endif
+}
+
+#if ENABLE_IRQ_LATENCY
+static void latency_record(volatile uint32_t *worst, uint32_t cycles)
+{
+    if (cycles > *worst)
+    {
+        *worst = cycles;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: LATENCY_LOAD_IRQHandler
+ ********************************************************************************
+ * Summary:
+ * Period match of the load slice. The timer restarted from 0 at the match, so
+ * its value on entry is the latency of this handler. Then the CPU is kept
+ * busy for LATENCY_LOAD_CYCLES.
+ *
+ *******************************************************************************/
+void LATENCY_LOAD_IRQHandler(void)
+{
+    uint32_t cycles = DWT->CYCCNT;
+
+    latency_record(&irq_latency_load_max, XMC_CCU4_SLICE_GetTimerValue(LATENCY_LOAD_SLICE) * latency_ccu_cycles);
+    XMC_CCU4_SLICE_ClearEvent(LATENCY_LOAD_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+    while ((DWT->CYCCNT - cycles) < LATENCY_LOAD_CYCLES)
+    {
+    }
+}
+
+/*******************************************************************************
+ * Function Name: latency_load_start
+ ********************************************************************************
+ * Summary:
+ * Run the load slice as an edge-aligned timer with a period match interrupt
+ * every LATENCY_LOAD_PERIOD CCU4 clocks.
+ *
+ *******************************************************************************/
+static void latency_load_start(void)
+{
+    static const XMC_CCU4_SLICE_COMPARE_CONFIG_t compare_config =
+    {
+        .timer_mode = XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
+        .monoshot = XMC_CCU4_SLICE_TIMER_REPEAT_MODE_REPEAT,
+        .prescaler_initval = XMC_CCU4_SLICE_PRESCALER_1,
+    };
+
+    latency_ccu_cycles = SystemCoreClock / XMC_SCU_CLOCK_GetCcuClockFrequency();
+
+    XMC_CCU4_Init(LATENCY_LOAD_CCU4, XMC_CCU4_SLICE_MCMS_ACTION_TRANSFER_PR_CR);
+    XMC_CCU4_SLICE_CompareInit(LATENCY_LOAD_SLICE, &compare_config);
+    XMC_CCU4_SLICE_SetTimerPeriodMatch(LATENCY_LOAD_SLICE, LATENCY_LOAD_PERIOD - 1u);
+    XMC_CCU4_EnableShadowTransfer(LATENCY_LOAD_CCU4, (uint32_t)XMC_CCU4_SHADOW_TRANSFER_SLICE_1);
+
+    XMC_CCU4_SLICE_EnableEvent(LATENCY_LOAD_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+    XMC_CCU4_SLICE_SetInterruptNode(LATENCY_LOAD_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, XMC_CCU4_SLICE_SR_ID_1);
+    NVIC_EnableIRQ(LATENCY_LOAD_IRQn);
+
+    XMC_CCU4_EnableClock(LATENCY_LOAD_CCU4, LATENCY_LOAD_SLICE_NUMBER);
+    XMC_CCU4_SLICE_StartTimer(LATENCY_LOAD_SLICE);
+}
+#endif
+
+#if ENABLE_PC_PROFILE
+/*******************************************************************************
+ * Function Name: PC_PROFILE_IRQHandler
+ ********************************************************************************
+ * Summary:
+ * Period match of the sampling slice. Passes the exception frame of the
+ * interrupted code, on the main or the process stack, to pc_profile_tick()
+ * before anything else is pushed.
+ *
+ *******************************************************************************/
+__attribute__((naked)) void PC_PROFILE_IRQHandler(void)
+{
+    __asm volatile
+    (
+        "tst lr, #4         \n"
+        "ite eq             \n"
+        "mrseq r0, msp      \n"
+        "mrsne r0, psp      \n"
+        "b pc_profile_tick  \n"
+    );
+}
+
+/* Second half of PC_PROFILE_IRQHandler; the frame holds r0-r3, r12, lr, pc and xpsr */
+void pc_profile_tick(const uint32_t *frame)
+{
+    XMC_CCU4_SLICE_ClearEvent(PC_PROFILE_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+    pc_profile_sample(&pc_profiler, frame[6]);
+}
+
+/*******************************************************************************
+ * Function Name: pc_profile_start
+ ********************************************************************************
+ * Summary:
+ * Run the sampling slice as an edge-aligned timer with a period match
+ * interrupt every PC_PROFILE_PERIOD CCU4 clocks.
+ *
+ *******************************************************************************/
+static void pc_profile_start(void)
+{
+    static const XMC_CCU4_SLICE_COMPARE_CONFIG_t compare_config =
+    {
+        .timer_mode = XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
+        .monoshot = XMC_CCU4_SLICE_TIMER_REPEAT_MODE_REPEAT,
+        .prescaler_initval = XMC_CCU4_SLICE_PRESCALER_1,
+    };
+
+    pc_profile_init(&pc_profiler, pc_profile_counts, PC_PROFILE_BUCKETS, PC_PROFILE_BASE, PC_PROFILE_SIZE,
+                    PC_PROFILE_SAMPLES);
+
+    XMC_CCU4_Init(PC_PROFILE_CCU4, XMC_CCU4_SLICE_MCMS_ACTION_TRANSFER_PR_CR);
+    XMC_CCU4_SLICE_CompareInit(PC_PROFILE_SLICE, &compare_config);
+    XMC_CCU4_SLICE_SetTimerPeriodMatch(PC_PROFILE_SLICE, PC_PROFILE_PERIOD - 1u);
+    XMC_CCU4_EnableShadowTransfer(PC_PROFILE_CCU4, (uint32_t)XMC_CCU4_SHADOW_TRANSFER_SLICE_2);
+
+    XMC_CCU4_SLICE_EnableEvent(PC_PROFILE_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+    XMC_CCU4_SLICE_SetInterruptNode(PC_PROFILE_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, XMC_CCU4_SLICE_SR_ID_2);
+    NVIC_EnableIRQ(PC_PROFILE_IRQn);
+
+    XMC_CCU4_EnableClock(PC_PROFILE_CCU4, PC_PROFILE_SLICE_NUMBER);
+    XMC_CCU4_SLICE_StartTimer(PC_PROFILE_SLICE);
+}
+#endif
+
+#if ENABLE_BAUD_SWITCH
+/*******************************************************************************
+ * Function Name: AUTOBAUD_IRQHandler
+ ********************************************************************************
+ * Summary:
+ * Capture interrupt of the auto-baud slice. Falling edges of the RX pin are
+ * captured by event 0 into CC4yC1V, rising edges by event 1 into CC4yC3V.
+ * Each edge needs one interrupt, which limits detection to about 1 Mbaud;
+ * faster rates are reached with a switch request.
+ *
+ *******************************************************************************/
+void AUTOBAUD_IRQHandler(void)
+{
+    #if ENABLE_IRQ_LATENCY
+    /* The captures hold the timer at the edges, so the difference is the latency */
+    uint32_t now = XMC_CCU4_SLICE_GetTimerValue(AUTOBAUD_SLICE);
+    uint32_t oldest = 0;
+    #endif
+    uint32_t rate = 0;
+    uint32_t captured;
+
+    if (XMC_CCU4_SLICE_GetEvent(AUTOBAUD_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT0))
+    {
+        XMC_CCU4_SLICE_ClearEvent(AUTOBAUD_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT0);
+        captured = XMC_CCU4_SLICE_GetCaptureRegisterValue(AUTOBAUD_SLICE, 1u);
+        rate = autobaud_edge(&rx_autobaud, captured);
+        #if ENABLE_IRQ_LATENCY
+        oldest = (now - captured) & 0xFFFFu;
+        #endif
+    }
+    if (XMC_CCU4_SLICE_GetEvent(AUTOBAUD_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT1))
+    {
+        XMC_CCU4_SLICE_ClearEvent(AUTOBAUD_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT1);
+        captured = XMC_CCU4_SLICE_GetCaptureRegisterValue(AUTOBAUD_SLICE, 3u);
+        rate = autobaud_edge(&rx_autobaud, captured);
+        #if ENABLE_IRQ_LATENCY
+        oldest = (((now - captured) & 0xFFFFu) > oldest) ? ((now - captured) & 0xFFFFu) : oldest;
+        #endif
+    }
+    #if ENABLE_IRQ_LATENCY
+    latency_record(&irq_latency_autobaud_max, (oldest << AUTOBAUD_PRESCALER) * latency_ccu_cycles);
+    #endif
+
+    if ((rate != 0) && (rx_baud_detected == 0))
+    {
+        rx_baud_detected = rate;
+    }
+}
 
-/* Define macro to enable/disable printing of debug messages */
-#define ENABLE_XMC_DEBUG_PRINT (0)
+/*******************************************************************************
+ * Function Name: autobaud_start
+ ********************************************************************************
+ * Summary:
+ * Run the auto-baud slice as a free-running 16-bit timer that captures both
+ * edges of the RX pin.
+ *
+ *******************************************************************************/
+static void autobaud_start(void)
+{
+    static const XMC_CCU4_SLICE_CAPTURE_CONFIG_t capture_config =
+    {
+        .fifo_enable = false,
+        .timer_clear_mode = XMC_CCU4_SLICE_TIMER_CLEAR_MODE_NEVER,
+        .same_event = false,
+        .ignore_full_flag = true,
+        .prescaler_mode = XMC_CCU4_SLICE_PRESCALER_MODE_NORMAL,
+        .prescaler_initval = AUTOBAUD_PRESCALER,
+        .float_limit = 0,
+        .timer_concatenation = false
+    };
+    static const XMC_CCU4_SLICE_EVENT_CONFIG_t falling_edge =
+    {
+        .mapped_input = AUTOBAUD_INPUT,
+        .edge = XMC_CCU4_SLICE_EVENT_EDGE_SENSITIVITY_FALLING_EDGE,
+        .level = XMC_CCU4_SLICE_EVENT_LEVEL_SENSITIVITY_ACTIVE_HIGH,
+        .duration = XMC_CCU4_SLICE_EVENT_FILTER_DISABLED
+    };
+    static const XMC_CCU4_SLICE_EVENT_CONFIG_t rising_edge =
+    {
+        .mapped_input = AUTOBAUD_INPUT,
+        .edge = XMC_CCU4_SLICE_EVENT_EDGE_SENSITIVITY_RISING_EDGE,
+        .level = XMC_CCU4_SLICE_EVENT_LEVEL_SENSITIVITY_ACTIVE_HIGH,
+        .duration = XMC_CCU4_SLICE_EVENT_FILTER_DISABLED
+    };
 
-/* Define macro to set the loop count before printing debug messages */
-#if ENABLE_XMC_DEBUG_PRINT
-static bool TRIGGERED = false;
-static bool LOOP_ENTER = false;
+    autobaud_init(&rx_autobaud, XMC_SCU_CLOCK_GetCcuClockFrequency() >> AUTOBAUD_PRESCALER, 0xFFFFu);
+
+    XMC_CCU4_Init(AUTOBAUD_CCU4, XMC_CCU4_SLICE_MCMS_ACTION_TRANSFER_PR_CR);
+    XMC_CCU4_SLICE_CaptureInit(AUTOBAUD_SLICE, &capture_config);
+    XMC_CCU4_SLICE_ConfigureEvent(AUTOBAUD_SLICE, XMC_CCU4_SLICE_EVENT_0, &falling_edge);
+    XMC_CCU4_SLICE_ConfigureEvent(AUTOBAUD_SLICE, XMC_CCU4_SLICE_EVENT_1, &rising_edge);
+    XMC_CCU4_SLICE_Capture0Config(AUTOBAUD_SLICE, XMC_CCU4_SLICE_EVENT_0);
+    XMC_CCU4_SLICE_Capture1Config(AUTOBAUD_SLICE, XMC_CCU4_SLICE_EVENT_1);
+    XMC_CCU4_SLICE_SetTimerPeriodMatch(AUTOBAUD_SLICE, 0xFFFFu);
+    XMC_CCU4_EnableShadowTransfer(AUTOBAUD_CCU4, (uint32_t)XMC_CCU4_SHADOW_TRANSFER_SLICE_0);
+
+    XMC_CCU4_SLICE_EnableEvent(AUTOBAUD_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT0);
+    XMC_CCU4_SLICE_EnableEvent(AUTOBAUD_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT1);
+    XMC_CCU4_SLICE_SetInterruptNode(AUTOBAUD_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT0, XMC_CCU4_SLICE_SR_ID_0);
+    XMC_CCU4_SLICE_SetInterruptNode(AUTOBAUD_SLICE, XMC_CCU4_SLICE_IRQ_ID_EVENT1, XMC_CCU4_SLICE_SR_ID_0);
+    NVIC_EnableIRQ(AUTOBAUD_IRQn);
+
+    XMC_CCU4_EnableClock(AUTOBAUD_CCU4, AUTOBAUD_SLICE_NUMBER);
+    XMC_CCU4_SLICE_StartTimer(AUTOBAUD_SLICE);
+}
 #endif
 
+#if ENABLE_BAUD_SWITCH || ENABLE_LOOPBACK_TEST
+/* Rates the USIC baud rate generator can produce with UART_OVERSAMPLING */
+static bool uart_baud_rate_valid(uint32_t rate)
+{
+    return (rate >= 1200u) && (rate <= (XMC_SCU_CLOCK_GetPeripheralClockFrequency() / UART_OVERSAMPLING));
+}
+
+static void discard(void *context, const uint8_t *data, uint32_t len)
+{
+    (void)context;
+    (void)data;
+    (void)len;
+}
+
+#if ENABLE_TX_COALESCING
 /*******************************************************************************
- * Global Variables
+ * Function Name: uart_send_held
+ ********************************************************************************
+ * Summary:
+ * Send the bytes held by the coalescer from the main loop, e.g. before a
+ * response that must not overtake them. SysTick ticks the same coalescer, so
+ * the bytes are taken out with interrupts disabled and sent with interrupts
+ * enabled. Until they are out, SysTick leaves the received data in the ring,
+ * so the echo of later data cannot overtake them. The ring takes the data
+ * that arrives meanwhile: at most TX_COALESCE_SIZE bytes are sent, at the
+ * rate the data comes in.
+ *
  *******************************************************************************/
-/* Declaration of ring buffer */
-static volatile uint8_t ring_buffer[RING_BUFFER_SIZE];
-uint32_t *dst_ptr = (uint32_t *)&ring_buffer[0];
+static void uart_send_held(void)
+{
+    static uint8_t held[TX_COALESCE_SIZE];
+    uint32_t len;
 
-#if ( ( UC_SERIES == XMC43 ) || ( UC_SERIES == XMC44 ) )
-uint32_t *src_ptr = (uint32_t *)&(XMC_UART1_CH0->RBUF);
-#else
-uint32_t *src_ptr = (uint32_t *)&(XMC_UART0_CH0->RBUF);
-#endif
+    __disable_irq();
+    len = tx_coalesce_take(&tx_batch, held);
+    tx_coalesce_sending = (len != 0);
+    __enable_irq();
 
-/* Strings for welcome message */
-const char DELIMITER_STR[] = "************************************************\r\n";
-const char APP_NAME[] = " DMA Ring buffer example\r\n";
-const char APP_HELP1[] = "This example receives data from UART-RX.\r\nData is routed through a DMA ring buffer read by CPU.\r\nFinally the data is sent as echo to UART-TX.\r\n";
-const char APP_HELP2[] = "Just start typing. What you type will be echoed below:\r\n";
+    if (len != 0)
+    {
+        uart_output(CYBSP_DEBUG_UART_HW, held, len);
+        tx_coalesce_sending = false;
+    }
+}
+#endif
 
 /*******************************************************************************
- * Function Name: uart_transmit
+ * Function Name: uart_set_baud_rate
  ********************************************************************************
  * Summary:
- * Helper function to transmit data on the UART.
+ * Switch the UART to a new rate between frames. The last frame is let out of
+ * the shift register first, and the switch runs with interrupts disabled so
+ * SysTick never sees the ring between two rates. With flush, the ring is
+ * emptied: it holds sync characters misframed at the old rate. With
+ * ENABLE_RING_RESIZE the ring is resized to hold four ticks at the new rate.
  *
  * Parameters:
- *  XMC_USIC_CH_t *const channel: Pointer to USIC instance
- *  const uint8_t *data: Pointer to data for transmission
- *  uint32_t len: length of data for transmission
+ *  uint32_t rate: New rate in bit/s
+ *  bool flush: Discard the unread data in the ring
  *
  * Return:
- *  void
+ *  bool: false if the USIC cannot generate the rate, the old rate is kept
  *
  *******************************************************************************/
-static void uart_transmit(XMC_USIC_CH_t *const channel, const uint8_t *data, uint32_t len)
+static bool uart_set_baud_rate(uint32_t rate, bool flush)
 {
-    for (uint32_t i = 0; i < len; ++i, ++data)
+    bool ok;
+
+    if (!uart_baud_rate_valid(rate))
     {
-        XMC_UART_CH_Transmit(channel, *data);
+        return false;
+    }
+
+    #if ENABLE_TX_COALESCING
+    /* Held bytes belong to the old rate */
+    uart_send_held();
+    #endif
+    #if ENABLE_TX_SCHEDULER
+    /* Let the response out at the old rate */
+    while (tx_sched_pending(&tx_queue, TX_SCHED_URGENT) != 0)
+    {
+        uart_pump();
+    }
+    #endif
+
+    while (XMC_USIC_CH_GetTransmitBufferStatus(CYBSP_DEBUG_UART_HW) == XMC_USIC_CH_TBUF_STATUS_BUSY)
+    {
+    }
+    while ((XMC_UART_CH_GetStatusFlag(CYBSP_DEBUG_UART_HW) & XMC_UART_CH_STATUS_FLAG_TRANSMISSION_IDLE) == 0)
+    {
+    }
+
+    __disable_irq();
+    ok = (XMC_UART_CH_SetBaudrate(CYBSP_DEBUG_UART_HW, rate, UART_OVERSAMPLING) == XMC_UART_CH_STATUS_OK);
+    if (!ok)
+    {
+        XMC_UART_CH_SetBaudrate(CYBSP_DEBUG_UART_HW, uart_baud_rate, UART_OVERSAMPLING);
+    }
+    if (flush)
+    {
+        ring_buffer_consume(&rx_producer.ring, dma_producer_position(&rx_producer), discard, NULL);
+    }
+    __enable_irq();
+
+    if (ok)
+    {
+        uart_baud_rate = rate;
+        #if ENABLE_RING_RESIZE
+        {
+            uint32_t size = 4u * (rate / 10u / TICKS_PER_SECOND);
+            size = (size < RING_BUFFER_SIZE) ? RING_BUFFER_SIZE : size;
+            rx_ring_size_request = (size > DMA_PRODUCER_MAX_BLOCK_SIZE) ? DMA_PRODUCER_MAX_BLOCK_SIZE : size;
+        }
+        #endif
+    }
+    return ok;
+}
+#endif
+
+#if ENABLE_LOOPBACK_TEST
+static bool loopback_set_rate(void *context, uint32_t rate)
+{
+    (void)context;
+    return uart_set_baud_rate(rate, true);
+}
+
+/*******************************************************************************
+ * Function Name: loopback_transmit
+ ********************************************************************************
+ * Summary:
+ * Loopback test backend: send a block of the pattern by DMA. The transmit
+ * buffer is empty, so its event will not come for the first byte; a software
+ * service request stands in for it.
+ *
+ *******************************************************************************/
+static void loopback_transmit(void *context, const uint8_t *data, uint32_t len)
+{
+    (void)context;
+    XMC_DMA_CH_SetSourceAddress(XMC_DMA0, GPDMA_CHANNEL_LOOPBACK, (uint32_t)(uintptr_t)data);
+    XMC_DMA_CH_SetBlockSize(XMC_DMA0, GPDMA_CHANNEL_LOOPBACK, len);
+    XMC_DMA_CH_Enable(XMC_DMA0, GPDMA_CHANNEL_LOOPBACK);
+    XMC_USIC_CH_TriggerServiceRequest(CYBSP_DEBUG_UART_HW, LOOPBACK_TX_SR);
+}
+
+/* Busy until the last byte of the block has left the transmit buffer, so the
+ * next block cannot overwrite it */
+static bool loopback_busy(void *context)
+{
+    (void)context;
+    return XMC_DMA_CH_IsEnabled(XMC_DMA0, GPDMA_CHANNEL_LOOPBACK) ||
+           (XMC_USIC_CH_GetTransmitBufferStatus(CYBSP_DEBUG_UART_HW) == XMC_USIC_CH_TBUF_STATUS_BUSY);
+}
+
+static const loopback_test_ops_t loopback_ops = { loopback_set_rate, loopback_transmit, loopback_busy };
+
+/* Result text from the main loop while SysTick echoes: held echo data is sent first, see
+ * uart_send_held(), then the text bypasses the coalescer */
+static void loopback_report(const char *text, int len)
+{
+    #if ENABLE_TX_COALESCING
+    uart_send_held();
+    #endif
+    uart_output(CYBSP_DEBUG_UART_HW, (const uint8_t *)text, (uint32_t)len);
+}
+
+/*******************************************************************************
+ * Function Name: loopback_test_run
+ ********************************************************************************
+ * Summary:
+ * Run the loopback sweep with the receive path of the echo: the DMA ring and
+ * the SysTick consumer, with uart_receive() handing the data to the checker.
+ * The line is taken over once the welcome message is out and given back at
+ * UART_BAUD_RATE, followed by a summary of the fastest rate without errors
+ * and the step that failed.
+ *
+ *******************************************************************************/
+static void loopback_test_run(void)
+{
+    XMC_DMA_CH_CONFIG_t tx_config =
+    {
+        .src_transfer_width = (uint32_t)XMC_DMA_CH_TRANSFER_WIDTH_8,
+        .dst_transfer_width = (uint32_t)XMC_DMA_CH_TRANSFER_WIDTH_8,
+        .src_address_count_mode = (uint32_t)XMC_DMA_CH_ADDRESS_COUNT_MODE_INCREMENT,
+        .dst_address_count_mode = (uint32_t)XMC_DMA_CH_ADDRESS_COUNT_MODE_NO_CHANGE,
+        .src_burst_length = (uint32_t)XMC_DMA_CH_BURST_LENGTH_1,
+        .dst_burst_length = (uint32_t)XMC_DMA_CH_BURST_LENGTH_1,
+        .transfer_flow = (uint32_t)XMC_DMA_CH_TRANSFER_FLOW_M2P_DMA,
+        .dst_addr = (uint32_t)(uintptr_t)&CYBSP_DEBUG_UART_HW->TBUF[0],
+        .block_size = 1,
+        .transfer_type = XMC_DMA_CH_TRANSFER_TYPE_SINGLE_BLOCK,
+        .priority = XMC_DMA_CH_PRIORITY_0,
+        .src_handshaking = XMC_DMA_CH_SRC_HANDSHAKING_SOFTWARE,
+        .dst_handshaking = XMC_DMA_CH_DST_HANDSHAKING_HARDWARE,
+        .dst_peripheral_request = LOOPBACK_TX_REQUEST
+    };
+    const loopback_step_t *best;
+    const loopback_step_t *failed;
+    char text[128];
+    int len;
+
+    #if ENABLE_TX_COALESCING
+    uart_send_held();
+    #endif
+    #if ENABLE_TX_SCHEDULER
+    while ((tx_sched_pending(&tx_queue, TX_SCHED_URGENT) + tx_sched_pending(&tx_queue, TX_SCHED_BULK)) != 0)
+    {
+        uart_pump();
+    }
+    #endif
+    #if ENABLE_BAUD_SWITCH
+    /* Pattern edges on a wired RX pin are no sync characters */
+    NVIC_DisableIRQ(AUTOBAUD_IRQn);
+    #endif
+
+    XMC_DMA_CH_Init(XMC_DMA0, GPDMA_CHANNEL_LOOPBACK, &tx_config);
+    XMC_USIC_CH_SetInterruptNodePointer(CYBSP_DEBUG_UART_HW, XMC_USIC_CH_INTERRUPT_NODE_POINTER_TRANSMIT_BUFFER,
+                                        LOOPBACK_TX_SR);
+    XMC_USIC_CH_EnableEvent(CYBSP_DEBUG_UART_HW, XMC_USIC_CH_EVENT_TRANSMIT_BUFFER);
+    #if LOOPBACK_TEST_INTERNAL
+    XMC_UART_CH_SetInputSource(CYBSP_DEBUG_UART_HW, XMC_UART_CH_INPUT_RXD, LOOPBACK_INPUT);
+    #endif
+
+    loopback_test_init(&loopback, &loopback_ops, NULL, loopback_rates, loopback_steps,
+                       sizeof(loopback_rates) / sizeof(loopback_rates[0]), loopback_block, sizeof(loopback_block),
+                       SystemCoreClock, LOOPBACK_TEST_STEP_MS);
+    loopback_running = true;
+    loopback_test_start(&loopback, DWT->CYCCNT);
+    while (loopback_test_service(&loopback, DWT->CYCCNT))
+    {
+    }
+    loopback_running = false;
+
+    XMC_USIC_CH_DisableEvent(CYBSP_DEBUG_UART_HW, XMC_USIC_CH_EVENT_TRANSMIT_BUFFER);
+    #if LOOPBACK_TEST_INTERNAL
+    XMC_UART_CH_SetInputSource(CYBSP_DEBUG_UART_HW, XMC_UART_CH_INPUT_RXD, UART_RX_INPUT);
+    #endif
+    uart_set_baud_rate(UART_BAUD_RATE, true);
+    #if ENABLE_BAUD_SWITCH
+    NVIC_ClearPendingIRQ(AUTOBAUD_IRQn);
+    NVIC_EnableIRQ(AUTOBAUD_IRQn);
+    #endif
+
+    best = loopback_test_best(&loopback);
+    failed = loopback_test_failed(&loopback);
+    if (best != NULL)
+    {
+        len = snprintf(text, sizeof(text), "Loopback test: %lu baud, %lu B/s without errors\r\n",
+                       (unsigned long)best->rate, (unsigned long)best->throughput);
+    }
+    else
+    {
+        len = snprintf(text, sizeof(text), "Loopback test: no rate without errors\r\n");
+    }
+    loopback_report(text, len);
+    if (failed != NULL)
+    {
+        len = snprintf(text, sizeof(text),
+                       "Failed at %lu baud: %lu bit errors in %lu bits, %lu slips, %lu of %lu B received\r\n",
+                       (unsigned long)failed->rate, (unsigned long)failed->errors, (unsigned long)failed->bits,
+                       (unsigned long)failed->slips, (unsigned long)failed->received, (unsigned long)failed->sent);
+        loopback_report(text, len);
     }
 }
+#endif
 
 /*******************************************************************************
  * Function Name: SysTick_Handler
@@ -126,37 +1502,174 @@ static void uart_transmit(XMC_USIC_CH_t *const channel, const uint8_t *data, uin
  *******************************************************************************/
 void SysTick_Handler(void)
 {
-    static uint32_t start = 0;
+    #if ENABLE_IRQ_LATENCY
+    /* The counter reloaded when the tick became pending and has counted down since */
+    latency_record(&irq_latency_systick_max, SysTick->LOAD - SysTick->VAL);
+    #endif
+
+    #if ENABLE_TICK_HISTOGRAM
+    /* Interval since the previous run, before anything in this run can delay the reading */
+    {
+        uint32_t cycles = DWT->CYCCNT;
+
+        if (rx_tick_histogram_reset)
+        {
+            histogram_reset(&rx_tick_interval);
+            histogram_reset(&rx_tick_bytes);
+            rx_tick_histogram_reset = false;
+        }
+        else
+        {
+            histogram_add(&rx_tick_interval, (cycles - rx_tick_cycles) / (SystemCoreClock / 1000000u));
+        }
+        rx_tick_cycles = cycles;
+    }
+    #endif
+
+    #if ENABLE_TX_COALESCING
+    /* The main loop is sending bytes it took out of the coalescer, see uart_send_held():
+     * the received data waits in the ring, as for a late tick */
+    if (tx_coalesce_sending)
+    {
+        return;
+    }
+    #endif
+
+    #if ENABLE_RX_BUDGET
+    uint32_t tick_start = DWT->CYCCNT;
+    #endif
+
+    #if ENABLE_RING_RESIZE
+    /* Move to the requested ring size; retried on the next tick while the backlog is too large.
+     * The backlog is sent first, so the blackout only covers the restart: without a FIFO, RBUF
+     * overruns if the channel is stopped for longer than one character */
+    if (rx_ring_size_request != 0)
+    {
+        uint32_t cycles = DWT->CYCCNT;
+
+        if (dma_producer_resize(&rx_producer, ring_buffer_next, rx_ring_size_request, uart_receive,
+                                CYBSP_DEBUG_UART_HW))
+        {
+            rx_resize_cycles = DWT->CYCCNT - cycles;
+            ring_buffer_next = (ring_buffer_next == ring_buffer) ? ring_buffer_spare : ring_buffer;
+            rx_ring_size_request = 0;
+        }
+    }
+    #endif
+
+    #if ENABLE_TX_SHAPER
+    /* Take over changed limits and report the rate of each second */
+    {
+        static uint32_t ticks = 0;
+        static uint64_t granted = 0;
+
+        __disable_irq();
+        token_bucket_configure(&tx_shaper, tx_shaper_rate, tx_shaper_burst);
+        __enable_irq();
+        if (++ticks == TICKS_PER_SECOND)
+        {
+            tx_shaper_achieved = (uint32_t)(tx_shaper.granted - granted);
+            tx_shaper_average = token_bucket_achieved(&tx_shaper);
+            granted = tx_shaper.granted;
+            ticks = 0;
+        }
+    }
+    #endif
+
+    #if ENABLE_TX_COALESCING
+    /* Take over changed limits and send the batch whose deadline expired,
+     * before this tick adds to it */
+    tx_batch.threshold = tx_coalesce_threshold;
+    tx_batch.deadline = tx_coalesce_deadline_ticks();
+    tx_coalesce_tick(&tx_batch, 1u);
+    #endif
 
     /* Get pointer to last byte written by DMA to ringbuffer */
-    uint32_t end = XMC_DMA_CH_GetTransferredData(XMC_DMA0, GPDMA_CHANNEL_2);
+    uint32_t end = dma_producer_position(&rx_producer);
 
-    /* Did the pointer proceed in the meanwhile? */
-    if (start != end)
+    #if ENABLE_TICK_HISTOGRAM
     {
-        /* Has the ring buffer overflowed ? */
-        if (start < end)
+        static uint32_t ticks = 0;
+
+        histogram_add(&rx_tick_bytes, ring_buffer_pending(&rx_producer.ring, end));
+        if (++ticks == TICKS_PER_SECOND)
         {
-            /* Process input data in linear buffer phase */
-            uart_transmit(CYBSP_DEBUG_UART_HW, (const uint8_t *)& ring_buffer[start], end - start);
+            uint32_t usable = rx_producer.ring.size - 1u;
+
+            rx_tick_interval_p999_us = histogram_percentile(&rx_tick_interval, 999u);
+            rx_ring_headroom = (rx_tick_bytes.max < usable) ? (usable - rx_tick_bytes.max) : 0u;
+            ticks = 0;
         }
-        else
+    }
+    #endif
+
+    #if ENABLE_FW_UPDATE
+    /* Take the update data that fits in the page buffers, the rest waits in the ring */
+    {
+        const uint8_t *data;
+        uint32_t len;
+
+        while ((len = ring_buffer_peek(&rx_producer.ring, end, &data)) != 0)
+        {
+            uint32_t taken = fw_update_write(&fw_receiver, data, len);
+            ring_buffer_advance(&rx_producer.ring, taken);
+            if (taken < len)
+            {
+                break;
+            }
+        }
+        fw_update_service(&fw_receiver);
+    }
+    #elif ENABLE_EBU_BUFFER
+    /* Spill the backlog to the cold tier, then send what the uplink takes in this tick */
+    {
+        uint32_t budget = RX_UPLINK_BYTES_PER_TICK;
+        const uint8_t *data;
+        uint32_t len;
+
+        tiered_ring_service(&rx_tier, end);
+        while ((budget != 0) && ((len = tiered_ring_peek(&rx_tier, end, &data)) != 0))
         {
-            /* Send received data to UART
-             * In overflow mode we have to process twice:
-             *  - Process data until end of buffer
-             *  - Process data until current position on top of buffer
-             */
-            uart_transmit(CYBSP_DEBUG_UART_HW, (const uint8_t *)&ring_buffer[start], RING_BUFFER_SIZE - start);
-            uart_transmit(CYBSP_DEBUG_UART_HW, (const uint8_t *)&ring_buffer[0], end);
+            len = (len < budget) ? len : budget;
+            uart_receive(CYBSP_DEBUG_UART_HW, data, len);
+            tiered_ring_advance(&rx_tier, len);
+            budget -= len;
         }
+    }
+    #elif ENABLE_RX_BUDGET
+    /* Send received data to UART up to the byte and cycle budget of the tick */
+    {
+        uint32_t budget = rx_budget_bytes;
+        uint32_t cycles = rx_budget_cycles;
+        uint32_t backlog;
+        uint32_t taken;
 
-        /* Set start pointer to the last read data */
-        start = end;
+        do
+        {
+            uint32_t chunk = (budget < RX_BUDGET_CHUNK) ? budget : RX_BUDGET_CHUNK;
+
+            taken = ring_buffer_consume_max(&rx_producer.ring, end, chunk, uart_receive, CYBSP_DEBUG_UART_HW);
+            budget -= taken;
+        } while ((taken != 0) && (budget != 0) && ((cycles == 0) || ((DWT->CYCCNT - tick_start) < cycles)));
+
+        backlog = ring_buffer_pending(&rx_producer.ring, end);
+        rx_backlog_max = (backlog > rx_backlog_max) ? backlog : rx_backlog_max;
     }
+    #else
+    /* Send received data to UART */
+    ring_buffer_consume(&rx_producer.ring, end, uart_receive, CYBSP_DEBUG_UART_HW);
+    #endif
+
     #if ENABLE_XMC_DEBUG_PRINT
         TRIGGERED = true;
     #endif
+
+    #if ENABLE_RX_BUDGET
+    {
+        uint32_t cycles = DWT->CYCCNT - tick_start;
+        rx_tick_cycles_max = (cycles > rx_tick_cycles_max) ? cycles : rx_tick_cycles_max;
+    }
+    #endif
 }
 
 /*******************************************************************************
@@ -183,25 +1696,208 @@ int main(void)
     cybsp_init();
     cy_retarget_io_init(CYBSP_DEBUG_UART_HW);
 
+    #if ENABLE_TX_COMPRESSION || ENABLE_RX_DECRYPTION || ENABLE_RING_RESIZE || ENABLE_TX_SCHEDULER || \
+        ENABLE_RX_BUDGET || ENABLE_IRQ_LATENCY || ENABLE_TICK_HISTOGRAM || ENABLE_LOOPBACK_TEST
+    /* Start the cycle counter used for the per-stage cycle statistics */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    #endif
+
+    #if ENABLE_TICK_HISTOGRAM
+    histogram_init(&rx_tick_interval, rx_tick_interval_counts, TICK_HISTOGRAM_BINS, TICK_INTERVAL_BIN_US);
+    histogram_init(&rx_tick_bytes, rx_tick_bytes_counts, TICK_HISTOGRAM_BINS, TICK_BYTES_BIN);
+    #endif
+
+    #if ENABLE_TX_SCHEDULER
+    tx_sched_init(&tx_queue, uart_write, CYBSP_DEBUG_UART_HW);
+    tx_sched_class_init(&tx_queue, TX_SCHED_URGENT, tx_urgent_data, sizeof(tx_urgent_data), tx_urgent_frames,
+                        TX_SCHED_URGENT_FRAMES);
+    tx_sched_class_init(&tx_queue, TX_SCHED_BULK, tx_bulk_data, sizeof(tx_bulk_data), tx_bulk_frames,
+                        TX_SCHED_BULK_FRAMES);
+    #endif
+
+    #if ENABLE_TX_SHAPER
+    token_bucket_init(&tx_shaper, tx_shaper_rate, tx_shaper_burst, SystemCoreClock);
+    tx_shaper_cycles = DWT->CYCCNT;
+    #endif
+
+    #if ENABLE_TX_COALESCING
+    tx_coalesce_init(&tx_batch, tx_coalesce_buffer, sizeof(tx_coalesce_buffer), uart_batch_sink,
+                     CYBSP_DEBUG_UART_HW, tx_coalesce_threshold, tx_coalesce_deadline_ticks());
+    #endif
+
+    #if ENABLE_TX_COMPRESSION
+    /* Compress everything sent from here on */
+    lz_stream_encoder_init(&tx_lz, uart_lz_sink, CYBSP_DEBUG_UART_HW);
+    #endif
+
+    #if ENABLE_RX_DECRYPTION
+    /* Fill the keystream ring before the first byte can arrive */
+    aes_ctr_init(&rx_aes, RX_AES_KEY, RX_AES_IV);
+    aes_ctr_refill(&rx_aes);
+    #endif
+
+    #if ENABLE_PROTOCOL_SCANNER
+    LINE_PROTOCOL_DFA_INIT(&rx_scanner);
+    #endif
+
+    #if ENABLE_FW_UPDATE
+    XMC_FCE_Enable();
+    XMC_FCE_Init(&fce_crc32);
+    fw_update_init(&fw_receiver, &fw_update_ops, NULL, FW_UPDATE_SLOT_ADDRESS, FW_UPDATE_SLOT_SIZE);
+    #endif
+
     #if ENABLE_XMC_DEBUG_PRINT
         printf("Init complete\r\n");
     #else
     /* Show welcome message on terminal during initialization */
-    uart_transmit(CYBSP_DEBUG_UART_HW, (const uint8_t *)DELIMITER_STR, sizeof(DELIMITER_STR));
-    uart_transmit(CYBSP_DEBUG_UART_HW, (const uint8_t *)APP_NAME, sizeof(APP_NAME));
-    uart_transmit(CYBSP_DEBUG_UART_HW, (const uint8_t *)DELIMITER_STR, sizeof(DELIMITER_STR));
-    uart_transmit(CYBSP_DEBUG_UART_HW, (const uint8_t *)APP_HELP1, sizeof(APP_HELP1));
-    uart_transmit(CYBSP_DEBUG_UART_HW, (const uint8_t *)APP_HELP2, sizeof(APP_HELP2));
+    uart_echo(CYBSP_DEBUG_UART_HW, (const uint8_t *)DELIMITER_STR, sizeof(DELIMITER_STR));
+    uart_echo(CYBSP_DEBUG_UART_HW, (const uint8_t *)APP_NAME, sizeof(APP_NAME));
+    uart_echo(CYBSP_DEBUG_UART_HW, (const uint8_t *)DELIMITER_STR, sizeof(DELIMITER_STR));
+    uart_echo(CYBSP_DEBUG_UART_HW, (const uint8_t *)APP_HELP1, sizeof(APP_HELP1));
+    uart_echo(CYBSP_DEBUG_UART_HW, (const uint8_t *)APP_HELP2, sizeof(APP_HELP2));
+    #endif
+
+    /* Take over the channel set up by the Device Configurator and attach the
+     * consumer to the ring buffer before DMA starts filling it */
+    dma_producer_attach(&rx_producer, XMC_DMA0, GPDMA_CHANNEL_2, XMC_DMA_CH_TRANSFER_WIDTH_8,
+                        ring_buffer, RING_BUFFER_SIZE);
+
+    #if ENABLE_BAUD_SWITCH
+    /* Listen for sync characters until the first one sets the rate */
+    baud_request_init(&rx_baud_request);
+    autobaud_start();
+    #endif
+
+    #if ENABLE_EBU_BUFFER
+    /* Spill once half of the ring buffer is unread, in blocks of up to 4095 bytes */
+    XMC_DMA_CH_Init(XMC_DMA0, GPDMA_CHANNEL_SPILL, &spill_config);
+    tiered_ring_init(&rx_tier, &rx_producer.ring, &spill_ops, NULL, (volatile uint8_t *)EBU_RING_ADDRESS,
+                     EBU_RING_SIZE, RING_BUFFER_SIZE / 2u, DMA_PRODUCER_MAX_BLOCK_SIZE);
     #endif
 
     /* Enable DMA module */
-    XMC_DMA_CH_Enable(XMC_DMA0, GPDMA_CHANNEL_2);
+    dma_producer_start(&rx_producer);
 
     /* System timer configuration */
+    #if ENABLE_TICK_HISTOGRAM
+    rx_tick_cycles = DWT->CYCCNT;
+    #endif
     SysTick_Config(SystemCoreClock / TICKS_PER_SECOND);
+    nvic_priority_init();
+
+    #if ENABLE_LOOPBACK_TEST
+    /* Before the synthetic load and the profiler, which would share the line or the CPU */
+    loopback_test_run();
+    #endif
+
+    #if ENABLE_IRQ_LATENCY
+    latency_load_start();
+    #endif
+
+    #if ENABLE_PC_PROFILE
+    pc_profile_start();
+    #endif
 
     while (1)
         {
+        #if ENABLE_TX_SCHEDULER
+            /* Feed the USIC whenever its transmit buffer is free */
+            uart_pump();
+        #endif
+
+        #if ENABLE_IRQ_LATENCY
+            /* Synthetic load: interrupts disabled as long as the longest critical section of the TX path */
+            {
+                uint32_t start = DWT->CYCCNT;
+
+                __disable_irq();
+                while ((DWT->CYCCNT - start) < LATENCY_CRITICAL_CYCLES)
+                {
+                }
+                __enable_irq();
+            }
+        #endif
+
+        #if ENABLE_PC_PROFILE
+            /* Send the full histogram, unchanged while sampling is paused, then start the next one */
+            if (pc_profile_full(&pc_profiler))
+            {
+                uint8_t record[PC_PROFILE_RECORD_MAX];
+                uint32_t cursor = 0;
+                uint32_t len;
+
+                NVIC_DisableIRQ(PC_PROFILE_IRQn);
+                while ((len = pc_profile_record(&pc_profiler, &cursor, record)) != 0)
+                {
+                    uart_report(CYBSP_DEBUG_UART_HW, record, len);
+                }
+                pc_profile_reset(&pc_profiler);
+                NVIC_EnableIRQ(PC_PROFILE_IRQn);
+            }
+        #endif
+
+        #if ENABLE_RX_DECRYPTION
+            /* Idle time: keep the keystream ring full so SysTick only XORs */
+            uint32_t cycles = DWT->CYCCNT;
+            if (aes_ctr_refill(&rx_aes) != 0)
+            {
+                rx_aes_refill_cycles += DWT->CYCCNT - cycles;
+            }
+        #endif
+
+        #if ENABLE_FW_UPDATE
+            /* Erase requested by a valid update header, then let the host stream the image */
+            if (fw_update_poll(&fw_receiver))
+            {
+                const uint8_t response = FW_UPDATE_RESPONSE_READY;
+                uart_respond(CYBSP_DEBUG_UART_HW, &response, 1);
+            }
+            if ((fw_receiver.state == FW_UPDATE_DONE) || (fw_receiver.state == FW_UPDATE_FAILED))
+            {
+                const uint8_t response = (fw_receiver.state == FW_UPDATE_DONE) ? FW_UPDATE_RESPONSE_OK
+                                                                               : FW_UPDATE_RESPONSE_ERROR;
+                uart_respond(CYBSP_DEBUG_UART_HW, &response, 1);
+
+                /* Accept the next update; SysTick must not see the receiver half initialized */
+                __disable_irq();
+                fw_update_init(&fw_receiver, &fw_update_ops, NULL, FW_UPDATE_SLOT_ADDRESS, FW_UPDATE_SLOT_SIZE);
+                __enable_irq();
+            }
+        #endif
+        #if ENABLE_BAUD_SWITCH
+            /* Auto-baud: adopt the rate of the host, once */
+            if (rx_baud_detected != 0)
+            {
+                NVIC_DisableIRQ(AUTOBAUD_IRQn);
+                XMC_CCU4_SLICE_StopTimer(AUTOBAUD_SLICE);
+                if (rx_baud_detected != uart_baud_rate)
+                {
+                    uart_set_baud_rate(rx_baud_detected, true);
+                }
+                rx_baud_detected = 0;
+            }
+            /* Switch request: answer at the old rate, the host changes its rate once it has the answer */
+            if (rx_baud_requested != 0)
+            {
+                uint32_t rate = rx_baud_requested;
+                uint8_t response[BAUD_RATE_REQUEST_SIZE];
+                bool valid = uart_baud_rate_valid(rate);
+
+                baud_rate_response(response, valid ? BAUD_RATE_ACCEPT : BAUD_RATE_REJECT, rate);
+                #if ENABLE_TX_COALESCING
+                /* The response must not overtake held echo data */
+                uart_send_held();
+                #endif
+                uart_respond(CYBSP_DEBUG_UART_HW, response, sizeof(response));
+                if (valid)
+                {
+                    uart_set_baud_rate(rate, false);
+                }
+                rx_baud_requested = 0;
+            }
+        #endif
         #if ENABLE_XMC_DEBUG_PRINT
             if(TRIGGERED && !LOOP_ENTER)
             {
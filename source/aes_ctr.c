@@ -0,0 +1,343 @@
+/******************************************************************************
+ * File Name:   aes_ctr.c
+ *
+ * Description: AES-128 in counter mode for payloads received through the DMA
+ *              ring buffer. aes_ctr_refill() runs in the idle loop and fills the
+ *              keystream ring, aes_ctr_xor() runs in the SysTick handler and
+ *              only falls back to computing a block when the ring runs dry.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "aes_ctr.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define KEYSTREAM_MASK (AES_CTR_KEYSTREAM_SIZE - 1u)
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static const uint8_t sbox[256] =
+{
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+static inline uint8_t xtime(uint8_t x)
+{
+    return (uint8_t)((x << 1) ^ ((x & 0x80u) ? 0x1bu : 0x00u));
+}
+
+/*******************************************************************************
+ * Function Name: aes128_expand_key
+ ********************************************************************************
+ * Summary:
+ * Compute the eleven AES-128 round keys (FIPS-197, section 5.2).
+ *
+ * Parameters:
+ *  uint8_t round_keys[]: Receives the expanded key
+ *  const uint8_t key[]: 128-bit cipher key
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void aes128_expand_key(uint8_t round_keys[AES_ROUND_KEYS_SIZE], const uint8_t key[16])
+{
+    uint8_t rcon = 0x01u;
+
+    memcpy(round_keys, key, 16u);
+    for (uint32_t i = 16u; i < AES_ROUND_KEYS_SIZE; i += 4u)
+    {
+        uint8_t t[4] = { round_keys[i - 4u], round_keys[i - 3u], round_keys[i - 2u], round_keys[i - 1u] };
+
+        if ((i % 16u) == 0u)
+        {
+            uint8_t first = t[0];
+            t[0] = (uint8_t)(sbox[t[1]] ^ rcon);
+            t[1] = sbox[t[2]];
+            t[2] = sbox[t[3]];
+            t[3] = sbox[first];
+            rcon = xtime(rcon);
+        }
+        for (uint32_t k = 0; k < 4u; ++k)
+        {
+            round_keys[i + k] = round_keys[i + k - 16u] ^ t[k];
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: aes128_encrypt_block
+ ********************************************************************************
+ * Summary:
+ * Encrypt one block. Byte oriented, no tables besides the S-box, so it fits
+ * the SRAM budget of the XMC.
+ *
+ * Parameters:
+ *  const uint8_t round_keys[]: Key expanded with aes128_expand_key()
+ *  const uint8_t in[]: Plaintext block
+ *  uint8_t out[]: Ciphertext block, may be the same as in
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void aes128_encrypt_block(const uint8_t round_keys[AES_ROUND_KEYS_SIZE], const uint8_t in[AES_BLOCK_SIZE],
+                          uint8_t out[AES_BLOCK_SIZE])
+{
+    uint8_t s[AES_BLOCK_SIZE];
+
+    for (uint32_t i = 0; i < AES_BLOCK_SIZE; ++i)
+    {
+        s[i] = in[i] ^ round_keys[i];
+    }
+
+    for (uint32_t round = 1u; round <= 10u; ++round)
+    {
+        uint8_t t[AES_BLOCK_SIZE];
+
+        /* SubBytes and ShiftRows, the state is stored column by column */
+        for (uint32_t c = 0; c < 4u; ++c)
+        {
+            for (uint32_t r = 0; r < 4u; ++r)
+            {
+                t[(c * 4u) + r] = sbox[s[(((c + r) % 4u) * 4u) + r]];
+            }
+        }
+
+        /* MixColumns, skipped in the last round */
+        if (round != 10u)
+        {
+            for (uint32_t c = 0; c < 16u; c += 4u)
+            {
+                uint8_t a0 = t[c];
+                uint8_t a1 = t[c + 1u];
+                uint8_t a2 = t[c + 2u];
+                uint8_t a3 = t[c + 3u];
+                uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+
+                t[c] = a0 ^ all ^ xtime(a0 ^ a1);
+                t[c + 1u] = a1 ^ all ^ xtime(a1 ^ a2);
+                t[c + 2u] = a2 ^ all ^ xtime(a2 ^ a3);
+                t[c + 3u] = a3 ^ all ^ xtime(a3 ^ a0);
+            }
+        }
+
+        for (uint32_t i = 0; i < AES_BLOCK_SIZE; ++i)
+        {
+            s[i] = t[i] ^ round_keys[(round * AES_BLOCK_SIZE) + i];
+        }
+    }
+    memcpy(out, s, AES_BLOCK_SIZE);
+}
+
+/*******************************************************************************
+ * Function Name: keystream_block
+ ********************************************************************************
+ * Summary:
+ * Keystream block for a stream position: the IV, treated as a 128-bit big
+ * endian counter, plus the block index, encrypted with the key.
+ *
+ *******************************************************************************/
+static void keystream_block(const aes_ctr_t *ctr, uint32_t position, uint8_t out[AES_BLOCK_SIZE])
+{
+    uint8_t counter[AES_BLOCK_SIZE];
+    uint32_t carry = position / AES_BLOCK_SIZE;
+
+    for (uint32_t i = AES_BLOCK_SIZE; i-- > 0u;)
+    {
+        carry += ctr->iv[i];
+        counter[i] = (uint8_t)carry;
+        carry >>= 8;
+    }
+    aes128_encrypt_block(ctr->round_keys, counter, out);
+}
+
+/*******************************************************************************
+ * Function Name: aes_ctr_init
+ ********************************************************************************
+ * Summary:
+ * Set key and initial counter block. The stream position starts at zero with
+ * an empty keystream ring. A key/IV pair covers 4 GB of stream.
+ *
+ * Parameters:
+ *  aes_ctr_t *ctr: Decryption stage
+ *  const uint8_t key[]: 128-bit key
+ *  const uint8_t iv[]: Initial counter block
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void aes_ctr_init(aes_ctr_t *ctr, const uint8_t key[16], const uint8_t iv[AES_BLOCK_SIZE])
+{
+    aes128_expand_key(ctr->round_keys, key);
+    memcpy(ctr->iv, iv, AES_BLOCK_SIZE);
+    ctr->produced = 0;
+    ctr->consumed = 0;
+    ctr->misses = 0;
+}
+
+/*******************************************************************************
+ * Function Name: aes_ctr_refill
+ ********************************************************************************
+ * Summary:
+ * Generate keystream until the ring is full. Meant for the idle loop; it may
+ * be interrupted by aes_ctr_xor() at any point. A block is published only
+ * after it is complete, and if the consumer overtook the refill with inline
+ * blocks, the refill continues from the consumer's position.
+ *
+ * Parameters:
+ *  aes_ctr_t *ctr: Decryption stage
+ *
+ * Return:
+ *  uint32_t: Number of blocks generated
+ *
+ *******************************************************************************/
+uint32_t aes_ctr_refill(aes_ctr_t *ctr)
+{
+    uint32_t blocks = 0;
+
+    for (;;)
+    {
+        uint32_t consumed = ctr->consumed;
+        uint32_t position = ctr->produced;
+
+        if ((int32_t)(position - consumed) < 0)
+        {
+            position = consumed & ~(AES_BLOCK_SIZE - 1u);
+        }
+        if ((int32_t)((position + AES_BLOCK_SIZE) - consumed) > (int32_t)AES_CTR_KEYSTREAM_SIZE)
+        {
+            break;
+        }
+
+        keystream_block(ctr, position, &ctr->keystream[position & KEYSTREAM_MASK]);
+        __asm volatile ("" ::: "memory");
+        ctr->produced = position + AES_BLOCK_SIZE;
+        ++blocks;
+    }
+    return blocks;
+}
+
+/*******************************************************************************
+ * Function Name: aes_ctr_xor
+ ********************************************************************************
+ * Summary:
+ * Decrypt (or encrypt) data in place. Consecutive calls continue the stream,
+ * so a segment split at the wrap of the DMA ring, or over several ticks,
+ * decrypts the same as one piece. Keystream that is not ready yet is
+ * computed on the spot and counted in misses.
+ *
+ * Parameters:
+ *  aes_ctr_t *ctr: Decryption stage
+ *  uint8_t *data: Data to transform
+ *  uint32_t len: Length of data
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void aes_ctr_xor(aes_ctr_t *ctr, uint8_t *data, uint32_t len)
+{
+    uint32_t position = ctr->consumed;
+    uint32_t produced = ctr->produced;
+
+    while (len != 0u)
+    {
+        if ((int32_t)(produced - position) > 0)
+        {
+            /* Hot path: XOR with precomputed keystream up to the ring end */
+            uint32_t run = produced - position;
+            uint32_t offset = position & KEYSTREAM_MASK;
+
+            if (run > len)
+            {
+                run = len;
+            }
+            if (run > (AES_CTR_KEYSTREAM_SIZE - offset))
+            {
+                run = AES_CTR_KEYSTREAM_SIZE - offset;
+            }
+            for (uint32_t i = 0; i < run; ++i)
+            {
+                data[i] ^= ctr->keystream[offset + i];
+            }
+            data += run;
+            len -= run;
+            position += run;
+        }
+        else
+        {
+            uint8_t block[AES_BLOCK_SIZE];
+            uint32_t offset = position & (AES_BLOCK_SIZE - 1u);
+            uint32_t run = AES_BLOCK_SIZE - offset;
+
+            keystream_block(ctr, position, block);
+            ctr->misses++;
+            if (run > len)
+            {
+                run = len;
+            }
+            for (uint32_t i = 0; i < run; ++i)
+            {
+                data[i] ^= block[offset + i];
+            }
+            data += run;
+            len -= run;
+            position += run;
+        }
+    }
+    ctr->consumed = position;
+}
+
+/* [] END OF FILE */
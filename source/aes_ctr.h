@@ -0,0 +1,83 @@
+/******************************************************************************
+ * File Name:   aes_ctr.h
+ *
+ * Description: AES-128 in counter mode for payloads received through the DMA
+ *              ring buffer. The keystream is generated ahead of time into a
+ *              small ring, so decrypting a received segment in the SysTick
+ *              handler is a plain XOR.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef AES_CTR_H
+#define AES_CTR_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define AES_BLOCK_SIZE 16u
+#define AES_ROUND_KEYS_SIZE 176u
+
+/* Precomputed keystream, must be a power of two multiple of the block size */
+#ifndef AES_CTR_KEYSTREAM_SIZE
+#define AES_CTR_KEYSTREAM_SIZE 512u
+#endif
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint8_t round_keys[AES_ROUND_KEYS_SIZE];
+    uint8_t iv[AES_BLOCK_SIZE];
+    uint8_t keystream[AES_CTR_KEYSTREAM_SIZE];
+    volatile uint32_t produced;     /* Stream position up to which keystream is ready */
+    volatile uint32_t consumed;     /* Stream position of the next byte to decrypt */
+    uint32_t misses;                /* Blocks generated on the hot path */
+} aes_ctr_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void aes128_expand_key(uint8_t round_keys[AES_ROUND_KEYS_SIZE], const uint8_t key[16]);
+void aes128_encrypt_block(const uint8_t round_keys[AES_ROUND_KEYS_SIZE], const uint8_t in[AES_BLOCK_SIZE],
+                          uint8_t out[AES_BLOCK_SIZE]);
+void aes_ctr_init(aes_ctr_t *ctr, const uint8_t key[16], const uint8_t iv[AES_BLOCK_SIZE]);
+uint32_t aes_ctr_refill(aes_ctr_t *ctr);
+void aes_ctr_xor(aes_ctr_t *ctr, uint8_t *data, uint32_t len);
+
+#endif /* AES_CTR_H */
+
+/* [] END OF FILE */
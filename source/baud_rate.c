@@ -0,0 +1,233 @@
+/******************************************************************************
+ * File Name:   baud_rate.c
+ *
+ * Description: Baud rate negotiation helpers. The detector only needs edge
+ *              times from a free-running capture timer, so any timer that
+ *              captures both edges of the RX pin can feed it.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include "baud_rate.h"
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+static const uint32_t standard_rates[] =
+{
+    9600u, 19200u, 38400u, 57600u, 115200u, 230400u, 460800u, 500000u, 921600u,
+    1000000u, 1500000u, 2000000u, 3000000u, 4000000u, 6000000u
+};
+
+/*******************************************************************************
+ * Function Name: autobaud_init
+ ********************************************************************************
+ * Summary:
+ * Reset the detector.
+ *
+ * Parameters:
+ *  autobaud_t *ab: Detector instance
+ *  uint32_t clock: Capture timer frequency in Hz
+ *  uint32_t mask: Largest timer value; edge intervals are taken modulo mask + 1
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void autobaud_init(autobaud_t *ab, uint32_t clock, uint32_t mask)
+{
+    ab->clock = clock;
+    ab->mask = mask;
+    ab->count = 0;
+}
+
+/*******************************************************************************
+ * Function Name: autobaud_edge
+ ********************************************************************************
+ * Summary:
+ * Add the time of an RX edge, either polarity. A sync character shows up as
+ * nine equal intervals; each must be within 1/8 of their mean, plus two
+ * timer ticks of capture quantization, which no other character produces. Back-to-back sync characters also match, since
+ * the stop and start bits continue the pattern.
+ *
+ * Parameters:
+ *  autobaud_t *ab: Detector instance
+ *  uint32_t timestamp: Capture timer value of the edge
+ *
+ * Return:
+ *  uint32_t: Detected rate in bit/s, snapped to a standard rate when close,
+ *            or 0 while no sync character has been seen
+ *
+ *******************************************************************************/
+uint32_t autobaud_edge(autobaud_t *ab, uint32_t timestamp)
+{
+    uint32_t span;
+    uint32_t first;
+
+    /* Keep the last BAUD_RATE_SYNC_EDGES edges in a sliding window */
+    ab->edges[ab->count % BAUD_RATE_SYNC_EDGES] = timestamp;
+    ab->count++;
+    if (ab->count < BAUD_RATE_SYNC_EDGES)
+    {
+        return 0;
+    }
+
+    first = ab->edges[ab->count % BAUD_RATE_SYNC_EDGES];
+    span = (timestamp - first) & ab->mask;
+    if (span < (BAUD_RATE_SYNC_EDGES - 1u))
+    {
+        return 0;
+    }
+
+    for (uint32_t i = 1; i < BAUD_RATE_SYNC_EDGES; ++i)
+    {
+        uint32_t from = ab->edges[(ab->count + i - 1u) % BAUD_RATE_SYNC_EDGES];
+        uint32_t to = ab->edges[(ab->count + i) % BAUD_RATE_SYNC_EDGES];
+        /* Compare interval * 9 with the span to avoid a division */
+        uint32_t scaled = ((to - from) & ab->mask) * (BAUD_RATE_SYNC_EDGES - 1u);
+        uint32_t diff = (scaled > span) ? (scaled - span) : (span - scaled);
+
+        if (diff > ((span / 8u) + (2u * (BAUD_RATE_SYNC_EDGES - 1u))))
+        {
+            return 0;
+        }
+    }
+
+    return baud_rate_snap((uint32_t)(((uint64_t)ab->clock * (BAUD_RATE_SYNC_EDGES - 1u) + (span / 2u)) / span));
+}
+
+/*******************************************************************************
+ * Function Name: baud_rate_snap
+ ********************************************************************************
+ * Summary:
+ * Round a measured rate to the nearest standard rate within
+ * BAUD_RATE_SNAP_PERCENT.
+ *
+ * Parameters:
+ *  uint32_t rate: Measured rate in bit/s
+ *
+ * Return:
+ *  uint32_t: Standard rate, or rate itself if none is close
+ *
+ *******************************************************************************/
+uint32_t baud_rate_snap(uint32_t rate)
+{
+    for (uint32_t i = 0; i < (sizeof(standard_rates) / sizeof(standard_rates[0])); ++i)
+    {
+        uint32_t standard = standard_rates[i];
+        uint32_t diff = (rate > standard) ? (rate - standard) : (standard - rate);
+
+        if (((uint64_t)diff * 100u) <= ((uint64_t)standard * BAUD_RATE_SNAP_PERCENT))
+        {
+            return standard;
+        }
+    }
+    return rate;
+}
+
+void baud_request_init(baud_request_t *req)
+{
+    req->fill = 0;
+}
+
+/*******************************************************************************
+ * Function Name: baud_request_scan
+ ********************************************************************************
+ * Summary:
+ * Look for a switch request in received data. The parser state carries over
+ * between segments, so a request may be split anywhere.
+ *
+ * Parameters:
+ *  baud_request_t *req: Parser instance
+ *  const uint8_t *data: Received data
+ *  uint32_t len: Length of received data
+ *
+ * Return:
+ *  uint32_t: Requested rate of the last complete request in data, or 0
+ *
+ *******************************************************************************/
+uint32_t baud_request_scan(baud_request_t *req, const uint8_t *data, uint32_t len)
+{
+    uint32_t rate = 0;
+
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        uint8_t c = data[i];
+
+        if ((req->fill == 1u) && (c != BAUD_RATE_REQUEST))
+        {
+            req->fill = 0;
+        }
+        if ((req->fill == 0) && (c != BAUD_RATE_ESCAPE))
+        {
+            continue;
+        }
+
+        req->frame[req->fill++] = c;
+        if (req->fill == BAUD_RATE_REQUEST_SIZE)
+        {
+            rate = (uint32_t)req->frame[2] | ((uint32_t)req->frame[3] << 8) |
+                   ((uint32_t)req->frame[4] << 16) | ((uint32_t)req->frame[5] << 24);
+            req->fill = 0;
+        }
+    }
+    return rate;
+}
+
+/*******************************************************************************
+ * Function Name: baud_rate_response
+ ********************************************************************************
+ * Summary:
+ * Build the response to a switch request.
+ *
+ * Parameters:
+ *  uint8_t response[]: Receives BAUD_RATE_REQUEST_SIZE bytes
+ *  uint8_t code: BAUD_RATE_ACCEPT or BAUD_RATE_REJECT
+ *  uint32_t rate: Requested rate
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void baud_rate_response(uint8_t response[BAUD_RATE_REQUEST_SIZE], uint8_t code, uint32_t rate)
+{
+    response[0] = BAUD_RATE_ESCAPE;
+    response[1] = code;
+    response[2] = (uint8_t)rate;
+    response[3] = (uint8_t)(rate >> 8);
+    response[4] = (uint8_t)(rate >> 16);
+    response[5] = (uint8_t)(rate >> 24);
+}
+
+/* [] END OF FILE */
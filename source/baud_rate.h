@@ -0,0 +1,98 @@
+/******************************************************************************
+ * File Name:   baud_rate.h
+ *
+ * Description: Baud rate negotiation helpers: auto-baud detection from the
+ *              edge times of a 0x55 sync character, and the parser for the in-
+ *              band baud switch request. Kept free of XMCLib dependencies so
+ *              the host tools run the same code.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#ifndef BAUD_RATE_H
+#define BAUD_RATE_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* 0x55 sent LSB first gives ten edges one bit time apart, start bit to stop bit */
+#define BAUD_RATE_SYNC_CHAR 0x55u
+#define BAUD_RATE_SYNC_EDGES 10u
+
+/* Switch request: ESC 'B' followed by the new rate, 32 bit little endian */
+#define BAUD_RATE_ESCAPE 0x1Bu
+#define BAUD_RATE_REQUEST 'B'
+#define BAUD_RATE_REQUEST_SIZE 6u
+
+/* Response sent at the old rate: ESC, 'b' (switching) or 'n' (rejected), the rate */
+#define BAUD_RATE_ACCEPT 'b'
+#define BAUD_RATE_REJECT 'n'
+
+/* Detected rates within this many percent of a standard rate are snapped to it */
+#ifndef BAUD_RATE_SNAP_PERCENT
+#define BAUD_RATE_SNAP_PERCENT 3u
+#endif
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t clock;                             /* Capture timer frequency in Hz */
+    uint32_t mask;                              /* Capture timer range, e.g. 0xFFFF for 16 bit */
+    uint32_t edges[BAUD_RATE_SYNC_EDGES];       /* Most recent edge times */
+    uint32_t count;                             /* Edges seen since reset */
+} autobaud_t;
+
+typedef struct
+{
+    uint8_t frame[BAUD_RATE_REQUEST_SIZE];
+    uint32_t fill;                              /* Bytes of a request collected */
+} baud_request_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void autobaud_init(autobaud_t *ab, uint32_t clock, uint32_t mask);
+uint32_t autobaud_edge(autobaud_t *ab, uint32_t timestamp);
+uint32_t baud_rate_snap(uint32_t rate);
+void baud_request_init(baud_request_t *req);
+uint32_t baud_request_scan(baud_request_t *req, const uint8_t *data, uint32_t len);
+void baud_rate_response(uint8_t response[BAUD_RATE_REQUEST_SIZE], uint8_t code, uint32_t rate);
+
+#endif /* BAUD_RATE_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,113 @@
+/******************************************************************************
+ * File Name:   dfa.c
+ *
+ * Description: Table driven scanner for line protocols. The generated tables
+ *              search for tokens anywhere in the stream: unexpected bytes lead
+ *              back into the start state without a separate resync step, and
+ *              the rows of accepting states equal the start row, so no reset is
+ *              needed after a token either.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "dfa.h"
+
+/*******************************************************************************
+ * Function Name: dfa_init
+ ********************************************************************************
+ * Summary:
+ * Attach a scanner to generated tables, see the *_DFA_INIT() macro of the
+ * generated header.
+ *
+ * Parameters:
+ *  dfa_t *dfa: Scanner instance
+ *  const uint8_t (*transitions)[256]: Generated transition table
+ *  const uint8_t *tokens: Generated token id per accepting state
+ *  uint8_t accept_base: First accepting state
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void dfa_init(dfa_t *dfa, const uint8_t (*transitions)[256], const uint8_t *tokens, uint8_t accept_base)
+{
+    dfa->transitions = transitions;
+    dfa->tokens = tokens;
+    dfa->accept_base = accept_base;
+    dfa->state = 0;
+}
+
+/*******************************************************************************
+ * Function Name: dfa_scan
+ ********************************************************************************
+ * Summary:
+ * Run the scanner over a segment. The state is kept between calls, so a
+ * token may span segments, ticks and the wrap of the ring.
+ *
+ * Parameters:
+ *  dfa_t *dfa: Scanner instance
+ *  const uint8_t *data: Segment to scan
+ *  uint32_t len: Length of segment
+ *  dfa_handler_t handler: Called for every token found, may be NULL
+ *  void *context: Passed through to handler
+ *
+ * Return:
+ *  uint32_t: Number of tokens found
+ *
+ *******************************************************************************/
+uint32_t dfa_scan(dfa_t *dfa, const uint8_t *data, uint32_t len, dfa_handler_t handler, void *context)
+{
+    const uint8_t (*transitions)[256] = dfa->transitions;
+    uint8_t accept_base = dfa->accept_base;
+    uint8_t state = dfa->state;
+    uint32_t found = 0;
+
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        state = transitions[state][data[i]];
+        if (state >= accept_base)
+        {
+            ++found;
+            if (handler != NULL)
+            {
+                handler(context, dfa->tokens[state - accept_base], &data[i]);
+            }
+        }
+    }
+    dfa->state = state;
+    return found;
+}
+
+/* [] END OF FILE */
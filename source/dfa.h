@@ -0,0 +1,69 @@
+/******************************************************************************
+ * File Name:   dfa.h
+ *
+ * Description: Table driven scanner for line protocols. The transition and
+ *              token tables are generated from a grammar of regular
+ *              expressions by host/dfa_gen, so scanning a ring segment costs
+ *              one table lookup and one compare per byte.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef DFA_H
+#define DFA_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+/* Called when a token ends; end points to its last byte in the current segment */
+typedef void (*dfa_handler_t)(void *context, uint8_t token, const uint8_t *end);
+
+typedef struct
+{
+    const uint8_t (*transitions)[256];  /* Next state per state and input byte */
+    const uint8_t *tokens;              /* Token id per accepting state */
+    uint8_t accept_base;                /* States from here on are accepting */
+    uint8_t state;
+} dfa_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void dfa_init(dfa_t *dfa, const uint8_t (*transitions)[256], const uint8_t *tokens, uint8_t accept_base);
+uint32_t dfa_scan(dfa_t *dfa, const uint8_t *data, uint32_t len, dfa_handler_t handler, void *context);
+
+#endif /* DFA_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,268 @@
+/******************************************************************************
+ * File Name:   dma_producer.c
+ *
+ * Description: GPDMA producer side of the ring buffer. Each producer owns one
+ *              channel in multi-block mode with source and destination reload:
+ *              the channel reads the peripheral result register on every
+ *              service request and writes the ring from the start again after
+ *              each block.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <stddef.h>
+
+#include "dma_producer.h"
+
+/*******************************************************************************
+ * Function Name: dma_producer_geometry
+ ********************************************************************************
+ * Summary:
+ * Common part of init and attach. The ring wraps where the channel reloads
+ * the destination address, so size must be a whole number of transfers and
+ * fit in one block.
+ *
+ *******************************************************************************/
+static bool dma_producer_geometry(dma_producer_t *producer, XMC_DMA_t *dma, uint8_t channel,
+                                  XMC_DMA_CH_TRANSFER_WIDTH_t width, volatile uint8_t *buffer, uint32_t size)
+{
+    /* The transfer width encodings are log2 of the transfer size in bytes */
+    uint8_t shift = (uint8_t)width;
+
+    if ((size == 0) || ((size & ((1u << shift) - 1u)) != 0) || ((size >> shift) > DMA_PRODUCER_MAX_BLOCK_SIZE))
+    {
+        return false;
+    }
+
+    producer->dma = dma;
+    producer->channel = channel;
+    producer->width_shift = shift;
+    ring_buffer_init(&producer->ring, buffer, size);
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: dma_producer_init
+ ********************************************************************************
+ * Summary:
+ * Configure a GPDMA channel to stream a peripheral result register into a
+ * ring. The channel is left disabled; call dma_producer_start() once the
+ * consumer is ready. The peripheral itself must be set up to raise its DMA
+ * service request.
+ *
+ * Parameters:
+ *  dma_producer_t *producer: Producer instance
+ *  XMC_DMA_t *dma: GPDMA module
+ *  uint8_t channel: Channel number within the module
+ *  const dma_producer_source_t *source: Result register, width, request line
+ *  volatile uint8_t *buffer: Ring storage, aligned to the transfer width
+ *  uint32_t size: Ring size in bytes
+ *
+ * Return:
+ *  bool: false if size is not a whole block of transfers
+ *
+ *******************************************************************************/
+bool dma_producer_init(dma_producer_t *producer, XMC_DMA_t *dma, uint8_t channel,
+                       const dma_producer_source_t *source, volatile uint8_t *buffer, uint32_t size)
+{
+    XMC_DMA_CH_CONFIG_t config =
+    {
+        .src_transfer_width = (uint32_t)source->width,
+        .dst_transfer_width = (uint32_t)source->width,
+        .src_address_count_mode = (uint32_t)XMC_DMA_CH_ADDRESS_COUNT_MODE_NO_CHANGE,
+        .dst_address_count_mode = (uint32_t)XMC_DMA_CH_ADDRESS_COUNT_MODE_INCREMENT,
+        .src_burst_length = (uint32_t)XMC_DMA_CH_BURST_LENGTH_1,
+        .dst_burst_length = (uint32_t)XMC_DMA_CH_BURST_LENGTH_1,
+        .transfer_flow = (uint32_t)XMC_DMA_CH_TRANSFER_FLOW_P2M_DMA,
+        .src_addr = source->source_address,
+        .dst_addr = (uint32_t)(uintptr_t)buffer,
+        .transfer_type = XMC_DMA_CH_TRANSFER_TYPE_MULTI_BLOCK_SRCADR_RELOAD_DSTADR_RELOAD,
+        .priority = source->priority,
+        .src_handshaking = XMC_DMA_CH_SRC_HANDSHAKING_HARDWARE,
+        .src_peripheral_request = source->peripheral_request
+    };
+
+    if (!dma_producer_geometry(producer, dma, channel, source->width, buffer, size))
+    {
+        return false;
+    }
+    config.block_size = (uint16_t)(size >> producer->width_shift);
+
+    if (!XMC_DMA_IsEnabled(dma))
+    {
+        XMC_DMA_Init(dma);
+    }
+    XMC_DMA_CH_Disable(dma, channel);
+    /* Also routes the request through the DLR line encoded in src_peripheral_request */
+    XMC_DMA_CH_Init(dma, channel, &config);
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: dma_producer_attach
+ ********************************************************************************
+ * Summary:
+ * Take over a channel configured elsewhere, e.g. by the Device Configurator
+ * in cybsp_init(). Only the destination and block size are set, so the ring
+ * geometry always matches the consumer.
+ *
+ * Parameters:
+ *  dma_producer_t *producer: Producer instance
+ *  XMC_DMA_t *dma: GPDMA module
+ *  uint8_t channel: Channel number within the module
+ *  XMC_DMA_CH_TRANSFER_WIDTH_t width: Configured destination transfer width
+ *  volatile uint8_t *buffer: Ring storage, aligned to the transfer width
+ *  uint32_t size: Ring size in bytes
+ *
+ * Return:
+ *  bool: false if size is not a whole block of transfers
+ *
+ *******************************************************************************/
+bool dma_producer_attach(dma_producer_t *producer, XMC_DMA_t *dma, uint8_t channel,
+                         XMC_DMA_CH_TRANSFER_WIDTH_t width, volatile uint8_t *buffer, uint32_t size)
+{
+    if (!dma_producer_geometry(producer, dma, channel, width, buffer, size))
+    {
+        return false;
+    }
+
+    XMC_DMA_CH_Disable(dma, channel);
+    XMC_DMA_CH_SetDestinationAddress(dma, channel, (uint32_t)(uintptr_t)buffer);
+    XMC_DMA_CH_SetBlockSize(dma, channel, size >> producer->width_shift);
+    return true;
+}
+
+void dma_producer_start(dma_producer_t *producer)
+{
+    XMC_DMA_CH_Enable(producer->dma, producer->channel);
+}
+
+void dma_producer_stop(dma_producer_t *producer)
+{
+    XMC_DMA_CH_Disable(producer->dma, producer->channel);
+}
+
+/*******************************************************************************
+ * Function Name: dma_producer_position
+ ********************************************************************************
+ * Summary:
+ * Current write position of the channel in bytes, the end argument of the
+ * ring_buffer.h consumer functions.
+ *
+ * Parameters:
+ *  const dma_producer_t *producer: Producer instance
+ *
+ * Return:
+ *  uint32_t: Byte offset of the next transfer within the ring
+ *
+ *******************************************************************************/
+uint32_t dma_producer_position(const dma_producer_t *producer)
+{
+    return XMC_DMA_CH_GetTransferredData(producer->dma, producer->channel) << producer->width_shift;
+}
+
+/*******************************************************************************
+ * Function Name: dma_producer_resize
+ ********************************************************************************
+ * Summary:
+ * Move the ring to new storage of a different size while data is arriving.
+ * Unread data is optionally handed to drain first. The channel is then
+ * stopped, the bytes still unread are copied to the end of the new ring
+ * and the channel restarts at the beginning of the new ring, so the
+ * consumer reads them before anything newer. The blackout lasts from the
+ * stop to the restart and grows with the bytes copied. A peripheral
+ * without FIFO keeps one byte in its result register meanwhile, so keep
+ * the blackout below one character time, e.g. by draining first. Call from
+ * the consumer context.
+ *
+ * Parameters:
+ *  dma_producer_t *producer: Producer instance
+ *  volatile uint8_t *buffer: New ring storage, must not overlap the current one
+ *  uint32_t size: New ring size in bytes
+ *  ring_buffer_handler_t drain: Consumer for the unread data, or NULL to copy all of it
+ *  void *context: Passed through to drain
+ *
+ * Return:
+ *  bool: false if the geometry is invalid or the unread data does not fit in
+ *        half of the new ring; the producer is unchanged and the call can be
+ *        repeated after consuming
+ *
+ *******************************************************************************/
+bool dma_producer_resize(dma_producer_t *producer, volatile uint8_t *buffer, uint32_t size,
+                         ring_buffer_handler_t drain, void *context)
+{
+    ring_buffer_t *ring = &producer->ring;
+    uint32_t width = 1u << producer->width_shift;
+    uint32_t end = dma_producer_position(producer);
+    uint32_t pending;
+    uint32_t start;
+
+    if ((size < (4u * width)) || ((size & (width - 1u)) != 0) ||
+        ((size >> producer->width_shift) > DMA_PRODUCER_MAX_BLOCK_SIZE))
+    {
+        return false;
+    }
+    if (drain != NULL)
+    {
+        ring_buffer_consume(ring, end, drain, context);
+    }
+    /* Leave headroom for the transfers that complete before the channel stops */
+    if ((ring_buffer_pending(ring, end) * 2u) > size)
+    {
+        return false;
+    }
+
+    /* Blackout: the channel finishes the current transfer and stops */
+    XMC_DMA_CH_Disable(producer->dma, producer->channel);
+    while (XMC_DMA_CH_IsEnabled(producer->dma, producer->channel))
+    {
+    }
+
+    end = dma_producer_position(producer);
+    pending = ring_buffer_pending(ring, end);
+    start = size - pending;
+    for (uint32_t i = 0, from = ring->start; i < pending; ++i)
+    {
+        buffer[start + i] = ring->buffer[from];
+        from = ((from + 1u) == ring->size) ? 0 : (from + 1u);
+    }
+
+    ring_buffer_init(ring, buffer, size);
+    ring->start = (pending != 0) ? start : 0;
+    XMC_DMA_CH_SetDestinationAddress(producer->dma, producer->channel, (uint32_t)(uintptr_t)buffer);
+    XMC_DMA_CH_SetBlockSize(producer->dma, producer->channel, size >> producer->width_shift);
+    XMC_DMA_CH_Enable(producer->dma, producer->channel);
+    return true;
+}
+
+/* [] END OF FILE */
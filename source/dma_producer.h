@@ -0,0 +1,92 @@
+/******************************************************************************
+ * File Name:   dma_producer.h
+ *
+ * Description: GPDMA producer side of the ring buffer. A producer moves the
+ *              result register of any peripheral with a DMA service request
+ *              (USIC RBUF, VADC GxRES, ...) into a ring that is read with the
+ *              consumer functions of ring_buffer.h.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#ifndef DMA_PRODUCER_H
+#define DMA_PRODUCER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "xmc_dma.h"
+#include "ring_buffer.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Largest block the GPDMA transfers before it reloads the destination (CTLH.BLOCK_TS) */
+#define DMA_PRODUCER_MAX_BLOCK_SIZE 4095u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t source_address;            /* Result register of the peripheral */
+    XMC_DMA_CH_TRANSFER_WIDTH_t width;  /* Width of one transfer, 8, 16 or 32 bit */
+    uint8_t peripheral_request;         /* DMA0_PERIPHERAL_REQUEST_* from xmc_dma_map.h, selects the DLR line */
+    XMC_DMA_CH_PRIORITY_t priority;
+} dma_producer_source_t;
+
+typedef struct
+{
+    ring_buffer_t ring;                 /* Consumer state, pass to ring_buffer_consume() */
+    XMC_DMA_t *dma;
+    uint8_t channel;
+    uint8_t width_shift;                /* log2 of the bytes per transfer */
+} dma_producer_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+bool dma_producer_init(dma_producer_t *producer, XMC_DMA_t *dma, uint8_t channel,
+                       const dma_producer_source_t *source, volatile uint8_t *buffer, uint32_t size);
+bool dma_producer_attach(dma_producer_t *producer, XMC_DMA_t *dma, uint8_t channel,
+                         XMC_DMA_CH_TRANSFER_WIDTH_t width, volatile uint8_t *buffer, uint32_t size);
+void dma_producer_start(dma_producer_t *producer);
+void dma_producer_stop(dma_producer_t *producer);
+uint32_t dma_producer_position(const dma_producer_t *producer);
+bool dma_producer_resize(dma_producer_t *producer, volatile uint8_t *buffer, uint32_t size,
+                         ring_buffer_handler_t drain, void *context);
+
+#endif /* DMA_PRODUCER_H */
+
+/* [] END OF FILE */
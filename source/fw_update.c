@@ -0,0 +1,245 @@
+/******************************************************************************
+ * File Name:   fw_update.c
+ *
+ * Description: Streaming firmware update receiver. fw_update_write() runs in
+ *              the SysTick handler and only takes as many bytes as fit in the
+ *              page buffers; the rest stays in the DMA ring until the next
+ *              tick. The ring therefore only has to hold what arrives during
+ *              one page programming time.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "fw_update.h"
+
+/*******************************************************************************
+ * Function Name: fw_update_init
+ ********************************************************************************
+ * Summary:
+ * Prepare the receiver to accept an update header.
+ *
+ * Parameters:
+ *  fw_update_t *fw: Receiver instance
+ *  const fw_update_ops_t *ops: Flash and CRC backend
+ *  void *context: Passed through to the ops
+ *  uint32_t slot_address: Flash address the image is programmed to
+ *  uint32_t slot_size: Largest accepted image
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void fw_update_init(fw_update_t *fw, const fw_update_ops_t *ops, void *context, uint32_t slot_address,
+                    uint32_t slot_size)
+{
+    memset(fw, 0, sizeof(*fw));
+    fw->ops = ops;
+    fw->context = context;
+    fw->slot_address = slot_address;
+    fw->slot_size = slot_size;
+    fw->programming = -1;
+    fw->state = FW_UPDATE_HEADER;
+}
+
+/*******************************************************************************
+ * Function Name: fw_update_service
+ ********************************************************************************
+ * Summary:
+ * Advance the programming pipeline: retire the page in flight once the flash
+ * is idle, hand the next full page to the flash and check the CRC after the
+ * last page. Called from every fw_update_write() and once per tick.
+ *
+ * Parameters:
+ *  fw_update_t *fw: Receiver instance
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void fw_update_service(fw_update_t *fw)
+{
+    if ((fw->state != FW_UPDATE_DATA) || fw->ops->busy(fw->context))
+    {
+        return;
+    }
+
+    if (fw->programming >= 0)
+    {
+        fw->full &= (uint8_t)~(1u << fw->programming);
+        fw->programming = -1;
+    }
+
+    /* The buffer that is not being filled is the older one */
+    {
+        uint8_t older = fw->fill ^ 1u;
+        int8_t next = (fw->full & (1u << older)) ? (int8_t)older : ((fw->full & (1u << fw->fill)) ? (int8_t)fw->fill : -1);
+
+        if (next >= 0)
+        {
+            fw->ops->program(fw->context, fw->next_address, fw->pages[next]);
+            fw->programming = next;
+            fw->next_address += FW_UPDATE_PAGE_SIZE;
+            fw->programmed++;
+        }
+    }
+
+    if ((fw->programming < 0) && (fw->full == 0) && (fw->received == fw->header.length))
+    {
+        fw->state = (fw->ops->crc_result(fw->context) == fw->header.crc32) ? FW_UPDATE_DONE : FW_UPDATE_FAILED;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: accept_header
+ ********************************************************************************
+ * Summary:
+ * Validate a complete header and request the erase of the target range.
+ *
+ *******************************************************************************/
+static void accept_header(fw_update_t *fw)
+{
+    const fw_update_header_t *h = &fw->header;
+
+    if ((h->magic != FW_UPDATE_MAGIC) || (h->length == 0) || (h->length > fw->slot_size) ||
+        ((h->length % FW_UPDATE_PAGE_SIZE) != 0))
+    {
+        fw->state = FW_UPDATE_FAILED;
+        return;
+    }
+    fw->received = 0;
+    fw->next_address = fw->slot_address;
+    fw->state = FW_UPDATE_ERASE;
+}
+
+/*******************************************************************************
+ * Function Name: fw_update_write
+ ********************************************************************************
+ * Summary:
+ * Take received bytes. While both page buffers hold data that is not yet
+ * programmed, no more bytes are taken; the caller leaves them in the ring
+ * and offers them again on the next tick.
+ *
+ * Parameters:
+ *  fw_update_t *fw: Receiver instance
+ *  const uint8_t *data: Received data
+ *  uint32_t len: Length of data
+ *
+ * Return:
+ *  uint32_t: Number of bytes taken
+ *
+ *******************************************************************************/
+uint32_t fw_update_write(fw_update_t *fw, const uint8_t *data, uint32_t len)
+{
+    uint32_t taken = 0;
+
+    if (fw->state == FW_UPDATE_HEADER)
+    {
+        uint32_t want = sizeof(fw->header) - fw->received;
+        uint32_t n = (len < want) ? len : want;
+
+        memcpy((uint8_t *)&fw->header + fw->received, data, n);
+        fw->received += n;
+        taken = n;
+        if (fw->received == sizeof(fw->header))
+        {
+            accept_header(fw);
+        }
+    }
+
+    fw_update_service(fw);
+    while ((fw->state == FW_UPDATE_DATA) && (taken < len) && (fw->received < fw->header.length))
+    {
+        uint32_t n;
+
+        if (fw->full & (1u << fw->fill))
+        {
+            /* Both buffers are full, the flash is the bottleneck */
+            if (fw->full == 3u)
+            {
+                fw->stalls++;
+                break;
+            }
+            fw->fill ^= 1u;
+        }
+
+        n = FW_UPDATE_PAGE_SIZE - fw->fill_offset;
+        if (n > (len - taken))
+        {
+            n = len - taken;
+        }
+        memcpy((uint8_t *)fw->pages[fw->fill] + fw->fill_offset, &data[taken], n);
+        fw->fill_offset += n;
+        fw->received += n;
+        taken += n;
+
+        if (fw->fill_offset == FW_UPDATE_PAGE_SIZE)
+        {
+            fw->ops->crc_update(fw->context, fw->pages[fw->fill], FW_UPDATE_PAGE_SIZE / 4u);
+            fw->full |= (uint8_t)(1u << fw->fill);
+            fw->fill_offset = 0;
+            fw_update_service(fw);
+        }
+    }
+    return taken;
+}
+
+/*******************************************************************************
+ * Function Name: fw_update_poll
+ ********************************************************************************
+ * Summary:
+ * Main loop part of the receiver: performs the erase requested by a valid
+ * header, which takes too long for the SysTick handler. The host waits for
+ * FW_UPDATE_RESPONSE_READY before it streams the image.
+ *
+ * Parameters:
+ *  fw_update_t *fw: Receiver instance
+ *
+ * Return:
+ *  bool: true when the erase finished and the READY response is due
+ *
+ *******************************************************************************/
+bool fw_update_poll(fw_update_t *fw)
+{
+    if (fw->state != FW_UPDATE_ERASE)
+    {
+        return false;
+    }
+    fw->ops->erase(fw->context, fw->slot_address, fw->header.length);
+    fw->ops->crc_reset(fw->context);
+    fw->state = FW_UPDATE_DATA;
+    return true;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,129 @@
+/******************************************************************************
+ * File Name:   fw_update.h
+ *
+ * Description: Streaming firmware update receiver. Image data is taken from
+ *              the DMA ring into two flash page buffers; one page is being
+ *              programmed while the next one fills, so the link never has to
+ *              pause for the flash. Flash and CRC access go through an ops
+ *              table, implemented with XMCLib on the target and simulated on
+ *              the host.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef FW_UPDATE_H
+#define FW_UPDATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Programming granularity of the XMC4 program flash */
+#define FW_UPDATE_PAGE_SIZE 256u
+
+/* "XFWU" little endian, first word of the update header */
+#define FW_UPDATE_MAGIC 0x55574658u
+
+/* Single byte responses sent to the host */
+#define FW_UPDATE_RESPONSE_READY 'R'
+#define FW_UPDATE_RESPONSE_OK 'K'
+#define FW_UPDATE_RESPONSE_ERROR 'E'
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+/* Sent ahead of the image; length is a multiple of FW_UPDATE_PAGE_SIZE */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t length;
+    uint32_t crc32;     /* CRC-32 (IEEE 802.3) of the image */
+    uint32_t reserved;
+} fw_update_header_t;
+
+typedef struct
+{
+    /* Erase the given range, may block; called from the main loop */
+    void (*erase)(void *context, uint32_t address, uint32_t length);
+    /* Start programming one page, must not wait for completion */
+    void (*program)(void *context, uint32_t address, const uint32_t *page);
+    /* Program or erase operation in progress */
+    bool (*busy)(void *context);
+    /* CRC-32 over whole words */
+    void (*crc_reset)(void *context);
+    void (*crc_update)(void *context, const uint32_t *data, uint32_t words);
+    uint32_t (*crc_result)(void *context);
+} fw_update_ops_t;
+
+typedef enum
+{
+    FW_UPDATE_HEADER,       /* Collecting the header */
+    FW_UPDATE_ERASE,        /* Header accepted, waiting for fw_update_poll() to erase */
+    FW_UPDATE_DATA,         /* Receiving and programming pages */
+    FW_UPDATE_DONE,         /* All pages programmed and CRC matched */
+    FW_UPDATE_FAILED        /* Bad header or CRC mismatch */
+} fw_update_state_t;
+
+typedef struct
+{
+    const fw_update_ops_t *ops;
+    void *context;
+    uint32_t slot_address;
+    uint32_t slot_size;
+    volatile fw_update_state_t state;
+    fw_update_header_t header;
+    uint32_t received;                  /* Bytes of header or image received */
+    uint32_t pages[2][FW_UPDATE_PAGE_SIZE / 4u];
+    uint8_t fill;                       /* Page buffer being filled */
+    uint8_t full;                       /* Bit per page buffer waiting to be programmed */
+    int8_t programming;                 /* Page buffer being programmed, or -1 */
+    uint32_t fill_offset;               /* Bytes in the page buffer being filled */
+    uint32_t next_address;              /* Flash address of the next page to program */
+    uint32_t programmed;                /* Pages handed to the flash */
+    uint32_t stalls;                    /* Ticks on which both buffers were full */
+} fw_update_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void fw_update_init(fw_update_t *fw, const fw_update_ops_t *ops, void *context, uint32_t slot_address,
+                    uint32_t slot_size);
+uint32_t fw_update_write(fw_update_t *fw, const uint8_t *data, uint32_t len);
+void fw_update_service(fw_update_t *fw);
+bool fw_update_poll(fw_update_t *fw);
+
+#endif /* FW_UPDATE_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,171 @@
+/******************************************************************************
+ * File Name:   histogram.c
+ *
+ * Description: Fixed-bin histogram: count values, report mean and percentiles.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <string.h>
+
+#include "histogram.h"
+
+/*******************************************************************************
+ * Function Name: histogram_init
+ ********************************************************************************
+ * Summary:
+ * Set up an empty histogram.
+ *
+ * Parameters:
+ *  histogram_t *h: Histogram instance
+ *  uint32_t *counts: Storage for one count per bin
+ *  uint32_t bins: Number of bins, at least 1
+ *  uint32_t width: Values per bin, at least 1
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void histogram_init(histogram_t *h, uint32_t *counts, uint32_t bins, uint32_t width)
+{
+    h->counts = counts;
+    h->bins = bins;
+    h->width = width;
+    histogram_reset(h);
+}
+
+/*******************************************************************************
+ * Function Name: histogram_reset
+ ********************************************************************************
+ * Summary:
+ * Clear all counts and the statistics.
+ *
+ * Parameters:
+ *  histogram_t *h: Histogram instance
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void histogram_reset(histogram_t *h)
+{
+    memset(h->counts, 0, h->bins * sizeof(h->counts[0]));
+    h->samples = 0;
+    h->min = UINT32_MAX;
+    h->max = 0;
+    h->sum = 0;
+}
+
+/*******************************************************************************
+ * Function Name: histogram_add
+ ********************************************************************************
+ * Summary:
+ * Count one value.
+ *
+ * Parameters:
+ *  histogram_t *h: Histogram instance
+ *  uint32_t value: Value to count
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void histogram_add(histogram_t *h, uint32_t value)
+{
+    uint32_t bin = value / h->width;
+
+    h->counts[(bin < h->bins) ? bin : (h->bins - 1u)]++;
+    h->samples++;
+    h->min = (value < h->min) ? value : h->min;
+    h->max = (value > h->max) ? value : h->max;
+    h->sum += value;
+}
+
+/*******************************************************************************
+ * Function Name: histogram_mean
+ ********************************************************************************
+ * Summary:
+ * Mean of the counted values.
+ *
+ * Parameters:
+ *  const histogram_t *h: Histogram instance
+ *
+ * Return:
+ *  uint32_t: Mean, rounded down; 0 without samples
+ *
+ *******************************************************************************/
+uint32_t histogram_mean(const histogram_t *h)
+{
+    return (h->samples != 0) ? (uint32_t)(h->sum / h->samples) : 0u;
+}
+
+/*******************************************************************************
+ * Function Name: histogram_percentile
+ ********************************************************************************
+ * Summary:
+ * Upper bound of the values below which the given share of the samples
+ * fall. The bound is the end of the bin that holds the percentile, or the
+ * maximum when that is lower or the percentile is in the last bin.
+ *
+ * Parameters:
+ *  const histogram_t *h: Histogram instance
+ *  uint32_t permille: Share of the samples, 0 to 1000
+ *
+ * Return:
+ *  uint32_t: Upper bound of the percentile; 0 without samples
+ *
+ *******************************************************************************/
+uint32_t histogram_percentile(const histogram_t *h, uint32_t permille)
+{
+    uint64_t wanted = (((uint64_t)h->samples * permille) + 999u) / 1000u;
+    uint64_t seen = 0;
+
+    if (h->samples == 0)
+    {
+        return 0;
+    }
+    for (uint32_t bin = 0; bin < (h->bins - 1u); ++bin)
+    {
+        seen += h->counts[bin];
+        if ((seen >= wanted) && (seen != 0))
+        {
+            uint32_t bound = ((bin + 1u) * h->width) - 1u;
+
+            return (bound < h->max) ? bound : h->max;
+        }
+    }
+    return h->max;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,74 @@
+/******************************************************************************
+ * File Name:   histogram.h
+ *
+ * Description: Fixed-bin histogram for runtime statistics such as the interval
+ *              between consumer runs. Values are counted in equal-width bins,
+ *              the last bin takes everything beyond; exact minimum, maximum
+ *              and mean are kept alongside. Kept free of XMCLib dependencies
+ *              so the host tools can use it.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t *counts;                   /* One count per bin */
+    uint32_t bins;                      /* The last bin counts all values from (bins - 1) * width */
+    uint32_t width;                     /* Values per bin */
+    uint32_t samples;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} histogram_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void histogram_init(histogram_t *h, uint32_t *counts, uint32_t bins, uint32_t width);
+void histogram_reset(histogram_t *h);
+void histogram_add(histogram_t *h, uint32_t value);
+uint32_t histogram_mean(const histogram_t *h);
+uint32_t histogram_percentile(const histogram_t *h, uint32_t permille);
+
+#endif /* HISTOGRAM_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,332 @@
+/******************************************************************************
+ * File Name:   loopback_test.c
+ *
+ * Description: Loopback throughput self-test: rate sweep, pattern transmission
+ *              and per-step evaluation.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <stddef.h>
+
+#include "loopback_test.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define LOOPBACK_TEST_SEED 0x7FFFu
+
+static bool loopback_test_expired(uint32_t now, uint32_t deadline)
+{
+    return (int32_t)(now - deadline) >= 0;
+}
+
+/*******************************************************************************
+ * Function Name: loopback_test_begin
+ ********************************************************************************
+ * Summary:
+ * Start the step at index, skipping rates the line refuses. The state is
+ * written last, so loopback_test_receive() only sees the new step once it
+ * is set up.
+ *
+ *******************************************************************************/
+static void loopback_test_begin(loopback_test_t *test, uint32_t now)
+{
+    for (; test->index < test->count; ++test->index)
+    {
+        loopback_step_t *step = &test->steps[test->index];
+
+        if (!test->ops->set_rate(test->context, step->rate))
+        {
+            step->status = LOOPBACK_STEP_SKIPPED;
+            continue;
+        }
+
+        prbs_init(&test->generator, LOOPBACK_TEST_SEED);
+        prbs_checker_init(&test->checker);
+        test->remaining = (uint32_t)(((uint64_t)step->rate * test->step_ms) / (LOOPBACK_TEST_FRAME_BITS * 1000u));
+        test->sent = 0;
+        test->received = 0;
+        test->start = now;
+        test->last = now;
+        /* A step normally takes step_ms and the drain; twice that means the transmitter is stuck */
+        test->deadline = now + ((test->clock / 1000u) * ((2u * test->step_ms) + LOOPBACK_TEST_DRAIN_MS));
+        test->state = LOOPBACK_TEST_SENDING;
+        return;
+    }
+    test->state = LOOPBACK_TEST_DONE;
+}
+
+/*******************************************************************************
+ * Function Name: loopback_test_finish
+ ********************************************************************************
+ * Summary:
+ * Evaluate the step in progress. Bits of an unfinished checker window count
+ * while the checker is locked. A step passes with every byte back, no bit
+ * error and no slip; the sweep stops at the first step that does not.
+ *
+ *******************************************************************************/
+static void loopback_test_finish(loopback_test_t *test, uint32_t now)
+{
+    loopback_step_t *step = &test->steps[test->index];
+    uint32_t elapsed = test->last - test->start;
+    bool passed;
+
+    test->state = LOOPBACK_TEST_IDLE;
+
+    step->sent = test->sent;
+    step->received = test->received;
+    step->bits = test->checker.bits + (test->checker.locked ? test->checker.window_bits : 0u);
+    step->errors = test->checker.errors + (test->checker.locked ? test->checker.window_errors : 0u);
+    step->slips = test->checker.slips;
+    step->throughput = (elapsed != 0) ? (uint32_t)(((uint64_t)step->received * test->clock) / elapsed) : 0u;
+
+    passed = (step->received == step->sent) && (step->errors == 0) && (step->slips == 0) && test->checker.locked;
+    step->status = passed ? LOOPBACK_STEP_PASSED : LOOPBACK_STEP_FAILED;
+    if (passed)
+    {
+        test->best = test->index;
+        test->index++;
+        loopback_test_begin(test, now);
+    }
+    else
+    {
+        test->state = LOOPBACK_TEST_DONE;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: loopback_test_init
+ ********************************************************************************
+ * Summary:
+ * Set up a sweep over the given rates. Nothing is sent before
+ * loopback_test_start().
+ *
+ * Parameters:
+ *  loopback_test_t *test: Test instance
+ *  const loopback_test_ops_t *ops: Line callbacks
+ *  void *context: Passed to the callbacks
+ *  const uint32_t *rates: Rates in bit/s, ascending
+ *  loopback_step_t *steps: Results, one per rate
+ *  uint32_t count: Number of rates
+ *  uint8_t *block: Buffer for the pattern handed to transmit()
+ *  uint32_t block_size: Bytes per transmit() call
+ *  uint32_t clock: Units of the time passed in per second; a step must be shorter than the wrap of the clock
+ *  uint32_t step_ms: Length of the pattern per step, in line time
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void loopback_test_init(loopback_test_t *test, const loopback_test_ops_t *ops, void *context, const uint32_t *rates,
+                        loopback_step_t *steps, uint32_t count, uint8_t *block, uint32_t block_size, uint32_t clock,
+                        uint32_t step_ms)
+{
+    test->ops = ops;
+    test->context = context;
+    test->steps = steps;
+    test->count = count;
+    test->block = block;
+    test->block_size = block_size;
+    test->clock = clock;
+    test->step_ms = step_ms;
+    test->state = LOOPBACK_TEST_IDLE;
+    test->index = 0;
+    test->remaining = 0;
+    test->sent = 0;
+    test->received = 0;
+    test->best = count;
+    prbs_checker_init(&test->checker);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        steps[i].rate = rates[i];
+        steps[i].status = LOOPBACK_STEP_NOT_RUN;
+        steps[i].sent = 0;
+        steps[i].received = 0;
+        steps[i].bits = 0;
+        steps[i].errors = 0;
+        steps[i].slips = 0;
+        steps[i].throughput = 0;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: loopback_test_start
+ ********************************************************************************
+ * Summary:
+ * Switch to the first rate and start sending.
+ *
+ * Parameters:
+ *  loopback_test_t *test: Test instance
+ *  uint32_t now: Current time in clock units
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void loopback_test_start(loopback_test_t *test, uint32_t now)
+{
+    test->index = 0;
+    loopback_test_begin(test, now);
+}
+
+/*******************************************************************************
+ * Function Name: loopback_test_receive
+ ********************************************************************************
+ * Summary:
+ * Check received bytes against the pattern. Called by the consumer of the
+ * receive path, which may preempt loopback_test_service(); data arriving
+ * between steps is left over from the previous rate and ignored.
+ *
+ * Parameters:
+ *  loopback_test_t *test: Test instance
+ *  const uint8_t *data: Received bytes
+ *  uint32_t len: Number of bytes
+ *  uint32_t now: Current time in clock units
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void loopback_test_receive(loopback_test_t *test, const uint8_t *data, uint32_t len, uint32_t now)
+{
+    if ((test->state != LOOPBACK_TEST_SENDING) && (test->state != LOOPBACK_TEST_DRAINING))
+    {
+        return;
+    }
+    prbs_check(&test->checker, data, len);
+    test->received += len;
+    test->last = now;
+}
+
+/*******************************************************************************
+ * Function Name: loopback_test_service
+ ********************************************************************************
+ * Summary:
+ * Drive the sweep from the main loop: hand the next block of the pattern to
+ * the transmitter when it is free, wait for the last bytes to come back,
+ * evaluate the step and move to the next rate.
+ *
+ * Parameters:
+ *  loopback_test_t *test: Test instance
+ *  uint32_t now: Current time in clock units
+ *
+ * Return:
+ *  bool: false once the sweep is done
+ *
+ *******************************************************************************/
+bool loopback_test_service(loopback_test_t *test, uint32_t now)
+{
+    switch (test->state)
+    {
+        case LOOPBACK_TEST_SENDING:
+            if (loopback_test_expired(now, test->deadline))
+            {
+                loopback_test_finish(test, now);
+            }
+            else if (!test->ops->busy(test->context))
+            {
+                if (test->remaining != 0)
+                {
+                    uint32_t len = (test->remaining < test->block_size) ? test->remaining : test->block_size;
+
+                    prbs_fill(&test->generator, test->block, len);
+                    test->ops->transmit(test->context, test->block, len);
+                    test->remaining -= len;
+                    test->sent += len;
+                }
+                else
+                {
+                    test->deadline = now + ((test->clock / 1000u) * LOOPBACK_TEST_DRAIN_MS);
+                    test->state = LOOPBACK_TEST_DRAINING;
+                }
+            }
+            break;
+
+        case LOOPBACK_TEST_DRAINING:
+            if ((test->received >= test->sent) || loopback_test_expired(now, test->deadline))
+            {
+                loopback_test_finish(test, now);
+            }
+            break;
+
+        default:
+            break;
+    }
+    return test->state != LOOPBACK_TEST_DONE;
+}
+
+/*******************************************************************************
+ * Function Name: loopback_test_best
+ ********************************************************************************
+ * Summary:
+ * Fastest step without errors, the maximum sustainable rate.
+ *
+ * Parameters:
+ *  const loopback_test_t *test: Test instance
+ *
+ * Return:
+ *  const loopback_step_t *: Step result, NULL if no step passed
+ *
+ *******************************************************************************/
+const loopback_step_t *loopback_test_best(const loopback_test_t *test)
+{
+    return (test->best < test->count) ? &test->steps[test->best] : NULL;
+}
+
+/*******************************************************************************
+ * Function Name: loopback_test_failed
+ ********************************************************************************
+ * Summary:
+ * Step that ended the sweep, with the bit errors, slips and lost bytes that
+ * failed it.
+ *
+ * Parameters:
+ *  const loopback_test_t *test: Test instance
+ *
+ * Return:
+ *  const loopback_step_t *: Step result, NULL if the sweep is running or every rate passed
+ *
+ *******************************************************************************/
+const loopback_step_t *loopback_test_failed(const loopback_test_t *test)
+{
+    if ((test->state != LOOPBACK_TEST_DONE) || (test->index >= test->count))
+    {
+        return NULL;
+    }
+    return &test->steps[test->index];
+}
+
+/* [] END OF FILE */
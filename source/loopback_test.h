@@ -0,0 +1,143 @@
+/******************************************************************************
+ * File Name:   loopback_test.h
+ *
+ * Description: Loopback throughput self-test. A PRBS-15 pattern is sent over a
+ *              UART whose output is looped back to its input, and checked
+ *              where the receive path delivers it; the rate is stepped up
+ *              until a step shows bit errors, slips or lost bytes. Each step
+ *              records the rate, the bytes sent and received, the bit error
+ *              count and the throughput; the fastest clean step is the maximum
+ *              sustainable rate. Line, DMA and clock are reached through
+ *              callbacks, so the same sweep runs on the target and against the
+ *              host simulator.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#ifndef LOOPBACK_TEST_H
+#define LOOPBACK_TEST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "prbs.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Bits per byte on the line, 8N1 */
+#define LOOPBACK_TEST_FRAME_BITS 10u
+
+/* Time left for the last bytes to reach the consumer, several ticks and a character at 1200 baud */
+#define LOOPBACK_TEST_DRAIN_MS 20u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    /* Switch the line to rate and discard what was received so far, false if the rate is not available */
+    bool (*set_rate)(void *context, uint32_t rate);
+    /* Start sending len bytes, must not wait for completion; data stays valid until busy() is false */
+    void (*transmit)(void *context, const uint8_t *data, uint32_t len);
+    /* Transmission in progress */
+    bool (*busy)(void *context);
+} loopback_test_ops_t;
+
+typedef enum
+{
+    LOOPBACK_TEST_IDLE,                 /* Not started, or between two steps */
+    LOOPBACK_TEST_SENDING,
+    LOOPBACK_TEST_DRAINING,             /* All sent, waiting for the last bytes */
+    LOOPBACK_TEST_DONE
+} loopback_test_state_t;
+
+typedef enum
+{
+    LOOPBACK_STEP_NOT_RUN,
+    LOOPBACK_STEP_SKIPPED,              /* Rate refused by set_rate() */
+    LOOPBACK_STEP_PASSED,
+    LOOPBACK_STEP_FAILED
+} loopback_step_status_t;
+
+typedef struct
+{
+    uint32_t rate;                      /* Bit/s */
+    loopback_step_status_t status;
+    uint32_t sent;                      /* Bytes */
+    uint32_t received;
+    uint32_t bits;                      /* Bits compared */
+    uint32_t errors;                    /* Bit errors among them */
+    uint32_t slips;                     /* Checker lost lock: bytes dropped or inserted */
+    uint32_t throughput;                /* Received bytes per second */
+} loopback_step_t;
+
+typedef struct
+{
+    const loopback_test_ops_t *ops;
+    void *context;
+    loopback_step_t *steps;             /* One per rate */
+    uint32_t count;
+    uint8_t *block;                     /* Pattern buffer handed to transmit() */
+    uint32_t block_size;
+    uint32_t clock;                     /* Units of the time passed in per second */
+    uint32_t step_ms;                   /* Pattern length per step, in line time */
+    volatile loopback_test_state_t state;
+    uint32_t index;                     /* Step in progress */
+    prbs_t generator;
+    prbs_checker_t checker;
+    uint32_t remaining;                 /* Bytes of the step not yet handed to transmit() */
+    uint32_t sent;
+    volatile uint32_t received;
+    uint32_t start;                     /* Time of the first byte of the step */
+    uint32_t last;                      /* Time the last bytes were received */
+    uint32_t deadline;
+    uint32_t best;                      /* Index of the fastest passed step, count for none */
+} loopback_test_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void loopback_test_init(loopback_test_t *test, const loopback_test_ops_t *ops, void *context, const uint32_t *rates,
+                        loopback_step_t *steps, uint32_t count, uint8_t *block, uint32_t block_size, uint32_t clock,
+                        uint32_t step_ms);
+void loopback_test_start(loopback_test_t *test, uint32_t now);
+void loopback_test_receive(loopback_test_t *test, const uint8_t *data, uint32_t len, uint32_t now);
+bool loopback_test_service(loopback_test_t *test, uint32_t now);
+const loopback_step_t *loopback_test_best(const loopback_test_t *test);
+const loopback_step_t *loopback_test_failed(const loopback_test_t *test);
+
+#endif /* LOOPBACK_TEST_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,318 @@
+/******************************************************************************
+ * File Name:   lz_stream.c
+ *
+ * Description: Streaming LZ compressor for the TX path and the matching
+ *              decompressor. The compressor keeps the last LZ_STREAM_WINDOW
+ *              bytes and a single-entry hash table, so the work per input byte
+ *              is one hash lookup and at most LZ_STREAM_MAX_MATCH compares.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "lz_stream.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define WINDOW_MASK (LZ_STREAM_WINDOW - 1u)
+
+/* Decoder states */
+#define STATE_TOKEN 0u
+#define STATE_LITERAL 1u
+#define STATE_DISTANCE 2u
+
+static inline uint32_t hash3(const uint8_t *data)
+{
+    uint32_t key = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
+    return (key * 2654435761u) >> (32u - LZ_STREAM_HASH_BITS);
+}
+
+/*******************************************************************************
+ * Function Name: flush_output
+ ********************************************************************************
+ * Summary:
+ * Pass the staged tokens to the sink and close an open literal run.
+ *
+ *******************************************************************************/
+static void flush_output(lz_stream_encoder_t *encoder)
+{
+    if (encoder->used != 0)
+    {
+        encoder->sink(encoder->context, encoder->out, encoder->used);
+        encoder->bytes_out += encoder->used;
+        encoder->used = 0;
+    }
+    encoder->literal_token = -1;
+}
+
+static void put_literal(lz_stream_encoder_t *encoder, uint8_t value)
+{
+    if (encoder->literal_token < 0)
+    {
+        if ((encoder->used + 2u) > LZ_STREAM_OUT_SIZE)
+        {
+            flush_output(encoder);
+        }
+        encoder->literal_token = (int32_t)encoder->used;
+        encoder->out[encoder->used++] = 0u;
+    }
+    else
+    {
+        encoder->out[encoder->literal_token]++;
+    }
+    encoder->out[encoder->used++] = value;
+
+    if (encoder->out[encoder->literal_token] == (LZ_STREAM_MAX_LITERALS - 1u))
+    {
+        encoder->literal_token = -1;
+    }
+    if (encoder->used == LZ_STREAM_OUT_SIZE)
+    {
+        flush_output(encoder);
+    }
+}
+
+static void put_match(lz_stream_encoder_t *encoder, uint32_t distance, uint32_t length)
+{
+    encoder->literal_token = -1;
+    if ((encoder->used + 2u) > LZ_STREAM_OUT_SIZE)
+    {
+        flush_output(encoder);
+    }
+    encoder->out[encoder->used++] = (uint8_t)(0x80u | ((length - LZ_STREAM_MIN_MATCH) << 2) | ((distance - 1u) >> 8));
+    encoder->out[encoder->used++] = (uint8_t)(distance - 1u);
+}
+
+/*******************************************************************************
+ * Function Name: lz_stream_encoder_init
+ ********************************************************************************
+ * Summary:
+ * Reset the compressor. The decoder on the other side of the link must be
+ * reset at the same point of the stream.
+ *
+ * Parameters:
+ *  lz_stream_encoder_t *encoder: Compressor instance
+ *  lz_stream_sink_t sink: Receives the compressed tokens
+ *  void *context: Passed through to sink
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void lz_stream_encoder_init(lz_stream_encoder_t *encoder, lz_stream_sink_t sink, void *context)
+{
+    memset(encoder, 0, sizeof(*encoder));
+    encoder->literal_token = -1;
+    encoder->sink = sink;
+    encoder->context = context;
+}
+
+/*******************************************************************************
+ * Function Name: lz_stream_compress
+ ********************************************************************************
+ * Summary:
+ * Compress a segment and pass all of it to the sink before returning, so no
+ * data is held back between ticks. Matches may refer to data of earlier
+ * segments; the last two bytes of a segment are always sent as literals
+ * because a match needs three bytes of lookahead.
+ *
+ * Parameters:
+ *  lz_stream_encoder_t *encoder: Compressor instance
+ *  const uint8_t *data: Data to compress
+ *  uint32_t len: Length of data
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void lz_stream_compress(lz_stream_encoder_t *encoder, const uint8_t *data, uint32_t len)
+{
+    uint32_t i = 0;
+
+    encoder->bytes_in += len;
+    while (i < len)
+    {
+        uint32_t length = 0;
+        uint32_t distance = 0;
+
+        if ((len - i) >= LZ_STREAM_MIN_MATCH)
+        {
+            uint32_t slot = hash3(&data[i]);
+            uint32_t limit = len - i;
+
+            distance = (uint16_t)(encoder->position - encoder->head[slot]);
+            encoder->head[slot] = (uint16_t)encoder->position;
+
+            /* The match must not reach into bytes that are not in the history yet */
+            if (limit > distance)
+            {
+                limit = distance;
+            }
+            if (limit > LZ_STREAM_MAX_MATCH)
+            {
+                limit = LZ_STREAM_MAX_MATCH;
+            }
+            if ((distance != 0) && (distance <= LZ_STREAM_WINDOW))
+            {
+                uint32_t from = encoder->position - distance;
+                while ((length < limit) && (encoder->history[(from + length) & WINDOW_MASK] == data[i + length]))
+                {
+                    ++length;
+                }
+            }
+        }
+
+        if (length >= LZ_STREAM_MIN_MATCH)
+        {
+            put_match(encoder, distance, length);
+        }
+        else
+        {
+            put_literal(encoder, data[i]);
+            length = 1;
+        }
+
+        for (uint32_t k = 0; k < length; ++k)
+        {
+            encoder->history[encoder->position & WINDOW_MASK] = data[i + k];
+            encoder->position++;
+        }
+        i += length;
+    }
+    flush_output(encoder);
+}
+
+/*******************************************************************************
+ * Function Name: lz_stream_decoder_init
+ ********************************************************************************
+ * Summary:
+ * Reset the decompressor.
+ *
+ * Parameters:
+ *  lz_stream_decoder_t *decoder: Decompressor instance
+ *  lz_stream_sink_t sink: Receives the decompressed data
+ *  void *context: Passed through to sink
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void lz_stream_decoder_init(lz_stream_decoder_t *decoder, lz_stream_sink_t sink, void *context)
+{
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->sink = sink;
+    decoder->context = context;
+}
+
+static void emit_byte(lz_stream_decoder_t *decoder, uint8_t value)
+{
+    decoder->history[decoder->position & WINDOW_MASK] = value;
+    decoder->position++;
+    decoder->out[decoder->used++] = value;
+    if (decoder->used == sizeof(decoder->out))
+    {
+        decoder->sink(decoder->context, decoder->out, decoder->used);
+        decoder->used = 0;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: lz_stream_decompress
+ ********************************************************************************
+ * Summary:
+ * Decompress a chunk of the token stream. Chunks may split tokens anywhere;
+ * the partial token is kept in the decoder state until the next call.
+ *
+ * Parameters:
+ *  lz_stream_decoder_t *decoder: Decompressor instance
+ *  const uint8_t *data: Compressed data
+ *  uint32_t len: Length of data
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void lz_stream_decompress(lz_stream_decoder_t *decoder, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        uint8_t value = data[i];
+
+        switch (decoder->state)
+        {
+            case STATE_TOKEN:
+                decoder->token = value;
+                if (value & 0x80u)
+                {
+                    decoder->state = STATE_DISTANCE;
+                }
+                else
+                {
+                    decoder->literals = (uint8_t)(value + 1u);
+                    decoder->state = STATE_LITERAL;
+                }
+                break;
+
+            case STATE_LITERAL:
+                emit_byte(decoder, value);
+                if (--decoder->literals == 0u)
+                {
+                    decoder->state = STATE_TOKEN;
+                }
+                break;
+
+            default:
+            {
+                uint32_t length = ((decoder->token >> 2) & 0x1Fu) + LZ_STREAM_MIN_MATCH;
+                uint32_t distance = ((((uint32_t)decoder->token & 0x03u) << 8) | value) + 1u;
+
+                for (uint32_t k = 0; k < length; ++k)
+                {
+                    emit_byte(decoder, decoder->history[(decoder->position - distance) & WINDOW_MASK]);
+                }
+                decoder->state = STATE_TOKEN;
+                break;
+            }
+        }
+    }
+
+    if (decoder->used != 0)
+    {
+        decoder->sink(decoder->context, decoder->out, decoder->used);
+        decoder->used = 0;
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,115 @@
+/******************************************************************************
+ * File Name:   lz_stream.h
+ *
+ * Description: Streaming LZ compressor for the TX path and the matching
+ *              decompressor. The format is a sequence of self-delimiting tokens,
+ *              so a compressed segment can be sent as soon as it is produced
+ *              and decoded from arbitrary chunks on the other end of the link.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef LZ_STREAM_H
+#define LZ_STREAM_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/*
+ * Token format:
+ *   0LLLLLLL             literal run, L + 1 bytes (1..128) follow
+ *   1MMMMMOO OOOOOOOO    match of M + 3 bytes (3..34) at distance O + 1 (1..1024)
+ * Both sides start with a zeroed history, so a match may reach before the
+ * start of the stream.
+ */
+#define LZ_STREAM_WINDOW 1024u
+#define LZ_STREAM_MIN_MATCH 3u
+#define LZ_STREAM_MAX_MATCH 34u
+#define LZ_STREAM_MAX_LITERALS 128u
+
+/* Size of the match finder hash table (entries = 1 << bits, two bytes each) */
+#ifndef LZ_STREAM_HASH_BITS
+#define LZ_STREAM_HASH_BITS 8
+#endif
+
+/* Output staging buffer of the compressor */
+#ifndef LZ_STREAM_OUT_SIZE
+#define LZ_STREAM_OUT_SIZE 64u
+#endif
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+/* Receives compressed or decompressed output */
+typedef void (*lz_stream_sink_t)(void *context, const uint8_t *data, uint32_t len);
+
+typedef struct
+{
+    uint8_t history[LZ_STREAM_WINDOW];
+    uint16_t head[1u << LZ_STREAM_HASH_BITS];
+    uint32_t position;          /* Bytes compressed so far */
+    uint8_t out[LZ_STREAM_OUT_SIZE];
+    uint32_t used;
+    int32_t literal_token;      /* Index of the open literal run in out, or -1 */
+    lz_stream_sink_t sink;
+    void *context;
+    uint32_t bytes_in;
+    uint32_t bytes_out;
+} lz_stream_encoder_t;
+
+typedef struct
+{
+    uint8_t history[LZ_STREAM_WINDOW];
+    uint32_t position;          /* Bytes decompressed so far */
+    uint8_t token;
+    uint8_t state;
+    uint8_t literals;           /* Literal bytes left in the current run */
+    uint8_t out[LZ_STREAM_MAX_LITERALS];
+    uint32_t used;
+    lz_stream_sink_t sink;
+    void *context;
+} lz_stream_decoder_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void lz_stream_encoder_init(lz_stream_encoder_t *encoder, lz_stream_sink_t sink, void *context);
+void lz_stream_compress(lz_stream_encoder_t *encoder, const uint8_t *data, uint32_t len);
+void lz_stream_decoder_init(lz_stream_decoder_t *decoder, lz_stream_sink_t sink, void *context);
+void lz_stream_decompress(lz_stream_decoder_t *decoder, const uint8_t *data, uint32_t len);
+
+#endif /* LZ_STREAM_H */
+
+/* [] END OF FILE */
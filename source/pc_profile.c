@@ -0,0 +1,280 @@
+/******************************************************************************
+ * File Name:   pc_profile.c
+ *
+ * Description: Statistical PC-sampling profiler: bucket the sampled program
+ *              counters and encode or check the report records.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <string.h>
+
+#include "pc_profile.h"
+
+static void put16(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void put32(uint8_t *p, uint32_t value)
+{
+    put16(p, value);
+    put16(p + 2, value >> 16);
+}
+
+static uint32_t fletcher16(const uint8_t *data, uint32_t len)
+{
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        sum1 = (sum1 + data[i]) % 255u;
+        sum2 = (sum2 + sum1) % 255u;
+    }
+    return (sum2 << 8) | sum1;
+}
+
+/* Frame a payload already placed at record + 4 */
+static uint32_t seal(uint8_t *record, uint8_t type, uint32_t payload)
+{
+    record[0] = PC_PROFILE_ESCAPE;
+    record[1] = PC_PROFILE_MARK;
+    record[2] = type;
+    record[3] = (uint8_t)payload;
+    put16(&record[4u + payload], fletcher16(&record[2], payload + 2u));
+    return payload + PC_PROFILE_OVERHEAD;
+}
+
+/*******************************************************************************
+ * Function Name: pc_profile_init
+ ********************************************************************************
+ * Summary:
+ * Spread the buckets over the address range to profile, with the smallest
+ * power-of-two bucket size that covers it, and clear the histogram.
+ *
+ * Parameters:
+ *  pc_profile_t *p: Profiler instance
+ *  uint16_t *counts: Histogram storage, one count per bucket
+ *  uint32_t buckets: Number of buckets, 1 to 65536
+ *  uint32_t base: Lowest code address to profile
+ *  uint32_t size: Bytes of code to profile
+ *  uint32_t limit: Samples per report, at most PC_PROFILE_MAX_SAMPLES
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void pc_profile_init(pc_profile_t *p, uint16_t *counts, uint32_t buckets, uint32_t base, uint32_t size,
+                     uint32_t limit)
+{
+    p->counts = counts;
+    p->buckets = buckets;
+    p->base = base;
+    p->shift = 0;
+    while (((uint64_t)buckets << p->shift) < size)
+    {
+        p->shift++;
+    }
+    p->limit = (limit < PC_PROFILE_MAX_SAMPLES) ? limit : PC_PROFILE_MAX_SAMPLES;
+    pc_profile_reset(p);
+}
+
+/*******************************************************************************
+ * Function Name: pc_profile_sample
+ ********************************************************************************
+ * Summary:
+ * Count one sample. Called from the sampling interrupt; samples beyond the
+ * limit are ignored until the report is sent and the profiler is reset.
+ *
+ * Parameters:
+ *  pc_profile_t *p: Profiler instance
+ *  uint32_t pc: Interrupted program counter
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void pc_profile_sample(pc_profile_t *p, uint32_t pc)
+{
+    uint32_t bucket = (pc - p->base) >> p->shift;
+
+    if (p->samples >= p->limit)
+    {
+        return;
+    }
+    if ((pc >= p->base) && (bucket < p->buckets))
+    {
+        p->counts[bucket]++;
+    }
+    else
+    {
+        p->outside++;
+    }
+    p->samples++;
+}
+
+/*******************************************************************************
+ * Function Name: pc_profile_full
+ ********************************************************************************
+ * Summary:
+ * Check whether the histogram holds a complete report.
+ *
+ * Parameters:
+ *  const pc_profile_t *p: Profiler instance
+ *
+ * Return:
+ *  bool: true once limit samples are taken
+ *
+ *******************************************************************************/
+bool pc_profile_full(const pc_profile_t *p)
+{
+    return p->samples >= p->limit;
+}
+
+/*******************************************************************************
+ * Function Name: pc_profile_reset
+ ********************************************************************************
+ * Summary:
+ * Clear the histogram for the next report. The sampling interrupt must be
+ * disabled.
+ *
+ * Parameters:
+ *  pc_profile_t *p: Profiler instance
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void pc_profile_reset(pc_profile_t *p)
+{
+    memset(p->counts, 0, p->buckets * sizeof(p->counts[0]));
+    p->outside = 0;
+    p->samples = 0;
+}
+
+/*******************************************************************************
+ * Function Name: pc_profile_record
+ ********************************************************************************
+ * Summary:
+ * Encode the next record of the report: the header first, then the non-empty
+ * buckets in address order. The histogram must not change until the last
+ * record is encoded.
+ *
+ * Parameters:
+ *  const pc_profile_t *p: Profiler instance
+ *  uint32_t *cursor: Position in the report, 0 for the header
+ *  uint8_t record[]: Receives the record
+ *
+ * Return:
+ *  uint32_t: Bytes of the record, 0 when the report is complete
+ *
+ *******************************************************************************/
+uint32_t pc_profile_record(const pc_profile_t *p, uint32_t *cursor, uint8_t record[PC_PROFILE_RECORD_MAX])
+{
+    uint32_t payload = 0;
+
+    if (*cursor == 0)
+    {
+        uint32_t entries = 0;
+
+        for (uint32_t i = 0; i < p->buckets; ++i)
+        {
+            entries += (p->counts[i] != 0) ? 1u : 0u;
+        }
+        put32(&record[4], p->base);
+        put32(&record[8], p->shift);
+        put32(&record[12], p->samples);
+        put32(&record[16], p->outside);
+        put32(&record[20], entries);
+        *cursor = 1;
+        return seal(record, PC_PROFILE_HEADER, PC_PROFILE_HEADER_SIZE);
+    }
+
+    /* The cursor is one past the next bucket to look at */
+    while ((*cursor <= p->buckets) && (payload < (PC_PROFILE_RECORD_ENTRIES * 4u)))
+    {
+        uint32_t bucket = *cursor - 1u;
+
+        if (p->counts[bucket] != 0)
+        {
+            put16(&record[4u + payload], bucket);
+            put16(&record[6u + payload], p->counts[bucket]);
+            payload += 4u;
+        }
+        (*cursor)++;
+    }
+    return (payload != 0) ? seal(record, PC_PROFILE_ENTRIES, payload) : 0u;
+}
+
+/*******************************************************************************
+ * Function Name: pc_profile_check
+ ********************************************************************************
+ * Summary:
+ * Check for a complete record with a valid checksum at the start of data.
+ * Used by the host to find records in a captured stream.
+ *
+ * Parameters:
+ *  const uint8_t *data: Received bytes
+ *  uint32_t len: Number of bytes available
+ *
+ * Return:
+ *  uint32_t: Bytes of the record, 0 if there is none or it is incomplete
+ *
+ *******************************************************************************/
+uint32_t pc_profile_check(const uint8_t *data, uint32_t len)
+{
+    uint32_t payload;
+
+    if ((len < PC_PROFILE_OVERHEAD) || (data[0] != PC_PROFILE_ESCAPE) || (data[1] != PC_PROFILE_MARK))
+    {
+        return 0;
+    }
+    payload = data[3];
+    if ((len < (payload + PC_PROFILE_OVERHEAD)) ||
+        ((data[2] == PC_PROFILE_HEADER) && (payload != PC_PROFILE_HEADER_SIZE)) ||
+        ((data[2] == PC_PROFILE_ENTRIES) && (((payload % 4u) != 0) || (payload > (PC_PROFILE_RECORD_ENTRIES * 4u)))) ||
+        ((data[2] != PC_PROFILE_HEADER) && (data[2] != PC_PROFILE_ENTRIES)))
+    {
+        return 0;
+    }
+    if (fletcher16(&data[2], payload + 2u) != (data[4u + payload] | ((uint32_t)data[5u + payload] << 8)))
+    {
+        return 0;
+    }
+    return payload + PC_PROFILE_OVERHEAD;
+}
+
+/* [] END OF FILE */
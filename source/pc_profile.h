@@ -0,0 +1,99 @@
+/******************************************************************************
+ * File Name:   pc_profile.h
+ *
+ * Description: Statistical PC-sampling profiler. A periodic interrupt adds the
+ *              interrupted program counter to a histogram of code address
+ *              ranges; the histogram is sent as checksummed records that
+ *              survive other traffic on the same line and are turned into a
+ *              flat profile by host/pc_symbolize. Kept free of XMCLib
+ *              dependencies so the host tools can use it.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#ifndef PC_PROFILE_H
+#define PC_PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+/* Record: ESC 'P', type, payload length, payload, Fletcher-16 over type to payload end */
+#define PC_PROFILE_ESCAPE 0x1Bu
+#define PC_PROFILE_MARK 'P'
+#define PC_PROFILE_OVERHEAD 6u
+
+/* Header payload: base, shift, samples, outside, entries; 32 bit little endian each */
+#define PC_PROFILE_HEADER 'H'
+#define PC_PROFILE_HEADER_SIZE 20u
+
+/* Entries payload: up to PC_PROFILE_RECORD_ENTRIES pairs of bucket index and count, 16 bit little endian */
+#define PC_PROFILE_ENTRIES 'E'
+#define PC_PROFILE_RECORD_ENTRIES 8u
+
+#define PC_PROFILE_RECORD_MAX (PC_PROFILE_OVERHEAD + (PC_PROFILE_RECORD_ENTRIES * 4u))
+
+/* Counts are 16 bit; at most this many samples per report keeps them exact */
+#define PC_PROFILE_MAX_SAMPLES 0xFFFFu
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint16_t *counts;                   /* Samples per bucket */
+    uint32_t buckets;                   /* At most 65536 */
+    uint32_t base;                      /* Address of bucket 0 */
+    uint32_t shift;                     /* Bucket size is 1 << shift bytes */
+    uint32_t limit;                     /* Samples per report */
+    volatile uint32_t samples;          /* Taken since reset, including outside */
+    volatile uint32_t outside;          /* Program counter not in any bucket */
+} pc_profile_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void pc_profile_init(pc_profile_t *p, uint16_t *counts, uint32_t buckets, uint32_t base, uint32_t size,
+                     uint32_t limit);
+void pc_profile_sample(pc_profile_t *p, uint32_t pc);
+bool pc_profile_full(const pc_profile_t *p);
+void pc_profile_reset(pc_profile_t *p);
+uint32_t pc_profile_record(const pc_profile_t *p, uint32_t *cursor, uint8_t record[PC_PROFILE_RECORD_MAX]);
+uint32_t pc_profile_check(const uint8_t *data, uint32_t len);
+
+#endif /* PC_PROFILE_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,183 @@
+/******************************************************************************
+ * File Name:   prbs.c
+ *
+ * Description: PRBS-15 generator and self-synchronizing bit error checker.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include "prbs.h"
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define PRBS_MASK ((1u << PRBS_ORDER) - 1u)
+
+static uint32_t prbs_next(prbs_t *prbs)
+{
+    uint32_t bit = ((prbs->state >> (PRBS_ORDER - 1u)) ^ (prbs->state >> (PRBS_ORDER - 2u))) & 1u;
+
+    prbs->state = ((prbs->state << 1) | bit) & PRBS_MASK;
+    return bit;
+}
+
+/*******************************************************************************
+ * Function Name: prbs_init
+ ********************************************************************************
+ * Summary:
+ * Seed the generator.
+ *
+ * Parameters:
+ *  prbs_t *prbs: Generator instance
+ *  uint32_t seed: Start state, the low 15 bits must not all be 0
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void prbs_init(prbs_t *prbs, uint32_t seed)
+{
+    prbs->state = seed & PRBS_MASK;
+}
+
+/*******************************************************************************
+ * Function Name: prbs_fill
+ ********************************************************************************
+ * Summary:
+ * Write the next bytes of the sequence.
+ *
+ * Parameters:
+ *  prbs_t *prbs: Generator instance
+ *  uint8_t *data: Buffer to fill
+ *  uint32_t len: Number of bytes
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void prbs_fill(prbs_t *prbs, uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        uint32_t byte = 0;
+
+        for (uint32_t bit = 0; bit < 8u; ++bit)
+        {
+            byte |= prbs_next(prbs) << bit;
+        }
+        data[i] = (uint8_t)byte;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: prbs_checker_init
+ ********************************************************************************
+ * Summary:
+ * Reset the checker and its counts; it locks on the next 15 bits.
+ *
+ * Parameters:
+ *  prbs_checker_t *checker: Checker instance
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void prbs_checker_init(prbs_checker_t *checker)
+{
+    checker->reference.state = 0;
+    checker->fill = 0;
+    checker->locked = false;
+    checker->bits = 0;
+    checker->errors = 0;
+    checker->window_bits = 0;
+    checker->window_errors = 0;
+    checker->slips = 0;
+}
+
+/*******************************************************************************
+ * Function Name: prbs_check
+ ********************************************************************************
+ * Summary:
+ * Compare received bytes with the sequence. Until locked, the received bits
+ * are loaded into the reference; once 15 are in, the reference runs free and
+ * every differing bit is an error. A window with too many errors means the
+ * stream slipped: its bits and errors are taken back, a slip is counted and
+ * the checker locks again.
+ *
+ * Parameters:
+ *  prbs_checker_t *checker: Checker instance
+ *  const uint8_t *data: Received bytes
+ *  uint32_t len: Number of bytes
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void prbs_check(prbs_checker_t *checker, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        for (uint32_t bit = 0; bit < 8u; ++bit)
+        {
+            uint32_t received = (data[i] >> bit) & 1u;
+
+            if (!checker->locked)
+            {
+                checker->reference.state = ((checker->reference.state << 1) | received) & PRBS_MASK;
+                checker->locked = (++checker->fill == PRBS_ORDER);
+                continue;
+            }
+
+            checker->window_errors += received ^ prbs_next(&checker->reference);
+            if (++checker->window_bits == PRBS_SLIP_WINDOW)
+            {
+                if (checker->window_errors > PRBS_SLIP_ERRORS)
+                {
+                    checker->slips++;
+                    checker->locked = false;
+                    checker->fill = 0;
+                }
+                else
+                {
+                    checker->bits += checker->window_bits;
+                    checker->errors += checker->window_errors;
+                }
+                checker->window_bits = 0;
+                checker->window_errors = 0;
+            }
+        }
+    }
+}
+
+/* [] END OF FILE */
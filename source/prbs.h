@@ -0,0 +1,90 @@
+/******************************************************************************
+ * File Name:   prbs.h
+ *
+ * Description: PRBS-15 (x^15 + x^14 + 1) pattern generator and bit error
+ *              checker for link tests. Bits go LSB first within a byte, as on
+ *              the UART line. The checker locks to the received sequence by
+ *              itself, so it needs no seed and recovers from lost or inserted
+ *              data. Kept free of XMCLib dependencies so the host tools can
+ *              use it.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#ifndef PRBS_H
+#define PRBS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define PRBS_ORDER 15u
+
+/* Lock is lost when more than PRBS_SLIP_ERRORS of PRBS_SLIP_WINDOW bits are wrong */
+#define PRBS_SLIP_WINDOW 256u
+#define PRBS_SLIP_ERRORS 32u
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t state;                     /* Last PRBS_ORDER bits, the newest in bit 0 */
+} prbs_t;
+
+typedef struct
+{
+    prbs_t reference;                   /* Free-running once locked */
+    uint32_t fill;                      /* Bits collected toward lock */
+    bool locked;
+    uint32_t bits;                      /* Compared while locked, slipped windows excluded */
+    uint32_t errors;
+    uint32_t window_bits;
+    uint32_t window_errors;
+    uint32_t slips;                     /* Lock lost: data dropped, inserted or garbled */
+} prbs_checker_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void prbs_init(prbs_t *prbs, uint32_t seed);
+void prbs_fill(prbs_t *prbs, uint8_t *data, uint32_t len);
+void prbs_checker_init(prbs_checker_t *checker);
+void prbs_check(prbs_checker_t *checker, const uint8_t *data, uint32_t len);
+
+#endif /* PRBS_H */
+
+/* [] END OF FILE */
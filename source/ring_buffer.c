@@ -0,0 +1,216 @@
+/******************************************************************************
+ * File Name:   ring_buffer.c
+ *
+ * Description: Consumer side of the DMA ring buffer. Kept free of XMCLib
+ *              dependencies so the same code runs on the host backends.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include "ring_buffer.h"
+
+/*******************************************************************************
+ * Function Name: ring_buffer_init
+ ********************************************************************************
+ * Summary:
+ * Attach a ring to its storage. The read position starts at the beginning of
+ * the buffer, which is where the producer starts writing.
+ *
+ * Parameters:
+ *  ring_buffer_t *ring: Ring instance
+ *  volatile uint8_t *buffer: Storage written by the producer
+ *  uint32_t size: Position at which the producer wraps to the start of buffer
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void ring_buffer_init(ring_buffer_t *ring, volatile uint8_t *buffer, uint32_t size)
+{
+    ring->buffer = buffer;
+    ring->size = size;
+    ring->start = 0;
+}
+
+/*******************************************************************************
+ * Function Name: ring_buffer_pending
+ ********************************************************************************
+ * Summary:
+ * Number of unread bytes for a given producer position.
+ *
+ * Parameters:
+ *  const ring_buffer_t *ring: Ring instance
+ *  uint32_t end: Current write position of the producer
+ *
+ * Return:
+ *  uint32_t: Bytes between the read position and end
+ *
+ *******************************************************************************/
+uint32_t ring_buffer_pending(const ring_buffer_t *ring, uint32_t end)
+{
+    return (end >= ring->start) ? (end - ring->start) : (ring->size - ring->start + end);
+}
+
+/*******************************************************************************
+ * Function Name: ring_buffer_consume
+ ********************************************************************************
+ * Summary:
+ * Pass everything the producer wrote since the last call to the handler and
+ * advance the read position to end.
+ *
+ * Parameters:
+ *  ring_buffer_t *ring: Ring instance
+ *  uint32_t end: Current write position of the producer
+ *  ring_buffer_handler_t handler: Called once per linear segment
+ *  void *context: Passed through to the handler
+ *
+ * Return:
+ *  uint32_t: Number of bytes handed to the handler
+ *
+ *******************************************************************************/
+uint32_t ring_buffer_consume(ring_buffer_t *ring, uint32_t end, ring_buffer_handler_t handler, void *context)
+{
+    uint32_t start = ring->start;
+    uint32_t count = 0;
+
+    /* Did the pointer proceed in the meanwhile? */
+    if (start != end)
+    {
+        /* Has the ring buffer overflowed ? */
+        if (start < end)
+        {
+            /* Process input data in linear buffer phase */
+            handler(context, (const uint8_t *)&ring->buffer[start], end - start);
+            count = end - start;
+        }
+        else
+        {
+            /* In overflow mode we have to process twice:
+             *  - Process data until end of buffer
+             *  - Process data until current position on top of buffer
+             */
+            handler(context, (const uint8_t *)&ring->buffer[start], ring->size - start);
+            if (end != 0)
+            {
+                handler(context, (const uint8_t *)&ring->buffer[0], end);
+            }
+            count = ring->size - start + end;
+        }
+
+        /* Set start pointer to the last read data */
+        ring->start = end;
+    }
+
+    return count;
+}
+
+/*******************************************************************************
+ * Function Name: ring_buffer_consume_max
+ ********************************************************************************
+ * Summary:
+ * Like ring_buffer_consume(), but pass at most max bytes to the handler. The
+ * rest stays unread for the next call, which bounds the time one call spends
+ * in the handler.
+ *
+ * Parameters:
+ *  ring_buffer_t *ring: Ring instance
+ *  uint32_t end: Current write position of the producer
+ *  uint32_t max: Largest number of bytes to consume
+ *  ring_buffer_handler_t handler: Called once per linear segment
+ *  void *context: Passed through to the handler
+ *
+ * Return:
+ *  uint32_t: Number of bytes handed to the handler
+ *
+ *******************************************************************************/
+uint32_t ring_buffer_consume_max(ring_buffer_t *ring, uint32_t end, uint32_t max, ring_buffer_handler_t handler,
+                                 void *context)
+{
+    if (ring_buffer_pending(ring, end) > max)
+    {
+        /* Stop max bytes after the read position instead */
+        end = ring->start + max;
+        if (end >= ring->size)
+        {
+            end -= ring->size;
+        }
+    }
+
+    return ring_buffer_consume(ring, end, handler, context);
+}
+
+/*******************************************************************************
+ * Function Name: ring_buffer_peek
+ ********************************************************************************
+ * Summary:
+ * Linear segment of unread data starting at the read position, without
+ * consuming it. For consumers that can only take part of the data in one
+ * tick; the part taken is released with ring_buffer_advance().
+ *
+ * Parameters:
+ *  const ring_buffer_t *ring: Ring instance
+ *  uint32_t end: Current write position of the producer
+ *  const uint8_t **data: Receives the start of the segment
+ *
+ * Return:
+ *  uint32_t: Length of the segment, 0 if there is no unread data
+ *
+ *******************************************************************************/
+uint32_t ring_buffer_peek(const ring_buffer_t *ring, uint32_t end, const uint8_t **data)
+{
+    *data = (const uint8_t *)&ring->buffer[ring->start];
+    return (end >= ring->start) ? (end - ring->start) : (ring->size - ring->start);
+}
+
+/*******************************************************************************
+ * Function Name: ring_buffer_advance
+ ********************************************************************************
+ * Summary:
+ * Release bytes returned by ring_buffer_peek() to the producer.
+ *
+ * Parameters:
+ *  ring_buffer_t *ring: Ring instance
+ *  uint32_t count: Number of bytes, at most the length of the peeked segment
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void ring_buffer_advance(ring_buffer_t *ring, uint32_t count)
+{
+    uint32_t start = ring->start + count;
+
+    ring->start = (start == ring->size) ? 0 : start;
+}
+
+/* [] END OF FILE */
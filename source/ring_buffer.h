@@ -0,0 +1,74 @@
+/******************************************************************************
+ * File Name:   ring_buffer.h
+ *
+ * Description: Consumer side of the DMA ring buffer. The producer (GPDMA on the
+ *              XMC, a serial fd on the host backend) only publishes its write
+ *              position; this module hands the bytes between the last read
+ *              position and that write position to a handler, in one or two
+ *              linear segments.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+/* Called with each linear segment of newly written data */
+typedef void (*ring_buffer_handler_t)(void *context, const uint8_t *data, uint32_t len);
+
+typedef struct
+{
+    volatile uint8_t *buffer;   /* Storage written by the producer */
+    uint32_t size;              /* Position at which the producer wraps */
+    uint32_t start;             /* Position of the first unread byte */
+} ring_buffer_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void ring_buffer_init(ring_buffer_t *ring, volatile uint8_t *buffer, uint32_t size);
+uint32_t ring_buffer_pending(const ring_buffer_t *ring, uint32_t end);
+uint32_t ring_buffer_consume(ring_buffer_t *ring, uint32_t end, ring_buffer_handler_t handler, void *context);
+uint32_t ring_buffer_consume_max(ring_buffer_t *ring, uint32_t end, uint32_t max, ring_buffer_handler_t handler,
+                                 void *context);
+uint32_t ring_buffer_peek(const ring_buffer_t *ring, uint32_t end, const uint8_t **data);
+void ring_buffer_advance(ring_buffer_t *ring, uint32_t count);
+
+#endif /* RING_BUFFER_H */
+
+/* [] END OF FILE */
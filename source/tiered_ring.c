@@ -0,0 +1,230 @@
+/******************************************************************************
+ * File Name:   tiered_ring.c
+ *
+ * Description: Two-tier receive ring. Data always leaves in arrival order: the
+ *              oldest bytes of the hot ring are the ones spilled, and the
+ *              consumer reads the hot ring directly only while the cold tier
+ *              is empty and no spill is in flight.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include "tiered_ring.h"
+
+/*******************************************************************************
+ * Function Name: tiered_ring_init
+ ********************************************************************************
+ * Summary:
+ * Put a cold tier behind a hot ring. The hot ring must already be attached
+ * to its producer.
+ *
+ * Parameters:
+ *  tiered_ring_t *tier: Tiered ring instance
+ *  ring_buffer_t *hot: Ring filled by the peripheral DMA
+ *  const tiered_ring_ops_t *ops: Copy engine
+ *  void *context: Passed through to the copy engine
+ *  volatile uint8_t *cold: Cold tier storage
+ *  uint32_t cold_size: Size of the cold tier in bytes
+ *  uint32_t spill_threshold: Hot backlog in bytes that starts a spill
+ *  uint32_t max_copy: Largest single copy the engine takes
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tiered_ring_init(tiered_ring_t *tier, ring_buffer_t *hot, const tiered_ring_ops_t *ops, void *context,
+                      volatile uint8_t *cold, uint32_t cold_size, uint32_t spill_threshold, uint32_t max_copy)
+{
+    tier->hot = hot;
+    tier->ops = ops;
+    tier->context = context;
+    tier->cold = cold;
+    tier->cold_size = cold_size;
+    tier->cold_read = 0;
+    tier->cold_write = 0;
+    tier->cold_used = 0;
+    tier->spill_threshold = spill_threshold;
+    tier->max_copy = max_copy;
+    tier->in_flight = 0;
+    tier->spilled = 0;
+    tier->peak_cold = 0;
+    tier->hot_bytes = 0;
+    tier->cold_bytes = 0;
+}
+
+/*******************************************************************************
+ * Function Name: tiered_ring_service
+ ********************************************************************************
+ * Summary:
+ * Retire a finished copy and start the next one while the hot backlog is at
+ * or above the spill threshold. A copy takes the oldest linear segment of
+ * the hot ring, up to the free linear space of the cold tier. The hot bytes
+ * are released to the DMA only once the copy has completed. Call before
+ * peeking, from the same context as the consumer.
+ *
+ * Parameters:
+ *  tiered_ring_t *tier: Tiered ring instance
+ *  uint32_t end: Current write position of the hot ring producer
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tiered_ring_service(tiered_ring_t *tier, uint32_t end)
+{
+    if (tier->in_flight != 0)
+    {
+        if (tier->ops->busy(tier->context))
+        {
+            return;
+        }
+
+        ring_buffer_advance(tier->hot, tier->in_flight);
+        tier->cold_write += tier->in_flight;
+        if (tier->cold_write == tier->cold_size)
+        {
+            tier->cold_write = 0;
+        }
+        tier->cold_used += tier->in_flight;
+        tier->spilled += tier->in_flight;
+        if (tier->cold_used > tier->peak_cold)
+        {
+            tier->peak_cold = tier->cold_used;
+        }
+        tier->in_flight = 0;
+    }
+
+    if (ring_buffer_pending(tier->hot, end) >= tier->spill_threshold)
+    {
+        const uint8_t *src;
+        uint32_t len = ring_buffer_peek(tier->hot, end, &src);
+        uint32_t linear = tier->cold_size - tier->cold_write;
+        uint32_t free = tier->cold_size - tier->cold_used;
+
+        len = (len < linear) ? len : linear;
+        len = (len < free) ? len : free;
+        len = (len < tier->max_copy) ? len : tier->max_copy;
+        if (len != 0)
+        {
+            tier->in_flight = len;
+            tier->ops->copy(tier->context, &tier->cold[tier->cold_write], src, len);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: tiered_ring_pending
+ ********************************************************************************
+ * Summary:
+ * Unread bytes in both tiers.
+ *
+ * Parameters:
+ *  const tiered_ring_t *tier: Tiered ring instance
+ *  uint32_t end: Current write position of the hot ring producer
+ *
+ * Return:
+ *  uint32_t: Backlog in bytes
+ *
+ *******************************************************************************/
+uint32_t tiered_ring_pending(const tiered_ring_t *tier, uint32_t end)
+{
+    return tier->cold_used + ring_buffer_pending(tier->hot, end);
+}
+
+/*******************************************************************************
+ * Function Name: tiered_ring_peek
+ ********************************************************************************
+ * Summary:
+ * Oldest linear segment of unread data, from the cold tier while it holds
+ * data and from the hot ring otherwise. Works like ring_buffer_peek(); the
+ * part taken is released with tiered_ring_advance() before the next
+ * tiered_ring_service().
+ *
+ * Parameters:
+ *  const tiered_ring_t *tier: Tiered ring instance
+ *  uint32_t end: Current write position of the hot ring producer
+ *  const uint8_t **data: Receives the start of the segment
+ *
+ * Return:
+ *  uint32_t: Length of the segment, 0 if there is nothing to read yet
+ *
+ *******************************************************************************/
+uint32_t tiered_ring_peek(const tiered_ring_t *tier, uint32_t end, const uint8_t **data)
+{
+    uint32_t linear;
+
+    if ((tier->cold_used == 0) && (tier->in_flight == 0))
+    {
+        return ring_buffer_peek(tier->hot, end, data);
+    }
+
+    /* Hot data behind a spill in flight waits until the copy has landed */
+    linear = tier->cold_size - tier->cold_read;
+    *data = (const uint8_t *)&tier->cold[tier->cold_read];
+    return (tier->cold_used < linear) ? tier->cold_used : linear;
+}
+
+/*******************************************************************************
+ * Function Name: tiered_ring_advance
+ ********************************************************************************
+ * Summary:
+ * Release bytes returned by tiered_ring_peek().
+ *
+ * Parameters:
+ *  tiered_ring_t *tier: Tiered ring instance
+ *  uint32_t count: Number of bytes, at most the length of the peeked segment
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tiered_ring_advance(tiered_ring_t *tier, uint32_t count)
+{
+    if ((tier->cold_used == 0) && (tier->in_flight == 0))
+    {
+        ring_buffer_advance(tier->hot, count);
+        tier->hot_bytes += count;
+        return;
+    }
+
+    tier->cold_read += count;
+    if (tier->cold_read == tier->cold_size)
+    {
+        tier->cold_read = 0;
+    }
+    tier->cold_used -= count;
+    tier->cold_bytes += count;
+}
+
+/* [] END OF FILE */
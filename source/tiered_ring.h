@@ -0,0 +1,93 @@
+/******************************************************************************
+ * File Name:   tiered_ring.h
+ *
+ * Description: Two-tier receive ring: the small DMA ring in internal SRAM (hot
+ *              tier) spills into a large ring in external memory (cold tier)
+ *              when the consumer falls behind. Kept free of XMCLib
+ *              dependencies; the copy engine is supplied by the application.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#ifndef TIERED_RING_H
+#define TIERED_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ring_buffer.h"
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    /* Start copying len bytes from the hot to the cold tier, must not wait for completion */
+    void (*copy)(void *context, volatile uint8_t *dst, const uint8_t *src, uint32_t len);
+    /* Copy in progress */
+    bool (*busy)(void *context);
+} tiered_ring_ops_t;
+
+typedef struct
+{
+    ring_buffer_t *hot;                 /* Ring filled by the peripheral DMA */
+    const tiered_ring_ops_t *ops;
+    void *context;
+    volatile uint8_t *cold;             /* Cold tier storage, e.g. EBU-mapped SDRAM */
+    uint32_t cold_size;
+    uint32_t cold_read;                 /* Position of the first unread byte */
+    uint32_t cold_write;                /* Position the next spill is copied to */
+    uint32_t cold_used;                 /* Unread bytes in the cold tier */
+    uint32_t spill_threshold;           /* Hot backlog that starts a spill */
+    uint32_t max_copy;                  /* Largest single copy the engine takes */
+    uint32_t in_flight;                 /* Bytes of the copy in progress, 0 if idle */
+    uint32_t spilled;                   /* Bytes moved to the cold tier */
+    uint32_t peak_cold;                 /* Highest cold tier fill */
+    uint32_t hot_bytes;                 /* Bytes consumed directly from the hot tier */
+    uint32_t cold_bytes;                /* Bytes consumed from the cold tier */
+} tiered_ring_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void tiered_ring_init(tiered_ring_t *tier, ring_buffer_t *hot, const tiered_ring_ops_t *ops, void *context,
+                      volatile uint8_t *cold, uint32_t cold_size, uint32_t spill_threshold, uint32_t max_copy);
+void tiered_ring_service(tiered_ring_t *tier, uint32_t end);
+uint32_t tiered_ring_pending(const tiered_ring_t *tier, uint32_t end);
+uint32_t tiered_ring_peek(const tiered_ring_t *tier, uint32_t end, const uint8_t **data);
+void tiered_ring_advance(tiered_ring_t *tier, uint32_t count);
+
+#endif /* TIERED_RING_H */
+
+/* [] END OF FILE */
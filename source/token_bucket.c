@@ -0,0 +1,176 @@
+/******************************************************************************
+ * File Name:   token_bucket.c
+ *
+ * Description: Token-bucket rate limiter: refill from elapsed time with exact
+ *              fractional accounting, grant bytes against the bucket and
+ *              report the rate achieved.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include "token_bucket.h"
+
+/*******************************************************************************
+ * Function Name: token_bucket_init
+ ********************************************************************************
+ * Summary:
+ * Set up a full bucket, so the first burst goes out at line rate.
+ *
+ * Parameters:
+ *  token_bucket_t *tb: Bucket instance
+ *  uint32_t rate: Average rate in bytes per second
+ *  uint32_t burst: Bucket depth in bytes, at least 1
+ *  uint32_t clock: Units of the elapsed time passed to token_bucket_refill() per second
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void token_bucket_init(token_bucket_t *tb, uint32_t rate, uint32_t burst, uint32_t clock)
+{
+    tb->rate = rate;
+    tb->burst = burst;
+    tb->clock = clock;
+    tb->tokens = burst;
+    tb->fraction = 0;
+    tb->granted = 0;
+    tb->elapsed = 0;
+    tb->throttled = 0;
+}
+
+/*******************************************************************************
+ * Function Name: token_bucket_configure
+ ********************************************************************************
+ * Summary:
+ * Change rate and burst at runtime. Tokens above the new depth are dropped;
+ * the statistics continue.
+ *
+ * Parameters:
+ *  token_bucket_t *tb: Bucket instance
+ *  uint32_t rate: Average rate in bytes per second
+ *  uint32_t burst: Bucket depth in bytes, at least 1
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void token_bucket_configure(token_bucket_t *tb, uint32_t rate, uint32_t burst)
+{
+    tb->rate = rate;
+    tb->burst = burst;
+    if (tb->tokens > burst)
+    {
+        tb->tokens = burst;
+        tb->fraction = 0;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: token_bucket_refill
+ ********************************************************************************
+ * Summary:
+ * Add the tokens earned in elapsed time. The remainder of the division is
+ * kept, so refilling in small steps earns exactly the configured rate.
+ *
+ * Parameters:
+ *  token_bucket_t *tb: Bucket instance
+ *  uint32_t elapsed: Time since the previous refill, in clock units
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void token_bucket_refill(token_bucket_t *tb, uint32_t elapsed)
+{
+    uint64_t earned = ((uint64_t)elapsed * tb->rate) + tb->fraction;
+    uint64_t tokens = tb->tokens + (earned / tb->clock);
+
+    tb->elapsed += elapsed;
+    if (tokens >= tb->burst)
+    {
+        tb->tokens = tb->burst;
+        tb->fraction = 0;
+    }
+    else
+    {
+        tb->tokens = (uint32_t)tokens;
+        tb->fraction = (uint32_t)(earned % tb->clock);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: token_bucket_take
+ ********************************************************************************
+ * Summary:
+ * Grant up to count bytes against the bucket.
+ *
+ * Parameters:
+ *  token_bucket_t *tb: Bucket instance
+ *  uint32_t count: Bytes the caller wants to send
+ *
+ * Return:
+ *  uint32_t: Bytes the caller may send now, 0 to count
+ *
+ *******************************************************************************/
+uint32_t token_bucket_take(token_bucket_t *tb, uint32_t count)
+{
+    if (count > tb->tokens)
+    {
+        count = tb->tokens;
+        tb->throttled++;
+    }
+    tb->tokens -= count;
+    tb->granted += count;
+    return count;
+}
+
+/*******************************************************************************
+ * Function Name: token_bucket_achieved
+ ********************************************************************************
+ * Summary:
+ * Average rate let through since init, to compare with the configured rate.
+ *
+ * Parameters:
+ *  const token_bucket_t *tb: Bucket instance
+ *
+ * Return:
+ *  uint32_t: Bytes per second, 0 before the first refill
+ *
+ *******************************************************************************/
+uint32_t token_bucket_achieved(const token_bucket_t *tb)
+{
+    return (tb->elapsed != 0) ? (uint32_t)((tb->granted * tb->clock) / tb->elapsed) : 0u;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,75 @@
+/******************************************************************************
+ * File Name:   token_bucket.h
+ *
+ * Description: Token-bucket rate limiter for one transmit channel. Tokens are
+ *              bytes; the bucket is refilled from elapsed time in any clock
+ *              and caps both the average rate and the burst a peer has to
+ *              absorb. Kept free of XMCLib dependencies so the host tools can
+ *              use it.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#ifndef TOKEN_BUCKET_H
+#define TOKEN_BUCKET_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef struct
+{
+    uint32_t rate;                      /* Bytes per second */
+    uint32_t burst;                     /* Bucket depth, the longest back-to-back run in bytes */
+    uint32_t clock;                     /* Units of elapsed time per second */
+    uint32_t tokens;
+    uint32_t fraction;                  /* Partial token, in 1/clock */
+    uint64_t granted;                   /* Bytes let through */
+    uint64_t elapsed;                   /* Time covered by the refills, in clock units */
+    uint32_t throttled;                 /* Requests cut short by the bucket */
+} token_bucket_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void token_bucket_init(token_bucket_t *tb, uint32_t rate, uint32_t burst, uint32_t clock);
+void token_bucket_configure(token_bucket_t *tb, uint32_t rate, uint32_t burst);
+void token_bucket_refill(token_bucket_t *tb, uint32_t elapsed);
+uint32_t token_bucket_take(token_bucket_t *tb, uint32_t count);
+uint32_t token_bucket_achieved(const token_bucket_t *tb);
+
+#endif /* TOKEN_BUCKET_H */
+
+/* [] END OF FILE */
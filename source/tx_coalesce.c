@@ -0,0 +1,220 @@
+/******************************************************************************
+ * File Name:   tx_coalesce.c
+ *
+ * Description: Transmit coalescing: fragments are held until the byte
+ *              threshold or the hold deadline is reached and then sent with
+ *              one call of the transmit path.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <string.h>
+
+#include "tx_coalesce.h"
+
+/*******************************************************************************
+ * Function Name: tx_coalesce_init
+ ********************************************************************************
+ * Summary:
+ * Set up an empty coalescing buffer in front of a transmit path.
+ *
+ * Parameters:
+ *  tx_coalesce_t *tx: Coalescer instance
+ *  uint8_t *buffer: Storage for held fragments
+ *  uint32_t capacity: Size of buffer, the largest batch
+ *  tx_coalesce_sink_t sink: Transmit path
+ *  void *context: Passed through to the sink
+ *  uint32_t threshold: Held bytes that send the batch at once, 1 disables holding
+ *  uint32_t deadline: Longest hold, in the unit passed to tx_coalesce_tick()
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tx_coalesce_init(tx_coalesce_t *tx, uint8_t *buffer, uint32_t capacity, tx_coalesce_sink_t sink, void *context,
+                      uint32_t threshold, uint32_t deadline)
+{
+    tx->sink = sink;
+    tx->context = context;
+    tx->buffer = buffer;
+    tx->capacity = capacity;
+    tx->len = 0;
+    tx->age = 0;
+    tx->threshold = threshold;
+    tx->deadline = deadline;
+    tx->fragments = 0;
+    tx->batches = 0;
+    tx->threshold_batches = 0;
+    tx->deadline_batches = 0;
+    tx->direct = 0;
+}
+
+/*******************************************************************************
+ * Function Name: tx_coalesce_flush
+ ********************************************************************************
+ * Summary:
+ * Send the held bytes now, e.g. before a response that must not overtake
+ * them or before the line is reconfigured.
+ *
+ * Parameters:
+ *  tx_coalesce_t *tx: Coalescer instance
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tx_coalesce_flush(tx_coalesce_t *tx)
+{
+    if (tx->len != 0)
+    {
+        tx->sink(tx->context, tx->buffer, tx->len);
+        tx->batches++;
+        tx->len = 0;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: tx_coalesce_take
+ ********************************************************************************
+ * Summary:
+ * Move the held bytes out of the coalescer instead of sending them, so the
+ * caller can send them after releasing a lock that it shares with the code
+ * calling tx_coalesce_tick(). Counted as a batch.
+ *
+ * Parameters:
+ *  tx_coalesce_t *tx: Coalescer instance
+ *  uint8_t *data: Destination, room for the capacity of the coalescer
+ *
+ * Return:
+ *  uint32_t: Number of bytes moved to data
+ *
+ *******************************************************************************/
+uint32_t tx_coalesce_take(tx_coalesce_t *tx, uint8_t *data)
+{
+    uint32_t len = tx->len;
+
+    if (len != 0)
+    {
+        memcpy(data, tx->buffer, len);
+        tx->batches++;
+        tx->len = 0;
+    }
+    return len;
+}
+
+/*******************************************************************************
+ * Function Name: tx_coalesce_write
+ ********************************************************************************
+ * Summary:
+ * Queue a fragment for transmission. Held bytes that the fragment does not
+ * fit behind are sent first; a fragment that alone reaches the threshold or
+ * the capacity is then sent unbuffered, so large transfers are not copied.
+ * The batch is sent as soon as the held bytes reach the threshold.
+ *
+ * Parameters:
+ *  tx_coalesce_t *tx: Coalescer instance
+ *  const uint8_t *data: Fragment to send
+ *  uint32_t len: Length of the fragment
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tx_coalesce_write(tx_coalesce_t *tx, const uint8_t *data, uint32_t len)
+{
+    uint32_t threshold = (tx->threshold < tx->capacity) ? tx->threshold : tx->capacity;
+
+    if (len == 0)
+    {
+        return;
+    }
+
+    if ((tx->len + len) > tx->capacity)
+    {
+        tx_coalesce_flush(tx);
+    }
+
+    if ((tx->len == 0) && (len >= threshold))
+    {
+        tx->sink(tx->context, data, len);
+        tx->direct++;
+        return;
+    }
+
+    if (tx->len == 0)
+    {
+        tx->age = 0;
+    }
+    memcpy(&tx->buffer[tx->len], data, len);
+    tx->len += len;
+    tx->fragments++;
+
+    if (tx->len >= threshold)
+    {
+        tx->threshold_batches++;
+        tx_coalesce_flush(tx);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: tx_coalesce_tick
+ ********************************************************************************
+ * Summary:
+ * Advance the hold timer and send the batch once the oldest held byte has
+ * waited for the deadline. Call at the start of each consumer period, before
+ * the new fragments of the period are written, so a deadline shorter than
+ * the period holds fragments for exactly one period.
+ *
+ * Parameters:
+ *  tx_coalesce_t *tx: Coalescer instance
+ *  uint32_t elapsed: Time since the previous call, in the unit of the deadline
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tx_coalesce_tick(tx_coalesce_t *tx, uint32_t elapsed)
+{
+    if (tx->len != 0)
+    {
+        tx->age += elapsed;
+        if (tx->age >= tx->deadline)
+        {
+            tx->deadline_batches++;
+            tx_coalesce_flush(tx);
+        }
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,82 @@
+/******************************************************************************
+ * File Name:   tx_coalesce.h
+ *
+ * Description: Transmit coalescing. Small fragments are collected and handed
+ *              to the transmit path as one batch once a byte threshold or a
+ *              hold deadline is reached. Kept free of XMCLib dependencies so
+ *              the host tools can use it.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#ifndef TX_COALESCE_H
+#define TX_COALESCE_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+typedef void (*tx_coalesce_sink_t)(void *context, const uint8_t *data, uint32_t len);
+
+typedef struct
+{
+    tx_coalesce_sink_t sink;            /* Transmit path, called once per batch */
+    void *context;
+    uint8_t *buffer;
+    uint32_t capacity;
+    uint32_t len;                       /* Bytes held */
+    uint32_t age;                       /* Time the oldest held byte has waited */
+    uint32_t threshold;                 /* Held bytes that send the batch at once, may change at runtime */
+    uint32_t deadline;                  /* Longest hold, same unit as tx_coalesce_tick(), may change at runtime */
+    uint32_t fragments;                 /* Writes taken into the buffer */
+    uint32_t batches;                   /* Sink calls for held data */
+    uint32_t threshold_batches;         /* Batches sent because the threshold was reached */
+    uint32_t deadline_batches;          /* Batches sent because the deadline expired */
+    uint32_t direct;                    /* Writes too large to hold, sent unbuffered */
+} tx_coalesce_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void tx_coalesce_init(tx_coalesce_t *tx, uint8_t *buffer, uint32_t capacity, tx_coalesce_sink_t sink, void *context,
+                      uint32_t threshold, uint32_t deadline);
+void tx_coalesce_write(tx_coalesce_t *tx, const uint8_t *data, uint32_t len);
+void tx_coalesce_tick(tx_coalesce_t *tx, uint32_t elapsed);
+void tx_coalesce_flush(tx_coalesce_t *tx);
+uint32_t tx_coalesce_take(tx_coalesce_t *tx, uint8_t *data);
+
+#endif /* TX_COALESCE_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,253 @@
+/******************************************************************************
+ * File Name:   tx_sched.c
+ *
+ * Description: Priority-classed transmit queue: bounded per-class frame queues
+ *              drained through a non-blocking writer, switching class only at
+ *              frame boundaries.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#include <string.h>
+
+#include "tx_sched.h"
+
+/* Advance a ring position by at most size; the rings need not be a power of two */
+static uint32_t tx_sched_wrap(uint32_t position, uint32_t size)
+{
+    return (position >= size) ? (position - size) : position;
+}
+
+/*******************************************************************************
+ * Function Name: tx_sched_init
+ ********************************************************************************
+ * Summary:
+ * Attach the scheduler to a transmitter. Every class must then be given its
+ * storage with tx_sched_class_init(). The scheduler is not reentrant: callers
+ * in different interrupt contexts have to serialize their calls.
+ *
+ * Parameters:
+ *  tx_sched_t *sched: Scheduler instance
+ *  tx_sched_write_t write: Non-blocking writer of the transmitter
+ *  void *context: Passed through to the writer
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tx_sched_init(tx_sched_t *sched, tx_sched_write_t write, void *context)
+{
+    memset(sched, 0, sizeof(*sched));
+    sched->write = write;
+    sched->context = context;
+    sched->active = TX_SCHED_NONE;
+}
+
+/*******************************************************************************
+ * Function Name: tx_sched_class_init
+ ********************************************************************************
+ * Summary:
+ * Give a class its bounded queue. The byte ring limits the queued bytes, the
+ * frame ring the queued frames; whichever fills first refuses new frames.
+ *
+ * Parameters:
+ *  tx_sched_t *sched: Scheduler instance
+ *  tx_sched_class_t cls: Class to set up
+ *  uint8_t *data: Byte ring storage
+ *  uint32_t capacity: Size of the byte ring, the largest frame
+ *  tx_sched_frame_t *frames: Frame ring storage
+ *  uint32_t max_frames: Number of entries in the frame ring
+ *
+ * Return:
+ *  void
+ *
+ *******************************************************************************/
+void tx_sched_class_init(tx_sched_t *sched, tx_sched_class_t cls, uint8_t *data, uint32_t capacity,
+                         tx_sched_frame_t *frames, uint32_t max_frames)
+{
+    tx_sched_queue_t *q = &sched->queue[cls];
+
+    memset(q, 0, sizeof(*q));
+    q->data = data;
+    q->capacity = capacity;
+    q->frames = frames;
+    q->max_frames = max_frames;
+}
+
+/*******************************************************************************
+ * Function Name: tx_sched_enqueue
+ ********************************************************************************
+ * Summary:
+ * Queue one frame. A frame is sent without interruption by other classes, so
+ * producers of bulk data should cut it into frames no longer than the delay
+ * urgent frames may see.
+ *
+ * Parameters:
+ *  tx_sched_t *sched: Scheduler instance
+ *  tx_sched_class_t cls: Class of the frame
+ *  const uint8_t *data: Frame content
+ *  uint32_t len: Length of the frame
+ *  uint32_t now: Current time, in the unit the latency statistics are kept in
+ *
+ * Return:
+ *  bool: false if the class has no room for the frame; nothing was queued
+ *
+ *******************************************************************************/
+bool tx_sched_enqueue(tx_sched_t *sched, tx_sched_class_t cls, const uint8_t *data, uint32_t len, uint32_t now)
+{
+    tx_sched_queue_t *q = &sched->queue[cls];
+    uint32_t position = q->byte_in;
+    uint32_t first = q->capacity - position;
+
+    if ((len == 0) || (len > (q->capacity - q->bytes)) || (q->depth == q->max_frames))
+    {
+        q->stats.dropped += (len != 0) ? 1u : 0u;
+        return false;
+    }
+
+    /* Frames may wrap around the end of the byte ring */
+    first = (len < first) ? len : first;
+    memcpy(&q->data[position], data, first);
+    memcpy(q->data, &data[first], len - first);
+    q->byte_in = tx_sched_wrap(q->byte_in + len, q->capacity);
+    q->bytes += len;
+
+    q->frames[q->frame_in].len = len;
+    q->frames[q->frame_in].enqueued = now;
+    q->frame_in = tx_sched_wrap(q->frame_in + 1u, q->max_frames);
+    q->depth++;
+
+    q->stats.peak_frames = (q->depth > q->stats.peak_frames) ? q->depth : q->stats.peak_frames;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: tx_sched_pump
+ ********************************************************************************
+ * Summary:
+ * Hand queued bytes to the writer until it stops taking them or all queues
+ * are empty. The frame in progress is always finished first; at each frame
+ * boundary the highest-priority class with a queued frame is chosen, so an
+ * urgent frame waits for at most the rest of one bulk frame.
+ *
+ * Parameters:
+ *  tx_sched_t *sched: Scheduler instance
+ *  uint32_t now: Current time, in the unit passed to tx_sched_enqueue()
+ *
+ * Return:
+ *  uint32_t: Number of bytes written
+ *
+ *******************************************************************************/
+uint32_t tx_sched_pump(tx_sched_t *sched, uint32_t now)
+{
+    uint32_t written = 0;
+
+    for (;;)
+    {
+        tx_sched_queue_t *q;
+        tx_sched_frame_t *frame;
+        uint32_t position;
+        uint32_t chunk;
+        uint32_t taken;
+
+        if (sched->active == TX_SCHED_NONE)
+        {
+            for (uint8_t cls = 0; cls < TX_SCHED_CLASSES; ++cls)
+            {
+                if (sched->queue[cls].depth != 0)
+                {
+                    sched->active = cls;
+                    sched->sent = 0;
+                    break;
+                }
+            }
+            if (sched->active == TX_SCHED_NONE)
+            {
+                return written;
+            }
+        }
+
+        q = &sched->queue[sched->active];
+        frame = &q->frames[q->frame_out];
+        position = q->byte_out;
+        chunk = frame->len - sched->sent;
+        chunk = (chunk < (q->capacity - position)) ? chunk : (q->capacity - position);
+
+        taken = sched->write(sched->context, &q->data[position], chunk);
+        q->byte_out = tx_sched_wrap(q->byte_out + taken, q->capacity);
+        q->bytes -= taken;
+        sched->sent += taken;
+        written += taken;
+
+        if (sched->sent == frame->len)
+        {
+            uint32_t latency = now - frame->enqueued;
+
+            q->stats.frames++;
+            q->stats.bytes += frame->len;
+            q->stats.total_latency += latency;
+            q->stats.max_latency = (latency > q->stats.max_latency) ? latency : q->stats.max_latency;
+            q->frame_out = tx_sched_wrap(q->frame_out + 1u, q->max_frames);
+            q->depth--;
+            sched->active = TX_SCHED_NONE;
+        }
+        else if (taken < chunk)
+        {
+            /* Transmitter full, continue on the next call */
+            return written;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: tx_sched_pending
+ ********************************************************************************
+ * Summary:
+ * Bytes of a class not yet handed to the writer, including the rest of its
+ * frame in progress.
+ *
+ * Parameters:
+ *  const tx_sched_t *sched: Scheduler instance
+ *  tx_sched_class_t cls: Class to query
+ *
+ * Return:
+ *  uint32_t: Pending bytes, 0 once everything of the class was written
+ *
+ *******************************************************************************/
+uint32_t tx_sched_pending(const tx_sched_t *sched, tx_sched_class_t cls)
+{
+    return sched->queue[cls].bytes;
+}
+
+/* [] END OF FILE */
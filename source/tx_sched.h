@@ -0,0 +1,123 @@
+/******************************************************************************
+ * File Name:   tx_sched.h
+ *
+ * Description: Priority-classed transmit queue. Frames are queued per class in
+ *              bounded byte and frame rings and handed to a non-blocking
+ *              writer; urgent frames go out before bulk frames at the next
+ *              frame boundary. Kept free of XMCLib dependencies so the host
+ *              tools can use it.
+ *
+ * Related Document: See README.md
+ *
+ *******************************************************************************
+ *
+ * Copyright (c) 2024, Infineon Technologies AG
+ * All rights reserved.
+ *
+ * Boost Software License - Version 1.0 - August 17th, 2003
+ *
+ * Permission is hereby granted, free of charge, to any person or organization
+ * obtaining a copy of the software and accompanying documentation covered by
+ * this license (the "Software") to use, reproduce, display, distribute,
+ * execute, and transmit the Software, and to prepare derivative works of the
+ * Software, and to permit third-parties to whom the Software is furnished to
+ * do so, all subject to the following:
+ *
+ * The copyright notices in the Software and this entire statement, including
+ * the above license grant, this restriction and the following disclaimer,
+ * must be included in all copies of the Software, in whole or in part, and
+ * all derivative works of the Software, unless such copies or derivative
+ * works are solely in the form of machine-executable object code generated by
+ * a source language processor.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+
+#ifndef TX_SCHED_H
+#define TX_SCHED_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Defines
+ *******************************************************************************/
+#define TX_SCHED_CLASSES 2u
+
+/* No frame in progress */
+#define TX_SCHED_NONE 0xFFu
+
+/*******************************************************************************
+ * Types
+ *******************************************************************************/
+/* Classes in order of priority */
+typedef enum
+{
+    TX_SCHED_URGENT = 0,
+    TX_SCHED_BULK = 1
+} tx_sched_class_t;
+
+/* Write as much of data as the transmitter takes without waiting, return the bytes taken */
+typedef uint32_t (*tx_sched_write_t)(void *context, const uint8_t *data, uint32_t len);
+
+typedef struct
+{
+    uint32_t len;
+    uint32_t enqueued;                  /* Time of tx_sched_enqueue() */
+} tx_sched_frame_t;
+
+typedef struct
+{
+    uint32_t frames;                    /* Frames completely written */
+    uint32_t bytes;
+    uint32_t dropped;                   /* Frames refused because the class was full */
+    uint32_t peak_frames;               /* Highest number of queued frames */
+    uint32_t max_latency;               /* Longest time from enqueue to the last byte written */
+    uint64_t total_latency;             /* Sum over all frames, divide by frames for the mean */
+} tx_sched_stats_t;
+
+typedef struct
+{
+    uint8_t *data;                      /* Byte ring holding the queued frames back to back */
+    uint32_t capacity;
+    tx_sched_frame_t *frames;           /* Frame ring */
+    uint32_t max_frames;
+    uint32_t byte_in;                   /* Positions in the byte ring, wrapped at capacity */
+    uint32_t byte_out;
+    uint32_t bytes;                     /* Bytes queued */
+    uint32_t frame_in;                  /* Positions in the frame ring, wrapped at max_frames */
+    uint32_t frame_out;
+    uint32_t depth;                     /* Frames queued */
+    tx_sched_stats_t stats;
+} tx_sched_queue_t;
+
+typedef struct
+{
+    tx_sched_write_t write;
+    void *context;
+    uint8_t active;                     /* Class of the frame in progress, TX_SCHED_NONE if idle */
+    uint32_t sent;                      /* Bytes of the frame in progress already written */
+    tx_sched_queue_t queue[TX_SCHED_CLASSES];
+} tx_sched_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ *******************************************************************************/
+void tx_sched_init(tx_sched_t *sched, tx_sched_write_t write, void *context);
+void tx_sched_class_init(tx_sched_t *sched, tx_sched_class_t cls, uint8_t *data, uint32_t capacity,
+                         tx_sched_frame_t *frames, uint32_t max_frames);
+bool tx_sched_enqueue(tx_sched_t *sched, tx_sched_class_t cls, const uint8_t *data, uint32_t len, uint32_t now);
+uint32_t tx_sched_pump(tx_sched_t *sched, uint32_t now);
+uint32_t tx_sched_pending(const tx_sched_t *sched, tx_sched_class_t cls);
+
+#endif /* TX_SCHED_H */
+
+/* [] END OF FILE */